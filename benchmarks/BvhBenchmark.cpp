@@ -0,0 +1,214 @@
+// Times building, refitting and querying a BoundingVolumeHierarchy over a synthetic scene of random boxes, and checks
+// the queries against brute force.
+// Usage: oglre-bench-bvh [--objects N] [--threads N] [--rays N] [--iterations N]
+//
+// The scene's density does not depend on its size, so runs over 10^5 to 10^7 objects are comparable. Frustum culling is
+// compared with FrustumCuller testing every object, which is what the BVH replaces. Fails if a query result is wrong.
+
+#include "BoundingVolumeHierarchy.h"
+#include "FrustumCuller.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+double GetMilliseconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Median time of calling function iterations times.
+template <typename Function>
+double TimeMedian(uint32_t iterations, const Function& function)
+{
+    std::vector<double> times;
+    for (uint32_t i = 0; i < iterations; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        times.push_back(GetMilliseconds(start));
+    }
+
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+// Checks the BVH finds the same objects as testing every one of them.
+bool CheckFrustum(const Oglre::BoundingVolumeHierarchy& bvh, const Oglre::BoxBounds& bounds, const Oglre::Frustum& frustum, uint32_t iterations)
+{
+    std::vector<uint32_t> bvhVisible(bounds.GetCount());
+    std::vector<uint32_t> linearVisible(bounds.GetCount());
+    uint32_t bvhCount = 0;
+    uint32_t linearCount = 0;
+
+    const double bvhMs = TimeMedian(iterations, [&]() { bvhCount = bvh.CullFrustum(frustum, bvhVisible); });
+    const double linearMs = TimeMedian(iterations, [&]() { linearCount = Oglre::FrustumCuller::Cull(frustum, bounds, linearVisible); });
+
+    std::cout << "  Frustum: " << bvhCount << " visible, BVH " << bvhMs << " ms, every object " << linearMs << " ms ("
+              << linearMs / bvhMs << "x)" << std::endl;
+
+    std::sort(bvhVisible.begin(), bvhVisible.begin() + bvhCount);
+    const bool isSame = bvhCount == linearCount && std::equal(bvhVisible.begin(), bvhVisible.begin() + bvhCount, linearVisible.begin());
+    if (!isSame) {
+        std::cout << "  The BVH and every object culling disagree!" << std::endl;
+    }
+
+    return isSame;
+}
+
+// Nearest box entry distance by testing every box, the same way the BVH tests its leaves.
+float RaycastEveryObject(const Oglre::BoxBounds& bounds, const glm::vec3& origin, const glm::vec3& direction)
+{
+    const glm::vec3 inverseDirection = 1.0f / direction;
+
+    float nearest = std::numeric_limits<float>::infinity();
+    for (uint32_t i = 0; i < bounds.GetCount(); ++i) {
+        const glm::vec3 minimum(bounds.GetMinimum(0)[i], bounds.GetMinimum(1)[i], bounds.GetMinimum(2)[i]);
+        const glm::vec3 maximum(bounds.GetMaximum(0)[i], bounds.GetMaximum(1)[i], bounds.GetMaximum(2)[i]);
+        const glm::vec3 t0 = (minimum - origin) * inverseDirection;
+        const glm::vec3 t1 = (maximum - origin) * inverseDirection;
+        const glm::vec3 near = glm::min(t0, t1);
+        const glm::vec3 far = glm::max(t0, t1);
+
+        const float entry = std::max(std::max(near.x, near.y), std::max(near.z, 0.0f));
+        const float exit = std::min(std::min(far.x, far.y), std::min(far.z, nearest));
+        if (entry <= exit) {
+            nearest = entry;
+        }
+    }
+
+    return nearest;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t objectCount = 100000;
+    uint32_t threadCount = 0;
+    uint32_t rayCount = 100000;
+    uint32_t iterations = 20;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (argument == "--objects" && hasValue) {
+            objectCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (argument == "--threads" && hasValue) {
+            threadCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (argument == "--rays" && hasValue) {
+            rayCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (argument == "--iterations" && hasValue) {
+            iterations = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        }
+    }
+
+    // Boxes of 1 to 10 units, about one per 1000 cubic units.
+    const float sceneExtent = 5.0f * std::cbrt(static_cast<float>(objectCount));
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<float> position(-sceneExtent, sceneExtent);
+    std::uniform_real_distribution<float> size(0.5f, 5.0f);
+
+    Oglre::BoxBounds bounds;
+    bounds.Resize(objectCount);
+    for (uint32_t i = 0; i < objectCount; ++i) {
+        const glm::vec3 centre(position(random), position(random), position(random));
+        const glm::vec3 extent(size(random), size(random), size(random));
+        bounds.Set(i, centre - extent, centre + extent);
+    }
+
+    std::cout << "Scene of " << objectCount << " objects, " << 2.0f * sceneExtent << " units across" << std::endl;
+
+    // Build, on one thread and on all of them.
+    Oglre::BvhBuildSettings settings;
+    settings.threadCount = 1;
+    Oglre::BoundingVolumeHierarchy bvh;
+    auto start = std::chrono::steady_clock::now();
+    bvh.Build(bounds, settings);
+    const double serialBuildMs = GetMilliseconds(start);
+
+    settings.threadCount = threadCount;
+    start = std::chrono::steady_clock::now();
+    bvh.Build(bounds, settings);
+    const double parallelBuildMs = GetMilliseconds(start);
+
+    std::cout << "  Build: " << serialBuildMs << " ms on one thread, " << parallelBuildMs << " ms in parallel, " << bvh.GetNodeCount()
+              << " nodes, SAH cost " << bvh.GetSahCost() << std::endl;
+
+    // A camera in the middle of the scene, seeing a quarter of it or so.
+    const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 16.0f / 9.0f, 0.1f, sceneExtent);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const Oglre::Frustum frustum = Oglre::Frustum::FromMatrix(projection * view);
+    bool passed = CheckFrustum(bvh, bounds, frustum, iterations);
+
+    // Refit after a tenth of the objects move a little, then after a tenth of them move anywhere, which skews the tree.
+    const auto moveObjects = [&](float distance, const char* name) {
+        std::uniform_int_distribution<uint32_t> object(0, objectCount - 1);
+        std::uniform_real_distribution<float> offset(-distance, distance);
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < objectCount / 10; ++i) {
+            const uint32_t moved = object(random);
+            const glm::vec3 minimum(bounds.GetMinimum(0)[moved], bounds.GetMinimum(1)[moved], bounds.GetMinimum(2)[moved]);
+            const glm::vec3 maximum(bounds.GetMaximum(0)[moved], bounds.GetMaximum(1)[moved], bounds.GetMaximum(2)[moved]);
+            const glm::vec3 movedMinimum = glm::clamp(minimum + glm::vec3(offset(random), offset(random), offset(random)), glm::vec3(-sceneExtent), glm::vec3(sceneExtent));
+            const glm::vec3 movedMaximum = movedMinimum + (maximum - minimum);
+
+            bounds.Set(moved, movedMinimum, movedMaximum);
+            bvh.UpdateObject(moved, movedMinimum, movedMaximum);
+        }
+        const double updateMs = GetMilliseconds(start);
+
+        start = std::chrono::steady_clock::now();
+        const uint32_t rebuiltCount = bvh.Refit();
+        const double refitMs = GetMilliseconds(start);
+
+        std::cout << "  Refit, " << name << ": " << updateMs << " ms updating, " << refitMs << " ms refitting, " << rebuiltCount
+                  << " subtrees rebuilt, SAH cost " << bvh.GetSahCost() << std::endl;
+    };
+
+    moveObjects(2.0f, "small moves");
+    passed &= CheckFrustum(bvh, bounds, frustum, iterations);
+    moveObjects(2.0f * sceneExtent, "large moves");
+    passed &= CheckFrustum(bvh, bounds, frustum, iterations);
+
+    // Rays from random points in random directions, like picking from cameras all over the scene.
+    std::normal_distribution<float> direction(0.0f, 1.0f);
+    std::vector<glm::vec3> origins(rayCount);
+    std::vector<glm::vec3> directions(rayCount);
+    for (uint32_t i = 0; i < rayCount; ++i) {
+        origins[i] = glm::vec3(position(random), position(random), position(random));
+        directions[i] = glm::normalize(glm::vec3(direction(random), direction(random), direction(random)));
+    }
+
+    uint32_t hitCount = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < rayCount; ++i) {
+        hitCount += bvh.Raycast(origins[i], directions[i]).IsHit();
+    }
+    const double rayMs = GetMilliseconds(start);
+    std::cout << "  Rays: " << hitCount << " / " << rayCount << " hit, " << 1e6 * rayMs / std::max(rayCount, 1u) << " ns per ray" << std::endl;
+
+    // Brute force is slow, so only a few rays are checked.
+    const uint32_t checkedRayCount = std::min(rayCount, std::max(1u, 100000000 / std::max(objectCount, 1u)));
+    uint32_t wrongRayCount = 0;
+    for (uint32_t i = 0; i < checkedRayCount; ++i) {
+        wrongRayCount += bvh.Raycast(origins[i], directions[i]).distance != RaycastEveryObject(bounds, origins[i], directions[i]);
+    }
+    if (wrongRayCount > 0) {
+        std::cout << "  " << wrongRayCount << " of " << checkedRayCount << " rays disagree with testing every object!" << std::endl;
+        passed = false;
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,497 @@
+// Times the CPU side of the renderer's hot paths, none of which need an OpenGL context: vertex layout construction,
+// program reflection and uniform lookup, camera matrices, shader preprocessing, render key sorting, transform updates
+// and frustum culling.
+// Usage: oglre-bench-cpu [--filter TEXT] [--samples N] [--shader FILE.glsl] [--json FILE]
+//
+// Each case runs enough times per sample to take at least a millisecond, and reports the median and fastest time per
+// run over the samples (15 by default). --filter only runs the cases whose name contains TEXT. --json also writes the
+// results out for tracking over time:
+//     { "benchmarks": [ { "name": "...", "items": N, "median_ns": ..., "minimum_ns": ..., "median_ns_per_item": ... } ] }
+// Program reflection reads a stub program through a stub GL function table, see InstallStubGLFunctions().
+// Build with --buildtype=release for meaningful numbers.
+
+#include "Camera.h"
+#include "FrustumCuller.h"
+#include "RadixSort.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderReflection.h"
+#include "TransformHierarchy.h"
+#include "VertexBufferLayout.h"
+#include "VertexFormats.h"
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// ----------------------
+// Stub GL Function Table
+// ----------------------
+//
+// ShaderReflection only talks to the driver through glGetProgramInterfaceiv(), glGetProgramResourceiv() and
+// glGetProgramResourceName(), which GLEW loads into function pointers. Pointing those at the functions below stands in
+// for a linked program shaped like the Basic program's MULTIVIEW + INSTANCED permutation, plus a few plain uniforms such
+// as a material would have.
+
+struct StubResource {
+    const char* name;
+    GLint type;
+    GLint location;
+    GLint blockIndex;
+    GLint arraySize;
+    GLint binding; // Blocks only.
+    GLint dataSize; // Blocks only.
+};
+
+// clang-format off
+const std::array<StubResource, 11> stubUniforms = { {
+    { "view",                   GL_FLOAT_MAT4,  -1, 0, 1 },
+    { "projection",             GL_FLOAT_MAT4,  -1, 0, 1 },
+    { "viewProjection",         GL_FLOAT_MAT4,  -1, 0, 1 },
+    { "cameraPosition",         GL_FLOAT_VEC4,  -1, 0, 1 },
+    { "model",                  GL_FLOAT_MAT4,  -1, 1, 1 },
+    { "mvp",                    GL_FLOAT_MAT4,  -1, 1, 1 },
+    { "viewProjections[0]",     GL_FLOAT_MAT4,  -1, 2, 4 },
+    { "viewCount",              GL_UNSIGNED_INT, -1, 2, 1 },
+    { "u_BaseColour",           GL_FLOAT_VEC4,  0, -1, 1 },
+    { "u_Roughness",            GL_FLOAT,       1, -1, 1 },
+    { "u_LightDirections[0]",   GL_FLOAT_VEC4,  2, -1, 8 },
+} };
+
+const std::array<StubResource, 3> stubUniformBlocks = { {
+    { "FrameUniforms",  0, -1, -1, 1, 0, 208 },
+    { "ObjectUniforms", 0, -1, -1, 1, 1, 128 },
+    { "ViewUniforms",   0, -1, -1, 1, 2, 272 },
+} };
+
+const std::array<StubResource, 3> stubInputs = { {
+    { "instanceModel",      GL_FLOAT_MAT4,  2, -1, 1 },
+    { "position",           GL_FLOAT_VEC3,  0, -1, 1 },
+    { "vertexInputColour",  GL_FLOAT_VEC3,  1, -1, 1 },
+} };
+// clang-format on
+
+std::span<const StubResource> GetStubResources(GLenum programInterface)
+{
+    switch (programInterface) {
+    case GL_UNIFORM:
+        return stubUniforms;
+    case GL_UNIFORM_BLOCK:
+        return stubUniformBlocks;
+    case GL_PROGRAM_INPUT:
+        return stubInputs;
+    }
+    return {};
+}
+
+void GLAPIENTRY StubGetProgramInterfaceiv(GLuint, GLenum programInterface, GLenum parameter, GLint* values)
+{
+    *values = parameter == GL_ACTIVE_RESOURCES ? static_cast<GLint>(GetStubResources(programInterface).size()) : 0;
+}
+
+void GLAPIENTRY StubGetProgramResourceiv(GLuint, GLenum programInterface, GLuint index, GLsizei propertyCount, const GLenum* properties, GLsizei valueCount,
+    GLsizei* length, GLint* values)
+{
+    const StubResource& resource = GetStubResources(programInterface)[index];
+    const GLsizei count = std::min(propertyCount, valueCount);
+    for (GLsizei i = 0; i < count; ++i) {
+        // clang-format off
+        switch (properties[i]) {
+            case GL_NAME_LENGTH:        values[i] = static_cast<GLint>(std::strlen(resource.name) + 1); break;
+            case GL_TYPE:               values[i] = resource.type; break;
+            case GL_LOCATION:           values[i] = resource.location; break;
+            case GL_BLOCK_INDEX:        values[i] = resource.blockIndex; break;
+            case GL_ARRAY_SIZE:         values[i] = resource.arraySize; break;
+            case GL_BUFFER_BINDING:     values[i] = resource.binding; break;
+            case GL_BUFFER_DATA_SIZE:   values[i] = resource.dataSize; break;
+            default:                    values[i] = 0; break;
+        }
+        // clang-format on
+    }
+    if (length != nullptr) {
+        *length = count;
+    }
+}
+
+void GLAPIENTRY StubGetProgramResourceName(GLuint, GLenum programInterface, GLuint index, GLsizei size, GLsizei* length, GLchar* name)
+{
+    const StubResource& resource = GetStubResources(programInterface)[index];
+    const GLsizei nameLength = std::min(static_cast<GLsizei>(std::strlen(resource.name)), size - 1);
+    std::memcpy(name, resource.name, nameLength);
+    name[nameLength] = '\0';
+    if (length != nullptr) {
+        *length = nameLength;
+    }
+}
+
+void InstallStubGLFunctions()
+{
+    __glewGetProgramInterfaceiv = StubGetProgramInterfaceiv;
+    __glewGetProgramResourceiv = StubGetProgramResourceiv;
+    __glewGetProgramResourceName = StubGetProgramResourceName;
+}
+
+// -------
+// Harness
+// -------
+
+struct BenchmarkResult {
+    std::string name;
+    uint64_t items = 1; // Per run, e.g. keys sorted.
+    double medianNs = 0.0;
+    double minimumNs = 0.0;
+};
+
+// Keeps the optimizer from removing work whose result is otherwise unused.
+volatile uint64_t sink = 0;
+
+template <typename T>
+void Consume(const T& value)
+{
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, std::min(sizeof(value), sizeof(bits)));
+    sink = sink + bits;
+}
+
+class BenchmarkRunner {
+public:
+    std::string filter;
+    uint32_t sampleCount = 15;
+
+    // Times run, which does items worth of work per call.
+    template <typename Function>
+    void Run(const std::string& name, uint64_t items, const Function& run)
+    {
+        if (!filter.empty() && name.find(filter) == std::string::npos) {
+            return;
+        }
+
+        using Clock = std::chrono::steady_clock;
+        const auto timeRuns = [&run](uint64_t runCount) {
+            const auto start = Clock::now();
+            for (uint64_t i = 0; i < runCount; ++i) {
+                run();
+            }
+            return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        };
+
+        // Warms the caches, then finds how many runs take a millisecond.
+        uint64_t runsPerSample = 1;
+        while (timeRuns(runsPerSample) < 1e6 && runsPerSample < (uint64_t(1) << 30)) {
+            runsPerSample *= 2;
+        }
+
+        std::vector<double> samples;
+        samples.reserve(sampleCount);
+        for (uint32_t sample = 0; sample < sampleCount; ++sample) {
+            samples.push_back(timeRuns(runsPerSample) / static_cast<double>(runsPerSample));
+        }
+        std::sort(samples.begin(), samples.end());
+
+        BenchmarkResult& result = m_Results.emplace_back();
+        result.name = name;
+        result.items = items;
+        result.medianNs = samples[samples.size() / 2];
+        result.minimumNs = samples.front();
+
+        std::cout << std::left << std::setw(48) << name << std::right << std::setw(14) << FormatTime(result.medianNs) << " median" << std::setw(14)
+                  << FormatTime(result.minimumNs) << " min";
+        if (items > 1) {
+            std::cout << std::setw(12) << std::setprecision(3) << result.medianNs / items << " ns/item";
+        }
+        std::cout << std::endl;
+    }
+
+    bool WriteJson(const std::string& filepath) const
+    {
+        std::ofstream stream(filepath, std::ios::trunc);
+        if (!stream) {
+            std::cout << "Results could not be written to " << filepath << std::endl;
+            return false;
+        }
+
+        stream.precision(10);
+        stream << "{\n  \"benchmarks\": [";
+        for (size_t i = 0; i < m_Results.size(); ++i) {
+            const BenchmarkResult& result = m_Results[i];
+            stream << (i == 0 ? "\n" : ",\n") << "    { \"name\": \"" << result.name << "\", \"items\": " << result.items << ", \"median_ns\": " << result.medianNs
+                   << ", \"minimum_ns\": " << result.minimumNs << ", \"median_ns_per_item\": " << result.medianNs / result.items << " }";
+        }
+        stream << "\n  ]\n}\n";
+
+        return static_cast<bool>(stream);
+    }
+
+private:
+    std::vector<BenchmarkResult> m_Results;
+
+    static std::string FormatTime(double nanoseconds)
+    {
+        std::ostringstream stream;
+        stream << std::fixed << std::setprecision(nanoseconds < 10.0 ? 2 : 1);
+        if (nanoseconds < 1e3) {
+            stream << nanoseconds << " ns";
+        } else if (nanoseconds < 1e6) {
+            stream << nanoseconds / 1e3 << " us";
+        } else {
+            stream << nanoseconds / 1e6 << " ms";
+        }
+        return stream.str();
+    }
+};
+
+// -----
+// Cases
+// -----
+
+void BenchmarkVertexLayouts(BenchmarkRunner& runner)
+{
+    // The instanced demo's two buffers: position and packed colour per vertex, a mat4 per instance.
+    runner.Run("vertex layout/push", 1, []() {
+        Oglre::VertexBufferLayout vertexLayout;
+        vertexLayout.Push<float>(3);
+        vertexLayout.Push<Oglre::Unorm10_10_10_2>(1);
+        Oglre::VertexBufferLayout instanceLayout;
+        instanceLayout.Push<glm::mat4>(1, 1);
+        Consume(vertexLayout.GetStride() + instanceLayout.GetStride());
+    });
+
+    runner.Run("vertex layout/static copy", 1, []() {
+        using VertexLayout = Oglre::StaticVertexLayout<Oglre::ColouredVertex>;
+        using InstanceLayout = Oglre::StaticVertexLayout<Oglre::InstanceTransform>;
+        const Oglre::VertexBufferLayout vertexLayout(VertexLayout::elements, VertexLayout::stride);
+        const Oglre::VertexBufferLayout instanceLayout(InstanceLayout::elements, InstanceLayout::stride);
+        Consume(vertexLayout.GetElements().size() + instanceLayout.GetElements().size());
+    });
+}
+
+void BenchmarkShaderReflection(BenchmarkRunner& runner)
+{
+    Oglre::ShaderReflection reflection;
+    runner.Run("shader reflection/reflect", stubUniforms.size() + stubUniformBlocks.size() + stubInputs.size(), [&reflection]() {
+        reflection.Reflect(1);
+        Consume(reflection.GetUniforms().size());
+    });
+
+    // What Shader::GetUniformHandle() does once the program is linked, for every uniform and one that is not there.
+    std::vector<std::string> names;
+    for (const Oglre::ShaderUniform& uniform : reflection.GetUniforms()) {
+        names.push_back(uniform.name);
+    }
+    names.push_back("u_Missing");
+
+    runner.Run("shader reflection/find uniform", names.size(), [&reflection, &names]() {
+        for (const std::string& name : names) {
+            Consume(reflection.FindUniform(name));
+        }
+    });
+}
+
+void BenchmarkCamera(BenchmarkRunner& runner)
+{
+    Oglre::Camera camera;
+    camera.SetPerspective(16.0f / 9.0f, 0.1f, 10000.0f);
+
+    // Moving every run dirties the view, so the view and view-projection matrices are recomputed.
+    float offset = 0.0f;
+    runner.Run("camera/move and update matrices", 1, [&camera, &offset]() {
+        offset = offset == 0.0f ? 1.0f : 0.0f;
+        camera.SetPosition(glm::vec3(200.0f + offset, 200.0f, 400.0f));
+        Consume(camera.GetViewProjectionMatrix()[3][3]);
+    });
+
+    runner.Run("camera/turn and update matrices", 1, [&camera]() {
+        camera.processMouseMovement(0.5f, 0.0f);
+        Consume(camera.GetViewProjectionMatrix()[3][3]);
+    });
+
+    runner.Run("camera/cached matrices", 1, [&camera]() {
+        Consume(camera.GetViewProjectionMatrix()[3][3]);
+    });
+}
+
+void BenchmarkShaderPreprocessor(BenchmarkRunner& runner, const std::string& shaderPath)
+{
+    // The program and its includes are read once up front, so that only preprocessing is timed.
+    std::map<std::string, std::string> files;
+    const auto readCachedFile = [&files](const std::string& path, std::string& text) {
+        auto file = files.find(path);
+        if (file == files.end()) {
+            std::string fileText;
+            if (!Oglre::ShaderPreprocessor::ReadFile(path, fileText)) {
+                return false;
+            }
+            file = files.emplace(path, std::move(fileText)).first;
+        }
+        text = file->second;
+        return true;
+    };
+
+    Oglre::PreprocessedShader shader;
+    if (!Oglre::ShaderPreprocessor::Preprocess(shaderPath, readCachedFile, shader)) {
+        std::cout << "Skipping the shader preprocessor, " << shaderPath << " could not be read (see --shader)" << std::endl;
+        return;
+    }
+
+    uint64_t sourceBytes = 0;
+    for (const auto& [path, text] : files) {
+        sourceBytes += text.size();
+    }
+
+    runner.Run("shader preprocessor/preprocess (per byte)", sourceBytes, [&shaderPath, &readCachedFile]() {
+        Oglre::PreprocessedShader preprocessed;
+        Oglre::ShaderPreprocessor::Preprocess(shaderPath, readCachedFile, preprocessed);
+        Consume(preprocessed.stages.size());
+    });
+
+    // Every stage of the permutation with the most defines the demo uses.
+    const std::vector<std::string> defines = { "MULTIVIEW", "INSTANCED" };
+    runner.Run("shader preprocessor/permutation source", shader.stages.size(), [&shader, &defines]() {
+        for (const Oglre::ShaderStageSource& stage : shader.stages) {
+            if (Oglre::ShaderPreprocessor::IsStageEnabled(stage.condition, defines)) {
+                Consume(Oglre::ShaderPreprocessor::GetPermutationSource(stage.version, stage.body, defines).size());
+            }
+        }
+    });
+}
+
+void BenchmarkSorting(BenchmarkRunner& runner, uint32_t count)
+{
+    // Render keys as Renderer::MakeSortKey() lays them out: a few passes and shaders in the high bits, depth below.
+    std::mt19937_64 random(12345);
+    std::vector<Oglre::SortItem> keys(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const uint64_t pass = random() % 2;
+        const uint64_t shader = random() % 8;
+        const uint64_t depth = random() & 0xFFFFFF;
+        keys[i] = { (pass << 60) | (shader << 48) | depth, i };
+    }
+
+    std::vector<Oglre::SortItem> items;
+    std::vector<Oglre::SortItem> scratch;
+    runner.Run("sorting/radix sort " + std::to_string(count) + " keys", count, [&]() {
+        items = keys;
+        Oglre::RadixSort(items, scratch);
+        Consume(items.front().index);
+    });
+
+    runner.Run("sorting/std::stable_sort " + std::to_string(count) + " keys", count, [&]() {
+        items = keys;
+        std::stable_sort(items.begin(), items.end(), [](const Oglre::SortItem& a, const Oglre::SortItem& b) { return a.key < b.key; });
+        Consume(items.front().index);
+    });
+}
+
+void BenchmarkTransforms(BenchmarkRunner& runner, uint32_t count)
+{
+    // The instanced demo's layout: a root with every instance as its child. Kept on one thread, so that results do not
+    // depend on the machine's core count.
+    Oglre::TransformHierarchy hierarchy;
+    hierarchy.parallelThreshold = std::numeric_limits<uint32_t>::max();
+
+    const uint32_t root = hierarchy.CreateNode();
+    std::vector<uint32_t> nodes;
+    nodes.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        nodes.push_back(hierarchy.CreateNode(root, glm::vec3(static_cast<float>(i % 64), static_cast<float>(i / 64 % 64), static_cast<float>(i / 4096))));
+    }
+    hierarchy.Update();
+
+    // Moving the root dirties every instance under it.
+    float offset = 0.0f;
+    runner.Run("transforms/update " + std::to_string(count) + " nodes", count, [&]() {
+        offset = offset == 0.0f ? 1.0f : 0.0f;
+        hierarchy.SetTranslation(root, glm::vec3(offset, 0.0f, 0.0f));
+        Consume(hierarchy.Update());
+    });
+
+    const glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 10000.0f)
+        * glm::lookAt(glm::vec3(0.0f, 0.0f, 100.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    std::vector<glm::mat4> mvpMatrices(count);
+    runner.Run("transforms/mvp matrices " + std::to_string(count) + " nodes", count, [&]() {
+        hierarchy.ComputeMvpMatrices(viewProjection, nodes, mvpMatrices);
+        Consume(mvpMatrices.back()[3][3]);
+    });
+}
+
+void BenchmarkCulling(BenchmarkRunner& runner, uint32_t count)
+{
+    // Boxes filling a 20000 unit cube around the camera, as in oglre-bench-culling, which compares the SIMD and
+    // scalar paths in more depth.
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<float> position(-10000.0f, 10000.0f);
+    Oglre::BoxBounds bounds;
+    bounds.Resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const glm::vec3 centre(position(random), position(random), position(random));
+        bounds.Set(i, centre - glm::vec3(50.0f), centre + glm::vec3(50.0f));
+    }
+
+    const glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 10000.0f)
+        * glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const Oglre::Frustum frustum = Oglre::Frustum::FromMatrix(viewProjection);
+    std::vector<uint32_t> visibleIndices(count);
+    runner.Run("culling/frustum " + std::to_string(count) + " boxes", count, [&]() {
+        Consume(Oglre::FrustumCuller::Cull(frustum, bounds, visibleIndices));
+    });
+}
+}
+
+int main(int argc, char* argv[])
+{
+    BenchmarkRunner runner;
+    std::string shaderPath = "resources/shaders/Basic.glsl";
+    std::string jsonPath = "";
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (argument == "--filter" && hasValue) {
+            runner.filter = argv[++i];
+        } else if (argument == "--samples" && hasValue) {
+            runner.sampleCount = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        } else if (argument == "--shader" && hasValue) {
+            shaderPath = argv[++i];
+        } else if (argument == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        }
+    }
+
+    InstallStubGLFunctions();
+
+    BenchmarkVertexLayouts(runner);
+    BenchmarkShaderReflection(runner);
+    BenchmarkCamera(runner);
+    BenchmarkShaderPreprocessor(runner, shaderPath);
+    BenchmarkSorting(runner, 1000);
+    BenchmarkSorting(runner, 100000);
+    BenchmarkTransforms(runner, 100000);
+    BenchmarkCulling(runner, 100000);
+
+    if (!jsonPath.empty() && !runner.WriteJson(jsonPath)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,204 @@
+// Times FrustumCuller over a million random boxes and spheres, with the scalar and the AVX2 paths, and checks that both
+// give the same visible lists.
+// Usage: oglre-bench-culling [--objects N] [--iterations N] [--budget MS]
+//
+// Fails if the paths disagree, or if the SIMD box test takes longer than the budget per cull.
+//
+// The target is 1 ms per million objects, but a million boxes are 24 MB of bounds, far larger than the caches, and the
+// SIMD test keeps up with reading them: on machines with less than 24 GB/s for one core it is bound by memory, not by
+// the test. So the default budget is the target or 1.5 times the time it takes just to read the bounds, whichever is
+// larger, and the read time and bandwidth are reported with it. --budget MS sets a fixed budget instead.
+// The objects fill a 20000 unit cube around a camera like the demo's, so roughly a quarter of them are visible.
+// Build with --buildtype=release, the budget is not checked in unoptimized builds.
+
+#include "FrustumCuller.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+struct CullTiming {
+    double medianMs = 0.0;
+    double minimumMs = 0.0;
+    uint32_t visibleCount = 0;
+};
+
+template <typename Bounds>
+CullTiming TimeCull(const Oglre::Frustum& frustum, const Bounds& bounds, std::vector<uint32_t>& visibleIndices, uint32_t iterations)
+{
+    std::vector<double> times;
+    times.reserve(iterations);
+
+    CullTiming timing;
+    for (uint32_t i = 0; i < iterations; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        timing.visibleCount = Oglre::FrustumCuller::Cull(frustum, bounds, visibleIndices);
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::sort(times.begin(), times.end());
+    timing.medianMs = times[times.size() / 2];
+    timing.minimumMs = times.front();
+
+    return timing;
+}
+
+// XORs every 8 bytes of array together, 4 accumulators at a time so the loads are not serialized.
+uint64_t ReadArray(const float* array, uint32_t count)
+{
+    const char* bytes = reinterpret_cast<const char*>(array);
+    const size_t size = size_t(count) * sizeof(float);
+
+    uint64_t accumulators[4] = {};
+    size_t offset = 0;
+    for (; offset + sizeof(accumulators) <= size; offset += sizeof(accumulators)) {
+        uint64_t words[4];
+        std::memcpy(words, bytes + offset, sizeof(words));
+        for (int i = 0; i < 4; ++i) {
+            accumulators[i] ^= words[i];
+        }
+    }
+    for (; offset < size; ++offset) {
+        accumulators[0] ^= static_cast<uint8_t>(bytes[offset]);
+    }
+
+    return accumulators[0] ^ accumulators[1] ^ accumulators[2] ^ accumulators[3];
+}
+
+// Median time to read every byte of the boxes' bounds with plain loads. Once the bounds do not fit the caches, a cull
+// cannot do much better than this.
+double TimeBoundsRead(const Oglre::BoxBounds& bounds, uint32_t iterations)
+{
+    std::vector<double> times;
+    times.reserve(iterations);
+
+    uint64_t checksum = 0;
+    for (uint32_t i = 0; i < iterations; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t axis = 0; axis < 3; ++axis) {
+            checksum ^= ReadArray(bounds.GetMinimum(axis), bounds.GetCount());
+            checksum ^= ReadArray(bounds.GetMaximum(axis), bounds.GetCount());
+        }
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    // Keeps the reads from being optimized away.
+    volatile uint64_t sink = checksum;
+    static_cast<void>(sink);
+
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+// Times both paths on bounds. Returns false if their visible lists differ.
+template <typename Bounds>
+bool Compare(const char* name, const Oglre::Frustum& frustum, const Bounds& bounds, uint32_t iterations, double& simdMedianMs)
+{
+    std::vector<uint32_t> scalarIndices(bounds.GetCount());
+    std::vector<uint32_t> simdIndices(bounds.GetCount());
+
+    Oglre::FrustumCuller::simdEnabled = false;
+    const CullTiming scalar = TimeCull(frustum, bounds, scalarIndices, iterations);
+    Oglre::FrustumCuller::simdEnabled = true;
+    const CullTiming simd = TimeCull(frustum, bounds, simdIndices, iterations);
+
+    const double objectsPerNs = bounds.GetCount() / (simd.medianMs * 1e6);
+    std::cout << name << ": " << simd.visibleCount << " / " << bounds.GetCount() << " visible\n"
+              << "  scalar: median " << scalar.medianMs << " ms, min " << scalar.minimumMs << " ms\n"
+              << "  simd:   median " << simd.medianMs << " ms, min " << simd.minimumMs << " ms (" << objectsPerNs << " objects/ns, "
+              << scalar.medianMs / simd.medianMs << "x)" << std::endl;
+
+    simdMedianMs = simd.medianMs;
+
+    const bool isSame = scalar.visibleCount == simd.visibleCount
+        && std::equal(scalarIndices.begin(), scalarIndices.begin() + scalar.visibleCount, simdIndices.begin());
+    if (!isSame) {
+        std::cout << name << ": the scalar and SIMD visible lists differ!" << std::endl;
+    }
+
+    return isSame;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t objectCount = 1000000;
+    uint32_t iterations = 50;
+    double budgetMs = 0.0; // 0 for the default, see above.
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (argument == "--objects" && hasValue) {
+            objectCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (argument == "--iterations" && hasValue) {
+            iterations = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        } else if (argument == "--budget" && hasValue) {
+            budgetMs = std::stod(argv[++i]);
+        }
+    }
+
+    // Fixed seed, so every run culls the same scene.
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<float> position(-10000.0f, 10000.0f);
+    std::uniform_real_distribution<float> size(1.0f, 200.0f);
+
+    Oglre::BoxBounds boxes;
+    Oglre::SphereBounds spheres;
+    boxes.Resize(objectCount);
+    spheres.Resize(objectCount);
+    for (uint32_t i = 0; i < objectCount; ++i) {
+        const glm::vec3 centre(position(random), position(random), position(random));
+        const glm::vec3 extent(size(random), size(random), size(random));
+        boxes.Set(i, centre - extent, centre + extent);
+        spheres.Set(i, centre, glm::length(extent));
+    }
+
+    const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 16.0f / 9.0f, 0.1f, 10000.0f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(200.0f, 200.0f, 400.0f), glm::vec3(200.0f, 200.0f, 399.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const Oglre::Frustum frustum = Oglre::Frustum::FromMatrix(projection * view);
+
+    std::cout << "Culling " << objectCount << " objects, " << iterations << " iterations, SIMD "
+              << (Oglre::FrustumCuller::IsSimdSupported() ? "supported" : "not supported") << std::endl;
+
+    double boxMedianMs = 0.0;
+    double sphereMedianMs = 0.0;
+    bool passed = Compare("Boxes", frustum, boxes, iterations, boxMedianMs);
+    passed &= Compare("Spheres", frustum, spheres, iterations, sphereMedianMs);
+
+    const double readMs = TimeBoundsRead(boxes, iterations);
+    const double boundsMegabytes = 6.0 * sizeof(float) * objectCount / 1e6;
+    std::cout << "Reading the box bounds: median " << readMs << " ms for " << boundsMegabytes << " MB (" << boundsMegabytes / readMs << " GB/s)"
+              << std::endl;
+
+    if (budgetMs <= 0.0) {
+        const double targetMs = objectCount / 1e6;
+        budgetMs = std::max(targetMs, 1.5 * readMs);
+    }
+    std::cout << "Budget: " << budgetMs << " ms per box cull" << std::endl;
+
+#ifndef __OPTIMIZE__
+    std::cout << "Unoptimized build, not checking the budget." << std::endl;
+    budgetMs = std::numeric_limits<double>::infinity();
+#endif
+
+    if (Oglre::FrustumCuller::IsSimdSupported() && boxMedianMs > budgetMs) {
+        std::cout << "Box culling took " << boxMedianMs << " ms, over the " << budgetMs << " ms budget!" << std::endl;
+        passed = false;
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
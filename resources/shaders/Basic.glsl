@@ -1,30 +1,80 @@
 #shader vertex
-#version 330 core
-                            
-layout(location = 0) in vec3  position;
+#version 450 core
+// Permutations, see include/Transform.glsl: none, INSTANCED or INDIRECT. Any of them can add MULTIVIEW, which draws
+// every view of Renderer::SetViews() in one pass.
+#ifdef INDIRECT
+#extension GL_ARB_shader_draw_parameters : require
+#endif
+
+layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 vertexInputColour;
 
-out vec3 vertexOutputColour;
+out VertexOutput
+{
+    vec3 colour;
+} vertexOutput;
 
-// For orthographic matrix
-uniform mat4 u_MVP;
+#include "include/Transform.glsl"
 
 void main()
-{  
+{
     vec4 pos4 = vec4(position, 1.0);
-    // Note that matrix multiplication is NOT commutative.
-    gl_Position = u_MVP * pos4;
+#ifdef MULTIVIEW
+    // World space, the geometry shader projects it into each view.
+    gl_Position = GetModelMatrix() * pos4;
+#else
+    gl_Position = GetClipPosition(pos4);
+#endif
+
+    vertexOutput.colour = vertexInputColour;
+};
+
+#shader geometry MULTIVIEW
+#version 450 core
+// One invocation per view, each projecting the triangle with its view's camera into its own viewport, so the scene is
+// only submitted once however many views there are.
+
+#include "include/Uniforms.glsl"
+
+layout(triangles, invocations = MAX_VIEWS) in;
+layout(triangle_strip, max_vertices = 3) out;
 
-    vertexOutputColour = vertexInputColour;
+in VertexOutput
+{
+    vec3 colour;
+} geometryInput[];
+
+out VertexOutput
+{
+    vec3 colour;
+} geometryOutput;
+
+void main()
+{
+    if (gl_InvocationID >= int(viewCount)) {
+        return;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        gl_Position = viewProjections[gl_InvocationID] * gl_in[i].gl_Position;
+        gl_ViewportIndex = gl_InvocationID;
+        geometryOutput.colour = geometryInput[i].colour;
+        EmitVertex();
+    }
+    EndPrimitive();
 };
 
 #shader fragment
-#version 330 core
+#version 450 core
+
+in VertexOutput
+{
+    vec3 colour;
+} fragmentInput;
 
-in vec3 vertexOutputColour;      
 out vec4 fragmentColour;
 
 void main()
-{  
-    fragmentColour = vec4(vertexOutputColour, 1.0);
-};
\ No newline at end of file
+{
+    fragmentColour = vec4(fragmentInput.colour, 1.0);
+};
@@ -0,0 +1,47 @@
+// Model space to clip space, with the model matrix from wherever the permutation gets it.
+// Note that matrix multiplication is NOT commutative.
+#include "Uniforms.glsl"
+
+#if defined(INSTANCED)
+
+// Per-instance model matrix, one column per attribute location (2, 3, 4 and 5).
+layout(location = 2) in mat4 instanceModel;
+
+mat4 GetModelMatrix()
+{
+    return instanceModel;
+}
+
+#elif defined(INDIRECT)
+
+// One model matrix per indirect draw command, written by IndirectDrawBatch::Upload().
+layout(std430, binding = 0) readonly buffer DrawData
+{
+    mat4 models[];
+};
+
+mat4 GetModelMatrix()
+{
+    return models[gl_DrawIDARB];
+}
+
+#else
+
+// The object's matrices, one block per draw.
+mat4 GetModelMatrix()
+{
+    return model;
+}
+
+#endif
+
+// Clip space of the frame's camera. Draws with ObjectUniforms have their MVP matrix computed on the CPU already, the
+// others only get their model matrix, so the frame's view and projection are applied here.
+vec4 GetClipPosition(vec4 position)
+{
+#if defined(INSTANCED) || defined(INDIRECT)
+    return viewProjection * GetModelMatrix() * position;
+#else
+    return mvp * position;
+#endif
+}
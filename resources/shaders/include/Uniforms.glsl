@@ -0,0 +1,27 @@
+// Uniform blocks shared by every program, bound by binding point rather than set by name.
+// Must match the C++ structs of the same names in src/Renderer/UniformBuffer.h, which Shader checks at load time.
+
+// Written once per frame, see Renderer::SetFrameUniforms().
+layout(std140, binding = 0) uniform FrameUniforms
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 cameraPosition;
+};
+
+// Written once per draw by Renderer::Flush().
+layout(std140, binding = 1) uniform ObjectUniforms
+{
+    mat4 model;
+    mat4 mvp;
+};
+
+// Every view of a multi-view pass, see Renderer::SetViews(). Only MULTIVIEW permutations read it.
+#define MAX_VIEWS 4
+
+layout(std140, binding = 2) uniform ViewUniforms
+{
+    mat4 viewProjections[MAX_VIEWS];
+    uint viewCount;
+};
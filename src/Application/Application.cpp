@@ -1,11 +1,31 @@
 #include "Application.h"
+#include "BenchmarkReport.h"
+#include "BoundingVolumeHierarchy.h"
 #include "Camera.h"
+#include "CameraPath.h"
+#include "FrustumCuller.h"
+#include "GLStateCache.h"
+#include "GeometryArena.h"
+#include "GpuHeap.h"
+#include "Importer.h"
+#include "JobSystem.h"
 #include "IndexBuffer.h"
+#include "IndirectDrawBatch.h"
+#include "MeshFile.h"
+#include "MeshLod.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "Profiler.h"
 #include "Renderer.h"
 #include "Shader.h"
+#include "ShaderCache.h"
+#include "TransformHierarchy.h"
+#include "UniformBuffer.h"
 #include "VertexArray.h"
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
+#include "VertexFormats.h"
+#include "VertexQuantizer.h"
 
 // Maths Library
 #include <glm/glm.hpp>
@@ -18,57 +38,99 @@
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <span>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 // ---------------------
 // Application Execution
 // ---------------------
 
-void Oglre::Application::Initialize()
+void Oglre::Application::Initialize(ContextBackend backend)
 {
-    // GLFW Setup
-    if (!glfwInit()) {
-        std::cout << "GLFW Initialization failed!\n"
-                  << "Exiting...\n";
+    m_epoch = std::chrono::steady_clock::now();
 
-        exit(EXIT_FAILURE);
-    }
+    if (backend == ContextBackend::HEADLESS) {
+        // No GLFW at all, as glfwInit() fails on machines without a display server.
+        m_headlessContext = std::make_unique<HeadlessContext>(headlessSettings.width, headlessSettings.height);
+        if (!m_headlessContext->IsValid()) {
+            std::cout << "Headless context creation failed!\n"
+                      << "Exiting...\n";
+
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        // GLFW Setup
+        if (!glfwInit()) {
+            std::cout << "GLFW Initialization failed!\n"
+                      << "Exiting...\n";
 
-    // OpenGL version and mode setup.
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+            exit(EXIT_FAILURE);
+        }
 
-    // GLFW Window settings
-    glfwWindowHint(GLFW_RESIZABLE, GL_TRUE);
+        // OpenGL version and mode setup.
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 
-    // For OpenGL debugging.
-    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+        // GLFW Window settings
+        glfwWindowHint(GLFW_RESIZABLE, GL_TRUE);
 
-    Application::m_window = glfwCreateWindow(initialWindowWidth, initialWindowHeight, "Oglre", NULL, NULL);
-    if (!m_window) {
-        std::cout << "GLFW Window creation failed\n"
-                  << "Exiting...\n";
+        // For OpenGL debugging.
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
 
-        exit(EXIT_FAILURE);
-    }
+        Application::m_window = glfwCreateWindow(initialWindowWidth, initialWindowHeight, "Oglre", NULL, NULL);
+        if (!m_window) {
+            std::cout << "GLFW Window creation failed\n"
+                      << "Exiting...\n";
 
-    glfwMakeContextCurrent(m_window);
+            exit(EXIT_FAILURE);
+        }
+
+        glfwMakeContextCurrent(m_window);
+        glfwSwapInterval(frameSchedulerSettings.swapInterval);
+
+        // Registered once, before DearImGui installs its own callbacks, which then pass events on to these.
+        glfwSetFramebufferSizeCallback(m_window, Oglre::Application::FramebufferSizeCallback);
+        glfwSetMouseButtonCallback(m_window, Oglre::Application::MouseButtonCallback);
+        glfwSetCursorPosCallback(m_window, Oglre::Application::MouseMovementCallback);
+        glfwSetScrollCallback(m_window, Oglre::Application::MouseScrollWheelCallback);
+    }
 
     // A valid OpenGL context must be created before initializing GLEW.
     // Initialize OpenGL loader (GLEW in this project).
-    bool error = glewInit();
+    // Core profile contexts need glewExperimental, otherwise GLEW skips entry points it cannot find in the extension string.
+    // glewInit() also initializes GLX, which fails without an X display, so headless mode only loads the GL entry points.
+    glewExperimental = GL_TRUE;
+    GLenum error = IsHeadless() ? glewContextInit() : glewInit();
     if (error != GLEW_OK) {
         std::cout << "Error: Failed to initialize OpenGL function pointer loader!\n";
     }
 
+    // The offscreen framebuffer stands in for the window's default framebuffer for the rest of the run.
+    if (IsHeadless()) {
+        if (!m_headlessContext->CreateFramebuffer()) {
+            std::cout << "Exiting...\n";
+
+            exit(EXIT_FAILURE);
+        }
+
+        m_headlessContext->Bind();
+        GLStateCache::SetViewport(0, 0, headlessSettings.width, headlessSettings.height);
+    }
+
     // Enable debugging layer of OpenGL
     int glFlags = 0;
     glGetIntegerv(GL_CONTEXT_FLAGS, &glFlags);
@@ -85,6 +147,12 @@ void Oglre::Application::Initialize()
 
     // Printing OpenGL version for convenience.
     std::cout << "OpenGL Version + System GPU Drivers: " << glGetString(GL_VERSION) << std::endl;
+
+    Shader::EnableParallelCompile();
+    ShaderCache::SetDirectory(shaderCachePath);
+
+    // The main thread keeps the context, jobs only do CPU work.
+    JobSystem::Initialize(workerCount);
 }
 
 void Oglre::Application::Run()
@@ -93,6 +161,33 @@ void Oglre::Application::Run()
 
     GLFWwindow* window = Oglre::Application::GetWindow();
 
+    // Every program is created first, so that they compile in the background while the scene is set up.
+    // gl_DrawIDARB needs GL_ARB_shader_draw_parameters and the batch is streamed with GL_ARB_buffer_storage,
+    // fall back to instancing without them.
+    const double shaderStartTime = GetTime();
+    const bool indirectSupported = GLEW_ARB_shader_draw_parameters && GLEW_ARB_multi_draw_indirect && GLEW_ARB_buffer_storage;
+
+    // Several views are drawn in one pass by the MULTIVIEW permutations, which write gl_ViewportIndex.
+    if (viewCount > ViewUniforms::maxViews) {
+        std::cout << "At most " << ViewUniforms::maxViews << " views are supported, drawing " << ViewUniforms::maxViews << std::endl;
+        viewCount = ViewUniforms::maxViews;
+    }
+    if (viewCount > 1 && !GLEW_ARB_viewport_array) {
+        std::cout << "Viewport arrays are not supported by this context, drawing a single view." << std::endl;
+        viewCount = 1;
+    }
+    const std::vector<std::string> viewDefines = viewCount > 1 ? std::vector<std::string> { "MULTIVIEW" } : std::vector<std::string> {};
+    const auto withViewDefines = [&](std::vector<std::string> defines) {
+        defines.insert(defines.end(), viewDefines.begin(), viewDefines.end());
+        return defines;
+    };
+
+    // Permutations of the embedded Basic program, see resources/shaders/Basic.glsl.
+    Shader shader("Basic", viewDefines);
+    Shader instancedShader("Basic", withViewDefines({ "INSTANCED" }));
+    std::unique_ptr<Shader> indirectShader = indirectSupported ? std::make_unique<Shader>("Basic", withViewDefines({ "INDIRECT" })) : nullptr;
+    const double shaderSubmitTime = GetTime() - shaderStartTime;
+
     // clang-format off
     // Cube positions.
     std::vector<float> vertices = {
@@ -128,75 +223,344 @@ void Oglre::Application::Run()
     // Create Vertex Array.
     VertexArray va;
 
-    // Generate Vertex Buffer Object.
-    const int nPoints = 3 * 2 * 8;
-    VertexBuffer vbo(vertices, nPoints * sizeof(float));
+    // Colours are packed into 10 bits per channel, which makes 24 byte vertices 16 byte ones.
+    // The layout of ColouredVertex is derived from the struct at compile time, see VertexFormats.h.
+    const auto makeColouredVertices = [](std::span<const float> source) {
+        const size_t floatsPerVertex = 6;
+        std::vector<ColouredVertex> colouredVertices(source.size() / floatsPerVertex);
+        for (size_t vertex = 0; vertex < colouredVertices.size(); ++vertex) {
+            const float* attributes = &source[vertex * floatsPerVertex];
+            colouredVertices[vertex].position = glm::vec3(attributes[0], attributes[1], attributes[2]);
+            VertexQuantizer::PackUnorm10_10_10_2(std::span(attributes + 3, 3), 3, std::span(&colouredVertices[vertex].colour.bits, 1));
+        }
 
-    // Create Vertex Buffer Layout.
-    VertexBufferLayout layout;
-    const int nFloatsPerVertexAttribute = 3;
+        return colouredVertices;
+    };
+    const std::vector<ColouredVertex> colouredVertices = makeColouredVertices(vertices);
 
-    // One Push for each vertex attribute.
-    layout.Push<float>(nFloatsPerVertexAttribute);
-    layout.Push<float>(nFloatsPerVertexAttribute);
-    va.AddBuffer(vbo, layout);
+    // Generate Vertex Buffer Object.
+    VertexBuffer vbo(std::as_bytes(std::span(colouredVertices)));
+    va.AddBuffer<ColouredVertex>(vbo);
     
     // Generate Index Buffer.
     const int numberOfIndices = 3 * 12;
-    IndexBuffer ibo(indices, numberOfIndices);
+    IndexBuffer ibo(indices);
+
+    // The scene's transforms: the single object, and the instanced demo's cube-shaped grid of cubes under one grid node.
+    // The first instance sits where the single cube is drawn.
+    TransformHierarchy sceneTransforms;
+    const uint32_t objectNode = sceneTransforms.CreateNode();
+    const uint32_t gridNode = sceneTransforms.CreateNode();
+
+    const int instanceGridSize = static_cast<int>(std::ceil(std::cbrt(static_cast<double>(maxInstanceCount))));
+    const float instanceSpacing = 300.0f;
+
+    std::vector<uint32_t> instanceNodes;
+    instanceNodes.reserve(maxInstanceCount);
+    for (int instance = 0; instance < maxInstanceCount; ++instance) {
+        const glm::vec3 gridPosition(instance % instanceGridSize, (instance / instanceGridSize) % instanceGridSize, instance / (instanceGridSize * instanceGridSize));
+        instanceNodes.push_back(sceneTransforms.CreateNode(gridNode, gridPosition * glm::vec3(instanceSpacing, instanceSpacing, -instanceSpacing)));
+    }
+    sceneTransforms.Update();
+
+    // Per-instance model matrices for the instanced demo.
+    std::vector<glm::mat4> instanceModels;
+    std::vector<InstanceTransform> instanceTransforms;
+    instanceModels.reserve(maxInstanceCount);
+    instanceTransforms.reserve(maxInstanceCount);
+    for (uint32_t instanceNode : instanceNodes) {
+        instanceModels.push_back(sceneTransforms.GetWorldMatrix(instanceNode));
+        instanceTransforms.push_back({ instanceModels.back() });
+    }
+
+    // The instanced VAO shares the cube's vertex and index buffers, plus one mat4 per instance.
+    VertexArray instancedVa;
+    instancedVa.AddBuffer<ColouredVertex>(vbo);
+
+    VertexBuffer instanceVbo(std::as_bytes(std::span(instanceTransforms)));
+    instancedVa.AddBuffer<InstanceTransform>(instanceVbo);
+
+    // Bounds of the drawn instances, for frustum culling and picking through a BVH, which is rebuilt when the number of
+    // instances changes. The indirect demo alternates between the cube and the octahedron, so the box is large enough
+    // for either.
+    BoxBounds instanceBounds;
+    BoundingVolumeHierarchy instanceBvh;
+    std::vector<uint32_t> visibleInstances(maxInstanceCount);
+    std::vector<InstanceTransform> visibleTransforms;
+    visibleTransforms.reserve(maxInstanceCount);
+
+    // clang-format off
+    // Octahedron, drawn alternately with the cube by the indirect demo.
+    std::vector<float> octahedronVertices = {
+        // Positions                // Colours
+        0.0f, 140.0f, 0.0f,         1.0f, 1.0f, 0.0f, // 0
+        140.0f, 0.0f, 0.0f,         1.0f, 0.0f, 1.0f, // 1
+        0.0f, 0.0f, 140.0f,         0.0f, 1.0f, 1.0f, // 2
+        -140.0f, 0.0f, 0.0f,        1.0f, 0.0f, 1.0f, // 3
+        0.0f, 0.0f, -140.0f,        0.0f, 1.0f, 1.0f, // 4
+        0.0f, -140.0f, 0.0f,        1.0f, 1.0f, 0.0f  // 5
+    };
 
-    // Deal with vertex and fragment shader.
-    Shader shader(shaderPath);
+    std::vector<unsigned int> octahedronIndices {
+        0, 1, 2,   0, 2, 3,   0, 3, 4,   0, 4, 1, // top
+        5, 2, 1,   5, 3, 2,   5, 4, 3,   5, 1, 4  // bottom
+    };
+    // clang-format on
+
+    const std::vector<ColouredVertex> colouredOctahedronVertices = makeColouredVertices(octahedronVertices);
+
+    // Both meshes share one vertex and index buffer, so the whole grid is a single multi-draw.
+    using ColouredVertexLayout = StaticVertexLayout<ColouredVertex>;
+    GeometryArena arena(VertexBufferLayout(ColouredVertexLayout::elements, ColouredVertexLayout::stride), 1024, 4096);
+    MeshRange cubeRange;
+    MeshRange octahedronRange;
+    arena.AddMesh(std::as_bytes(std::span(colouredVertices)), indices, cubeRange);
+    arena.AddMesh(std::as_bytes(std::span(colouredOctahedronVertices)), octahedronIndices, octahedronRange);
+
+    if (!indirectSupported && drawPath == DrawPath::INDIRECT) {
+        std::cout << "Multi-draw indirect is not supported by this context, using instanced drawing." << std::endl;
+        drawPath = DrawPath::INSTANCED;
+    }
+    std::unique_ptr<IndirectDrawBatch> indirectBatch = indirectSupported ? std::make_unique<IndirectDrawBatch>() : nullptr;
+
+    // The first frame needs every program, so wait for whichever are still compiling. Startup is cold if any had to be
+    // compiled, and warm if every one came from the binary cache.
+    const double shaderWaitStartTime = GetTime();
+    while (!shader.IsReady() || !instancedShader.IsReady() || (indirectShader && !indirectShader->IsReady())) {
+        std::this_thread::yield();
+    }
+    if (indirectShader) {
+        indirectShader->Bind();
+    }
+    instancedShader.Bind();
     shader.Bind();
 
+    // Vertex layouts that do not match what the programs read are reported now, rather than showing up on screen.
+    shader.CheckVertexInputs(va);
+    instancedShader.CheckVertexInputs(instancedVa);
+    if (indirectShader) {
+        indirectShader->CheckVertexInputs(arena.GetVertexArray());
+    }
+
+    std::cout << (ShaderCache::GetMissCount() > 0 ? "Cold" : "Warm") << " shader startup: " << ShaderCache::GetHitCount() << " programs from the cache, "
+              << ShaderCache::GetMissCount() << " compiled, " << 1000.0 * shaderSubmitTime << " ms to submit, " << 1000.0 * (GetTime() - shaderWaitStartTime)
+              << " ms waiting after scene setup" << std::endl;
+
     // Instantiate Renderer.
     Renderer renderer;
 
-    // Instantiate Camera.
-    Oglre::Camera camera;
+    // The main camera is Application::camera, which input moves. Any other views look at the origin from fixed points:
+    // from above like a minimap, then from either side.
+    const std::array<glm::vec3, ViewUniforms::maxViews - 1> extraViewPositions = { glm::vec3(0.0f, 3000.0f, 1.0f), glm::vec3(1500.0f, 600.0f, 1500.0f),
+        glm::vec3(-1500.0f, 600.0f, -1500.0f) };
+    std::vector<Camera> extraCameras(viewCount - 1);
+    std::vector<RenderView> views(viewCount);
+    views[0].camera = &camera;
+    for (uint32_t view = 1; view < viewCount; ++view) {
+        extraCameras[view - 1].SetPosition(extraViewPositions[view - 1]);
+        extraCameras[view - 1].LookAt(glm::vec3(0.0f));
+        views[view].camera = &extraCameras[view - 1];
+    }
+
+    // Instances that another view has already found visible, while culling for several views.
+    std::vector<uint32_t> viewVisibleInstances(viewCount > 1 ? maxInstanceCount : 0);
+    std::vector<uint8_t> isInstanceVisible(viewCount > 1 ? maxInstanceCount : 0);
 
     // Model View Projection matrices
-    // First matrix is an identity matrix, second matrix is the translation matrix that moves the view.
-    glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)); // Move "object" 100 units up and right.
-    glm::mat4 projection;
+    // The model matrix is the object's world matrix, updated every frame.
+    glm::mat4 model = sceneTransforms.GetWorldMatrix(objectNode);
+
+    // The single object is the cube, unless a mesh file was given.
+    const VertexArray* sceneVa = &va;
+    const IndexBuffer* sceneIbo = &ibo;
+
+    // Levels of detail of the mesh, finest first, each with its own index buffer into the mesh's vertex buffer.
+    std::unique_ptr<VertexBuffer> meshVbo;
+    std::vector<std::unique_ptr<IndexBuffer>> meshLodIbos;
+    std::unique_ptr<VertexArray> meshVa;
+    std::vector<MeshLod> meshLods;
+    GLenum meshIndexType = GL_UNSIGNED_INT;
+    glm::vec3 meshCentre(0.0f);
+    float meshScale = 1.0f;
+    float meshRadius = 0.0f;
+
+    // Meshes imported on the fly have their levels of detail generated in the background, and switch to them once done.
+    std::future<LodChain> meshLodFuture;
+    uint32_t meshLod = 0;
+    LodSelector lodSelector;
+
+    if (!meshPath.empty()) {
+        const double loadStartTime = GetTime();
+
+        // Uploads the mesh, and centres it on the cube's position at the cube's size.
+        const auto uploadMesh = [&](const VertexBufferLayout& layout, std::span<const std::byte> vertexData, std::span<const std::byte> indexData,
+                                    GLenum indexType, const glm::vec3& boundsMinimum, const glm::vec3& boundsMaximum) {
+            meshVbo = std::make_unique<VertexBuffer>(vertexData);
+            meshLodIbos.push_back(std::make_unique<IndexBuffer>(indexData, indexType));
+            meshVa = std::make_unique<VertexArray>();
+            meshVa->AddBuffer(*meshVbo, layout);
+            shader.CheckVertexInputs(*meshVa);
+            meshIndexType = indexType;
+
+            sceneVa = meshVa.get();
+            sceneIbo = meshLodIbos[0].get();
+
+            const glm::vec3 extent = boundsMaximum - boundsMinimum;
+            const float largestExtent = std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-6f));
+
+            meshCentre = 0.5f * (boundsMinimum + boundsMaximum);
+            meshScale = 200.0f / largestExtent;
+            meshRadius = 0.5f * glm::length(extent) * meshScale;
+            sceneTransforms.SetLocal(objectNode, -meshCentre * meshScale, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(meshScale));
+
+            const double loadTime = GetTime() - loadStartTime;
+            std::cout << "Loaded " << meshPath << ": " << vertexData.size() / layout.GetStride() << " vertices, "
+                      << sceneIbo->GetCount() / 3 << " triangles in " << 1000.0 * loadTime << " ms" << std::endl;
+        };
+
+        if (meshPath.ends_with(".oglm")) {
+            // The buffers are uploaded straight from the mapped file, which is unmapped again once they are.
+            MeshFile meshFile(meshPath);
+            if (meshFile.IsValid()) {
+                meshLods = meshFile.GetLods();
+                uploadMesh(meshFile.GetLayout(), meshFile.GetVertexData(), meshFile.GetIndexData(meshLods[0]), meshFile.GetIndexType(),
+                    meshFile.GetBoundsMinimum(), meshFile.GetBoundsMaximum());
+
+                for (size_t lod = 1; lod < meshLods.size(); ++lod) {
+                    meshLodIbos.push_back(std::make_unique<IndexBuffer>(meshFile.GetIndexData(meshLods[lod]), meshFile.GetIndexType()));
+                }
+            }
+        } else {
+            // Source formats are imported on the fly, convert them with oglre-meshconv for faster startup.
+            ImportedMesh importedMesh;
+            if (Importer::Import(meshPath, importedMesh)) {
+                const uint32_t stride = importedMesh.layout.GetStride();
+                const MeshOptimizationReport report = MeshOptimizer::Optimize(std::as_writable_bytes(std::span(importedMesh.vertices)), stride, importedMesh.indices);
+                importedMesh.vertices.resize(uint64_t(report.vertexCount) * stride / sizeof(float));
+
+                std::cout << "Optimized " << meshPath << ": ACMR " << report.before.acmr << " -> " << report.after.acmr
+                          << ", ATVR " << report.before.atvr << " -> " << report.after.atvr << std::endl;
+
+                const std::vector<std::byte> indexData = MeshOptimizer::PackIndices(importedMesh.indices, report.indexType);
+                uploadMesh(importedMesh.layout, std::as_bytes(std::span(importedMesh.vertices)), indexData, report.indexType,
+                    importedMesh.boundsMinimum, importedMesh.boundsMaximum);
+
+                meshLodFuture = std::async(std::launch::async, [vertices = std::move(importedMesh.vertices), indices = std::move(importedMesh.indices), stride]() {
+                    return MeshSimplifier::GenerateLodChain(indices, std::as_bytes(std::span(vertices)), stride);
+                });
+            }
+        }
+    }
     glm::mat4 mvpMatrix;
 
     // DearImGUI things
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    ImGuiIO& io = ImGui::GetIO();
-    (void)io;
+    // The GLFW platform backend needs a window, so there is no UI in headless mode.
+    if (!IsHeadless()) {
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        (void)io;
+
+        // Setup Dear ImGui style
+        ImGui::StyleColorsDark();
+
+        // Setup Platform/Renderer backends
+        std::string glsl_version = "#version 330";
+
+        ImGui_ImplGlfw_InitForOpenGL(window, true);
+        ImGui_ImplOpenGL3_Init(glsl_version.c_str());
+    }
+
+    // Profiler counter names for each job system thread's utilization.
+    std::vector<std::string> jobThreadCounterNames;
+    for (uint32_t thread = 0; thread < JobSystem::GetThreadCount(); ++thread) {
+        jobThreadCounterNames.push_back("Job Thread " + std::to_string(thread) + " Utilization (%)");
+    }
 
-    // Setup Dear ImGui style
-    ImGui::StyleColorsDark();
+    // Camera paths: recorded from the keyboard and mouse, or replayed in their place. The benchmark plays the replayed
+    // path if there is one, otherwise a flythrough of the scene's bounds.
+    CameraPath recordedPath;
+    CameraPath replayPath;
+    uint32_t replayStep = 0;
+    if (!replayPathFile.empty() && replayPath.Load(replayPathFile)) {
+        std::cout << "Replaying " << replayPath.GetPoseCount() << " camera poses from " << replayPathFile << std::endl;
+    }
+
+    BenchmarkReport benchmarkReport;
+    if (benchmarkSettings.isEnabled) {
+        if (replayPath.IsEmpty()) {
+            glm::vec3 sceneMinimum(-100.0f);
+            glm::vec3 sceneMaximum(100.0f);
+            if (instanceCount > 1) {
+                sceneMinimum = glm::vec3(std::numeric_limits<float>::max());
+                sceneMaximum = glm::vec3(std::numeric_limits<float>::lowest());
+                for (int instance = 0; instance < instanceCount; ++instance) {
+                    const glm::vec3 position(instanceModels[instance][3]);
+                    sceneMinimum = glm::min(sceneMinimum, position - glm::vec3(140.0f));
+                    sceneMaximum = glm::max(sceneMaximum, position + glm::vec3(140.0f));
+                }
+            }
+            replayPath = CameraPath::GenerateFlythrough(sceneMinimum, sceneMaximum, benchmarkSettings.flythroughPoseCount);
+        }
+        m_benchmarkFrameCount = benchmarkSettings.warmupFrameCount + replayPath.GetPoseCount();
+
+        benchmarkReport.SetProperty("path", replayPathFile.empty() ? "flythrough " + std::to_string(replayPath.GetPoseCount()) : replayPathFile);
+        benchmarkReport.SetProperty("instances", std::to_string(instanceCount));
+        benchmarkReport.SetProperty("draw_path", instanceCount > 1 && drawPath == DrawPath::INDIRECT ? "indirect" : "instanced");
+        benchmarkReport.SetProperty("mesh", meshPath);
+        benchmarkReport.SetProperty("views", std::to_string(viewCount));
+        benchmarkReport.SetProperty("resolution", IsHeadless() ? std::to_string(headlessSettings.width) + "x" + std::to_string(headlessSettings.height) : "window");
+        benchmarkReport.SetProperty("renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+
+        std::cout << "Benchmarking " << replayPath.GetPoseCount() << " frames after " << benchmarkSettings.warmupFrameCount << " warm-up frames" << std::endl;
+    }
 
-    // Setup Platform/Renderer backends
-    std::string glsl_version = "#version 330";
+    // Frame pacing, and the simulated camera position that is drawn interpolated.
+    FrameScheduler frameScheduler(frameSchedulerSettings);
+    InterpolatedValue<glm::vec3> cameraPosition(camera.GetPosition());
+    glm::vec3 drawnCameraPosition = camera.GetPosition();
 
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
-    ImGui_ImplOpenGL3_Init(glsl_version.c_str());
+    m_runStartTime = GetTime();
 
     // Render and event loop.
-    while (!glfwWindowShouldClose(window)) {
+    while (!ShouldClose()) {
+        Profiler::BeginFrame();
+        const double frameStartTime = GetTime();
 
-        // DearImGUI things
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
+        const uint32_t simulationSteps = frameScheduler.BeginFrame();
+        Profiler::SetCounter("Frame Time (ms)", 1000.0 * frameScheduler.GetFrameTime());
+        Profiler::SetCounter("Frame Jitter (ms)", 1000.0 * frameScheduler.GetFrameJitter());
 
         // Flags
         static int f_Projection = 0;
 
+        // DearImGUI things
+        if (!IsHeadless()) {
+            ProfileScope scope("UI");
+
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui_ImplGlfw_NewFrame();
+            ImGui::NewFrame();
+        }
+
         // Basic Camera controls through DearImGUI
-        {
+        if (!IsHeadless()) {
             ImGui::Begin("Camera Controls");
 
-            ImGui::SliderFloat3("Camera Position", &camera.cameraPosition[0], 0.0f, 1000.0f);
-            ImGui::SliderFloat3("Camera View", &camera.cameraFront[0], 0.0f, 1000.0f);
+            // Edited through copies, so that the camera knows its matrices are out of date. An edited position reaches
+            // cameraPosition in the simulation below, which snaps to it rather than interpolating.
+            glm::vec3 editedPosition = camera.GetPosition();
+            if (ImGui::SliderFloat3("Camera Position", &editedPosition[0], 0.0f, 1000.0f)) {
+                camera.SetPosition(editedPosition);
+            }
+            glm::vec3 editedFront = camera.GetFront();
+            if (ImGui::SliderFloat3("Camera View", &editedFront[0], 0.0f, 1000.0f)) {
+                camera.SetFront(editedFront);
+            }
 
             if (ImGui::Button("Reset Camera")) {
-                camera.cameraPosition = glm::vec3(200.0f, 200.0f, 200.0f);
-                camera.cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
+                camera.SetPosition(glm::vec3(200.0f, 200.0f, 200.0f));
+                camera.SetFront(glm::vec3(0.0f, 0.0f, -1.0f));
             }
 
             static bool wireframeMode = false;
@@ -211,61 +575,377 @@ void Oglre::Application::Run()
             ImGui::SameLine();
             ImGui::RadioButton("Orthographic Projection", &f_Projection, 1);
 
+            ImGui::SliderInt("Cubes", &instanceCount, 1, maxInstanceCount);
+            ImGui::SliderFloat("LOD Pixel Error", &lodSelector.pixelErrorThreshold, 0.1f, 20.0f);
+            if (indirectSupported) {
+                int drawPathIndex = static_cast<int>(drawPath);
+                ImGui::RadioButton("Instanced", &drawPathIndex, 0);
+                ImGui::SameLine();
+                ImGui::RadioButton("Multi-Draw Indirect", &drawPathIndex, 1);
+                drawPath = static_cast<DrawPath>(drawPathIndex);
+            }
+
+            // Frame pacing. A cap of 0 is uncapped.
+            float frameRateCap = static_cast<float>(frameScheduler.GetSettings().frameRateCap);
+            if (ImGui::SliderFloat("Frame Cap (FPS)", &frameRateCap, 0.0f, 240.0f, "%.0f")) {
+                frameScheduler.SetFrameRateCap(frameRateCap);
+            }
+            int swapInterval = frameScheduler.GetSettings().swapInterval;
+            if (ImGui::SliderInt("Swap Interval", &swapInterval, 0, 4)) {
+                frameScheduler.SetSwapInterval(swapInterval);
+                glfwSwapInterval(swapInterval);
+            }
+
             ImGui::End();
+
+            Profiler::DrawImGuiWindow();
         }
 
         // Match viewport size with current window size
         static int currentWindowWidth = 0;
         static int currentWindowHeight = 0;
-        glfwGetWindowSize(window, &currentWindowWidth, &currentWindowHeight);
-        glfwSetFramebufferSizeCallback(window, Oglre::Application::FramebufferSizeCallback);
+        static int currentFramebufferWidth = 0;
+        static int currentFramebufferHeight = 0;
+        if (IsHeadless()) {
+            currentWindowWidth = headlessSettings.width;
+            currentWindowHeight = headlessSettings.height;
+            currentFramebufferWidth = headlessSettings.width;
+            currentFramebufferHeight = headlessSettings.height;
+        } else {
+            ProfileScope scope("Input");
+
+            glfwGetWindowSize(window, &currentWindowWidth, &currentWindowHeight);
+            glfwGetFramebufferSize(window, &currentFramebufferWidth, &currentFramebufferHeight);
+        }
+
+        // Keyboard movement, or a replayed camera path, is the simulation: it advances in fixed steps, and the camera is
+        // drawn between the last two. Anything else that moved the camera since last frame, e.g. the UI, moves it without
+        // interpolation. Benchmarks take exactly one step per frame, and draw it as is, so that every run draws the same.
+        {
+            ProfileScope scope("Simulation");
 
-        // Process keyboard commands.
-        Oglre::Application::ProcessKeyboardInput(window);
+            if (camera.GetPosition() != drawnCameraPosition) {
+                cameraPosition.Reset(camera.GetPosition());
+            }
+            camera.SetPosition(cameraPosition.GetCurrent());
+
+            const uint32_t steps = benchmarkSettings.isEnabled ? 1 : simulationSteps;
+            for (uint32_t step = 0; step < steps; ++step) {
+                if (benchmarkSettings.isEnabled) {
+                    replayPath.Apply(m_frameCount < benchmarkSettings.warmupFrameCount ? 0 : static_cast<uint32_t>(m_frameCount - benchmarkSettings.warmupFrameCount), camera);
+                } else if (replayStep < replayPath.GetPoseCount()) {
+                    replayPath.Apply(replayStep++, camera);
+                    if (replayStep == replayPath.GetPoseCount()) {
+                        std::cout << "Camera path replay finished" << std::endl;
+                    }
+                } else if (!IsHeadless()) {
+                    ProcessKeyboardInput(window, static_cast<float>(frameScheduler.GetFixedTimestep()));
+                }
+
+                if (!recordPathFile.empty()) {
+                    recordedPath.Record(camera);
+                }
+                cameraPosition.Step(camera.GetPosition());
+            }
+
+            drawnCameraPosition = benchmarkSettings.isEnabled ? cameraPosition.GetCurrent() : cameraPosition.Interpolate(frameScheduler.GetInterpolationAlpha());
+            camera.SetPosition(drawnCameraPosition);
 
-        // Process mouse input and movement.
-        glfwSetMouseButtonCallback(window, Oglre::Application::MouseButtonCallback);
-        glfwSetCursorPosCallback(window, Oglre::Application::MouseMovementCallback);
-        glfwSetScrollCallback(window, Oglre::Application::MouseScrollWheelCallback);
+            Profiler::SetCounter("Simulation Steps", simulationSteps);
+        }
+
+        // Split-screen: the main camera's view on the left, then a column per extra camera. Viewports are in pixels of the
+        // framebuffer, which differs from the window's size on high DPI displays.
+        const int viewWidth = currentFramebufferWidth / static_cast<int>(viewCount);
+        for (uint32_t view = 0; view < viewCount; ++view) {
+            views[view].x = static_cast<int>(view) * viewWidth;
+            views[view].y = 0;
+            views[view].width = viewWidth;
+            views[view].height = currentFramebufferHeight;
+        }
 
-        // Projection matrix for use in the Vertex Shader.
+        // Projection matrix for use in the Vertex Shader. The cameras only recompute it when it differs from last frame's.
+        const float aspectRatio = (float)currentWindowWidth / viewCount / currentWindowHeight;
         if (f_Projection == 0) {
-            projection = glm::perspective(glm::radians(camera.cameraFOV), (float)currentWindowWidth / currentWindowHeight, 0.1f, 10000.0f);
+            camera.SetPerspective(aspectRatio, 0.1f, 10000.0f);
         } else if (f_Projection == 1) {
             // TODO: Works, but I need the object to be in the same position when switching between perspectives (Possible..?)
-            static float min = -pow(10, glm::radians(camera.cameraFOV));
-            static float max = pow(10, glm::radians(camera.cameraFOV));
+            static float min = -pow(10, glm::radians(camera.GetFOV()));
+            static float max = pow(10, glm::radians(camera.GetFOV()));
 
-            projection = glm::ortho(min, max, min, max, -10000.0f, 10000.0f);
+            camera.SetOrthographic(min, max, min, max, -10000.0f, 10000.0f);
+        }
+        for (Camera& extraCamera : extraCameras) {
+            extraCamera.SetPerspective(aspectRatio, 0.1f, 10000.0f);
         }
 
         // Set MVP matrix once projection matrix has been updated.
         // Note that the calculation is actually Projection * View * Model as OpenGL uses column major ordering by default.
         // This affects how the MVP Matrix must be created.
-        mvpMatrix = projection * camera.GetCameraViewMatrix() * model;
+        {
+            ProfileScope scope("Transforms");
+
+            Profiler::SetCounter("Updated Transforms", sceneTransforms.Update());
+            model = sceneTransforms.GetWorldMatrix(objectNode);
+            sceneTransforms.ComputeMvpMatrices(camera.GetViewProjectionMatrix(), std::span(&objectNode, 1), std::span(&mvpMatrix, 1));
+        }
+
+        // The background levels of detail are uploaded once they are ready. The first level is the mesh already uploaded.
+        if (meshLodFuture.valid() && meshLodFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            const LodChain lodChain = meshLodFuture.get();
+            for (size_t lod = 1; lod < lodChain.lods.size(); ++lod) {
+                const std::span<const uint32_t> lodIndices = std::span(lodChain.indices).subspan(lodChain.lods[lod].indexOffset, lodChain.lods[lod].indexCount);
+                meshLodIbos.push_back(std::make_unique<IndexBuffer>(MeshOptimizer::PackIndices(lodIndices, meshIndexType), meshIndexType));
+            }
+            meshLods = lodChain.lods;
 
-        // Now shader can be set.
-        shader.SetUniformMat4f("u_MVP", mvpMatrix);
+            std::cout << "Generated " << meshLods.size() << " levels of detail for " << meshPath << ", down to " << meshLods.back().indexCount / 3
+                      << " triangles" << std::endl;
+        }
+
+        // The mesh is drawn at the coarsest level of detail that is less than a pixel or so off the full mesh, judged
+        // from the nearest point of its bounding sphere.
+        if (meshLods.size() > 1) {
+            const glm::vec3 worldCentre = glm::vec3(model * glm::vec4(meshCentre, 1.0f));
+            const float distance = std::max(glm::length(camera.GetPosition() - worldCentre) - meshRadius, 0.0f);
+
+            lodSelector.SetProjection(camera.GetFOV(), static_cast<float>(currentWindowHeight));
+            meshLod = lodSelector.Select(meshLods, meshScale, distance, meshLod);
+            sceneIbo = meshLodIbos[meshLod].get();
+
+            Profiler::SetCounter("LOD", meshLod);
+        }
+
+        // Depth of the object's origin in normalized device coordinates, remapped to [0, 1] for sorting.
+        const glm::vec4 clipPosition = mvpMatrix * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        const float sortDepth = clipPosition.z / clipPosition.w * 0.5f + 0.5f;
+
+        if (instanceCount > 1 && instanceBvh.GetObjectCount() != static_cast<uint32_t>(instanceCount)) {
+            ProfileScope scope("BVH Build");
+
+            instanceBounds.Resize(instanceCount);
+            for (int instance = 0; instance < instanceCount; ++instance) {
+                const glm::vec3 position(instanceModels[instance][3]);
+                instanceBounds.Set(instance, position - glm::vec3(140.0f), position + glm::vec3(140.0f));
+            }
+            instanceBvh.Build(instanceBounds);
+        }
+
+        // Only the instances in the camera's frustum are drawn. With several views, the instances any of them sees.
+        uint32_t visibleInstanceCount = 0;
+        if (instanceCount > 1) {
+            ProfileScope scope("Culling");
+
+            const Frustum frustum = Frustum::FromMatrix(camera.GetViewProjectionMatrix());
+            visibleInstanceCount = instanceBvh.CullFrustum(frustum, visibleInstances);
+
+            if (viewCount > 1) {
+                for (uint32_t i = 0; i < visibleInstanceCount; ++i) {
+                    isInstanceVisible[visibleInstances[i]] = true;
+                }
+                for (uint32_t view = 1; view < viewCount; ++view) {
+                    const Frustum viewFrustum = Frustum::FromMatrix(views[view].camera->GetViewProjectionMatrix());
+                    const uint32_t viewVisibleCount = instanceBvh.CullFrustum(viewFrustum, viewVisibleInstances);
+                    for (uint32_t i = 0; i < viewVisibleCount; ++i) {
+                        const uint32_t instance = viewVisibleInstances[i];
+                        if (!isInstanceVisible[instance]) {
+                            isInstanceVisible[instance] = true;
+                            visibleInstances[visibleInstanceCount++] = instance;
+                        }
+                    }
+                }
+                for (uint32_t i = 0; i < visibleInstanceCount; ++i) {
+                    isInstanceVisible[visibleInstances[i]] = false;
+                }
+            }
+
+            Profiler::SetCounter("Visible Objects", visibleInstanceCount);
+        }
+
+        // Left clicks pick the nearest instance under the cursor, with a ray from the near plane to the far plane.
+        if (m_isPickRequested) {
+            m_isPickRequested = false;
+
+            if (instanceCount > 1) {
+                // The ray goes through whichever view was clicked.
+                const float windowViewWidth = static_cast<float>(currentWindowWidth) / viewCount;
+                const uint32_t view = std::min(static_cast<uint32_t>(std::max(m_pickPosition.x, 0.0f) / windowViewWidth), viewCount - 1);
+                const float viewX = m_pickPosition.x - view * windowViewWidth;
+
+                const glm::vec2 ndcPosition(2.0f * viewX / windowViewWidth - 1.0f, 1.0f - 2.0f * m_pickPosition.y / currentWindowHeight);
+                const glm::mat4 inverseViewProjection = glm::inverse(views[view].camera->GetViewProjectionMatrix());
+                const glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndcPosition, -1.0f, 1.0f);
+                const glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndcPosition, 1.0f, 1.0f);
+
+                const glm::vec3 rayOrigin = glm::vec3(nearPoint) / nearPoint.w;
+                const glm::vec3 rayDirection = glm::normalize(glm::vec3(farPoint) / farPoint.w - rayOrigin);
+                const RayHit hit = instanceBvh.Raycast(rayOrigin, rayDirection);
+
+                if (hit.IsHit()) {
+                    std::cout << "Picked instance " << hit.object << " at distance " << hit.distance << std::endl;
+                } else {
+                    std::cout << "Picked nothing" << std::endl;
+                }
+            }
+        }
 
         // Render from this point on.
-        renderer.Clear();
-        renderer.Draw(va, ibo, shader);
- 
-        // DearImGUI things
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        {
+            ProfileScope scope("Scene", true);
+
+            renderer.Clear();
+
+            renderer.SetFrameUniforms({ camera.GetCameraViewMatrix(), camera.GetProjectionMatrix(), camera.GetViewProjectionMatrix(), glm::vec4(camera.GetPosition(), 1.0f) });
+            if (viewCount > 1) {
+                renderer.SetViews(views);
+            }
+
+            if (instanceCount > 1 && drawPath == DrawPath::INDIRECT) {
+                // Every other object in the grid is an octahedron, each with its own command in the same batch.
+                indirectBatch->Clear();
+                for (uint32_t i = 0; i < visibleInstanceCount; ++i) {
+                    const uint32_t instance = visibleInstances[i];
+                    const MeshRange& mesh = instance % 2 == 0 ? cubeRange : octahedronRange;
+                    indirectBatch->Add(mesh, instanceModels[instance]);
+                }
+
+                renderer.MultiDrawIndirect(arena, *indirectBatch, *indirectShader);
+
+                Profiler::SetCounter("Triangles", indirectBatch->GetIndexCount() / 3);
+            } else if (instanceCount > 1) {
+                // The visible instances' transforms are packed to the front of the instance buffer.
+                visibleTransforms.clear();
+                for (uint32_t i = 0; i < visibleInstanceCount; ++i) {
+                    visibleTransforms.push_back(instanceTransforms[visibleInstances[i]]);
+                }
+                instanceVbo.Update(0, visibleTransforms.data(), static_cast<uint32_t>(visibleTransforms.size() * sizeof(InstanceTransform)));
+
+                renderer.DrawInstanced(instancedVa, ibo, instancedShader, visibleInstanceCount);
+
+                Profiler::SetCounter("Triangles", static_cast<double>(visibleInstanceCount) * numberOfIndices / 3);
+            } else {
+                renderer.Submit(*sceneVa, *sceneIbo, shader, { model, mvpMatrix }, sortDepth);
+                renderer.Flush();
+
+                Profiler::SetCounter("Triangles", sceneIbo->GetCount() / 3);
+            }
+        }
+
+        // Nothing to present in headless mode, the frame stays in the offscreen framebuffer.
+        if (!IsHeadless()) {
+            // DearImGUI things
+            {
+                ProfileScope scope("ImGui", true);
+
+                ImGui::Render();
+                ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+                // DearImGui's renderer binds its own program, VAO and buffers behind the state cache's back.
+                GLStateCache::Invalidate();
+            }
+
+            ProfileScope scope("Present");
+
+            // Swaps the front and back buffers of the specified window.
+            // The front buffer is the current buffer shown on screen, whilst the back is the data to be drawn to.
+            glfwSwapBuffers(window);
+
+            // Poll and process events.
+            glfwPollEvents();
+        }
+
+        JobSystem::EndFrame();
+        for (size_t thread = 0; thread < jobThreadCounterNames.size(); ++thread) {
+            Profiler::SetCounter(jobThreadCounterNames[thread].c_str(), 100.0 * JobSystem::GetStatistics()[thread].utilization);
+        }
+
+        GLStateCache::EndFrame();
+        GpuHeap::EndFrame();
+
+        if (benchmarkSettings.isEnabled && m_frameCount >= benchmarkSettings.warmupFrameCount) {
+            benchmarkReport.AddFrame({ 1000.0 * (GetTime() - frameStartTime), static_cast<uint32_t>(Profiler::GetCounter("Draw Calls")),
+                static_cast<uint64_t>(Profiler::GetCounter("Triangles")), visibleInstanceCount });
+        }
+
+        // Waits out the rest of the frame when capped. Timed, so the wait is not mistaken for work in the profiler.
+        {
+            ProfileScope scope("Frame Limiter");
+
+            frameScheduler.EndFrame();
+        }
+
+        Profiler::EndFrame();
+        ++m_frameCount;
+    }
+
+    if (IsHeadless()) {
+        // Wait for the GPU so that the reported time covers all of the submitted work.
+        glFinish();
+
+        const double elapsedTime = GetTime() - m_runStartTime;
+        std::cout << "Rendered " << m_frameCount << " frames in " << elapsedTime << "s ("
+                  << m_frameCount / elapsedTime << " FPS, " << 1000.0 * elapsedTime / m_frameCount << " ms/frame)" << std::endl;
+
+        const FramePacingStatistics pacing = frameScheduler.GetStatistics();
+        std::cout << "Frame pacing: " << pacing.averageFrameTime << " ms average, " << pacing.frameTimeDeviation << " ms standard deviation, "
+                  << pacing.maximumFrameTime << " ms worst, jitter " << pacing.averageJitter << " ms average, " << pacing.maximumJitter << " ms worst";
+        if (frameScheduler.GetDroppedStepCount() > 0) {
+            std::cout << ", " << frameScheduler.GetDroppedStepCount() << " fixed steps dropped";
+        }
+        std::cout << std::endl;
 
-        // Swaps the front and back buffers of the specified window.
-        // The front buffer is the current buffer shown on screen, whilst the back is the data to be drawn to.
-        glfwSwapBuffers(window);
+        Profiler::PrintReport(std::cout);
 
-        // Poll and process events.
-        glfwPollEvents();
+        if (!headlessSettings.outputImagePath.empty()) {
+            m_headlessContext->SaveFramebuffer(headlessSettings.outputImagePath);
+        }
+    }
+
+    if (!recordPathFile.empty() && recordedPath.Save(recordPathFile)) {
+        std::cout << "Recorded " << recordedPath.GetPoseCount() << " camera poses to " << recordPathFile << std::endl;
+    }
+
+    if (benchmarkSettings.isEnabled) {
+        const BenchmarkSummary summary = benchmarkReport.Summarize();
+        std::cout << "Benchmark: " << summary.frameCount << " frames, frame time average " << summary.averageFrameTime << " ms, p50 " << summary.p50FrameTime
+                  << " ms, p95 " << summary.p95FrameTime << " ms, p99 " << summary.p99FrameTime << " ms, " << summary.averageDrawCalls << " draw calls, "
+                  << summary.averageTriangles << " triangles" << std::endl;
+
+        if (!benchmarkSettings.outputPath.empty()) {
+            benchmarkReport.WriteCsv(benchmarkSettings.outputPath + ".csv");
+            BenchmarkReport::WriteJson(benchmarkSettings.outputPath + ".json", summary);
+        }
+
+        // Regressions fail the run, so that scripts can tell from the exit code alone.
+        if (!benchmarkSettings.baselinePath.empty()) {
+            BenchmarkSummary baseline;
+            if (!BenchmarkReport::LoadSummary(benchmarkSettings.baselinePath, baseline)) {
+                m_exitCode = EXIT_FAILURE;
+            } else {
+                std::cout << "Compared with " << benchmarkSettings.baselinePath << ", " << 100.0 * benchmarkSettings.regressionThreshold << "% threshold:" << std::endl;
+                if (!BenchmarkReport::CompareWithBaseline(summary, baseline, benchmarkSettings.regressionThreshold, std::cout)) {
+                    std::cout << "Benchmark regressed, or is not comparable with the baseline!" << std::endl;
+                    m_exitCode = EXIT_FAILURE;
+                }
+            }
+        }
     }
 }
 
 void Oglre::Application::Exit()
 {
+    JobSystem::Shutdown();
+    Profiler::Shutdown();
+    Renderer::Shutdown();
+    GpuHeap::Shutdown();
+
+    if (IsHeadless()) {
+        // Releases the GL objects while the context is still current, then the context itself.
+        m_headlessContext.reset();
+
+        exit(m_exitCode);
+    }
+
     // Cleanup
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -274,7 +954,7 @@ void Oglre::Application::Exit()
     glfwDestroyWindow(m_window);
     glfwTerminate();
 
-    exit(EXIT_SUCCESS);
+    exit(m_exitCode);
 }
 
 GLFWwindow* Oglre::Application::GetWindow()
@@ -282,6 +962,37 @@ GLFWwindow* Oglre::Application::GetWindow()
     return m_window;
 }
 
+bool Oglre::Application::IsHeadless()
+{
+    return m_headlessContext != nullptr;
+}
+
+bool Oglre::Application::ShouldClose()
+{
+    // Benchmarks last as long as their camera path, whatever the headless limits.
+    if (benchmarkSettings.isEnabled && m_frameCount >= m_benchmarkFrameCount) {
+        return true;
+    }
+
+    if (!IsHeadless()) {
+        return glfwWindowShouldClose(m_window);
+    }
+
+    if (benchmarkSettings.isEnabled) {
+        return false;
+    }
+
+    if (headlessSettings.frameCount > 0 && m_frameCount >= headlessSettings.frameCount) {
+        return true;
+    }
+
+    if (headlessSettings.durationSeconds > 0.0 && GetTime() - m_runStartTime >= headlessSettings.durationSeconds) {
+        return true;
+    }
+
+    return false;
+}
+
 // -----------------------
 // Application Information
 // -----------------------
@@ -306,27 +1017,17 @@ bool Oglre::Application::MouseButtonPressed()
     }
 }
 
-float Oglre::Application::GetDeltaTime()
+double Oglre::Application::GetTime()
 {
-    static float deltaTime = 0.0f;
-    static float currentTime = 0.0f;
-    static float lastTime = 0.0f;
-
-    currentTime = glfwGetTime();
-    deltaTime = currentTime - lastTime;
-    lastTime = currentTime;
-
-    return deltaTime;
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_epoch).count();
 }
 
 // --------------------------------
 // Input Handling + Camera Movement
 // --------------------------------
 
-void Oglre::Application::ProcessKeyboardInput(GLFWwindow* window)
+void Oglre::Application::ProcessKeyboardInput(GLFWwindow* window, float deltaTime)
 {
-    const float deltaTime = Application::GetDeltaTime();
-
     // The resulting right vectors are normalized as the camera speed would otherwise be based on the camera's orientation.
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
         camera.KeyboardInput(Oglre::CameraMovements::FORWARD, deltaTime);
@@ -361,32 +1062,9 @@ void Oglre::Application::MouseMovementCallback(GLFWwindow* window, double xPosit
     Application::lastMousePosition.x = xPosition;
     Application::lastMousePosition.y = yPosition;
 
-    xPositionOffset *= camera.cameraSensitivity;
-    yPositionOffset *= camera.cameraSensitivity;
-
-    camera.cameraYaw += xPositionOffset;
-    camera.cameraPitch += yPositionOffset;
-
-    // Constrain pitch because at 90 degrees the LookAt function flips the camera direction.
-    if (camera.cameraPitch > 89.0f) {
-        camera.cameraPitch = 89.0f;
-    }
-    if (camera.cameraPitch < -89.0f) {
-        camera.cameraPitch = -89.0f;
-    }
-
-    // Create camera direction vector using Euler angles.
-    glm::vec3 cameraDirection;
-
-    // Must convert to radians first.
-    // Note that xz sides are influenced by cos(pitch) and must therefore be included in their calculations.
-    cameraDirection.x = std::cos(glm::radians(camera.cameraYaw)) * std::cos(glm::radians(camera.cameraPitch));
-    cameraDirection.y = sin(glm::radians(camera.cameraPitch));
-    cameraDirection.z = std::sin(glm::radians(camera.cameraYaw)) * std::cos(glm::radians(camera.cameraPitch));
-
-    // Set camera direction vector if mouse is pressed.
+    // Turn the camera only while the right mouse button is pressed.
     if (m_isRightMouseButtonPressed) {
-        camera.cameraFront = glm::normalize(cameraDirection);
+        camera.processMouseMovement(xPositionOffset, yPositionOffset);
     }
 }
 
@@ -398,6 +1076,16 @@ void Oglre::Application::MouseButtonCallback(GLFWwindow* window, int button, int
 
         // Enable camera movement with mouse.
         m_isRightMouseButtonPressed = true;
+    } else if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
+        // Picked in the next frame, once the view and projection are up to date. Clicks on ImGui windows are ignored.
+        if (!ImGui::GetIO().WantCaptureMouse) {
+            double xPosition = 0.0;
+            double yPosition = 0.0;
+            glfwGetCursorPos(window, &xPosition, &yPosition);
+
+            m_pickPosition = glm::vec2(xPosition, yPosition);
+            m_isPickRequested = true;
+        }
     } else {
         glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
         glfwSetInputMode(window, GLFW_RAW_MOUSE_MOTION, GLFW_FALSE);
@@ -409,15 +1097,7 @@ void Oglre::Application::MouseButtonCallback(GLFWwindow* window, int button, int
 
 void Oglre::Application::MouseScrollWheelCallback(GLFWwindow* window, double xPositionOffset, double yPositionOffset)
 {
-    camera.cameraFOV -= static_cast<float>(yPositionOffset);
-
-    // Constrain zoom/FOV values
-    if (camera.cameraFOV < 1.0f) {
-        camera.cameraFOV = 1.0f;
-    }
-    if (camera.cameraFOV > 90.0f) {
-        camera.cameraFOV = 90.0f;
-    }
+    camera.processMouseScroll(static_cast<float>(yPositionOffset));
 }
 
 // ----------------------
@@ -540,7 +1220,7 @@ void APIENTRY Oglre::Application::GLDebugPrintMessage(GLenum source, GLenum type
 void Oglre::Application::FramebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
     // Ensure viewport matches new window dimensions.
-    glViewport(0, 0, width, height);
+    GLStateCache::SetViewport(0, 0, width, height);
 
     // Should re-render scene after calling glfwSetFramebufferSizeCallback() as current frame
     // would have been drawn for the old viewport size.
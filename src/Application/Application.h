@@ -11,11 +11,61 @@
 // clang-format on
 
 #include "Camera.h"
+#include "FrameScheduler.h"
+#include "HeadlessContext.h"
 
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
 #include <string>
 
 namespace Oglre {
 
+// The kind of OpenGL context that Application::Initialize() creates.
+enum class ContextBackend {
+    WINDOW, // GLFW window, rendering to the window's default framebuffer.
+    HEADLESS // No window, rendering to an offscreen framebuffer. For CI and render farm nodes.
+};
+
+// How the multi-cube demo scene is drawn.
+enum class DrawPath {
+    INSTANCED, // One mesh, one glDrawElementsInstanced() call with per-instance attributes.
+    INDIRECT // Mixed meshes from a shared GeometryArena, one glMultiDrawElementsIndirect() call.
+};
+
+// Controls how long a headless run lasts and what it renders to.
+// The run ends when either limit is reached, a limit of 0 is ignored.
+struct HeadlessSettings {
+    uint32_t width = 800;
+    uint32_t height = 600;
+    uint32_t frameCount = 1000;
+    double durationSeconds = 0.0;
+
+    // If not empty, the final frame is written to this path as a PPM image.
+    std::string outputImagePath = "";
+};
+
+// Benchmark mode plays a camera path over the demo scene, one pose per frame whatever the frame rate, and reports the
+// frame times, draw calls and triangles. Best run headless, where nothing but the path moves the camera.
+struct BenchmarkSettings {
+    bool isEnabled = false;
+
+    // Poses of the generated flythrough, played when no camera path is replayed (see Application::replayPathFile).
+    uint32_t flythroughPoseCount = 600;
+
+    // Frames drawn at the first pose before measuring, while caches and the driver settle.
+    uint32_t warmupFrameCount = 30;
+
+    // Every frame is written to outputPath.csv and the summary to outputPath.json.
+    std::string outputPath = "benchmark";
+
+    // If set, a summary written by an earlier run. Frame times more than regressionThreshold (0.1 for 10%) slower than
+    // it fail the run, as do differences in what was drawn.
+    std::string baselinePath = "";
+    double regressionThreshold = 0.1;
+};
+
 // -----------------------
 // Application Information
 // -----------------------
@@ -26,13 +76,44 @@ public:
     // Application Execution
     // ---------------------
 
-    static void Initialize();
+    static void Initialize(ContextBackend backend = ContextBackend::WINDOW);
     static void Run();
     static void Exit();
 
     static GLFWwindow* GetWindow();
+    static bool IsHeadless();
+    static bool ShouldClose(); // Window was closed, or the headless frame/time limit was reached.
+
+    static inline HeadlessSettings headlessSettings;
+
+    // Linked program binaries are kept here between runs. Empty disables the cache.
+    static inline std::string shaderCachePath = "shader_cache";
+
+    // If set, this mesh is drawn in place of the single cube. .oglm files are mapped, other formats go through Importer.
+    static inline std::string meshPath = "";
+
+    // Number of cubes in the demo scene. More than one draws a grid of cubes with a single instanced draw call, culled
+    // to the camera's frustum first. Left clicking a cube prints its index.
+    static constexpr int maxInstanceCount = 100000;
+    static inline int instanceCount = 1;
+    static inline DrawPath drawPath = DrawPath::INSTANCED;
+
+    // Job system worker threads, besides the main thread. 0 for one fewer than the number of hardware threads.
+    static inline uint32_t workerCount = 0;
 
-    static inline std::string shaderPath = "../resources/shaders/Basic.glsl"; // TODO: Function that returns all shader paths.
+    // Split-screen views, side by side. The first is the camera below, the others look at the scene from fixed points.
+    // More than one draws every view in a single multi-view pass, see Renderer::SetViews().
+    static inline uint32_t viewCount = 1;
+
+    // Fixed timestep, frame cap and swap interval, see FrameScheduler. Frame pacing is reported at the end of headless runs.
+    static inline FrameSchedulerSettings frameSchedulerSettings;
+
+    static inline BenchmarkSettings benchmarkSettings;
+
+    // The camera's pose after every fixed step is recorded to recordPathFile, saved at the end of the run. A path
+    // replayed from replayPathFile moves the camera in place of the keyboard until it ends. See CameraPath.
+    static inline std::string recordPathFile = "";
+    static inline std::string replayPathFile = "";
 
     // --------------------------------
     // Input Handling + Camera Movement
@@ -43,14 +124,14 @@ public:
     static inline glm::vec2 lastMousePosition = glm::vec2(initialWindowWidth / 2.0f, initialWindowHeight / 2.0f);
     static inline Camera camera;
 
-    static void ProcessKeyboardInput(GLFWwindow* window); // Manage GLFW's keyboard input
+    static void ProcessKeyboardInput(GLFWwindow* window, float deltaTime); // Move the camera by one fixed step of GLFW's keyboard input
     static void MouseMovementCallback(GLFWwindow* window, double xPosition, double yPosition); // Listen for mouse-movement events
     static void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods); // Listen for mouse button presses.
     static void MouseScrollWheelCallback(GLFWwindow* window, double xPositionOffset, double yPositionOffset); // Listen for mouse scroll wheel.
 
     static bool IsFirstMouseInput(); // Check if mouse input has been received for the first time.
     static bool MouseButtonPressed(); // Check if right mouse button is being pressed.
-    static float GetDeltaTime(); // Get frametime, i.e. the time taken to render a frame.
+    static double GetTime(); // Seconds since Initialize(). Unlike glfwGetTime(), also valid without GLFW.
 
     // ----------------------
     // OpenGL Error Functions
@@ -68,10 +149,20 @@ public:
 
 private:
     static inline GLFWwindow* m_window = nullptr;
+    static inline std::unique_ptr<HeadlessContext> m_headlessContext = nullptr;
+
+    static inline std::chrono::steady_clock::time_point m_epoch = std::chrono::steady_clock::now();
+    static inline uint64_t m_frameCount = 0;
+    static inline double m_runStartTime = 0.0;
+    static inline uint64_t m_benchmarkFrameCount = 0; // Warm-up frames included.
+    static inline int m_exitCode = EXIT_SUCCESS;
 
     static inline bool m_isFirstMouseInput = true;
     static inline bool m_isRightMouseButtonPressed = false;
 
+    static inline bool m_isPickRequested = false;
+    static inline glm::vec2 m_pickPosition = glm::vec2(0.0f); // Cursor position of the pick, in window coordinates.
+
     Application() {}; // Creating instance of this class is now not possible.
 };
 
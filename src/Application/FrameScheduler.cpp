@@ -0,0 +1,115 @@
+#include "FrameScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+double ToSeconds(std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration<double>(duration).count();
+}
+}
+
+Oglre::FrameScheduler::FrameScheduler(const FrameSchedulerSettings& settings)
+    : m_Settings(settings)
+    , m_FrameStart(Clock::now())
+    , m_FramePeriod(Clock::duration::zero())
+{
+    SetFrameRateCap(settings.frameRateCap);
+}
+
+uint32_t Oglre::FrameScheduler::BeginFrame()
+{
+    const Clock::time_point now = Clock::now();
+    const double frameTime = ToSeconds(now - m_FrameStart);
+    m_FrameStart = now;
+
+    // The first frame has nothing before it to measure, and nothing to simulate yet.
+    if (m_IsFirstFrame) {
+        m_IsFirstFrame = false;
+        return 0;
+    }
+
+    if (m_FrameCount > 0) {
+        m_FrameJitter = std::abs(frameTime - m_FrameTime);
+        m_JitterSum += m_FrameJitter;
+        m_MaximumJitter = std::max(m_MaximumJitter, m_FrameJitter);
+    }
+    m_FrameTime = frameTime;
+
+    ++m_FrameCount;
+    const double delta = frameTime - m_FrameTimeMean;
+    m_FrameTimeMean += delta / m_FrameCount;
+    m_FrameTimeM2 += delta * (frameTime - m_FrameTimeMean);
+    m_MaximumFrameTime = std::max(m_MaximumFrameTime, frameTime);
+
+    m_Accumulator += std::min(frameTime, maxFrameTime);
+    uint32_t steps = static_cast<uint32_t>(m_Accumulator / m_Settings.fixedTimestep);
+    if (steps > m_Settings.maxStepsPerFrame) {
+        m_DroppedStepCount += steps - m_Settings.maxStepsPerFrame;
+        steps = m_Settings.maxStepsPerFrame;
+    }
+    m_Accumulator = std::fmod(m_Accumulator, m_Settings.fixedTimestep);
+
+    return steps;
+}
+
+void Oglre::FrameScheduler::EndFrame()
+{
+    m_WaitTime = 0.0;
+    if (m_FramePeriod == Clock::duration::zero()) {
+        return;
+    }
+
+    const Clock::time_point waitStart = Clock::now();
+    WaitUntil(m_FrameStart + m_FramePeriod);
+    m_WaitTime = ToSeconds(Clock::now() - waitStart);
+}
+
+void Oglre::FrameScheduler::SetFrameRateCap(double frameRateCap)
+{
+    m_Settings.frameRateCap = std::max(frameRateCap, 0.0);
+    m_FramePeriod = m_Settings.frameRateCap > 0.0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_Settings.frameRateCap))
+                                                  : Clock::duration::zero();
+}
+
+Oglre::FramePacingStatistics Oglre::FrameScheduler::GetStatistics() const
+{
+    FramePacingStatistics statistics;
+    statistics.frameCount = m_FrameCount;
+    if (m_FrameCount == 0) {
+        return statistics;
+    }
+
+    statistics.averageFrameTime = 1000.0 * m_FrameTimeMean;
+    statistics.frameTimeDeviation = 1000.0 * std::sqrt(m_FrameTimeM2 / m_FrameCount);
+    statistics.maximumFrameTime = 1000.0 * m_MaximumFrameTime;
+    statistics.averageJitter = m_FrameCount > 1 ? 1000.0 * m_JitterSum / (m_FrameCount - 1) : 0.0;
+    statistics.maximumJitter = 1000.0 * m_MaximumJitter;
+
+    return statistics;
+}
+
+void Oglre::FrameScheduler::WaitUntil(Clock::time_point deadline)
+{
+    // Sleep in 1 ms slices while a slice is unlikely to overshoot the deadline. The estimate is the mean slice plus a
+    // standard deviation, so that it follows the scheduler of the machine it runs on.
+    const std::chrono::milliseconds sleepSlice(1);
+    while (ToSeconds(deadline - Clock::now()) > m_SleepEstimate) {
+        const Clock::time_point sleepStart = Clock::now();
+        std::this_thread::sleep_for(sleepSlice);
+        const double slept = ToSeconds(Clock::now() - sleepStart);
+
+        ++m_SleepCount;
+        const double delta = slept - m_SleepMean;
+        m_SleepMean += delta / m_SleepCount;
+        m_SleepM2 += delta * (slept - m_SleepMean);
+        m_SleepEstimate = m_SleepMean + std::sqrt(m_SleepM2 / (m_SleepCount - 1));
+    }
+
+    // Spin for the rest. Only the last fraction of a millisecond or so, so this costs little CPU time.
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
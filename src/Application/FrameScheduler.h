@@ -0,0 +1,187 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace Oglre {
+
+struct FrameSchedulerSettings {
+    // Seconds simulated by each fixed step, independent of the frame rate.
+    double fixedTimestep = 1.0 / 60.0;
+
+    // Fixed steps taken at most per frame. Frames slower than this drop the rest of their time rather than spiralling,
+    // with the simulation running slower than real time until they speed up again.
+    uint32_t maxStepsPerFrame = 8;
+
+    // Frames per second at most, 0 for no cap. The cap is kept by FrameScheduler::EndFrame() on the CPU, so it also
+    // holds in headless mode and with the swap interval at 0.
+    double frameRateCap = 0.0;
+
+    // glfwSwapInterval(): 0 presents immediately, 1 waits for every vertical blank, 2 for every other one, and so on.
+    int swapInterval = 1;
+};
+
+// Frame times and how evenly they are spaced, over every frame since the scheduler was created. Times are in ms.
+struct FramePacingStatistics {
+    uint64_t frameCount = 0;
+    double averageFrameTime = 0.0;
+    double frameTimeDeviation = 0.0; // Standard deviation.
+    double maximumFrameTime = 0.0;
+    double averageJitter = 0.0; // Mean difference between consecutive frame times.
+    double maximumJitter = 0.0;
+};
+
+// ---------------
+// Frame Scheduler
+// ---------------
+//
+// Decouples the simulation from rendering, and paces frames. Each frame:
+//
+//     const uint32_t steps = scheduler.BeginFrame();
+//     for each of the steps: update the simulation by GetFixedTimestep() seconds;
+//     draw the simulation GetInterpolationAlpha() of the way from its previous step to its latest one;
+//     scheduler.EndFrame();
+//
+// The simulation therefore behaves the same at any frame rate, and is drawn smoothly between its steps.
+//
+// The frame cap waits with a sleep-then-spin: std::this_thread::sleep_for() is cheap but wakes up late by a varying
+// amount, so the scheduler sleeps in short slices while more time is left than a slice has been seen to take, and
+// spins for the rest. Sleeps overshooting by more than usual make the scheduler spin earlier in later frames.
+class FrameScheduler {
+public:
+    explicit FrameScheduler(const FrameSchedulerSettings& settings = {});
+
+    // Measures the previous frame and returns the number of fixed steps to take this frame, possibly 0.
+    uint32_t BeginFrame();
+
+    // Waits until the frame cap allows the next frame to start. Returns at once without a cap.
+    void EndFrame();
+
+    // How far between the last two fixed steps the current frame is, in [0, 1).
+    inline float GetInterpolationAlpha() const
+    {
+        return static_cast<float>(m_Accumulator / m_Settings.fixedTimestep);
+    }
+
+    inline double GetFixedTimestep() const
+    {
+        return m_Settings.fixedTimestep;
+    }
+
+    inline const FrameSchedulerSettings& GetSettings() const
+    {
+        return m_Settings;
+    }
+
+    // 0 removes the cap.
+    void SetFrameRateCap(double frameRateCap);
+
+    // Only recorded here, the caller passes it on to glfwSwapInterval().
+    inline void SetSwapInterval(int swapInterval)
+    {
+        m_Settings.swapInterval = swapInterval;
+    }
+
+    // Seconds between the starts of the previous frame and the current one, including any wait for the cap.
+    inline double GetFrameTime() const
+    {
+        return m_FrameTime;
+    }
+
+    // Difference between the previous frame's time and the one before it, in seconds.
+    inline double GetFrameJitter() const
+    {
+        return m_FrameJitter;
+    }
+
+    // Seconds the previous EndFrame() spent waiting for the cap, sleeping or spinning.
+    inline double GetWaitTime() const
+    {
+        return m_WaitTime;
+    }
+
+    // Fixed steps dropped so far, because a frame took longer than maxStepsPerFrame steps.
+    inline uint64_t GetDroppedStepCount() const
+    {
+        return m_DroppedStepCount;
+    }
+
+    FramePacingStatistics GetStatistics() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Frames longer than this, e.g. after a breakpoint or a dragged window, are simulated as if they were this long.
+    static constexpr double maxFrameTime = 0.25;
+
+    FrameSchedulerSettings m_Settings;
+
+    Clock::time_point m_FrameStart;
+    Clock::duration m_FramePeriod; // Zero without a cap.
+    bool m_IsFirstFrame = true;
+
+    double m_Accumulator = 0.0; // Seconds not yet simulated, always less than one fixed step after BeginFrame().
+    double m_FrameTime = 0.0;
+    double m_FrameJitter = 0.0;
+    double m_WaitTime = 0.0;
+    uint64_t m_DroppedStepCount = 0;
+
+    // Running frame time statistics, with Welford's algorithm for the variance. In seconds.
+    uint64_t m_FrameCount = 0;
+    double m_FrameTimeMean = 0.0;
+    double m_FrameTimeM2 = 0.0;
+    double m_MaximumFrameTime = 0.0;
+    double m_JitterSum = 0.0;
+    double m_MaximumJitter = 0.0;
+
+    // How long a sleep slice actually takes, mean and variance as above. Seeded pessimistically, so the first frames
+    // spin a little more than they need to rather than oversleep.
+    double m_SleepEstimate = 5e-3;
+    double m_SleepMean = 5e-3;
+    double m_SleepM2 = 0.0;
+    uint64_t m_SleepCount = 1;
+
+    void WaitUntil(Clock::time_point deadline);
+};
+
+// A value updated in fixed steps, e.g. a position, and drawn part way between its last two steps. T needs + and -, and
+// * by a float.
+template <typename T>
+class InterpolatedValue {
+public:
+    explicit InterpolatedValue(const T& value)
+        : m_Previous(value)
+        , m_Current(value)
+    {
+    }
+
+    // Records the value after a fixed step.
+    inline void Step(const T& value)
+    {
+        m_Previous = m_Current;
+        m_Current = value;
+    }
+
+    // Jumps to value without interpolating towards it, e.g. when it is set from outside of the simulation.
+    inline void Reset(const T& value)
+    {
+        m_Previous = value;
+        m_Current = value;
+    }
+
+    inline const T& GetCurrent() const
+    {
+        return m_Current;
+    }
+
+    // alpha is FrameScheduler::GetInterpolationAlpha().
+    inline T Interpolate(float alpha) const
+    {
+        return m_Previous + (m_Current - m_Previous) * alpha;
+    }
+
+private:
+    T m_Previous;
+    T m_Current;
+};
+}
@@ -0,0 +1,172 @@
+#include "HeadlessContext.h"
+
+// clang-format off
+#include <GL/glew.h>
+#include <GL/gl.h>
+// clang-format on
+
+#ifdef OGLRE_ENABLE_HEADLESS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+Oglre::HeadlessContext::HeadlessContext(uint32_t width, uint32_t height)
+    : m_Width(width)
+    , m_Height(height)
+    , m_Display(nullptr)
+    , m_Context(nullptr)
+    , m_FramebufferID(0)
+    , m_ColourAttachmentID(0)
+    , m_DepthAttachmentID(0)
+{
+#ifdef OGLRE_ENABLE_HEADLESS
+    // The surfaceless platform needs no X11/Wayland connection or DRM device.
+    // Fall back to the default display for EGL implementations that do not expose it.
+    EGLDisplay display = EGL_NO_DISPLAY;
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (getPlatformDisplay) {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint majorVersion = 0;
+    EGLint minorVersion = 0;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &majorVersion, &minorVersion)) {
+        std::cout << "EGL display initialization failed! (0x" << std::hex << eglGetError() << std::dec << ")\n";
+        return;
+    }
+    m_Display = display;
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cout << "EGL does not support desktop OpenGL!\n";
+        return;
+    }
+
+    // Nothing is ever presented, so a config is only needed if the implementation insists on one.
+    EGLConfig config = EGL_NO_CONFIG_KHR;
+    const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (!extensions || !std::strstr(extensions, "EGL_KHR_no_config_context")) {
+        const EGLint configAttributes[] = {
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_NONE
+        };
+
+        EGLint numberOfConfigs = 0;
+        if (!eglChooseConfig(display, configAttributes, &config, 1, &numberOfConfigs) || numberOfConfigs == 0) {
+            std::cout << "No suitable EGL config found!\n";
+            return;
+        }
+    }
+
+    // Mesa's llvmpipe tops out at 4.5, so that is what is requested here rather than the windowed 4.6.
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 5,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_CONTEXT_OPENGL_DEBUG, EGL_TRUE,
+        EGL_NONE
+    };
+
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT) {
+        std::cout << "EGL context creation failed! (0x" << std::hex << eglGetError() << std::dec << ")\n";
+        return;
+    }
+
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::cout << "Failed to make the EGL context current!\n";
+        eglDestroyContext(display, context);
+        return;
+    }
+    m_Context = context;
+
+    std::cout << "EGL Version: " << majorVersion << "." << minorVersion << " (surfaceless)\n";
+#else
+    std::cout << "Headless rendering is not available, Oglre was built without EGL!\n";
+#endif
+}
+
+Oglre::HeadlessContext::~HeadlessContext()
+{
+#ifdef OGLRE_ENABLE_HEADLESS
+    if (m_Context) {
+        glDeleteFramebuffers(1, &m_FramebufferID);
+        glDeleteRenderbuffers(1, &m_ColourAttachmentID);
+        glDeleteRenderbuffers(1, &m_DepthAttachmentID);
+
+        eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(m_Display, m_Context);
+    }
+
+    if (m_Display) {
+        eglTerminate(m_Display);
+    }
+#endif
+}
+
+bool Oglre::HeadlessContext::IsValid() const
+{
+    return m_Context != nullptr;
+}
+
+bool Oglre::HeadlessContext::CreateFramebuffer()
+{
+    glGenRenderbuffers(1, &m_ColourAttachmentID);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_ColourAttachmentID);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, m_Width, m_Height);
+
+    glGenRenderbuffers(1, &m_DepthAttachmentID);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_DepthAttachmentID);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_Width, m_Height);
+
+    glGenFramebuffers(1, &m_FramebufferID);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferID);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColourAttachmentID);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_DepthAttachmentID);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "Offscreen framebuffer is incomplete!\n";
+        return false;
+    }
+
+    return true;
+}
+
+void Oglre::HeadlessContext::Bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferID);
+}
+
+bool Oglre::HeadlessContext::SaveFramebuffer(const std::string& filepath) const
+{
+    std::vector<uint8_t> pixels(static_cast<size_t>(m_Width) * m_Height * 3);
+
+    Bind();
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, m_Width, m_Height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    std::ofstream stream(filepath, std::ios::binary);
+    if (!stream) {
+        std::cout << "Failed to open " << filepath << " for writing!\n";
+        return false;
+    }
+
+    stream << "P6\n"
+           << m_Width << " " << m_Height << "\n255\n";
+
+    // OpenGL's origin is the bottom left, whereas PPM rows start at the top.
+    const size_t rowSize = static_cast<size_t>(m_Width) * 3;
+    for (uint32_t row = m_Height; row > 0; --row) {
+        stream.write(reinterpret_cast<const char*>(pixels.data() + (row - 1) * rowSize), rowSize);
+    }
+
+    return true;
+}
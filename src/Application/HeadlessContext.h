@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Oglre {
+
+// Creates an OpenGL 4.x core context without a window or display server, and an offscreen framebuffer to render into.
+// Uses EGL on Mesa's surfaceless platform, so it runs on llvmpipe on machines with neither a display nor a GPU.
+// The backend is only compiled in when meson finds EGL (see the "headless" option), otherwise IsValid() is always false.
+class HeadlessContext {
+public:
+    HeadlessContext(uint32_t width, uint32_t height);
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // True once the EGL context has been created and made current.
+    bool IsValid() const;
+
+    // Creates the colour + depth attachments. Requires the GL function pointers to be loaded first.
+    bool CreateFramebuffer();
+
+    // Binds the offscreen framebuffer, which takes the place of the window's default framebuffer.
+    void Bind() const;
+
+    // Reads back the colour attachment and writes it out as a binary PPM image.
+    bool SaveFramebuffer(const std::string& filepath) const;
+
+    inline uint32_t GetWidth() const
+    {
+        return m_Width;
+    }
+
+    inline uint32_t GetHeight() const
+    {
+        return m_Height;
+    }
+
+private:
+    uint32_t m_Width;
+    uint32_t m_Height;
+
+    // EGL handles are kept as void* so that EGL headers do not leak into the rest of the engine.
+    void* m_Display;
+    void* m_Context;
+
+    uint32_t m_FramebufferID;
+    uint32_t m_ColourAttachmentID;
+    uint32_t m_DepthAttachmentID;
+};
+}
@@ -0,0 +1,207 @@
+#include "BenchmarkReport.h"
+#include "Json.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+// Nearest rank: the smallest sample that at least percentile of the samples are less than or equal to.
+double Percentile(const std::vector<double>& sortedSamples, double percentile)
+{
+    const size_t rank = static_cast<size_t>(std::ceil(percentile * sortedSamples.size()));
+    return sortedSamples[std::clamp<size_t>(rank, 1, sortedSamples.size()) - 1];
+}
+
+std::string EscapeJson(const std::string& text)
+{
+    std::string escaped;
+    for (const char character : text) {
+        if (character == '"' || character == '\\') {
+            escaped += '\\';
+        }
+        escaped += character;
+    }
+    return escaped;
+}
+}
+
+void Oglre::BenchmarkReport::SetProperty(const std::string& name, const std::string& value)
+{
+    for (auto& [propertyName, propertyValue] : m_Properties) {
+        if (propertyName == name) {
+            propertyValue = value;
+            return;
+        }
+    }
+    m_Properties.emplace_back(name, value);
+}
+
+void Oglre::BenchmarkReport::AddFrame(const BenchmarkFrame& frame)
+{
+    m_Frames.push_back(frame);
+}
+
+Oglre::BenchmarkSummary Oglre::BenchmarkReport::Summarize() const
+{
+    BenchmarkSummary summary;
+    summary.properties = m_Properties;
+    summary.frameCount = static_cast<uint32_t>(m_Frames.size());
+    if (m_Frames.empty()) {
+        return summary;
+    }
+
+    std::vector<double> frameTimes;
+    frameTimes.reserve(m_Frames.size());
+    double frameTimeSum = 0.0;
+    double drawCallSum = 0.0;
+    double triangleSum = 0.0;
+    for (const BenchmarkFrame& frame : m_Frames) {
+        frameTimes.push_back(frame.frameTime);
+        frameTimeSum += frame.frameTime;
+        drawCallSum += frame.drawCalls;
+        triangleSum += static_cast<double>(frame.triangles);
+    }
+    std::sort(frameTimes.begin(), frameTimes.end());
+
+    const double frameCount = static_cast<double>(m_Frames.size());
+    summary.averageFrameTime = frameTimeSum / frameCount;
+    summary.p50FrameTime = Percentile(frameTimes, 0.50);
+    summary.p95FrameTime = Percentile(frameTimes, 0.95);
+    summary.p99FrameTime = Percentile(frameTimes, 0.99);
+    summary.minimumFrameTime = frameTimes.front();
+    summary.maximumFrameTime = frameTimes.back();
+    summary.averageDrawCalls = drawCallSum / frameCount;
+    summary.averageTriangles = triangleSum / frameCount;
+
+    return summary;
+}
+
+bool Oglre::BenchmarkReport::WriteCsv(const std::string& filepath) const
+{
+    std::ofstream stream(filepath, std::ios::trunc);
+    if (!stream) {
+        std::cout << "Benchmark report " << filepath << " could not be created" << std::endl;
+        return false;
+    }
+
+    stream << "frame,frame_time_ms,draw_calls,triangles,visible_objects\n";
+    for (size_t frame = 0; frame < m_Frames.size(); ++frame) {
+        const BenchmarkFrame& sample = m_Frames[frame];
+        stream << frame << ',' << sample.frameTime << ',' << sample.drawCalls << ',' << sample.triangles << ',' << sample.visibleObjects << '\n';
+    }
+
+    return static_cast<bool>(stream);
+}
+
+bool Oglre::BenchmarkReport::WriteJson(const std::string& filepath, const BenchmarkSummary& summary)
+{
+    std::ofstream stream(filepath, std::ios::trunc);
+    if (!stream) {
+        std::cout << "Benchmark report " << filepath << " could not be created" << std::endl;
+        return false;
+    }
+
+    // 10 significant digits, so a baseline read back is within 5e-10 of what was measured, see CompareWithBaseline().
+    stream.precision(10);
+    stream << "{\n"
+           << "  \"properties\": {";
+    for (size_t property = 0; property < summary.properties.size(); ++property) {
+        stream << (property == 0 ? "\n" : ",\n") << "    \"" << EscapeJson(summary.properties[property].first) << "\": \""
+               << EscapeJson(summary.properties[property].second) << '"';
+    }
+    stream << (summary.properties.empty() ? "},\n" : "\n  },\n");
+
+    stream << "  \"frames\": " << summary.frameCount << ",\n"
+           << "  \"frame_time_ms\": {\n"
+           << "    \"average\": " << summary.averageFrameTime << ",\n"
+           << "    \"p50\": " << summary.p50FrameTime << ",\n"
+           << "    \"p95\": " << summary.p95FrameTime << ",\n"
+           << "    \"p99\": " << summary.p99FrameTime << ",\n"
+           << "    \"minimum\": " << summary.minimumFrameTime << ",\n"
+           << "    \"maximum\": " << summary.maximumFrameTime << "\n"
+           << "  },\n"
+           << "  \"draw_calls\": " << summary.averageDrawCalls << ",\n"
+           << "  \"triangles\": " << summary.averageTriangles << "\n"
+           << "}\n";
+
+    return static_cast<bool>(stream);
+}
+
+bool Oglre::BenchmarkReport::LoadSummary(const std::string& filepath, BenchmarkSummary& summary)
+{
+    std::ifstream stream(filepath);
+    if (!stream) {
+        std::cout << "Benchmark baseline " << filepath << " could not be opened" << std::endl;
+        return false;
+    }
+
+    std::stringstream text;
+    text << stream.rdbuf();
+
+    std::string error;
+    const JsonValue document = JsonValue::Parse(text.str(), error);
+    if (document.GetType() != JsonValue::Type::OBJECT) {
+        std::cout << "Benchmark baseline " << filepath << " could not be parsed: " << error << std::endl;
+        return false;
+    }
+
+    summary = BenchmarkSummary();
+    for (const auto& [name, value] : document["properties"].GetMembers()) {
+        summary.properties.emplace_back(name, value.AsString());
+    }
+
+    const JsonValue& frameTime = document["frame_time_ms"];
+    summary.frameCount = static_cast<uint32_t>(document["frames"].AsNumber());
+    summary.averageFrameTime = frameTime["average"].AsNumber();
+    summary.p50FrameTime = frameTime["p50"].AsNumber();
+    summary.p95FrameTime = frameTime["p95"].AsNumber();
+    summary.p99FrameTime = frameTime["p99"].AsNumber();
+    summary.minimumFrameTime = frameTime["minimum"].AsNumber();
+    summary.maximumFrameTime = frameTime["maximum"].AsNumber();
+    summary.averageDrawCalls = document["draw_calls"].AsNumber();
+    summary.averageTriangles = document["triangles"].AsNumber();
+
+    return true;
+}
+
+bool Oglre::BenchmarkReport::CompareWithBaseline(const BenchmarkSummary& summary, const BenchmarkSummary& baseline, double threshold, std::ostream& stream)
+{
+    bool isPassing = true;
+
+    for (const auto& [name, value] : summary.properties) {
+        const auto baselineProperty = std::find_if(baseline.properties.begin(), baseline.properties.end(), [&name](const auto& property) { return property.first == name; });
+        if (baselineProperty != baseline.properties.end() && baselineProperty->second != value) {
+            stream << "  " << name << ": " << value << ", baseline " << baselineProperty->second << " NOT COMPARABLE" << std::endl;
+            isPassing = false;
+        }
+    }
+
+    const auto compareFrameTime = [&](const char* name, double value, double baselineValue) {
+        const double change = baselineValue > 0.0 ? value / baselineValue - 1.0 : 0.0;
+        const bool isRegression = change > threshold;
+        isPassing = isPassing && !isRegression;
+
+        stream << "  " << name << ": " << value << " ms, baseline " << baselineValue << " ms (" << (change >= 0.0 ? "+" : "") << 100.0 * change << "%)"
+               << (isRegression ? " REGRESSION" : "") << std::endl;
+    };
+    compareFrameTime("average", summary.averageFrameTime, baseline.averageFrameTime);
+    compareFrameTime("p50", summary.p50FrameTime, baseline.p50FrameTime);
+    compareFrameTime("p95", summary.p95FrameTime, baseline.p95FrameTime);
+    compareFrameTime("p99", summary.p99FrameTime, baseline.p99FrameTime);
+
+    // The baseline's averages were rounded to 10 significant digits by WriteJson(), so allow for that rounding and
+    // nothing more.
+    const auto compareWork = [&](const char* name, double value, double baselineValue) {
+        if (std::abs(value - baselineValue) > 1e-9 * std::max(std::abs(baselineValue), 1.0)) {
+            stream << "  " << name << ": " << value << ", baseline " << baselineValue << " MISMATCH, the runs did not draw the same" << std::endl;
+            isPassing = false;
+        }
+    };
+    compareWork("draw calls", summary.averageDrawCalls, baseline.averageDrawCalls);
+    compareWork("triangles", summary.averageTriangles, baseline.averageTriangles);
+
+    return isPassing;
+}
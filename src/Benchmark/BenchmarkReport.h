@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Oglre {
+
+// One measured frame of a benchmark run.
+struct BenchmarkFrame {
+    double frameTime = 0.0; // ms
+    uint32_t drawCalls = 0;
+    uint64_t triangles = 0;
+    uint32_t visibleObjects = 0;
+};
+
+// What a benchmark run is compared on. Frame times are in ms, percentiles by nearest rank.
+struct BenchmarkSummary {
+    uint32_t frameCount = 0;
+    double averageFrameTime = 0.0;
+    double p50FrameTime = 0.0;
+    double p95FrameTime = 0.0;
+    double p99FrameTime = 0.0;
+    double minimumFrameTime = 0.0;
+    double maximumFrameTime = 0.0;
+    double averageDrawCalls = 0.0;
+    double averageTriangles = 0.0;
+
+    // How the run was set up, e.g. the instance count and draw path. Written with the results, and compared with a
+    // baseline's so that runs of different scenes are not mistaken for regressions.
+    std::vector<std::pair<std::string, std::string>> properties;
+};
+
+// ----------------
+// Benchmark Report
+// ----------------
+//
+// Collects the frames of a benchmark run, and writes them out for tracking over time: every frame as CSV, and the
+// summary as JSON, which a later run can load as its baseline.
+class BenchmarkReport {
+public:
+    // Shown in the summary's properties, in the order they are first set.
+    void SetProperty(const std::string& name, const std::string& value);
+
+    void AddFrame(const BenchmarkFrame& frame);
+
+    BenchmarkSummary Summarize() const;
+
+    bool WriteCsv(const std::string& filepath) const;
+    static bool WriteJson(const std::string& filepath, const BenchmarkSummary& summary);
+
+    // Reads a summary written by WriteJson(). Returns false if the file cannot be read or parsed.
+    static bool LoadSummary(const std::string& filepath, BenchmarkSummary& summary);
+
+    // Prints each frame time statistic against the baseline's. A statistic more than threshold (0.1 for 10%) slower
+    // than the baseline is a regression. A property that differs from the baseline's, or any difference in draw calls
+    // or triangles, means the runs are not comparable: the same path over the same scene draws exactly the same.
+    // Returns true only if the runs are comparable and nothing regressed.
+    static bool CompareWithBaseline(const BenchmarkSummary& summary, const BenchmarkSummary& baseline, double threshold, std::ostream& stream);
+
+    inline const std::vector<BenchmarkFrame>& GetFrames() const
+    {
+        return m_Frames;
+    }
+
+private:
+    std::vector<BenchmarkFrame> m_Frames;
+    std::vector<std::pair<std::string, std::string>> m_Properties;
+};
+}
@@ -0,0 +1,111 @@
+#include "CameraPath.h"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <numbers>
+#include <sstream>
+
+namespace {
+const char* cameraPathHeader = "oglre-camera-path 1";
+}
+
+Oglre::CameraPath Oglre::CameraPath::GenerateFlythrough(const glm::vec3& boundsMinimum, const glm::vec3& boundsMaximum, uint32_t poseCount)
+{
+    const glm::vec3 centre = 0.5f * (boundsMinimum + boundsMaximum);
+    const glm::vec3 halfExtent = 0.5f * (boundsMaximum - boundsMinimum);
+    const float boundingRadius = std::max(glm::length(halfExtent), 1.0f);
+
+    CameraPath path;
+    path.m_Poses.reserve(poseCount);
+    for (uint32_t pose = 0; pose < poseCount; ++pose) {
+        const float t = static_cast<float>(pose) / static_cast<float>(poseCount);
+        const float angle = 2.0f * std::numbers::pi_v<float> * t;
+
+        // 1.5 times the bounding radius at the start and end, a third of it half way round.
+        const float dive = std::sin(std::numbers::pi_v<float> * t);
+        const float radius = boundingRadius * (1.5f - 1.17f * dive * dive);
+        const float height = 0.5f * halfExtent.y * std::sin(2.0f * angle) + 0.25f * boundingRadius;
+
+        CameraPose cameraPose;
+        cameraPose.position = centre + glm::vec3(std::cos(angle) * radius, height, std::sin(angle) * radius);
+        cameraPose.front = glm::normalize(centre - cameraPose.position);
+        cameraPose.fov = 75.0f;
+        path.m_Poses.push_back(cameraPose);
+    }
+
+    return path;
+}
+
+bool Oglre::CameraPath::Load(const std::string& filepath)
+{
+    m_Poses.clear();
+
+    std::ifstream stream(filepath);
+    if (!stream) {
+        std::cout << "Camera path " << filepath << " could not be opened" << std::endl;
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(stream, line) || line != cameraPathHeader) {
+        std::cout << "Camera path " << filepath << " is not a camera path" << std::endl;
+        return false;
+    }
+
+    while (std::getline(stream, line)) {
+        if (line.empty()) {
+            continue;
+        }
+
+        std::istringstream lineStream(line);
+        CameraPose pose;
+        if (!(lineStream >> pose.position.x >> pose.position.y >> pose.position.z >> pose.front.x >> pose.front.y >> pose.front.z >> pose.fov)) {
+            std::cout << "Camera path " << filepath << " has a malformed pose on line " << m_Poses.size() + 2 << std::endl;
+            m_Poses.clear();
+            return false;
+        }
+        m_Poses.push_back(pose);
+    }
+
+    return true;
+}
+
+bool Oglre::CameraPath::Save(const std::string& filepath) const
+{
+    std::ofstream stream(filepath, std::ios::trunc);
+    if (!stream) {
+        std::cout << "Camera path " << filepath << " could not be created" << std::endl;
+        return false;
+    }
+
+    // Enough digits for every float to read back exactly.
+    stream.precision(9);
+    stream << cameraPathHeader << '\n';
+    for (const CameraPose& pose : m_Poses) {
+        stream << pose.position.x << ' ' << pose.position.y << ' ' << pose.position.z << ' ' << pose.front.x << ' ' << pose.front.y << ' '
+               << pose.front.z << ' ' << pose.fov << '\n';
+    }
+
+    return static_cast<bool>(stream);
+}
+
+void Oglre::CameraPath::Record(const Camera& camera)
+{
+    m_Poses.push_back({ camera.GetPosition(), camera.GetFront(), camera.GetFOV() });
+}
+
+void Oglre::CameraPath::Apply(uint32_t index, Camera& camera) const
+{
+    if (m_Poses.empty()) {
+        return;
+    }
+
+    const CameraPose& pose = m_Poses[std::min<size_t>(index, m_Poses.size() - 1)];
+    camera.SetPosition(pose.position);
+    camera.SetFront(pose.front);
+    camera.SetFOV(pose.fov);
+}
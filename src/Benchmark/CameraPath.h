@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Camera.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+namespace Oglre {
+
+struct CameraPose {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f);
+    float fov = 90.0f;
+};
+
+// -----------
+// Camera Path
+// -----------
+//
+// A camera pose for every fixed step of the simulation (see FrameScheduler), recorded from a session or generated.
+// Recording keeps what the keyboard and mouse did to the camera rather than the raw input, so a replay ends up at
+// exactly the same poses whatever the camera's speed and sensitivity, and however fast the machine draws.
+//
+// Saved as text: a header line, then "px py pz fx fy fz fov" for each pose.
+class CameraPath {
+public:
+    // Orbits the box once over poseCount poses, always looking at its centre. The orbit starts well outside the box,
+    // dives in to pass through it half way round, and rises and falls a little, so that the number of visible objects
+    // and their distance vary over the path.
+    static CameraPath GenerateFlythrough(const glm::vec3& boundsMinimum, const glm::vec3& boundsMaximum, uint32_t poseCount);
+
+    // Replaces the poses with the file's. Returns false, leaving the path empty, if it cannot be read.
+    bool Load(const std::string& filepath);
+    bool Save(const std::string& filepath) const;
+
+    // Appends the camera's current pose.
+    void Record(const Camera& camera);
+
+    // Moves the camera to pose index. Indices past the end hold the last pose.
+    void Apply(uint32_t index, Camera& camera) const;
+
+    inline const std::vector<CameraPose>& GetPoses() const
+    {
+        return m_Poses;
+    }
+
+    inline uint32_t GetPoseCount() const
+    {
+        return static_cast<uint32_t>(m_Poses.size());
+    }
+
+    inline bool IsEmpty() const
+    {
+        return m_Poses.empty();
+    }
+
+private:
+    std::vector<CameraPose> m_Poses;
+};
+}
@@ -1,72 +1,154 @@
 #include "Camera.h"
 
+#include "glm/ext/matrix_clip_space.hpp"
 #include "glm/ext/matrix_transform.hpp"
 #include "glm/ext/vector_float3.hpp"
 #include "glm/fwd.hpp"
 #include "glm/geometric.hpp"
 
+#include <algorithm>
+#include <cmath>
 
 Oglre::Camera::Camera()
 {
     updateCameraVectors();
 }
 
-glm::mat4 Oglre::Camera::GetCameraViewMatrix()
+const glm::mat4& Oglre::Camera::GetCameraViewMatrix() const
 {
-    return glm::lookAt(cameraPosition, cameraPosition + cameraFront, cameraUp);
+    if (m_IsViewDirty) {
+        m_ViewMatrix = glm::lookAt(m_Position, m_Position + m_Front, m_Up);
+        m_IsViewDirty = false;
+    }
+    return m_ViewMatrix;
+}
+
+const glm::mat4& Oglre::Camera::GetProjectionMatrix() const
+{
+    if (m_IsProjectionDirty) {
+        const std::array<float, 6>& p = m_ProjectionParameters;
+        if (m_Projection == CameraProjection::PERSPECTIVE) {
+            m_ProjectionMatrix = glm::perspective(glm::radians(m_FOV), p[0], p[1], p[2]);
+        } else {
+            m_ProjectionMatrix = glm::ortho(p[0], p[1], p[2], p[3], p[4], p[5]);
+        }
+        m_IsProjectionDirty = false;
+    }
+    return m_ProjectionMatrix;
+}
+
+const glm::mat4& Oglre::Camera::GetViewProjectionMatrix() const
+{
+    if (m_IsViewProjectionDirty) {
+        // Note that the calculation is Projection * View, as OpenGL uses column major ordering.
+        m_ViewProjectionMatrix = GetProjectionMatrix() * GetCameraViewMatrix();
+        m_IsViewProjectionDirty = false;
+    }
+    return m_ViewProjectionMatrix;
+}
+
+void Oglre::Camera::SetPosition(const glm::vec3& position)
+{
+    if (position != m_Position) {
+        m_Position = position;
+        MarkViewDirty();
+    }
+}
+
+void Oglre::Camera::SetFront(const glm::vec3& front)
+{
+    const glm::vec3 normalizedFront = glm::normalize(front);
+    if (normalizedFront != m_Front) {
+        m_Front = normalizedFront;
+        MarkViewDirty();
+    }
+}
+
+void Oglre::Camera::LookAt(const glm::vec3& target)
+{
+    const glm::vec3 direction = glm::normalize(target - m_Position);
+
+    // The inverse of updateCameraVectors(), with the pitch constrained the same way as mouse movement.
+    m_Pitch = std::clamp(glm::degrees(std::asin(direction.y)), -89.0f, 89.0f);
+    m_Yaw = glm::degrees(std::atan2(direction.z, direction.x));
+    updateCameraVectors();
+}
+
+void Oglre::Camera::SetFOV(float fov)
+{
+    // Constrain zoom/FOV values.
+    fov = std::clamp(fov, 1.0f, 90.0f);
+    if (fov != m_FOV) {
+        m_FOV = fov;
+        if (m_Projection == CameraProjection::PERSPECTIVE) {
+            m_IsProjectionDirty = true;
+            m_IsViewProjectionDirty = true;
+        }
+    }
+}
+
+void Oglre::Camera::SetPerspective(float aspectRatio, float nearPlane, float farPlane)
+{
+    SetProjection(CameraProjection::PERSPECTIVE, { aspectRatio, nearPlane, farPlane, 0.0f, 0.0f, 0.0f });
+}
+
+void Oglre::Camera::SetOrthographic(float left, float right, float bottom, float top, float nearPlane, float farPlane)
+{
+    SetProjection(CameraProjection::ORTHOGRAPHIC, { left, right, bottom, top, nearPlane, farPlane });
 }
 
 void Oglre::Camera::KeyboardInput(CameraMovements movement, float deltaTime)
 {
-    float cameraVelocity = cameraSpeed * deltaTime;
+    float cameraVelocity = m_Speed * deltaTime;
 
     if (!constrainMovement) {
         // The resulting right vectors are normalized as the camera speed would otherwise be based on the camera's orientation.
         switch (movement) {
         case CameraMovements::FORWARD: {
-            cameraPosition += cameraVelocity * cameraFront;
+            m_Position += cameraVelocity * m_Front;
             break;
         }
         case CameraMovements::BACKWARD: {
-            cameraPosition -= cameraVelocity * cameraFront;
+            m_Position -= cameraVelocity * m_Front;
             break;
         }
         case CameraMovements::LEFT: {
-            cameraPosition -= cameraVelocity * glm::normalize(glm::cross(cameraFront, cameraUp));
+            m_Position -= cameraVelocity * glm::normalize(glm::cross(m_Front, m_Up));
             break;
         }
         case CameraMovements::RIGHT: {
-            cameraPosition += cameraVelocity * glm::normalize(glm::cross(cameraFront, cameraUp));
+            m_Position += cameraVelocity * glm::normalize(glm::cross(m_Front, m_Up));
             break;
         }
         case CameraMovements::UP: {
-            cameraPosition += cameraVelocity * cameraUp;
+            m_Position += cameraVelocity * m_Up;
             break;
         }
         case CameraMovements::DOWN: {
-            cameraPosition -= cameraVelocity * cameraUp;
+            m_Position -= cameraVelocity * m_Up;
             break;
         }
         }
+        MarkViewDirty();
     }
 }
 
 void Oglre::Camera::processMouseMovement(float xPositionOffset, float yPositionOffset)
 {
-    xPositionOffset *= cameraSensitivity;
-    yPositionOffset *= cameraSensitivity;
+    xPositionOffset *= m_Sensitivity;
+    yPositionOffset *= m_Sensitivity;
 
     if (!constrainMovement) {
-        cameraYaw += xPositionOffset;
-        cameraPitch += yPositionOffset;
+        m_Yaw += xPositionOffset;
+        m_Pitch += yPositionOffset;
     }
 
     // Constrain pitch because at 90 degrees the LookAt function flips the camera direction.
-    if (cameraPitch > 89.0f) {
-        cameraPitch = 89.0f;
+    if (m_Pitch > 89.0f) {
+        m_Pitch = 89.0f;
     }
-    if (cameraPitch < -89.0f) {
-        cameraPitch = -89.0f;
+    if (m_Pitch < -89.0f) {
+        m_Pitch = -89.0f;
     }
 
     updateCameraVectors();
@@ -74,17 +156,25 @@ void Oglre::Camera::processMouseMovement(float xPositionOffset, float yPositionO
 
 void Oglre::Camera::processMouseScroll(float yPositionOffset)
 {
-    cameraFOV -= static_cast<float>(yPositionOffset);
+    SetFOV(m_FOV - static_cast<float>(yPositionOffset));
+}
 
-    // Constrain zoom/FOV values.
-    if (cameraFOV < 1.0f) {
-        cameraFOV = 1.0f;
-    }
-    if (cameraFOV > 90.0f) {
-        cameraFOV = 90.0f;
+void Oglre::Camera::SetProjection(CameraProjection projection, const std::array<float, 6>& parameters)
+{
+    if (projection != m_Projection || parameters != m_ProjectionParameters) {
+        m_Projection = projection;
+        m_ProjectionParameters = parameters;
+        m_IsProjectionDirty = true;
+        m_IsViewProjectionDirty = true;
     }
 }
 
+void Oglre::Camera::MarkViewDirty()
+{
+    m_IsViewDirty = true;
+    m_IsViewProjectionDirty = true;
+}
+
 void Oglre::Camera::updateCameraVectors()
 {
     // Create camera direction vector using Euler angles.
@@ -92,11 +182,12 @@ void Oglre::Camera::updateCameraVectors()
 
     // Must convert to radians first.
     // Note that xz sides are influenced by cos(pitch) and must therefore be included in their calculations.
-    cameraDirection.x = std::cos(glm::radians(cameraYaw)) * std::cos(glm::radians(cameraPitch));
-    cameraDirection.y = sin(glm::radians(cameraPitch));
-    cameraDirection.z = std::sin(glm::radians(cameraYaw)) * std::cos(glm::radians(cameraPitch));
-
-    cameraFront = glm::normalize(cameraDirection);
-    cameraRight = glm::normalize(glm::cross(cameraFront, worldUp));
-    cameraUp = glm::normalize(glm::cross(cameraRight, cameraFront));
-}
\ No newline at end of file
+    cameraDirection.x = std::cos(glm::radians(m_Yaw)) * std::cos(glm::radians(m_Pitch));
+    cameraDirection.y = sin(glm::radians(m_Pitch));
+    cameraDirection.z = std::sin(glm::radians(m_Yaw)) * std::cos(glm::radians(m_Pitch));
+
+    m_Front = glm::normalize(cameraDirection);
+    m_Right = glm::normalize(glm::cross(m_Front, m_WorldUp));
+    m_Up = glm::normalize(glm::cross(m_Right, m_Front));
+    MarkViewDirty();
+}
@@ -2,6 +2,7 @@
 
 #include "glm/ext/vector_float3.hpp"
 #include "glm/fwd.hpp"
+#include <array>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
@@ -19,41 +20,97 @@ enum class CameraMovements {
     DOWN
 };
 
+enum class CameraProjection {
+    PERSPECTIVE,
+    ORTHOGRAPHIC
+};
+
+// A camera's position, orientation and projection. Any number of cameras can exist, e.g. one per split-screen view.
+// The view, projection and view-projection matrices are cached, and only recomputed by the first Get*Matrix() call after
+// something they depend on has changed, so they can be asked for as often as needed.
 class Camera {
 public:
     Camera();
     ~Camera() = default;
 
-    // Camera Attributes.
-    static inline glm::vec3 cameraPosition = glm::vec3(200.0f, 200.0f, 400.0f);
-    static inline glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
-    static inline glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
-    static inline glm::vec3 cameraRight = glm::vec3(0.0f, 0.0f, 0.0f);
-    static inline glm::vec3 worldUp = glm::vec3(0.0f, 1.0f, 0.0f);
-
-    // Camera Options
-    static inline float cameraPitch = 0.0f;
-    static inline float cameraYaw = -90.0f;
-    static inline float cameraSpeed = 1000.0f;
-    static inline float cameraSensitivity = 0.25f;
-    static inline float cameraFOV = 90.0f;
-
     // Camera Flags
-    static inline bool constrainMovement = false;
-    static inline glm::vec2 xPosConstraint; // TODO: NOT CURRENTLY UTILIZED.
-    static inline glm::vec2 yPosConstraint; // TODO: NOT CURRENTLY UTILIZED.
-    static inline glm::vec2 zPosConstraint; // TODO: NOT CURRENTLY UTILIZED.
+    bool constrainMovement = false;
+    glm::vec2 xPosConstraint; // TODO: NOT CURRENTLY UTILIZED.
+    glm::vec2 yPosConstraint; // TODO: NOT CURRENTLY UTILIZED.
+    glm::vec2 zPosConstraint; // TODO: NOT CURRENTLY UTILIZED.
 
     // Get the matrix that defines what the camera "sees".
-    static glm::mat4 GetCameraViewMatrix();
+    const glm::mat4& GetCameraViewMatrix() const;
+    const glm::mat4& GetProjectionMatrix() const;
+    const glm::mat4& GetViewProjectionMatrix() const;
+
+    inline const glm::vec3& GetPosition() const
+    {
+        return m_Position;
+    }
+
+    inline const glm::vec3& GetFront() const
+    {
+        return m_Front;
+    }
+
+    // Vertical field of view in degrees.
+    inline float GetFOV() const
+    {
+        return m_FOV;
+    }
+
+    void SetPosition(const glm::vec3& position);
+
+    // front need not be normalized. The yaw and pitch are left as they are, so the next mouse movement turns the camera
+    // from where they point.
+    void SetFront(const glm::vec3& front);
+
+    // Turns the camera to face target, yaw and pitch included.
+    void LookAt(const glm::vec3& target);
+
+    // Clamped to [1, 90] degrees.
+    void SetFOV(float fov);
+
+    // Setting the same projection again keeps the cached matrices.
+    void SetPerspective(float aspectRatio, float nearPlane, float farPlane);
+    void SetOrthographic(float left, float right, float bottom, float top, float nearPlane, float farPlane);
 
     // TODO: Camera should NOT be processing keyboard input. It should only take a CameraMovements
-    static void KeyboardInput(CameraMovements movement, float deltaTime);
-    static void processMouseMovement(float xPositionOffset, float yPositionOffset);
-    static void processMouseScroll(float yPositionOffset);
+    void KeyboardInput(CameraMovements movement, float deltaTime);
+    void processMouseMovement(float xPositionOffset, float yPositionOffset);
+    void processMouseScroll(float yPositionOffset);
 
 private:
+    // Camera Attributes.
+    glm::vec3 m_Position = glm::vec3(200.0f, 200.0f, 400.0f);
+    glm::vec3 m_Front = glm::vec3(0.0f, 0.0f, -1.0f);
+    glm::vec3 m_Up = glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::vec3 m_Right = glm::vec3(0.0f, 0.0f, 0.0f);
+    glm::vec3 m_WorldUp = glm::vec3(0.0f, 1.0f, 0.0f);
+
+    // Camera Options
+    float m_Pitch = 0.0f;
+    float m_Yaw = -90.0f;
+    float m_Speed = 1000.0f;
+    float m_Sensitivity = 0.25f;
+    float m_FOV = 90.0f;
+
+    // Perspective: aspect ratio, near and far plane. Orthographic: left, right, bottom, top, near and far plane.
+    CameraProjection m_Projection = CameraProjection::PERSPECTIVE;
+    std::array<float, 6> m_ProjectionParameters = { 1.0f, 0.1f, 10000.0f, 0.0f, 0.0f, 0.0f };
+
+    mutable glm::mat4 m_ViewMatrix;
+    mutable glm::mat4 m_ProjectionMatrix;
+    mutable glm::mat4 m_ViewProjectionMatrix;
+    mutable bool m_IsViewDirty = true;
+    mutable bool m_IsProjectionDirty = true;
+    mutable bool m_IsViewProjectionDirty = true;
+
+    void SetProjection(CameraProjection projection, const std::array<float, 6>& parameters);
+    void MarkViewDirty();
+
     // Update the direction that the camera points, i.e. the camera front vector.
-    static void updateCameraVectors();
+    void updateCameraVectors();
 };
 }
@@ -0,0 +1,582 @@
+#include "BoundingVolumeHierarchy.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace {
+// Deeper nodes are made leaves whatever their size, so queries can use a fixed size stack.
+constexpr uint32_t maximumDepth = 96;
+constexpr uint32_t maximumBinCount = 64;
+
+// Half the surface area, which is all SAH needs as it only compares areas.
+inline float HalfArea(const glm::vec3& minimum, const glm::vec3& maximum)
+{
+    const glm::vec3 extent = glm::max(maximum - minimum, glm::vec3(0.0f));
+    return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+}
+
+struct Bin {
+    glm::vec3 minimum = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 maximum = glm::vec3(-std::numeric_limits<float>::max());
+    uint32_t count = 0;
+
+    inline void Grow(const glm::vec3& boxMinimum, const glm::vec3& boxMaximum)
+    {
+        minimum = glm::min(minimum, boxMinimum);
+        maximum = glm::max(maximum, boxMaximum);
+    }
+};
+
+// The corners of a box furthest along and against a plane's normal.
+inline void GetPlaneCorners(const glm::vec4& plane, const glm::vec3& minimum, const glm::vec3& maximum, glm::vec3& furthest, glm::vec3& nearest)
+{
+    for (int axis = 0; axis < 3; ++axis) {
+        const bool isPositive = plane[axis] >= 0.0f;
+        furthest[axis] = isPositive ? maximum[axis] : minimum[axis];
+        nearest[axis] = isPositive ? minimum[axis] : maximum[axis];
+    }
+}
+
+// Entry distance of a ray into a box, or infinity if it misses or only enters past maxDistance.
+inline float IntersectBox(const glm::vec3& origin, const glm::vec3& inverseDirection, const glm::vec3& minimum, const glm::vec3& maximum, float maxDistance)
+{
+    const glm::vec3 t0 = (minimum - origin) * inverseDirection;
+    const glm::vec3 t1 = (maximum - origin) * inverseDirection;
+    const glm::vec3 near = glm::min(t0, t1);
+    const glm::vec3 far = glm::max(t0, t1);
+
+    const float entry = std::max(std::max(near.x, near.y), std::max(near.z, 0.0f));
+    const float exit = std::min(std::min(far.x, far.y), std::min(far.z, maxDistance));
+
+    return entry <= exit ? entry : std::numeric_limits<float>::infinity();
+}
+}
+
+// ------------
+// Construction
+// ------------
+
+void Oglre::BoundingVolumeHierarchy::Build(const BoxBounds& bounds, const BvhBuildSettings& settings)
+{
+    m_Settings = settings;
+    m_Settings.binCount = std::clamp(m_Settings.binCount, 2u, maximumBinCount);
+    m_Settings.maximumLeafSize = std::max(m_Settings.maximumLeafSize, 1u);
+
+    const uint32_t objectCount = bounds.GetCount();
+    m_Boxes.resize(objectCount);
+    m_SlotBounds.Resize(objectCount);
+    m_SlotObjects.resize(objectCount);
+    m_ObjectSlots.resize(objectCount);
+    m_ObjectLeaves.resize(objectCount);
+    for (uint32_t object = 0; object < objectCount; ++object) {
+        m_Boxes[object].minimum = glm::vec3(bounds.GetMinimum(0)[object], bounds.GetMinimum(1)[object], bounds.GetMinimum(2)[object]);
+        m_Boxes[object].maximum = glm::vec3(bounds.GetMaximum(0)[object], bounds.GetMaximum(1)[object], bounds.GetMaximum(2)[object]);
+        m_SlotObjects[object] = object;
+    }
+
+    m_DirtyLeaves.clear();
+    m_Nodes.clear();
+    if (objectCount == 0) {
+        return;
+    }
+
+    const uint32_t threadBudget = m_Settings.threadCount > 0 ? m_Settings.threadCount : JobSystem::GetThreadCount();
+
+    std::vector<BvhNode> nodes;
+    nodes.reserve(2 * objectCount / m_Settings.maximumLeafSize + 1);
+    BuildSubtree(0, objectCount, nodes, 0, threadBudget);
+
+    m_Nodes.resize(nodes.size());
+    m_Parents.resize(nodes.size());
+    m_BuildAreas.resize(nodes.size());
+    m_IsNodeDirty.assign(nodes.size(), 0);
+    PlaceSubtree(nodes, 0, 0);
+}
+
+void Oglre::BoundingVolumeHierarchy::BuildSubtree(uint32_t first, uint32_t count, std::vector<BvhNode>& nodes, uint32_t depth, uint32_t threadBudget)
+{
+    struct Builder {
+        BoundingVolumeHierarchy& bvh;
+
+        // Bins centroids along axis, binCount bins over centroidMinimum + [0, binCount / binScale).
+        inline uint32_t GetBin(const ObjectBox& box, int axis, const glm::vec3& centroidMinimum, const glm::vec3& binScale) const
+        {
+            const float centroid = 0.5f * (box.minimum[axis] + box.maximum[axis]);
+            const uint32_t bin = static_cast<uint32_t>((centroid - centroidMinimum[axis]) * binScale[axis]);
+            return std::min(bin, bvh.m_Settings.binCount - 1);
+        }
+
+        // Finds the cheapest split of slots [first, first + count) by SAH, as bins [0, split) of axis going left.
+        // Kept out of BuildNode() so the bins are not on the stack for every level of the recursion.
+        bool FindSplit(uint32_t first, uint32_t count, const glm::vec3& centroidMinimum, const glm::vec3& binScale, int& bestAxis, uint32_t& bestSplit) const
+        {
+            const uint32_t binCount = bvh.m_Settings.binCount;
+            const std::vector<ObjectBox>& boxes = bvh.m_Boxes;
+
+            // Bin along every axis in one pass over the boxes, then sweep each axis.
+            std::array<std::array<Bin, maximumBinCount>, 3> bins;
+            for (uint32_t slot = first; slot < first + count; ++slot) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    Bin& bin = bins[axis][GetBin(boxes[slot], axis, centroidMinimum, binScale)];
+                    bin.Grow(boxes[slot].minimum, boxes[slot].maximum);
+                    ++bin.count;
+                }
+            }
+
+            float bestCost = std::numeric_limits<float>::infinity();
+            bestAxis = -1;
+            for (int axis = 0; axis < 3; ++axis) {
+                if (binScale[axis] == 0.0f) {
+                    continue;
+                }
+
+                // Area times count of everything right of each split, swept from the right.
+                std::array<float, maximumBinCount> rightCosts;
+                Bin right;
+                for (uint32_t split = binCount - 1; split > 0; --split) {
+                    right.Grow(bins[axis][split].minimum, bins[axis][split].maximum);
+                    right.count += bins[axis][split].count;
+                    rightCosts[split] = right.count > 0 ? HalfArea(right.minimum, right.maximum) * right.count : 0.0f;
+                }
+
+                Bin left;
+                for (uint32_t split = 1; split < binCount; ++split) {
+                    left.Grow(bins[axis][split - 1].minimum, bins[axis][split - 1].maximum);
+                    left.count += bins[axis][split - 1].count;
+                    const float leftCost = left.count > 0 ? HalfArea(left.minimum, left.maximum) * left.count : 0.0f;
+                    const float cost = leftCost + rightCosts[split];
+                    if (cost < bestCost && left.count > 0 && left.count < count) {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = split;
+                    }
+                }
+            }
+
+            return bestAxis >= 0;
+        }
+
+        // Returns the index of the node made for slots [first, first + count).
+        uint32_t BuildNode(uint32_t first, uint32_t count, std::vector<BvhNode>& nodes, uint32_t depth, uint32_t threadBudget)
+        {
+            const BvhBuildSettings& settings = bvh.m_Settings;
+            std::vector<ObjectBox>& boxes = bvh.m_Boxes;
+            std::vector<uint32_t>& slotObjects = bvh.m_SlotObjects;
+
+            Bin bounds;
+            Bin centroidBounds;
+            for (uint32_t slot = first; slot < first + count; ++slot) {
+                bounds.Grow(boxes[slot].minimum, boxes[slot].maximum);
+                const glm::vec3 centroid = 0.5f * (boxes[slot].minimum + boxes[slot].maximum);
+                centroidBounds.Grow(centroid, centroid);
+            }
+
+            const uint32_t nodeIndex = static_cast<uint32_t>(nodes.size());
+            nodes.push_back({ bounds.minimum, first, bounds.maximum, count });
+            if (count <= settings.maximumLeafSize || depth + 1 >= maximumDepth) {
+                return nodeIndex;
+            }
+
+            const glm::vec3 centroidExtent = centroidBounds.maximum - centroidBounds.minimum;
+            glm::vec3 binScale;
+            for (int axis = 0; axis < 3; ++axis) {
+                binScale[axis] = centroidExtent[axis] > 0.0f ? settings.binCount * 0.9999f / centroidExtent[axis] : 0.0f;
+            }
+
+            // Partitions the slots and their objects together. Without a split, every centroid is in the same place, so
+            // any split is as good as another.
+            uint32_t middle = first + count / 2;
+            int bestAxis = -1;
+            uint32_t bestSplit = 0;
+            if (FindSplit(first, count, centroidBounds.minimum, binScale, bestAxis, bestSplit)) {
+                uint32_t i = first;
+                uint32_t j = first + count;
+                while (i < j) {
+                    if (GetBin(boxes[i], bestAxis, centroidBounds.minimum, binScale) < bestSplit) {
+                        ++i;
+                    } else {
+                        --j;
+                        std::swap(boxes[i], boxes[j]);
+                        std::swap(slotObjects[i], slotObjects[j]);
+                    }
+                }
+                middle = i;
+            }
+
+            const uint32_t leftCount = middle - first;
+            const uint32_t rightCount = count - leftCount;
+
+            uint32_t rightIndex = 0;
+            if (threadBudget > 1 && count >= settings.parallelThreshold) {
+                // The right subtree is built into its own nodes as a job, then appended, which keeps the depth first
+                // order as the left subtree is complete by then.
+                std::vector<BvhNode> rightNodes;
+                const uint32_t rightBudget = threadBudget / 2;
+                const auto buildRight = [&]() {
+                    rightNodes.reserve(2 * rightCount / settings.maximumLeafSize + 1);
+                    BuildNode(middle, rightCount, rightNodes, depth + 1, rightBudget);
+                };
+
+                JobCounter rightCounter;
+                JobSystem::Run(rightCounter, buildRight);
+                BuildNode(first, leftCount, nodes, depth + 1, threadBudget - rightBudget);
+                JobSystem::Wait(rightCounter);
+
+                rightIndex = static_cast<uint32_t>(nodes.size());
+                for (BvhNode node : rightNodes) {
+                    if (!node.IsLeaf()) {
+                        node.index += rightIndex;
+                    }
+                    nodes.push_back(node);
+                }
+            } else {
+                BuildNode(first, leftCount, nodes, depth + 1, threadBudget);
+                rightIndex = BuildNode(middle, rightCount, nodes, depth + 1, threadBudget);
+            }
+
+            nodes[nodeIndex].index = rightIndex;
+            nodes[nodeIndex].objectCount = 0;
+            return nodeIndex;
+        }
+    };
+
+    Builder builder { *this };
+    builder.BuildNode(first, count, nodes, depth, threadBudget);
+}
+
+void Oglre::BoundingVolumeHierarchy::PlaceSubtree(const std::vector<BvhNode>& subtree, uint32_t nodeIndex, uint32_t parent)
+{
+    m_Parents[nodeIndex] = parent;
+
+    for (uint32_t i = 0; i < subtree.size(); ++i) {
+        const uint32_t node = nodeIndex + i;
+        m_Nodes[node] = subtree[i];
+        m_BuildAreas[node] = HalfArea(subtree[i].minimum, subtree[i].maximum);
+        m_IsNodeDirty[node] = 0;
+
+        if (subtree[i].IsLeaf()) {
+            for (uint32_t slot = subtree[i].index; slot < subtree[i].index + subtree[i].objectCount; ++slot) {
+                m_SlotBounds.Set(slot, m_Boxes[slot].minimum, m_Boxes[slot].maximum);
+                m_ObjectSlots[m_SlotObjects[slot]] = slot;
+                m_ObjectLeaves[m_SlotObjects[slot]] = node;
+            }
+        } else {
+            m_Nodes[node].index += nodeIndex;
+            m_Parents[node + 1] = node;
+            m_Parents[m_Nodes[node].index] = node;
+        }
+    }
+}
+
+void Oglre::BoundingVolumeHierarchy::GetSubtreeRange(uint32_t nodeIndex, uint32_t& firstSlot, uint32_t& lastSlot, uint32_t& endNode) const
+{
+    uint32_t leftmost = nodeIndex;
+    while (!m_Nodes[leftmost].IsLeaf()) {
+        leftmost = leftmost + 1;
+    }
+
+    uint32_t rightmost = nodeIndex;
+    while (!m_Nodes[rightmost].IsLeaf()) {
+        rightmost = m_Nodes[rightmost].index;
+    }
+
+    firstSlot = m_Nodes[leftmost].index;
+    lastSlot = m_Nodes[rightmost].index + m_Nodes[rightmost].objectCount;
+    endNode = rightmost + 1;
+}
+
+// -----
+// Refit
+// -----
+
+void Oglre::BoundingVolumeHierarchy::UpdateObject(uint32_t object, const glm::vec3& minimum, const glm::vec3& maximum)
+{
+    m_Boxes[m_ObjectSlots[object]] = { minimum, maximum };
+    m_SlotBounds.Set(m_ObjectSlots[object], minimum, maximum);
+
+    const uint32_t leaf = m_ObjectLeaves[object];
+    if (!m_IsNodeDirty[leaf]) {
+        m_IsNodeDirty[leaf] = 1;
+        m_DirtyLeaves.push_back(leaf);
+    }
+}
+
+uint32_t Oglre::BoundingVolumeHierarchy::Refit()
+{
+    if (m_DirtyLeaves.empty()) {
+        return 0;
+    }
+
+    // Every node above a dirty leaf, each once. Children come after their parents in depth first order, so refitting in
+    // descending order refits children first.
+    std::vector<uint32_t> dirtyNodes = std::move(m_DirtyLeaves);
+    m_DirtyLeaves.clear();
+    const size_t leafCount = dirtyNodes.size();
+    for (size_t i = 0; i < leafCount; ++i) {
+        for (uint32_t node = dirtyNodes[i]; node != 0;) {
+            node = m_Parents[node];
+            if (m_IsNodeDirty[node]) {
+                break;
+            }
+            m_IsNodeDirty[node] = 1;
+            dirtyNodes.push_back(node);
+        }
+    }
+
+    std::sort(dirtyNodes.begin(), dirtyNodes.end(), std::greater<uint32_t>());
+    for (uint32_t node : dirtyNodes) {
+        RefitNode(node);
+        m_IsNodeDirty[node] = 0;
+    }
+
+    // Rebuild the topmost skewed subtrees, anything below them is rebuilt with them.
+    uint32_t rebuiltCount = 0;
+    uint32_t rebuiltEnd = 0;
+    for (auto it = dirtyNodes.rbegin(); it != dirtyNodes.rend(); ++it) {
+        const uint32_t node = *it;
+        if (node < rebuiltEnd || m_Nodes[node].IsLeaf()) {
+            continue;
+        }
+
+        const float area = HalfArea(m_Nodes[node].minimum, m_Nodes[node].maximum);
+        if (area <= m_Settings.skewThreshold * m_BuildAreas[node]) {
+            continue;
+        }
+
+        uint32_t firstSlot = 0;
+        uint32_t lastSlot = 0;
+        GetSubtreeRange(node, firstSlot, lastSlot, rebuiltEnd);
+        if (!RebuildSubtree(node)) {
+            // The new subtree needs more nodes than the old one had, so everything has to move.
+            std::vector<BvhNode> nodes;
+            nodes.reserve(m_Nodes.size());
+            BuildSubtree(0, GetObjectCount(), nodes, 0, m_Settings.threadCount > 0 ? m_Settings.threadCount : JobSystem::GetThreadCount());
+
+            m_Nodes.resize(nodes.size());
+            m_Parents.resize(nodes.size());
+            m_BuildAreas.resize(nodes.size());
+            m_IsNodeDirty.assign(nodes.size(), 0);
+            PlaceSubtree(nodes, 0, 0);
+
+            return rebuiltCount + 1;
+        }
+        ++rebuiltCount;
+    }
+
+    return rebuiltCount;
+}
+
+void Oglre::BoundingVolumeHierarchy::RefitNode(uint32_t nodeIndex)
+{
+    BvhNode& node = m_Nodes[nodeIndex];
+    if (node.IsLeaf()) {
+        Bin bounds;
+        for (uint32_t slot = node.index; slot < node.index + node.objectCount; ++slot) {
+            bounds.Grow(m_Boxes[slot].minimum, m_Boxes[slot].maximum);
+        }
+        node.minimum = bounds.minimum;
+        node.maximum = bounds.maximum;
+    } else {
+        const BvhNode& left = m_Nodes[nodeIndex + 1];
+        const BvhNode& right = m_Nodes[node.index];
+        node.minimum = glm::min(left.minimum, right.minimum);
+        node.maximum = glm::max(left.maximum, right.maximum);
+    }
+}
+
+bool Oglre::BoundingVolumeHierarchy::RebuildSubtree(uint32_t nodeIndex)
+{
+    uint32_t firstSlot = 0;
+    uint32_t lastSlot = 0;
+    uint32_t endNode = 0;
+    GetSubtreeRange(nodeIndex, firstSlot, lastSlot, endNode);
+
+    uint32_t depth = 0;
+    for (uint32_t node = nodeIndex; node != 0; node = m_Parents[node]) {
+        ++depth;
+    }
+
+    std::vector<BvhNode> subtree;
+    subtree.reserve(endNode - nodeIndex);
+    BuildSubtree(firstSlot, lastSlot - firstSlot, subtree, depth, 1);
+    if (subtree.size() > endNode - nodeIndex) {
+        return false;
+    }
+
+    PlaceSubtree(subtree, nodeIndex, m_Parents[nodeIndex]);
+
+    // Nodes the new subtree did not need are left unreachable, as empty boxes.
+    for (uint32_t node = nodeIndex + static_cast<uint32_t>(subtree.size()); node < endNode; ++node) {
+        m_Nodes[node] = { glm::vec3(std::numeric_limits<float>::max()), 0, glm::vec3(-std::numeric_limits<float>::max()), 0 };
+    }
+
+    return true;
+}
+
+// -------
+// Queries
+// -------
+
+uint32_t Oglre::BoundingVolumeHierarchy::CullFrustum(const Frustum& frustum, std::span<uint32_t> visibleObjects) const
+{
+    if (m_Nodes.empty()) {
+        return 0;
+    }
+
+    // Planes a node is entirely inside of are dropped for its children, which are inside them too.
+    constexpr uint32_t allPlanes = (1 << 6) - 1;
+    std::array<std::pair<uint32_t, uint32_t>, maximumDepth + 1> stack;
+    uint32_t stackSize = 0;
+    stack[stackSize++] = { 0, allPlanes };
+
+    // Leaves that are only partly inside are tested after the traversal, with FrustumCuller's SIMD path. Depth first
+    // order makes neighbouring leaves' slots contiguous, so their ranges are merged into runs long enough for it.
+    std::vector<std::pair<uint32_t, uint32_t>> partialRanges;
+
+    uint32_t visibleCount = 0;
+    while (stackSize > 0) {
+        auto [nodeIndex, planeMask] = stack[--stackSize];
+        const BvhNode& node = m_Nodes[nodeIndex];
+
+        bool isOutside = false;
+        for (uint32_t plane = 0; plane < 6 && !isOutside; ++plane) {
+            if (!(planeMask & (1 << plane))) {
+                continue;
+            }
+
+            glm::vec3 furthest;
+            glm::vec3 nearest;
+            GetPlaneCorners(frustum.planes[plane], node.minimum, node.maximum, furthest, nearest);
+            isOutside = Frustum::PlaneDistance(frustum.planes[plane], furthest.x, furthest.y, furthest.z) < 0.0f;
+            if (Frustum::PlaneDistance(frustum.planes[plane], nearest.x, nearest.y, nearest.z) >= 0.0f) {
+                planeMask &= ~(1 << plane);
+            }
+        }
+        if (isOutside) {
+            continue;
+        }
+
+        if (planeMask == 0) {
+            // Entirely inside, so is everything below.
+            uint32_t firstSlot = 0;
+            uint32_t lastSlot = 0;
+            uint32_t endNode = 0;
+            GetSubtreeRange(nodeIndex, firstSlot, lastSlot, endNode);
+            const uint32_t count = std::min(lastSlot - firstSlot, static_cast<uint32_t>(visibleObjects.size()) - visibleCount);
+            std::copy_n(m_SlotObjects.begin() + firstSlot, count, visibleObjects.begin() + visibleCount);
+            visibleCount += count;
+        } else if (node.IsLeaf()) {
+            if (!partialRanges.empty() && partialRanges.back().first + partialRanges.back().second == node.index) {
+                partialRanges.back().second += node.objectCount;
+            } else {
+                partialRanges.emplace_back(node.index, node.objectCount);
+            }
+        } else {
+            stack[stackSize++] = { node.index, planeMask };
+            stack[stackSize++] = { nodeIndex + 1, planeMask };
+        }
+    }
+
+    // FrustumCuller writes slots, which are then replaced by their objects in place.
+    for (const auto& [firstSlot, slotCount] : partialRanges) {
+        const uint32_t rangeVisibleCount = FrustumCuller::Cull(frustum, m_SlotBounds, firstSlot, slotCount, visibleObjects.subspan(visibleCount));
+        for (uint32_t i = visibleCount; i < visibleCount + rangeVisibleCount; ++i) {
+            visibleObjects[i] = m_SlotObjects[visibleObjects[i]];
+        }
+        visibleCount += rangeVisibleCount;
+    }
+
+    return visibleCount;
+}
+
+Oglre::RayHit Oglre::BoundingVolumeHierarchy::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const
+{
+    RayHit hit;
+    if (m_Nodes.empty()) {
+        return hit;
+    }
+
+    const glm::vec3 inverseDirection = 1.0f / direction;
+    hit.distance = maxDistance;
+
+    // Nodes are pushed with their entry distance, and skipped once something nearer has been hit.
+    std::array<std::pair<uint32_t, float>, maximumDepth + 1> stack;
+    uint32_t stackSize = 0;
+
+    const float rootEntry = IntersectBox(origin, inverseDirection, m_Nodes[0].minimum, m_Nodes[0].maximum, hit.distance);
+    if (rootEntry != std::numeric_limits<float>::infinity()) {
+        stack[stackSize++] = { 0, rootEntry };
+    }
+
+    while (stackSize > 0) {
+        const auto [nodeIndex, entry] = stack[--stackSize];
+        if (entry > hit.distance) {
+            continue;
+        }
+
+        const BvhNode& node = m_Nodes[nodeIndex];
+        if (node.IsLeaf()) {
+            for (uint32_t slot = node.index; slot < node.index + node.objectCount; ++slot) {
+                const float distance = IntersectBox(origin, inverseDirection, m_Boxes[slot].minimum, m_Boxes[slot].maximum, hit.distance);
+                if (distance < hit.distance || (distance == hit.distance && !hit.IsHit())) {
+                    hit.distance = distance;
+                    hit.object = m_SlotObjects[slot];
+                }
+            }
+            continue;
+        }
+
+        // The nearer child is pushed last, so it is visited first and prunes the other.
+        uint32_t nearChild = nodeIndex + 1;
+        uint32_t farChild = node.index;
+        float nearEntry = IntersectBox(origin, inverseDirection, m_Nodes[nearChild].minimum, m_Nodes[nearChild].maximum, hit.distance);
+        float farEntry = IntersectBox(origin, inverseDirection, m_Nodes[farChild].minimum, m_Nodes[farChild].maximum, hit.distance);
+        if (farEntry < nearEntry) {
+            std::swap(nearChild, farChild);
+            std::swap(nearEntry, farEntry);
+        }
+
+        if (farEntry != std::numeric_limits<float>::infinity()) {
+            stack[stackSize++] = { farChild, farEntry };
+        }
+        if (nearEntry != std::numeric_limits<float>::infinity()) {
+            stack[stackSize++] = { nearChild, nearEntry };
+        }
+    }
+
+    if (!hit.IsHit()) {
+        hit.distance = std::numeric_limits<float>::infinity();
+    }
+    return hit;
+}
+
+float Oglre::BoundingVolumeHierarchy::GetSahCost() const
+{
+    if (m_Nodes.empty()) {
+        return 0.0f;
+    }
+
+    const float rootArea = std::max(HalfArea(m_Nodes[0].minimum, m_Nodes[0].maximum), std::numeric_limits<float>::min());
+
+    // Walks the reachable nodes only, subtree rebuilds can leave unused ones behind.
+    std::array<uint32_t, maximumDepth + 1> stack;
+    uint32_t stackSize = 0;
+    stack[stackSize++] = 0;
+
+    double cost = 0.0;
+    while (stackSize > 0) {
+        const BvhNode& node = m_Nodes[stack[--stackSize]];
+        const float relativeArea = HalfArea(node.minimum, node.maximum) / rootArea;
+        if (node.IsLeaf()) {
+            cost += relativeArea * node.objectCount;
+        } else {
+            cost += relativeArea;
+            stack[stackSize++] = node.index;
+            stack[stackSize++] = static_cast<uint32_t>(&node - m_Nodes.data()) + 1;
+        }
+    }
+
+    return static_cast<float>(cost);
+}
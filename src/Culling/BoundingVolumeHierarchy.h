@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "FrustumCuller.h"
+
+namespace Oglre {
+
+// One node of a BoundingVolumeHierarchy, 32 bytes so two share a cache line.
+// Nodes are stored depth first, so an inner node's left child is always the next node, and a subtree's nodes are
+// contiguous.
+struct BvhNode {
+    glm::vec3 minimum;
+    uint32_t index; // Inner nodes: index of the right child. Leaves: first slot of the leaf's objects.
+    glm::vec3 maximum;
+    uint32_t objectCount; // 0 for inner nodes.
+
+    inline bool IsLeaf() const
+    {
+        return objectCount > 0;
+    }
+};
+static_assert(sizeof(BvhNode) == 32, "BvhNode should stay 32 bytes.");
+
+struct BvhBuildSettings {
+    uint32_t maximumLeafSize = 4;
+    uint32_t binCount = 16; // SAH candidate splits per axis are binCount - 1.
+
+    // Subtrees of at least parallelThreshold objects are built as their own jobs, splitting the build up to threadCount
+    // ways. 0 uses every job system thread, 1 builds on the calling thread only.
+    uint32_t threadCount = 0;
+    uint32_t parallelThreshold = 1 << 14;
+
+    // Refit() rebuilds a subtree once its surface area has grown by more than this factor since it was built.
+    float skewThreshold = 2.0f;
+};
+
+struct RayHit {
+    static constexpr uint32_t noObject = std::numeric_limits<uint32_t>::max();
+
+    uint32_t object = noObject;
+    float distance = std::numeric_limits<float>::infinity();
+
+    inline bool IsHit() const
+    {
+        return object != noObject;
+    }
+};
+
+// -------------------------
+// Bounding Volume Hierarchy
+// -------------------------
+//
+// A binary tree of axis-aligned boxes over a scene's objects, so frustum and ray queries only visit the parts of the
+// scene they can touch, rather than every object.
+//
+// Built top down with binned SAH (Wald 2007): each node is split where the surface area heuristic estimates the
+// cheapest traversal, among binCount planes per axis. Objects that move only need UpdateObject() and Refit(), which
+// recomputes the boxes of the nodes above them. Refitting keeps the tree valid but not good, so subtrees whose boxes
+// have grown past skewThreshold are rebuilt in place.
+//
+// Objects are identified by their index in the bounds Build() was given.
+class BoundingVolumeHierarchy {
+public:
+    void Build(const BoxBounds& bounds, const BvhBuildSettings& settings = {});
+
+    // Moves an object. Takes effect in queries after the next Refit().
+    void UpdateObject(uint32_t object, const glm::vec3& minimum, const glm::vec3& maximum);
+
+    // Refits the nodes above every object updated since the last Refit(), and rebuilds skewed subtrees.
+    // Returns the number of subtrees that were rebuilt.
+    uint32_t Refit();
+
+    // Writes the objects that intersect frustum to visibleObjects, in no particular order, and returns how many.
+    // Leaves the frustum only partly covers are tested with FrustumCuller, so the same objects are found, with its SIMD
+    // path where the CPU has it. visibleObjects needs room for GetObjectCount().
+    uint32_t CullFrustum(const Frustum& frustum, std::span<uint32_t> visibleObjects) const;
+
+    // The nearest object whose box the ray enters within maxDistance. direction does not need to be normalized, the
+    // distance is in multiples of it. Rays starting inside a box hit it at distance 0.
+    RayHit Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+    // Estimated cost of a random query, relative to testing one box, summed over the tree. Lower is better.
+    float GetSahCost() const;
+
+    inline uint32_t GetObjectCount() const
+    {
+        return static_cast<uint32_t>(m_ObjectSlots.size());
+    }
+
+    inline uint32_t GetNodeCount() const
+    {
+        return static_cast<uint32_t>(m_Nodes.size());
+    }
+
+    inline const std::vector<BvhNode>& GetNodes() const
+    {
+        return m_Nodes;
+    }
+
+private:
+    // An object's box, in the order the leaves reference them, so a leaf's boxes are contiguous.
+    struct ObjectBox {
+        glm::vec3 minimum;
+        glm::vec3 maximum;
+    };
+
+    BvhBuildSettings m_Settings;
+
+    std::vector<BvhNode> m_Nodes;
+    std::vector<uint32_t> m_Parents; // Per node, the root's is itself.
+    std::vector<float> m_BuildAreas; // Per node, surface area when its subtree was last built, to detect skew.
+
+    std::vector<ObjectBox> m_Boxes; // Per slot.
+    BoxBounds m_SlotBounds; // Per slot, the same boxes as m_Boxes for FrustumCuller to test leaves with.
+    std::vector<uint32_t> m_SlotObjects; // Per slot, the object in it.
+    std::vector<uint32_t> m_ObjectSlots; // Per object, its slot.
+    std::vector<uint32_t> m_ObjectLeaves; // Per object, the leaf whose slots hold it.
+
+    std::vector<uint32_t> m_DirtyLeaves;
+    std::vector<uint8_t> m_IsNodeDirty;
+
+    // Builds the subtree over slots [first, first + count) into nodes, depth first, with child indices relative to the
+    // start of nodes. Reorders the slots. depth is the depth its root will be placed at, so that the whole tree stays
+    // within the depth the queries' stacks allow.
+    void BuildSubtree(uint32_t first, uint32_t count, std::vector<BvhNode>& nodes, uint32_t depth, uint32_t threadBudget);
+
+    // Copies a subtree built by BuildSubtree() to nodes [nodeIndex, nodeIndex + subtree.size()), and updates the
+    // per node and per object bookkeeping. parent is the parent of the subtree's root.
+    void PlaceSubtree(const std::vector<BvhNode>& subtree, uint32_t nodeIndex, uint32_t parent);
+
+    // Slots [first, last) of the subtree at nodeIndex, and the index one past its last node.
+    void GetSubtreeRange(uint32_t nodeIndex, uint32_t& firstSlot, uint32_t& lastSlot, uint32_t& endNode) const;
+
+    bool RebuildSubtree(uint32_t nodeIndex);
+    void RefitNode(uint32_t nodeIndex);
+};
+}
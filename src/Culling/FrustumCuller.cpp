@@ -0,0 +1,362 @@
+#include "FrustumCuller.h"
+
+#include <algorithm>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define OGLRE_CULLER_AVX2
+#include <immintrin.h>
+#endif
+
+// -------
+// Frustum
+// -------
+
+Oglre::Frustum Oglre::Frustum::FromMatrix(const glm::mat4& viewProjection)
+{
+    // glm matrices are column major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i]).
+    const auto row = [&](int i) {
+        return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    };
+
+    Frustum frustum;
+    frustum.planes[0] = row(3) + row(0);
+    frustum.planes[1] = row(3) - row(0);
+    frustum.planes[2] = row(3) + row(1);
+    frustum.planes[3] = row(3) - row(1);
+    frustum.planes[4] = row(3) + row(2);
+    frustum.planes[5] = row(3) - row(2);
+
+    // Unit normals make the distance term a real distance, which the sphere test relies on.
+    for (glm::vec4& plane : frustum.planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+
+    return frustum;
+}
+
+// ------------
+// Bounds (SoA)
+// ------------
+
+void Oglre::BoxBounds::Resize(uint32_t count)
+{
+    m_MinimumX.resize(count);
+    m_MinimumY.resize(count);
+    m_MinimumZ.resize(count);
+    m_MaximumX.resize(count);
+    m_MaximumY.resize(count);
+    m_MaximumZ.resize(count);
+}
+
+void Oglre::BoxBounds::Clear()
+{
+    Resize(0);
+}
+
+void Oglre::BoxBounds::Set(uint32_t index, const glm::vec3& minimum, const glm::vec3& maximum)
+{
+    m_MinimumX[index] = minimum.x;
+    m_MinimumY[index] = minimum.y;
+    m_MinimumZ[index] = minimum.z;
+    m_MaximumX[index] = maximum.x;
+    m_MaximumY[index] = maximum.y;
+    m_MaximumZ[index] = maximum.z;
+}
+
+uint32_t Oglre::BoxBounds::Add(const glm::vec3& minimum, const glm::vec3& maximum)
+{
+    const uint32_t index = GetCount();
+    Resize(index + 1);
+    Set(index, minimum, maximum);
+
+    return index;
+}
+
+void Oglre::SphereBounds::Resize(uint32_t count)
+{
+    m_CentreX.resize(count);
+    m_CentreY.resize(count);
+    m_CentreZ.resize(count);
+    m_Radius.resize(count);
+}
+
+void Oglre::SphereBounds::Clear()
+{
+    Resize(0);
+}
+
+void Oglre::SphereBounds::Set(uint32_t index, const glm::vec3& centre, float radius)
+{
+    m_CentreX[index] = centre.x;
+    m_CentreY[index] = centre.y;
+    m_CentreZ[index] = centre.z;
+    m_Radius[index] = radius;
+}
+
+uint32_t Oglre::SphereBounds::Add(const glm::vec3& centre, float radius)
+{
+    const uint32_t index = GetCount();
+    Resize(index + 1);
+    Set(index, centre, radius);
+
+    return index;
+}
+
+// --------------
+// Frustum Culler
+// --------------
+
+namespace {
+// A box is outside a plane when its corner furthest along the plane's normal is, so for each plane and axis only one of
+// the minimum or the maximum is ever read. Choosing the arrays up front keeps the loops free of per-object selects.
+struct BoxPlane {
+    std::array<const float*, 3> corner; // x, y, z arrays of the corner furthest along the normal.
+    glm::vec4 plane;
+};
+
+std::array<BoxPlane, 6> MakeBoxPlanes(const Oglre::Frustum& frustum, const Oglre::BoxBounds& bounds)
+{
+    std::array<BoxPlane, 6> boxPlanes;
+    for (uint32_t i = 0; i < 6; ++i) {
+        boxPlanes[i].plane = frustum.planes[i];
+        for (uint32_t axis = 0; axis < 3; ++axis) {
+            boxPlanes[i].corner[axis] = frustum.planes[i][axis] >= 0.0f ? bounds.GetMaximum(axis) : bounds.GetMinimum(axis);
+        }
+    }
+
+    return boxPlanes;
+}
+
+uint32_t CullBoxesScalar(const std::array<BoxPlane, 6>& boxPlanes, uint32_t first, uint32_t last, uint32_t* visibleIndices)
+{
+    uint32_t visibleCount = 0;
+    for (uint32_t i = first; i < last; ++i) {
+        bool isVisible = true;
+        for (const BoxPlane& boxPlane : boxPlanes) {
+            const glm::vec4& plane = boxPlane.plane;
+            const float distance = Oglre::Frustum::PlaneDistance(plane, boxPlane.corner[0][i], boxPlane.corner[1][i], boxPlane.corner[2][i]);
+            isVisible &= distance >= 0.0f;
+        }
+
+        // Written unconditionally, and only kept by advancing the count, so there is no branch to mispredict.
+        visibleIndices[visibleCount] = i;
+        visibleCount += isVisible;
+    }
+
+    return visibleCount;
+}
+
+uint32_t CullSpheresScalar(const Oglre::Frustum& frustum, const Oglre::SphereBounds& bounds, uint32_t first, uint32_t count, uint32_t* visibleIndices)
+{
+    const float* centreX = bounds.GetCentre(0);
+    const float* centreY = bounds.GetCentre(1);
+    const float* centreZ = bounds.GetCentre(2);
+    const float* radius = bounds.GetRadius();
+
+    uint32_t visibleCount = 0;
+    for (uint32_t i = first; i < count; ++i) {
+        bool isVisible = true;
+        for (const glm::vec4& plane : frustum.planes) {
+            const float distance = Oglre::Frustum::PlaneDistance(plane, centreX[i], centreY[i], centreZ[i]);
+            isVisible &= distance >= -radius[i];
+        }
+
+        visibleIndices[visibleCount] = i;
+        visibleCount += isVisible;
+    }
+
+    return visibleCount;
+}
+
+#ifdef OGLRE_CULLER_AVX2
+bool HasAvx2()
+{
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    return hasAvx2;
+}
+
+// For each 8-bit visibility mask, the lanes of the set bits moved to the front, for compacting indices with one permute.
+constexpr std::array<std::array<uint32_t, 8>, 256> MakeCompactionTable()
+{
+    std::array<std::array<uint32_t, 8>, 256> table {};
+    for (uint32_t mask = 0; mask < 256; ++mask) {
+        uint32_t next = 0;
+        for (uint32_t lane = 0; lane < 8; ++lane) {
+            if (mask & (1u << lane)) {
+                table[mask][next++] = lane;
+            }
+        }
+    }
+
+    return table;
+}
+
+constexpr std::array<std::array<uint32_t, 8>, 256> compactionTable = MakeCompactionTable();
+
+// Appends the indices of the visible lanes of a block of 8 starting at first. Always stores 8 indices, the ones past the
+// visible count are overwritten by the next block, so visibleIndices needs room for a whole block.
+__attribute__((target("avx2"))) inline uint32_t CompactIndicesAvx2(__m256 visible, uint32_t first, uint32_t* visibleIndices)
+{
+    const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(visible));
+    const __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(compactionTable[mask].data()));
+    const __m256i indices = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(first)), lanes);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(visibleIndices), indices);
+
+    return static_cast<uint32_t>(__builtin_popcount(mask));
+}
+
+// Tests Blocks blocks of 8 boxes starting at first, and appends the visible ones. Testing several blocks per plane
+// means each plane's coefficients are broadcast once for all of them, rather than reloaded for every block.
+template <uint32_t Blocks>
+__attribute__((target("avx2"))) inline uint32_t CullBoxBlocksAvx2(const std::array<BoxPlane, 6>& boxPlanes, uint32_t first, uint32_t* visibleIndices)
+{
+    __m256 visible[Blocks];
+    for (uint32_t block = 0; block < Blocks; ++block) {
+        visible[block] = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    }
+
+    for (const BoxPlane& boxPlane : boxPlanes) {
+        const __m256 normalX = _mm256_set1_ps(boxPlane.plane.x);
+        const __m256 normalY = _mm256_set1_ps(boxPlane.plane.y);
+        const __m256 normalZ = _mm256_set1_ps(boxPlane.plane.z);
+        const __m256 distance = _mm256_set1_ps(boxPlane.plane.w);
+
+#pragma GCC unroll 4
+        for (uint32_t block = 0; block < Blocks; ++block) {
+            const uint32_t i = first + 8 * block;
+            // Same operations as Frustum::PlaneDistance().
+            const __m256 x = _mm256_mul_ps(normalX, _mm256_loadu_ps(boxPlane.corner[0] + i));
+            const __m256 y = _mm256_mul_ps(normalY, _mm256_loadu_ps(boxPlane.corner[1] + i));
+            const __m256 z = _mm256_mul_ps(normalZ, _mm256_loadu_ps(boxPlane.corner[2] + i));
+            const __m256 cornerDistance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(x, y), z), distance);
+            visible[block] = _mm256_and_ps(visible[block], _mm256_cmp_ps(cornerDistance, _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+    }
+
+    uint32_t visibleCount = 0;
+    for (uint32_t block = 0; block < Blocks; ++block) {
+        visibleCount += CompactIndicesAvx2(visible[block], first + 8 * block, visibleIndices + visibleCount);
+    }
+
+    return visibleCount;
+}
+
+template <uint32_t Blocks>
+__attribute__((target("avx2"))) inline uint32_t CullSphereBlocksAvx2(const Oglre::Frustum& frustum, const Oglre::SphereBounds& bounds, uint32_t first,
+    uint32_t* visibleIndices)
+{
+    __m256 visible[Blocks];
+    for (uint32_t block = 0; block < Blocks; ++block) {
+        visible[block] = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    }
+
+    for (const glm::vec4& plane : frustum.planes) {
+        const __m256 normalX = _mm256_set1_ps(plane.x);
+        const __m256 normalY = _mm256_set1_ps(plane.y);
+        const __m256 normalZ = _mm256_set1_ps(plane.z);
+        const __m256 distance = _mm256_set1_ps(plane.w);
+
+#pragma GCC unroll 4
+        for (uint32_t block = 0; block < Blocks; ++block) {
+            const uint32_t i = first + 8 * block;
+            // Same operations as Frustum::PlaneDistance().
+            const __m256 x = _mm256_mul_ps(normalX, _mm256_loadu_ps(bounds.GetCentre(0) + i));
+            const __m256 y = _mm256_mul_ps(normalY, _mm256_loadu_ps(bounds.GetCentre(1) + i));
+            const __m256 z = _mm256_mul_ps(normalZ, _mm256_loadu_ps(bounds.GetCentre(2) + i));
+            const __m256 centreDistance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(x, y), z), distance);
+            const __m256 negativeRadius = _mm256_xor_ps(_mm256_loadu_ps(bounds.GetRadius() + i), _mm256_set1_ps(-0.0f));
+            visible[block] = _mm256_and_ps(visible[block], _mm256_cmp_ps(centreDistance, negativeRadius, _CMP_GE_OQ));
+        }
+    }
+
+    uint32_t visibleCount = 0;
+    for (uint32_t block = 0; block < Blocks; ++block) {
+        visibleCount += CompactIndicesAvx2(visible[block], first + 8 * block, visibleIndices + visibleCount);
+    }
+
+    return visibleCount;
+}
+
+// Blocks of 8 tested per step of the main loops.
+constexpr uint32_t blocksPerStep = 4;
+
+// Tests boxes [first, last) and returns the number of visible ones. processed is set to one past the last box tested,
+// first plus a multiple of 8.
+__attribute__((target("avx2"))) uint32_t CullBoxesAvx2(const std::array<BoxPlane, 6>& boxPlanes, uint32_t first, uint32_t last, uint32_t* visibleIndices,
+    uint32_t& processed)
+{
+    uint32_t visibleCount = 0;
+    uint32_t i = first;
+    for (; i + 8 * blocksPerStep <= last; i += 8 * blocksPerStep) {
+        visibleCount += CullBoxBlocksAvx2<blocksPerStep>(boxPlanes, i, visibleIndices + visibleCount);
+    }
+    for (; i + 8 <= last; i += 8) {
+        visibleCount += CullBoxBlocksAvx2<1>(boxPlanes, i, visibleIndices + visibleCount);
+    }
+
+    processed = i;
+    return visibleCount;
+}
+
+__attribute__((target("avx2"))) uint32_t CullSpheresAvx2(const Oglre::Frustum& frustum, const Oglre::SphereBounds& bounds, uint32_t count, uint32_t* visibleIndices,
+    uint32_t& processed)
+{
+    uint32_t visibleCount = 0;
+    uint32_t i = 0;
+    for (; i + 8 * blocksPerStep <= count; i += 8 * blocksPerStep) {
+        visibleCount += CullSphereBlocksAvx2<blocksPerStep>(frustum, bounds, i, visibleIndices + visibleCount);
+    }
+    for (; i + 8 <= count; i += 8) {
+        visibleCount += CullSphereBlocksAvx2<1>(frustum, bounds, i, visibleIndices + visibleCount);
+    }
+
+    processed = i;
+    return visibleCount;
+}
+#endif
+}
+
+bool Oglre::FrustumCuller::IsSimdSupported()
+{
+#ifdef OGLRE_CULLER_AVX2
+    return HasAvx2();
+#else
+    return false;
+#endif
+}
+
+uint32_t Oglre::FrustumCuller::Cull(const Frustum& frustum, const BoxBounds& bounds, std::span<uint32_t> visibleIndices)
+{
+    return Cull(frustum, bounds, 0, bounds.GetCount(), visibleIndices);
+}
+
+uint32_t Oglre::FrustumCuller::Cull(const Frustum& frustum, const BoxBounds& bounds, uint32_t first, uint32_t count, std::span<uint32_t> visibleIndices)
+{
+    const std::array<BoxPlane, 6> boxPlanes = MakeBoxPlanes(frustum, bounds);
+    const uint32_t last = first + std::min({ count, bounds.GetCount() - std::min(first, bounds.GetCount()), static_cast<uint32_t>(visibleIndices.size()) });
+
+    uint32_t visibleCount = 0;
+    uint32_t processed = first;
+#ifdef OGLRE_CULLER_AVX2
+    if (simdEnabled && HasAvx2()) {
+        visibleCount = CullBoxesAvx2(boxPlanes, first, last, visibleIndices.data(), processed);
+    }
+#endif
+
+    return visibleCount + CullBoxesScalar(boxPlanes, processed, last, visibleIndices.data() + visibleCount);
+}
+
+uint32_t Oglre::FrustumCuller::Cull(const Frustum& frustum, const SphereBounds& bounds, std::span<uint32_t> visibleIndices)
+{
+    const uint32_t count = std::min(bounds.GetCount(), static_cast<uint32_t>(visibleIndices.size()));
+
+    uint32_t visibleCount = 0;
+    uint32_t processed = 0;
+#ifdef OGLRE_CULLER_AVX2
+    if (simdEnabled && HasAvx2()) {
+        visibleCount = CullSpheresAvx2(frustum, bounds, count, visibleIndices.data(), processed);
+    }
+#endif
+
+    return visibleCount + CullSpheresScalar(frustum, bounds, processed, count, visibleIndices.data() + visibleCount);
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace Oglre {
+
+// The six planes of a view frustum, as (normal, distance) with normals of unit length pointing inwards, so a point p
+// is inside a plane when dot(normal, p) + distance >= 0.
+struct Frustum {
+    std::array<glm::vec4, 6> planes; // Left, right, bottom, top, near, far.
+
+    // Extracts the planes of the clip space volume -w <= x, y, z <= w (Gribb and Hartmann), in whatever space the
+    // matrix transforms from, e.g. world space for projection * view.
+    static Frustum FromMatrix(const glm::mat4& viewProjection);
+
+    // dot(normal, point) + distance. Every culling path evaluates it with these operations in this order, without FMA,
+    // so they all round the same way and agree even on volumes that just touch a plane.
+    static inline float PlaneDistance(const glm::vec4& plane, float x, float y, float z)
+    {
+        return ((plane.x * x + plane.y * y) + plane.z * z) + plane.w;
+    }
+};
+
+// ------------
+// Bounds (SoA)
+// ------------
+//
+// Bounding volumes stored structure-of-arrays, one array per component, so FrustumCuller can load 8 objects' worth of
+// one component with a single instruction. Objects are identified by their index.
+
+// Axis-aligned bounding boxes.
+class BoxBounds {
+public:
+    void Resize(uint32_t count);
+    void Clear();
+    void Set(uint32_t index, const glm::vec3& minimum, const glm::vec3& maximum);
+    uint32_t Add(const glm::vec3& minimum, const glm::vec3& maximum);
+
+    inline uint32_t GetCount() const
+    {
+        return static_cast<uint32_t>(m_MinimumX.size());
+    }
+
+    // Component arrays: 0, 1, 2 for x, y, z.
+    inline const float* GetMinimum(uint32_t axis) const
+    {
+        return axis == 0 ? m_MinimumX.data() : axis == 1 ? m_MinimumY.data() : m_MinimumZ.data();
+    }
+
+    inline const float* GetMaximum(uint32_t axis) const
+    {
+        return axis == 0 ? m_MaximumX.data() : axis == 1 ? m_MaximumY.data() : m_MaximumZ.data();
+    }
+
+private:
+    std::vector<float> m_MinimumX;
+    std::vector<float> m_MinimumY;
+    std::vector<float> m_MinimumZ;
+    std::vector<float> m_MaximumX;
+    std::vector<float> m_MaximumY;
+    std::vector<float> m_MaximumZ;
+};
+
+// Bounding spheres.
+class SphereBounds {
+public:
+    void Resize(uint32_t count);
+    void Clear();
+    void Set(uint32_t index, const glm::vec3& centre, float radius);
+    uint32_t Add(const glm::vec3& centre, float radius);
+
+    inline uint32_t GetCount() const
+    {
+        return static_cast<uint32_t>(m_Radius.size());
+    }
+
+    inline const float* GetCentre(uint32_t axis) const
+    {
+        return axis == 0 ? m_CentreX.data() : axis == 1 ? m_CentreY.data() : m_CentreZ.data();
+    }
+
+    inline const float* GetRadius() const
+    {
+        return m_Radius.data();
+    }
+
+private:
+    std::vector<float> m_CentreX;
+    std::vector<float> m_CentreY;
+    std::vector<float> m_CentreZ;
+    std::vector<float> m_Radius;
+};
+
+// --------------
+// Frustum Culler
+// --------------
+//
+// Tests bounding volumes against a Frustum and writes the indices of those that are at least partly inside, in
+// ascending order, to a compact list. Volumes are tested 8 at a time with AVX2 where the CPU has it, checked
+// once at runtime, and one at a time otherwise. Both paths give the same results.
+//
+// The test is conservative: a volume is only culled when it is entirely outside one plane, so a few volumes near the
+// frustum's corners are kept even though they are not visible.
+class FrustumCuller {
+public:
+    // Set to false to force the scalar path, e.g. to compare the two.
+    static inline bool simdEnabled = true;
+
+    static bool IsSimdSupported();
+
+    // visibleIndices must have room for bounds.GetCount() indices. Returns how many were written.
+    static uint32_t Cull(const Frustum& frustum, const BoxBounds& bounds, std::span<uint32_t> visibleIndices);
+    // Only tests boxes [first, first + count), for callers that know which ranges are worth testing, e.g. the leaves
+    // of a BoundingVolumeHierarchy. visibleIndices must have room for count indices.
+    static uint32_t Cull(const Frustum& frustum, const BoxBounds& bounds, uint32_t first, uint32_t count, std::span<uint32_t> visibleIndices);
+    static uint32_t Cull(const Frustum& frustum, const SphereBounds& bounds, std::span<uint32_t> visibleIndices);
+};
+}
@@ -0,0 +1,1152 @@
+#include "Importer.h"
+#include "JobSystem.h"
+#include "Json.h"
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+// -------
+// Helpers
+// -------
+
+constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+
+uint32_t ResolveThreadCount(const Oglre::ImportSettings& settings)
+{
+    const uint32_t jobThreadCount = Oglre::JobSystem::GetThreadCount();
+    if (settings.threadCount > 0) {
+        return std::min(settings.threadCount, jobThreadCount);
+    }
+    return jobThreadCount;
+}
+
+// Calls function(index) for every index in [0, count), spread over up to threadCount job system threads.
+template <typename Function>
+void ParallelFor(uint32_t count, uint32_t threadCount, const Function& function)
+{
+    const uint32_t workerCount = std::min(count, threadCount);
+    if (workerCount <= 1) {
+        for (uint32_t index = 0; index < count; ++index) {
+            function(index);
+        }
+        return;
+    }
+
+    // Work is handed out one index at a time, so uneven chunks do not leave threads idle.
+    std::atomic<uint32_t> next = 0;
+    const auto worker = [&]() {
+        for (uint32_t index = next++; index < count; index = next++) {
+            function(index);
+        }
+    };
+
+    Oglre::JobCounter counter;
+    for (uint32_t i = 1; i < workerCount; ++i) {
+        Oglre::JobSystem::Run(counter, worker);
+    }
+    worker();
+
+    Oglre::JobSystem::Wait(counter);
+}
+
+bool ReadFile(const std::string& path, std::vector<char>& data)
+{
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    if (!stream) {
+        std::cout << "Could not open " << path << std::endl;
+        return false;
+    }
+
+    data.resize(static_cast<size_t>(stream.tellg()));
+    stream.seekg(0);
+    stream.read(data.data(), static_cast<std::streamsize>(data.size()));
+
+    if (!stream) {
+        std::cout << "Could not read " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+uint32_t GetFloatsPerVertex(const Oglre::ImportSettings& settings)
+{
+    return settings.includeTexCoords ? 8 : 6;
+}
+
+void PrepareMesh(Oglre::ImportedMesh& mesh, const Oglre::ImportSettings& settings)
+{
+    mesh = Oglre::ImportedMesh();
+    mesh.layout.Push<float>(3);
+    mesh.layout.Push<float>(3);
+    if (settings.includeTexCoords) {
+        mesh.layout.Push<float>(2);
+    }
+}
+
+// Area-weighted smooth normals for the vertices flagged in needsNormal, which must have one entry per vertex.
+void GenerateNormals(Oglre::ImportedMesh& mesh, const std::vector<uint8_t>& needsNormal, uint32_t floatsPerVertex)
+{
+    if (std::find(needsNormal.begin(), needsNormal.end(), 1) == needsNormal.end()) {
+        return;
+    }
+
+    float* vertices = mesh.vertices.data();
+    const auto position = [&](uint32_t vertex) {
+        const float* p = vertices + size_t(vertex) * floatsPerVertex;
+        return glm::vec3(p[0], p[1], p[2]);
+    };
+
+    std::vector<glm::vec3> normals(needsNormal.size(), glm::vec3(0.0f));
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        const uint32_t a = mesh.indices[i];
+        const uint32_t b = mesh.indices[i + 1];
+        const uint32_t c = mesh.indices[i + 2];
+        const glm::vec3 faceNormal = glm::cross(position(b) - position(a), position(c) - position(a));
+
+        normals[a] += faceNormal;
+        normals[b] += faceNormal;
+        normals[c] += faceNormal;
+    }
+
+    for (size_t vertex = 0; vertex < needsNormal.size(); ++vertex) {
+        if (!needsNormal[vertex]) {
+            continue;
+        }
+
+        const float length = glm::length(normals[vertex]);
+        const glm::vec3 normal = length > 0.0f ? normals[vertex] / length : glm::vec3(0.0f, 1.0f, 0.0f);
+
+        float* n = vertices + vertex * floatsPerVertex + 3;
+        n[0] = normal.x;
+        n[1] = normal.y;
+        n[2] = normal.z;
+    }
+}
+
+void ComputeBounds(Oglre::ImportedMesh& mesh, uint32_t floatsPerVertex)
+{
+    glm::vec3 minimum(std::numeric_limits<float>::max());
+    glm::vec3 maximum(std::numeric_limits<float>::lowest());
+
+    for (size_t i = 0; i + 2 < mesh.vertices.size(); i += floatsPerVertex) {
+        const glm::vec3 position(mesh.vertices[i], mesh.vertices[i + 1], mesh.vertices[i + 2]);
+        minimum = glm::min(minimum, position);
+        maximum = glm::max(maximum, position);
+    }
+
+    if (mesh.vertices.empty()) {
+        minimum = maximum = glm::vec3(0.0f);
+    }
+
+    mesh.boundsMinimum = minimum;
+    mesh.boundsMaximum = maximum;
+}
+
+// ---
+// OBJ
+// ---
+
+// A face corner as written in the file. Indices are already 0-based, see ObjChunk::relativeMasks for negative ones.
+struct ObjCorner {
+    int32_t position;
+    int32_t texCoord;
+    int32_t normal;
+};
+
+// A face corner resolved to indices into the whole file's attribute arrays, invalidIndex if missing.
+struct ObjKey {
+    uint32_t position;
+    uint32_t texCoord;
+    uint32_t normal;
+
+    bool operator==(const ObjKey& other) const
+    {
+        return position == other.position && texCoord == other.texCoord && normal == other.normal;
+    }
+};
+
+struct ObjKeyHash {
+    size_t operator()(const ObjKey& key) const
+    {
+        uint64_t hash = key.position * 0x9E3779B97F4A7C15ull;
+        hash ^= (key.texCoord + 0x7F4A7C15ull) * 0xBF58476D1CE4E5B9ull;
+        hash ^= (key.normal + 0x1CE4E5B9ull) * 0x94D049BB133111EBull;
+        return static_cast<size_t>(hash ^ (hash >> 31));
+    }
+};
+
+struct ObjChunk {
+    std::string_view text;
+
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> texCoords;
+    std::vector<glm::vec3> normals;
+
+    // Triangulated face corners. Negative (relative) OBJ indices can only be resolved once the number of attributes in
+    // earlier chunks is known, so they are stored relative to the start of this chunk, with a bit set in relativeMasks.
+    std::vector<ObjCorner> corners;
+    std::vector<uint8_t> relativeMasks;
+
+    // Offsets of this chunk's attributes and corners in the whole file.
+    uint32_t positionOffset = 0;
+    uint32_t texCoordOffset = 0;
+    uint32_t normalOffset = 0;
+    uint64_t cornerOffset = 0;
+
+    // Corners deduplicated within the chunk. localIndices has one entry per corner, into uniqueKeys.
+    std::vector<ObjKey> uniqueKeys;
+    std::vector<uint32_t> uniqueHashes;
+    std::vector<uint32_t> localIndices;
+
+    // Index of each unique key within its bucket of the global deduplication.
+    std::vector<uint32_t> bucketIndices;
+
+    std::string error;
+    uint64_t errorLine = 0; // Counted from the start of the chunk, 0 if the error is not about a particular line.
+};
+
+const char* SkipSpaces(const char* position, const char* end)
+{
+    while (position < end && (*position == ' ' || *position == '\t')) {
+        ++position;
+    }
+    return position;
+}
+
+const char* ParseFloat(const char* position, const char* end, float& value)
+{
+    position = SkipSpaces(position, end);
+
+    // from_chars does not accept a leading '+'.
+    if (position < end && *position == '+') {
+        ++position;
+    }
+
+    const auto result = std::from_chars(position, end, value);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+// Parses one "v", "v/vt", "v//vn" or "v/vt/vn" corner.
+const char* ParseCorner(const char* position, const char* end, int32_t (&values)[3], uint8_t& relativeMask, const uint32_t (&counts)[3])
+{
+    values[0] = values[1] = values[2] = std::numeric_limits<int32_t>::min();
+
+    for (int component = 0; component < 3; ++component) {
+        if (component > 0) {
+            if (position >= end || *position != '/') {
+                break;
+            }
+            ++position;
+
+            // "v//vn" has no texture coordinate.
+            if (position < end && *position == '/') {
+                continue;
+            }
+        }
+
+        long index = 0;
+        const auto result = std::from_chars(position, end, index);
+        if (result.ec != std::errc() || index == 0) {
+            return nullptr;
+        }
+        position = result.ptr;
+
+        if (index > 0) {
+            values[component] = static_cast<int32_t>(index - 1);
+        } else {
+            values[component] = static_cast<int32_t>(static_cast<long>(counts[component]) + index);
+            relativeMask |= 1 << component;
+        }
+    }
+
+    return position;
+}
+
+void ParseObjChunk(ObjChunk& chunk)
+{
+    const char* position = chunk.text.data();
+    const char* const end = position + chunk.text.size();
+    uint64_t lineNumber = 1;
+
+    std::vector<ObjCorner> face;
+    std::vector<uint8_t> faceMasks;
+
+    while (position < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(position, '\n', end - position));
+        if (lineEnd == nullptr) {
+            lineEnd = end;
+        }
+        const char* contentEnd = lineEnd > position && lineEnd[-1] == '\r' ? lineEnd - 1 : lineEnd;
+
+        const char* cursor = SkipSpaces(position, contentEnd);
+        const size_t length = contentEnd - cursor;
+        bool isValid = true;
+
+        if (length > 2 && cursor[0] == 'v' && cursor[1] == ' ') {
+            glm::vec3 value(0.0f);
+            cursor += 2;
+            for (int i = 0; i < 3 && cursor != nullptr; ++i) {
+                cursor = ParseFloat(cursor, contentEnd, value[i]);
+            }
+            isValid = cursor != nullptr;
+            chunk.positions.push_back(value);
+        } else if (length > 3 && cursor[0] == 'v' && cursor[1] == 'n' && cursor[2] == ' ') {
+            glm::vec3 value(0.0f);
+            cursor += 3;
+            for (int i = 0; i < 3 && cursor != nullptr; ++i) {
+                cursor = ParseFloat(cursor, contentEnd, value[i]);
+            }
+            isValid = cursor != nullptr;
+            chunk.normals.push_back(value);
+        } else if (length > 3 && cursor[0] == 'v' && cursor[1] == 't' && cursor[2] == ' ') {
+            glm::vec2 value(0.0f);
+            cursor += 3;
+            for (int i = 0; i < 2 && cursor != nullptr; ++i) {
+                cursor = ParseFloat(cursor, contentEnd, value[i]);
+            }
+            isValid = cursor != nullptr;
+            chunk.texCoords.push_back(value);
+        } else if (length > 2 && cursor[0] == 'f' && cursor[1] == ' ') {
+            const uint32_t counts[3] = {
+                static_cast<uint32_t>(chunk.positions.size()),
+                static_cast<uint32_t>(chunk.texCoords.size()),
+                static_cast<uint32_t>(chunk.normals.size())
+            };
+
+            face.clear();
+            faceMasks.clear();
+            cursor = SkipSpaces(cursor + 2, contentEnd);
+            while (cursor != nullptr && cursor < contentEnd) {
+                int32_t values[3];
+                uint8_t relativeMask = 0;
+                cursor = ParseCorner(cursor, contentEnd, values, relativeMask, counts);
+                if (cursor != nullptr) {
+                    face.push_back({ values[0], values[1], values[2] });
+                    faceMasks.push_back(relativeMask);
+                    cursor = SkipSpaces(cursor, contentEnd);
+                }
+            }
+            isValid = cursor != nullptr && face.size() >= 3;
+
+            // Fan triangulation, fine for the convex polygons OBJ exporters write.
+            for (size_t i = 2; isValid && i < face.size(); ++i) {
+                for (const size_t corner : { size_t(0), i - 1, i }) {
+                    chunk.corners.push_back(face[corner]);
+                    chunk.relativeMasks.push_back(faceMasks[corner]);
+                }
+            }
+        }
+
+        if (!isValid) {
+            chunk.error = "could not parse \"" + std::string(position, contentEnd) + "\"";
+            chunk.errorLine = lineNumber;
+            return;
+        }
+
+        position = lineEnd + 1;
+        ++lineNumber;
+    }
+}
+
+// Turns the chunk's corners into keys into the whole file's attributes, and deduplicates them within the chunk.
+void ResolveObjChunk(ObjChunk& chunk, uint32_t positionCount, uint32_t texCoordCount, uint32_t normalCount)
+{
+    const uint32_t offsets[3] = { chunk.positionOffset, chunk.texCoordOffset, chunk.normalOffset };
+    const uint32_t counts[3] = { positionCount, texCoordCount, normalCount };
+
+    std::unordered_map<ObjKey, uint32_t, ObjKeyHash> uniqueIndices;
+    uniqueIndices.reserve(chunk.corners.size() / 4);
+    chunk.localIndices.resize(chunk.corners.size());
+
+    for (size_t i = 0; i < chunk.corners.size(); ++i) {
+        const int32_t values[3] = { chunk.corners[i].position, chunk.corners[i].texCoord, chunk.corners[i].normal };
+        uint32_t resolved[3];
+
+        for (int component = 0; component < 3; ++component) {
+            if (values[component] == std::numeric_limits<int32_t>::min()) {
+                resolved[component] = invalidIndex;
+                continue;
+            }
+
+            const int64_t index = (chunk.relativeMasks[i] & (1 << component)) ? int64_t(offsets[component]) + values[component] : values[component];
+            if (index < 0 || index >= counts[component]) {
+                chunk.error = "face refers to a vertex attribute that does not exist";
+                return;
+            }
+            resolved[component] = static_cast<uint32_t>(index);
+        }
+
+        // A position is required, other attributes are optional.
+        if (resolved[0] == invalidIndex) {
+            chunk.error = "face corner without a position";
+            return;
+        }
+
+        const ObjKey key = { resolved[0], resolved[1], resolved[2] };
+        const auto [it, inserted] = uniqueIndices.try_emplace(key, static_cast<uint32_t>(chunk.uniqueKeys.size()));
+        if (inserted) {
+            chunk.uniqueKeys.push_back(key);
+            chunk.uniqueHashes.push_back(static_cast<uint32_t>(ObjKeyHash()(key) >> 7));
+        }
+        chunk.localIndices[i] = it->second;
+    }
+
+    // The raw corners are no longer needed, release them to keep peak memory down.
+    chunk.corners = std::vector<ObjCorner>();
+    chunk.relativeMasks = std::vector<uint8_t>();
+}
+
+// ----
+// glTF
+// ----
+
+constexpr uint32_t gltfModeTriangles = 4;
+
+struct GltfPrimitiveJob {
+    const Oglre::JsonValue* primitive;
+    glm::mat4 transform;
+
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    uint32_t firstVertex = 0;
+    uint64_t firstIndex = 0;
+};
+
+struct GltfDocument {
+    Oglre::JsonValue json;
+    std::vector<std::vector<char>> buffers;
+};
+
+// Every integer a double holds exactly, the most an index, count or byte size may be.
+constexpr uint64_t gltfIntegerMaximum = uint64_t(1) << 53;
+
+// An absent index. Looking it up in a JSON array gives a null value, as for any index past the end.
+constexpr uint64_t gltfNoIndex = std::numeric_limits<uint64_t>::max();
+
+// Reads an index, count or byte size, or defaultValue if value is absent. Returns false if value is not a whole number
+// in [0, maximum]: converting a negative, fractional or out of range double to an unsigned integer is undefined.
+bool ReadGltfInteger(const Oglre::JsonValue& value, uint64_t defaultValue, uint64_t& result, uint64_t maximum = gltfIntegerMaximum)
+{
+    if (value.IsNull()) {
+        result = defaultValue;
+        return true;
+    }
+
+    const double number = value.AsNumber(-1.0);
+    if (value.GetType() != Oglre::JsonValue::Type::NUMBER || !std::isfinite(number) || number < 0.0 || number > static_cast<double>(maximum)
+        || std::floor(number) != number) {
+        return false;
+    }
+
+    result = static_cast<uint64_t>(number);
+    return true;
+}
+
+bool ReadGltfInteger(const Oglre::JsonValue& value, uint32_t defaultValue, uint32_t& result)
+{
+    uint64_t wideResult = 0;
+    if (!ReadGltfInteger(value, defaultValue, wideResult, std::numeric_limits<uint32_t>::max())) {
+        return false;
+    }
+
+    result = static_cast<uint32_t>(wideResult);
+    return true;
+}
+
+// Adds mesh's triangle list primitives to jobs. Returns false if a primitive's mode is not a valid number.
+bool CollectGltfMesh(const Oglre::JsonValue& mesh, const glm::mat4& transform, std::vector<GltfPrimitiveJob>& jobs)
+{
+    const Oglre::JsonValue& primitives = mesh["primitives"];
+    for (size_t i = 0; i < primitives.Size(); ++i) {
+        uint32_t mode = 0;
+        if (!ReadGltfInteger(primitives[i]["mode"], gltfModeTriangles, mode)) {
+            return false;
+        }
+        if (mode == gltfModeTriangles) {
+            jobs.push_back({ &primitives[i], transform });
+        }
+    }
+
+    return true;
+}
+
+uint32_t GetComponentSize(uint32_t componentType)
+{
+    // clang-format off
+    switch (componentType)
+    {
+        case 5120: case 5121: return 1; // BYTE, UNSIGNED_BYTE
+        case 5122: case 5123: return 2; // SHORT, UNSIGNED_SHORT
+        case 5125: case 5126: return 4; // UNSIGNED_INT, FLOAT
+    }
+    // clang-format on
+    return 0;
+}
+
+uint32_t GetComponentCount(const std::string& type)
+{
+    // clang-format off
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2")   return 2;
+    if (type == "VEC3")   return 3;
+    if (type == "VEC4")   return 4;
+    // clang-format on
+    return 0;
+}
+
+// Where an accessor's elements are, after checking that all of them are inside their buffer.
+struct GltfAccessorView {
+    const char* data = nullptr;
+    uint32_t count = 0;
+    uint32_t stride = 0;
+    uint32_t componentType = 0;
+    uint32_t componentCount = 0;
+    bool normalized = false;
+};
+
+// componentCount is the number of components the caller reads from each element, which the accessor's type must have.
+bool GetAccessorView(const GltfDocument& document, const Oglre::JsonValue& accessorIndex, uint32_t componentCount, GltfAccessorView& view, std::string& error)
+{
+    uint64_t index = 0;
+    if (!ReadGltfInteger(accessorIndex, gltfNoIndex, index)) {
+        error = "invalid accessor index";
+        return false;
+    }
+
+    const Oglre::JsonValue& accessor = document.json["accessors"][index];
+    if (accessor.IsNull() || !accessor["sparse"].IsNull()) {
+        error = "missing or sparse accessor";
+        return false;
+    }
+
+    uint64_t bufferViewIndex = 0;
+    uint64_t bufferIndex = 0;
+    if (!ReadGltfInteger(accessor["bufferView"], gltfNoIndex, bufferViewIndex)) {
+        error = "invalid buffer view index";
+        return false;
+    }
+    const Oglre::JsonValue& bufferView = document.json["bufferViews"][bufferViewIndex];
+    if (bufferView.IsNull() || !ReadGltfInteger(bufferView["buffer"], gltfNoIndex, bufferIndex) || bufferIndex >= document.buffers.size()) {
+        error = "accessor without a buffer view";
+        return false;
+    }
+
+    if (!ReadGltfInteger(accessor["componentType"], 0u, view.componentType) || !ReadGltfInteger(accessor["count"], 0u, view.count)) {
+        error = "invalid accessor component type or count";
+        return false;
+    }
+    view.componentCount = GetComponentCount(accessor["type"].AsString());
+    view.normalized = accessor["normalized"].AsBoolean();
+
+    const uint32_t elementSize = GetComponentSize(view.componentType) * view.componentCount;
+    if (elementSize == 0) {
+        error = "unsupported accessor type";
+        return false;
+    }
+    if (view.componentCount != componentCount) {
+        error = "accessor type does not match its attribute";
+        return false;
+    }
+
+    uint64_t viewOffset = 0;
+    uint64_t viewLength = 0;
+    uint64_t accessorOffset = 0;
+    if (!ReadGltfInteger(bufferView["byteStride"], elementSize, view.stride) || !ReadGltfInteger(bufferView["byteOffset"], 0, viewOffset)
+        || !ReadGltfInteger(bufferView["byteLength"], 0, viewLength) || !ReadGltfInteger(accessor["byteOffset"], 0, accessorOffset)) {
+        error = "invalid buffer view or accessor layout";
+        return false;
+    }
+
+    const uint64_t offset = viewOffset + accessorOffset;
+    const uint64_t viewEnd = viewOffset + viewLength;
+    const uint64_t end = view.count == 0 ? offset : offset + uint64_t(view.count - 1) * view.stride + elementSize;
+    if (end > viewEnd || viewEnd > document.buffers[bufferIndex].size()) {
+        error = "accessor is outside its buffer";
+        return false;
+    }
+
+    view.data = document.buffers[bufferIndex].data() + offset;
+    return true;
+}
+
+// Reads a component as a float, applying the normalization rules of the glTF specification.
+float ReadComponent(const GltfAccessorView& view, uint32_t element, uint32_t component)
+{
+    const char* data = view.data + size_t(element) * view.stride + component * GetComponentSize(view.componentType);
+
+    // clang-format off
+    switch (view.componentType)
+    {
+        case 5126: { float v; std::memcpy(&v, data, 4); return v; }
+        case 5121: { uint8_t v; std::memcpy(&v, data, 1); return view.normalized ? v / 255.0f : v; }
+        case 5123: { uint16_t v; std::memcpy(&v, data, 2); return view.normalized ? v / 65535.0f : v; }
+        case 5120: { int8_t v; std::memcpy(&v, data, 1); return view.normalized ? std::max(v / 127.0f, -1.0f) : v; }
+        case 5122: { int16_t v; std::memcpy(&v, data, 2); return view.normalized ? std::max(v / 32767.0f, -1.0f) : v; }
+        case 5125: { uint32_t v; std::memcpy(&v, data, 4); return static_cast<float>(v); }
+    }
+    // clang-format on
+    return 0.0f;
+}
+
+uint32_t ReadIndex(const GltfAccessorView& view, uint32_t element)
+{
+    const char* data = view.data + size_t(element) * view.stride;
+
+    // clang-format off
+    switch (view.componentType)
+    {
+        case 5121: { uint8_t v; std::memcpy(&v, data, 1); return v; }
+        case 5123: { uint16_t v; std::memcpy(&v, data, 2); return v; }
+        case 5125: { uint32_t v; std::memcpy(&v, data, 4); return v; }
+    }
+    // clang-format on
+    return invalidIndex;
+}
+
+bool DecodeBase64(std::string_view text, std::vector<char>& data)
+{
+    const auto decode = [](char c) -> int {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+') return 62;
+        if (c == '/') return 63;
+        return -1;
+    };
+
+    data.clear();
+    data.reserve(text.size() / 4 * 3);
+
+    uint32_t bits = 0;
+    int bitCount = 0;
+    for (const char c : text) {
+        if (c == '=') {
+            break;
+        }
+
+        const int value = decode(c);
+        if (value < 0) {
+            return false;
+        }
+
+        bits = (bits << 6) | static_cast<uint32_t>(value);
+        bitCount += 6;
+        if (bitCount >= 8) {
+            bitCount -= 8;
+            data.push_back(static_cast<char>((bits >> bitCount) & 0xFF));
+        }
+    }
+
+    return true;
+}
+
+bool LoadGltfBuffers(const std::string& path, GltfDocument& document, std::vector<char>* glbBuffer, uint64_t& bytesRead)
+{
+    const std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+    const Oglre::JsonValue& buffers = document.json["buffers"];
+    document.buffers.resize(buffers.Size());
+
+    for (size_t i = 0; i < buffers.Size(); ++i) {
+        const std::string& uri = buffers[i]["uri"].AsString();
+
+        if (uri.empty()) {
+            // A buffer without a URI is the GLB's binary chunk.
+            if (glbBuffer == nullptr || i != 0) {
+                std::cout << path << ": buffer " << i << " has no data" << std::endl;
+                return false;
+            }
+            document.buffers[i] = std::move(*glbBuffer);
+        } else if (uri.rfind("data:", 0) == 0) {
+            const size_t dataStart = uri.find(";base64,");
+            if (dataStart == std::string::npos || !DecodeBase64(std::string_view(uri).substr(dataStart + 8), document.buffers[i])) {
+                std::cout << path << ": buffer " << i << " has an unsupported data URI" << std::endl;
+                return false;
+            }
+        } else {
+            if (!ReadFile(directory + uri, document.buffers[i])) {
+                return false;
+            }
+            bytesRead += document.buffers[i].size();
+        }
+    }
+
+    return true;
+}
+
+glm::mat4 GetNodeTransform(const Oglre::JsonValue& node)
+{
+    const Oglre::JsonValue& matrix = node["matrix"];
+    if (matrix.Size() == 16) {
+        glm::mat4 transform(1.0f);
+        for (int column = 0; column < 4; ++column) {
+            for (int row = 0; row < 4; ++row) {
+                transform[column][row] = static_cast<float>(matrix[column * 4 + row].AsNumber());
+            }
+        }
+        return transform;
+    }
+
+    const Oglre::JsonValue& translation = node["translation"];
+    const Oglre::JsonValue& rotation = node["rotation"];
+    const Oglre::JsonValue& scale = node["scale"];
+
+    glm::mat4 transform(1.0f);
+    if (translation.Size() == 3) {
+        transform = glm::translate(transform, glm::vec3(translation[0].AsNumber(), translation[1].AsNumber(), translation[2].AsNumber()));
+    }
+    if (rotation.Size() == 4) {
+        // glTF stores quaternions as (x, y, z, w).
+        const glm::quat orientation(static_cast<float>(rotation[3].AsNumber(1.0)), static_cast<float>(rotation[0].AsNumber()), static_cast<float>(rotation[1].AsNumber()), static_cast<float>(rotation[2].AsNumber()));
+        transform = transform * glm::mat4_cast(orientation);
+    }
+    if (scale.Size() == 3) {
+        transform = glm::scale(transform, glm::vec3(scale[0].AsNumber(1.0), scale[1].AsNumber(1.0), scale[2].AsNumber(1.0)));
+    }
+    return transform;
+}
+
+// Returns false if an index or mode below the node is not a valid number.
+bool CollectGltfNode(const Oglre::JsonValue& nodes, const Oglre::JsonValue& meshes, const Oglre::JsonValue& nodeIndex, const glm::mat4& parentTransform, uint32_t depth,
+    std::vector<GltfPrimitiveJob>& jobs)
+{
+    uint64_t index = 0;
+    if (!ReadGltfInteger(nodeIndex, gltfNoIndex, index)) {
+        return false;
+    }
+
+    // glTF forbids cycles, but a broken file should not hang the importer.
+    constexpr uint32_t maxDepth = 128;
+    const Oglre::JsonValue& node = nodes[index];
+    if (node.IsNull() || depth > maxDepth) {
+        return true;
+    }
+
+    const glm::mat4 transform = parentTransform * GetNodeTransform(node);
+
+    uint64_t meshIndex = 0;
+    if (!ReadGltfInteger(node["mesh"], gltfNoIndex, meshIndex) || !CollectGltfMesh(meshes[meshIndex], transform, jobs)) {
+        return false;
+    }
+
+    const Oglre::JsonValue& children = node["children"];
+    for (size_t i = 0; i < children.Size(); ++i) {
+        if (!CollectGltfNode(nodes, meshes, children[i], transform, depth + 1, jobs)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+}
+
+// ------
+// Import
+// ------
+
+bool Oglre::Importer::Import(const std::string& path, ImportedMesh& mesh, const ImportSettings& settings, ImportStatistics* statistics)
+{
+    ImportStatistics localStatistics;
+    ImportStatistics& stats = statistics != nullptr ? *statistics : localStatistics;
+    stats = ImportStatistics();
+
+    const auto startTime = std::chrono::steady_clock::now();
+
+    std::string extension = path.substr(path.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    bool success = false;
+    if (extension == "obj") {
+        success = ImportObj(path, mesh, settings, stats);
+    } else if (extension == "gltf" || extension == "glb") {
+        success = ImportGltf(path, mesh, settings, stats);
+    } else {
+        std::cout << "Unsupported mesh format: " << path << std::endl;
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    stats.vertexCount = mesh.GetVertexCount();
+    return success;
+}
+
+bool Oglre::Importer::ImportObj(const std::string& path, ImportedMesh& mesh, const ImportSettings& settings, ImportStatistics& statistics)
+{
+    PrepareMesh(mesh, settings);
+
+    std::vector<char> file;
+    if (!ReadFile(path, file)) {
+        return false;
+    }
+    statistics.bytesRead = file.size();
+
+    const uint32_t threadCount = ResolveThreadCount(settings);
+    statistics.threadCount = threadCount;
+
+    // Split into chunks at line boundaries. A few chunks per thread balances uneven chunks, e.g. all "v" then all "f".
+    constexpr size_t minimumChunkSize = 1 << 20;
+    const size_t chunkCount = std::clamp<size_t>(file.size() / minimumChunkSize, 1, threadCount * 4);
+    std::vector<ObjChunk> chunks;
+    chunks.reserve(chunkCount);
+
+    size_t chunkStart = 0;
+    for (size_t i = 0; i < chunkCount && chunkStart < file.size(); ++i) {
+        size_t chunkEnd = i + 1 == chunkCount ? file.size() : std::max(chunkStart, file.size() * (i + 1) / chunkCount);
+        while (chunkEnd < file.size() && file[chunkEnd - 1] != '\n') {
+            ++chunkEnd;
+        }
+
+        chunks.emplace_back();
+        chunks.back().text = std::string_view(file.data() + chunkStart, chunkEnd - chunkStart);
+        chunkStart = chunkEnd;
+    }
+
+    const uint32_t chunkTotal = static_cast<uint32_t>(chunks.size());
+    ParallelFor(chunkTotal, threadCount, [&](uint32_t i) { ParseObjChunk(chunks[i]); });
+
+    // Prefix sums give each chunk its offset into the whole file's attributes and corners.
+    uint64_t positionCount = 0;
+    uint64_t texCoordCount = 0;
+    uint64_t normalCount = 0;
+    uint64_t cornerCount = 0;
+    for (ObjChunk& chunk : chunks) {
+        if (!chunk.error.empty()) {
+            // Line numbers are only needed for errors, so the lines before the chunk are only counted then.
+            const uint64_t line = std::count(static_cast<const char*>(file.data()), chunk.text.data(), '\n') + chunk.errorLine;
+            std::cout << path << ":" << line << ": " << chunk.error << std::endl;
+            return false;
+        }
+
+        chunk.positionOffset = static_cast<uint32_t>(positionCount);
+        chunk.texCoordOffset = static_cast<uint32_t>(texCoordCount);
+        chunk.normalOffset = static_cast<uint32_t>(normalCount);
+        chunk.cornerOffset = cornerCount;
+
+        positionCount += chunk.positions.size();
+        texCoordCount += chunk.texCoords.size();
+        normalCount += chunk.normals.size();
+        cornerCount += chunk.corners.size();
+    }
+
+    if (positionCount >= invalidIndex || cornerCount >= invalidIndex) {
+        std::cout << path << ": too large, meshes are limited to 2^32 - 1 vertices and indices" << std::endl;
+        return false;
+    }
+    statistics.cornerCount = cornerCount;
+
+    ParallelFor(chunkTotal, threadCount, [&](uint32_t i) {
+        ResolveObjChunk(chunks[i], static_cast<uint32_t>(positionCount), static_cast<uint32_t>(texCoordCount), static_cast<uint32_t>(normalCount));
+    });
+
+    for (const ObjChunk& chunk : chunks) {
+        if (!chunk.error.empty()) {
+            std::cout << path << ": " << chunk.error << std::endl;
+            return false;
+        }
+    }
+
+    // Deduplicate across chunks. Keys are partitioned into buckets by hash, so each bucket is deduplicated by exactly one
+    // thread without locking, and each bucket's vertices end up contiguous in the output.
+    const uint32_t bucketCount = threadCount;
+    std::vector<std::vector<ObjKey>> bucketKeys(bucketCount);
+
+    for (ObjChunk& chunk : chunks) {
+        chunk.bucketIndices.resize(chunk.uniqueKeys.size());
+    }
+
+    ParallelFor(bucketCount, threadCount, [&](uint32_t bucket) {
+        std::unordered_map<ObjKey, uint32_t, ObjKeyHash> bucketIndices;
+        std::vector<ObjKey>& keys = bucketKeys[bucket];
+
+        for (ObjChunk& chunk : chunks) {
+            for (size_t i = 0; i < chunk.uniqueKeys.size(); ++i) {
+                if (chunk.uniqueHashes[i] % bucketCount != bucket) {
+                    continue;
+                }
+
+                const auto [it, inserted] = bucketIndices.try_emplace(chunk.uniqueKeys[i], static_cast<uint32_t>(keys.size()));
+                if (inserted) {
+                    keys.push_back(chunk.uniqueKeys[i]);
+                }
+                chunk.bucketIndices[i] = it->second;
+            }
+        }
+    });
+
+    std::vector<uint32_t> bucketOffsets(bucketCount);
+    uint64_t vertexCount = 0;
+    for (uint32_t bucket = 0; bucket < bucketCount; ++bucket) {
+        bucketOffsets[bucket] = static_cast<uint32_t>(vertexCount);
+        vertexCount += bucketKeys[bucket].size();
+    }
+
+    // Gather the attribute arrays, so vertices can be written by global attribute index.
+    std::vector<glm::vec3> positions(positionCount);
+    std::vector<glm::vec2> texCoords(texCoordCount);
+    std::vector<glm::vec3> normals(normalCount);
+    ParallelFor(chunkTotal, threadCount, [&](uint32_t i) {
+        ObjChunk& chunk = chunks[i];
+        std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.positionOffset);
+        std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), texCoords.begin() + chunk.texCoordOffset);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normalOffset);
+
+        chunk.positions = std::vector<glm::vec3>();
+        chunk.texCoords = std::vector<glm::vec2>();
+        chunk.normals = std::vector<glm::vec3>();
+    });
+
+    const uint32_t floatsPerVertex = GetFloatsPerVertex(settings);
+    mesh.vertices.resize(vertexCount * floatsPerVertex);
+    mesh.indices.resize(cornerCount);
+    std::vector<uint8_t> needsNormal(vertexCount, 0);
+
+    ParallelFor(bucketCount, threadCount, [&](uint32_t bucket) {
+        const std::vector<ObjKey>& keys = bucketKeys[bucket];
+        for (size_t i = 0; i < keys.size(); ++i) {
+            const ObjKey& key = keys[i];
+            const size_t vertex = bucketOffsets[bucket] + i;
+            float* output = mesh.vertices.data() + vertex * floatsPerVertex;
+
+            const glm::vec3& position = positions[key.position];
+            const glm::vec3 normal = key.normal != invalidIndex ? normals[key.normal] : glm::vec3(0.0f);
+            output[0] = position.x;
+            output[1] = position.y;
+            output[2] = position.z;
+            output[3] = normal.x;
+            output[4] = normal.y;
+            output[5] = normal.z;
+
+            if (settings.includeTexCoords) {
+                const glm::vec2 texCoord = key.texCoord != invalidIndex ? texCoords[key.texCoord] : glm::vec2(0.0f);
+                output[6] = texCoord.x;
+                output[7] = texCoord.y;
+            }
+
+            needsNormal[vertex] = key.normal == invalidIndex;
+        }
+    });
+
+    ParallelFor(chunkTotal, threadCount, [&](uint32_t i) {
+        const ObjChunk& chunk = chunks[i];
+        uint32_t* output = mesh.indices.data() + chunk.cornerOffset;
+        for (size_t corner = 0; corner < chunk.localIndices.size(); ++corner) {
+            const uint32_t unique = chunk.localIndices[corner];
+            output[corner] = bucketOffsets[chunk.uniqueHashes[unique] % bucketCount] + chunk.bucketIndices[unique];
+        }
+    });
+
+    GenerateNormals(mesh, needsNormal, floatsPerVertex);
+    ComputeBounds(mesh, floatsPerVertex);
+    return true;
+}
+
+bool Oglre::Importer::ImportGltf(const std::string& path, ImportedMesh& mesh, const ImportSettings& settings, ImportStatistics& statistics)
+{
+    PrepareMesh(mesh, settings);
+
+    std::vector<char> file;
+    if (!ReadFile(path, file)) {
+        return false;
+    }
+    statistics.bytesRead = file.size();
+
+    const uint32_t threadCount = ResolveThreadCount(settings);
+    statistics.threadCount = threadCount;
+
+    // A .glb is a 12 byte header followed by a JSON chunk and an optional binary chunk.
+    std::string_view jsonText(file.data(), file.size());
+    std::vector<char> glbBuffer;
+    bool isGlb = file.size() >= 12 && std::memcmp(file.data(), "glTF", 4) == 0;
+    if (isGlb) {
+        const auto readUint32 = [&file](size_t offset) {
+            uint32_t value = 0;
+            if (offset + 4 <= file.size()) {
+                std::memcpy(&value, file.data() + offset, 4);
+            }
+            return value;
+        };
+
+        constexpr uint32_t jsonChunkType = 0x4E4F534A;
+        constexpr uint32_t binaryChunkType = 0x004E4942;
+
+        const uint32_t jsonLength = readUint32(12);
+        if (readUint32(4) != 2 || readUint32(16) != jsonChunkType || 20 + uint64_t(jsonLength) > file.size()) {
+            std::cout << path << ": unsupported or corrupt GLB header" << std::endl;
+            return false;
+        }
+        jsonText = std::string_view(file.data() + 20, jsonLength);
+
+        const size_t binaryOffset = 20 + ((jsonLength + 3) & ~3u);
+        const uint32_t binaryLength = readUint32(binaryOffset);
+        if (readUint32(binaryOffset + 4) == binaryChunkType && binaryOffset + 8 + uint64_t(binaryLength) <= file.size()) {
+            glbBuffer.assign(file.data() + binaryOffset + 8, file.data() + binaryOffset + 8 + binaryLength);
+        }
+    }
+
+    GltfDocument document;
+    std::string error;
+    document.json = JsonValue::Parse(jsonText, error);
+    if (!error.empty()) {
+        std::cout << path << ": " << error << std::endl;
+        return false;
+    }
+
+    if (!LoadGltfBuffers(path, document, isGlb ? &glbBuffer : nullptr, statistics.bytesRead)) {
+        return false;
+    }
+
+    // Walk the default scene, or every mesh untransformed if the file has no scenes.
+    std::vector<GltfPrimitiveJob> jobs;
+    const JsonValue& nodes = document.json["nodes"];
+    const JsonValue& meshes = document.json["meshes"];
+    uint64_t sceneIndex = 0;
+    bool isSceneValid = ReadGltfInteger(document.json["scene"], 0, sceneIndex);
+    const JsonValue& scene = document.json["scenes"][sceneIndex];
+    if (!scene.IsNull()) {
+        const JsonValue& rootNodes = scene["nodes"];
+        for (size_t i = 0; i < rootNodes.Size() && isSceneValid; ++i) {
+            isSceneValid = CollectGltfNode(nodes, meshes, rootNodes[i], glm::mat4(1.0f), 0, jobs);
+        }
+    } else {
+        for (size_t i = 0; i < meshes.Size() && isSceneValid; ++i) {
+            isSceneValid = CollectGltfMesh(meshes[i], glm::mat4(1.0f), jobs);
+        }
+    }
+
+    if (!isSceneValid) {
+        std::cout << path << ": invalid scene, node, mesh or primitive mode" << std::endl;
+        return false;
+    }
+
+    // Sizes come from the accessors, so every primitive's place in the output is known before any is converted.
+    uint64_t vertexCount = 0;
+    uint64_t indexCount = 0;
+    for (GltfPrimitiveJob& job : jobs) {
+        GltfAccessorView positions;
+        if (!GetAccessorView(document, (*job.primitive)["attributes"]["POSITION"], 3, positions, error)) {
+            std::cout << path << ": primitive without positions, " << error << std::endl;
+            return false;
+        }
+
+        job.vertexCount = positions.count;
+        const JsonValue& indices = (*job.primitive)["indices"];
+        if (indices.IsNull()) {
+            job.indexCount = positions.count;
+        } else {
+            GltfAccessorView indexView;
+            if (!GetAccessorView(document, indices, 1, indexView, error)) {
+                std::cout << path << ": " << error << std::endl;
+                return false;
+            }
+            job.indexCount = indexView.count;
+        }
+
+        job.firstVertex = static_cast<uint32_t>(vertexCount);
+        job.firstIndex = indexCount;
+        vertexCount += job.vertexCount;
+        indexCount += job.indexCount - job.indexCount % 3;
+    }
+
+    if (vertexCount >= invalidIndex) {
+        std::cout << path << ": too large, meshes are limited to 2^32 - 1 vertices" << std::endl;
+        return false;
+    }
+
+    const uint32_t floatsPerVertex = GetFloatsPerVertex(settings);
+    mesh.vertices.resize(vertexCount * floatsPerVertex);
+    mesh.indices.resize(indexCount);
+    std::vector<uint8_t> needsNormal(vertexCount, 0);
+
+    std::mutex errorMutex;
+    ParallelFor(static_cast<uint32_t>(jobs.size()), threadCount, [&](uint32_t jobIndex) {
+        const GltfPrimitiveJob& job = jobs[jobIndex];
+        const JsonValue& attributes = (*job.primitive)["attributes"];
+        std::string jobError;
+
+        GltfAccessorView positions;
+        GltfAccessorView normals;
+        GltfAccessorView texCoords;
+        GltfAccessorView indices;
+        GetAccessorView(document, attributes["POSITION"], 3, positions, jobError);
+        const bool hasNormals = !attributes["NORMAL"].IsNull() && GetAccessorView(document, attributes["NORMAL"], 3, normals, jobError) && normals.count >= job.vertexCount;
+        const bool hasTexCoords = settings.includeTexCoords && !attributes["TEXCOORD_0"].IsNull() && GetAccessorView(document, attributes["TEXCOORD_0"], 2, texCoords, jobError) && texCoords.count >= job.vertexCount;
+        const bool hasIndices = !(*job.primitive)["indices"].IsNull() && GetAccessorView(document, (*job.primitive)["indices"], 1, indices, jobError);
+
+        // Normals transform by the inverse transpose, so non-uniform scales keep them perpendicular.
+        const glm::mat4 normalTransform = glm::transpose(glm::inverse(job.transform));
+
+        for (uint32_t i = 0; i < job.vertexCount; ++i) {
+            const size_t vertex = size_t(job.firstVertex) + i;
+            float* output = mesh.vertices.data() + vertex * floatsPerVertex;
+
+            const glm::vec4 position = job.transform * glm::vec4(ReadComponent(positions, i, 0), ReadComponent(positions, i, 1), ReadComponent(positions, i, 2), 1.0f);
+            output[0] = position.x;
+            output[1] = position.y;
+            output[2] = position.z;
+
+            if (hasNormals) {
+                const glm::vec4 transformed = normalTransform * glm::vec4(ReadComponent(normals, i, 0), ReadComponent(normals, i, 1), ReadComponent(normals, i, 2), 0.0f);
+                const glm::vec3 normal(transformed);
+                const float length = glm::length(normal);
+                const glm::vec3 unitNormal = length > 0.0f ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+                output[3] = unitNormal.x;
+                output[4] = unitNormal.y;
+                output[5] = unitNormal.z;
+            } else {
+                needsNormal[vertex] = 1;
+            }
+
+            if (settings.includeTexCoords) {
+                output[6] = hasTexCoords ? ReadComponent(texCoords, i, 0) : 0.0f;
+                output[7] = hasTexCoords ? ReadComponent(texCoords, i, 1) : 0.0f;
+            }
+        }
+
+        // A mirroring transform turns the triangles inside out, so their winding is flipped back.
+        const glm::vec3 x(job.transform[0]);
+        const glm::vec3 y(job.transform[1]);
+        const glm::vec3 z(job.transform[2]);
+        const bool flipWinding = glm::dot(glm::cross(x, y), z) < 0.0f;
+
+        const uint32_t triangleIndexCount = job.indexCount - job.indexCount % 3;
+        uint32_t* output = mesh.indices.data() + job.firstIndex;
+        for (uint32_t i = 0; i < triangleIndexCount; ++i) {
+            const uint32_t source = flipWinding && i % 3 != 0 ? (i % 3 == 1 ? i + 1 : i - 1) : i;
+            const uint32_t index = hasIndices ? ReadIndex(indices, source) : source;
+
+            if (index >= job.vertexCount) {
+                jobError = "index out of range";
+                output[i] = job.firstVertex;
+                continue;
+            }
+            output[i] = job.firstVertex + index;
+        }
+
+        if (!jobError.empty()) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            error = jobError;
+        }
+    });
+
+    if (!error.empty()) {
+        std::cout << path << ": " << error << std::endl;
+        return false;
+    }
+
+    GenerateNormals(mesh, needsNormal, floatsPerVertex);
+    ComputeBounds(mesh, floatsPerVertex);
+    return true;
+}
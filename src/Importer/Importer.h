@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "VertexBufferLayout.h"
+
+namespace Oglre {
+
+struct ImportSettings {
+    // Job system threads used for parsing and vertex deduplication, 0 to use all of them.
+    uint32_t threadCount = 0;
+
+    // Adds a 2 float texture coordinate attribute after the normal. Missing coordinates are imported as (0, 0).
+    bool includeTexCoords = false;
+};
+
+// Interleaved, indexed triangle data ready to be uploaded to a VertexBuffer and IndexBuffer.
+// The layout is | position: 3 floats | normal: 3 floats | (texture coordinate: 2 floats) |. All of a file's meshes are
+// merged into one, with glTF node transforms applied. Normals missing from the file are generated.
+struct ImportedMesh {
+    VertexBufferLayout layout;
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+
+    glm::vec3 boundsMinimum = glm::vec3(0.0f);
+    glm::vec3 boundsMaximum = glm::vec3(0.0f);
+
+    inline uint32_t GetVertexCount() const
+    {
+        return layout.GetStride() == 0 ? 0 : static_cast<uint32_t>(vertices.size() * sizeof(float) / layout.GetStride());
+    }
+};
+
+// Throughput figures for the last import.
+struct ImportStatistics {
+    uint64_t bytesRead = 0; // Size of the source file(s), including external glTF buffers.
+    double seconds = 0.0;
+    uint32_t threadCount = 0;
+
+    // Vertices referenced by faces before deduplication (OBJ only), and unique vertices after.
+    uint64_t cornerCount = 0;
+    uint64_t vertexCount = 0;
+};
+
+// Imports Wavefront OBJ (.obj) and glTF 2.0 (.gltf, .glb) files.
+// OBJ files are split into chunks at line boundaries, which are parsed and deduplicated on worker threads.
+// glTF primitives are converted on worker threads. Errors are reported to std::cout.
+class Importer {
+public:
+    // Picks the format from the file extension. Returns false if the file could not be imported.
+    static bool Import(const std::string& path, ImportedMesh& mesh, const ImportSettings& settings = ImportSettings(), ImportStatistics* statistics = nullptr);
+
+    static bool ImportObj(const std::string& path, ImportedMesh& mesh, const ImportSettings& settings, ImportStatistics& statistics);
+    static bool ImportGltf(const std::string& path, ImportedMesh& mesh, const ImportSettings& settings, ImportStatistics& statistics);
+};
+}
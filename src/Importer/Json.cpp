@@ -0,0 +1,353 @@
+#include "Json.h"
+
+#include <cstdlib>
+
+namespace Oglre {
+
+// Recursive descent parser over the whole document.
+class JsonParser {
+public:
+    JsonParser(std::string_view text)
+        : m_Text(text)
+        , m_Position(0)
+    {
+    }
+
+    bool ParseDocument(JsonValue& value, std::string& error)
+    {
+        if (!ParseValue(value, 0)) {
+            error = m_Error + " at byte " + std::to_string(m_Position);
+            return false;
+        }
+
+        SkipWhitespace();
+        if (m_Position != m_Text.size()) {
+            error = "Unexpected data after the document at byte " + std::to_string(m_Position);
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    // Deeper documents are rejected, rather than overflowing the stack.
+    static constexpr uint32_t maxDepth = 256;
+
+    std::string_view m_Text;
+    size_t m_Position;
+    std::string m_Error;
+
+    bool Fail(const char* message)
+    {
+        m_Error = message;
+        return false;
+    }
+
+    // Reads the 4 hex digits of a \u escape. Returns false if any of them is not a hex digit.
+    bool ParseHexQuad(uint32_t& value)
+    {
+        if (m_Position + 4 > m_Text.size()) {
+            return false;
+        }
+
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char digit = m_Text[m_Position++];
+            value <<= 4;
+            if (digit >= '0' && digit <= '9') {
+                value |= digit - '0';
+            } else if (digit >= 'a' && digit <= 'f') {
+                value |= digit - 'a' + 10;
+            } else if (digit >= 'A' && digit <= 'F') {
+                value |= digit - 'A' + 10;
+            } else {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void SkipWhitespace()
+    {
+        while (m_Position < m_Text.size() && (m_Text[m_Position] == ' ' || m_Text[m_Position] == '\t' || m_Text[m_Position] == '\n' || m_Text[m_Position] == '\r')) {
+            ++m_Position;
+        }
+    }
+
+    bool Consume(std::string_view literal)
+    {
+        if (m_Text.substr(m_Position, literal.size()) != literal) {
+            return false;
+        }
+        m_Position += literal.size();
+        return true;
+    }
+
+    bool ParseValue(JsonValue& value, uint32_t depth)
+    {
+        if (depth > maxDepth) {
+            return Fail("Document is nested too deeply");
+        }
+
+        SkipWhitespace();
+        if (m_Position >= m_Text.size()) {
+            return Fail("Unexpected end of document");
+        }
+
+        const char c = m_Text[m_Position];
+        if (c == '{') {
+            return ParseObject(value, depth);
+        }
+        if (c == '[') {
+            return ParseArray(value, depth);
+        }
+        if (c == '"') {
+            value.m_Type = JsonValue::Type::STRING;
+            return ParseString(value.m_String);
+        }
+        if (Consume("true")) {
+            value.m_Type = JsonValue::Type::BOOLEAN;
+            value.m_Boolean = true;
+            return true;
+        }
+        if (Consume("false")) {
+            value.m_Type = JsonValue::Type::BOOLEAN;
+            return true;
+        }
+        if (Consume("null")) {
+            return true;
+        }
+
+        return ParseNumber(value);
+    }
+
+    bool ParseObject(JsonValue& value, uint32_t depth)
+    {
+        value.m_Type = JsonValue::Type::OBJECT;
+        ++m_Position;
+
+        SkipWhitespace();
+        if (Consume("}")) {
+            return true;
+        }
+
+        while (true) {
+            SkipWhitespace();
+            std::string key;
+            if (m_Position >= m_Text.size() || m_Text[m_Position] != '"' || !ParseString(key)) {
+                return Fail("Expected an object key");
+            }
+
+            SkipWhitespace();
+            if (!Consume(":")) {
+                return Fail("Expected ':'");
+            }
+
+            value.m_Members.emplace_back(std::move(key), JsonValue());
+            if (!ParseValue(value.m_Members.back().second, depth + 1)) {
+                return false;
+            }
+
+            SkipWhitespace();
+            if (Consume("}")) {
+                return true;
+            }
+            if (!Consume(",")) {
+                return Fail("Expected ',' or '}'");
+            }
+        }
+    }
+
+    bool ParseArray(JsonValue& value, uint32_t depth)
+    {
+        value.m_Type = JsonValue::Type::ARRAY;
+        ++m_Position;
+
+        SkipWhitespace();
+        if (Consume("]")) {
+            return true;
+        }
+
+        while (true) {
+            value.m_Elements.emplace_back();
+            if (!ParseValue(value.m_Elements.back(), depth + 1)) {
+                return false;
+            }
+
+            SkipWhitespace();
+            if (Consume("]")) {
+                return true;
+            }
+            if (!Consume(",")) {
+                return Fail("Expected ',' or ']'");
+            }
+        }
+    }
+
+    bool ParseString(std::string& string)
+    {
+        ++m_Position;
+
+        while (m_Position < m_Text.size()) {
+            const char c = m_Text[m_Position++];
+            if (c == '"') {
+                return true;
+            }
+            if (c != '\\') {
+                string += c;
+                continue;
+            }
+
+            if (m_Position >= m_Text.size()) {
+                break;
+            }
+
+            const char escape = m_Text[m_Position++];
+            switch (escape) {
+            case '"':
+            case '\\':
+            case '/':
+                string += escape;
+                break;
+            case 'b':
+                string += '\b';
+                break;
+            case 'f':
+                string += '\f';
+                break;
+            case 'n':
+                string += '\n';
+                break;
+            case 'r':
+                string += '\r';
+                break;
+            case 't':
+                string += '\t';
+                break;
+            case 'u': {
+                uint32_t codePoint = 0;
+                if (!ParseHexQuad(codePoint)) {
+                    return Fail("Invalid \\u escape");
+                }
+
+                // Characters past U+FFFF are escaped as a surrogate pair. Either half alone is not a character, and
+                // would encode as invalid UTF-8.
+                if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+                    return Fail("Invalid \\u escape, unpaired surrogate");
+                }
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                    uint32_t lowSurrogate = 0;
+                    if (m_Text.substr(m_Position, 2) != "\\u") {
+                        return Fail("Invalid \\u escape, unpaired surrogate");
+                    }
+                    m_Position += 2;
+                    if (!ParseHexQuad(lowSurrogate) || lowSurrogate < 0xDC00 || lowSurrogate > 0xDFFF) {
+                        return Fail("Invalid \\u escape, unpaired surrogate");
+                    }
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                }
+
+                // Encode as UTF-8.
+                if (codePoint < 0x80) {
+                    string += static_cast<char>(codePoint);
+                } else if (codePoint < 0x800) {
+                    string += static_cast<char>(0xC0 | (codePoint >> 6));
+                    string += static_cast<char>(0x80 | (codePoint & 0x3F));
+                } else if (codePoint < 0x10000) {
+                    string += static_cast<char>(0xE0 | (codePoint >> 12));
+                    string += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                    string += static_cast<char>(0x80 | (codePoint & 0x3F));
+                } else {
+                    string += static_cast<char>(0xF0 | (codePoint >> 18));
+                    string += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                    string += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                    string += static_cast<char>(0x80 | (codePoint & 0x3F));
+                }
+                break;
+            }
+            default:
+                return Fail("Invalid escape sequence");
+            }
+        }
+
+        return Fail("Unterminated string");
+    }
+
+    bool ParseNumber(JsonValue& value)
+    {
+        const size_t start = m_Position;
+        while (m_Position < m_Text.size()) {
+            const char c = m_Text[m_Position];
+            if ((c < '0' || c > '9') && c != '-' && c != '+' && c != '.' && c != 'e' && c != 'E') {
+                break;
+            }
+            ++m_Position;
+        }
+
+        if (m_Position == start) {
+            return Fail("Unexpected character");
+        }
+
+        const std::string number(m_Text.substr(start, m_Position - start));
+        char* end = nullptr;
+        value.m_Number = std::strtod(number.c_str(), &end);
+        if (end != number.c_str() + number.size()) {
+            return Fail("Invalid number");
+        }
+
+        value.m_Type = JsonValue::Type::NUMBER;
+        return true;
+    }
+};
+}
+
+namespace {
+const Oglre::JsonValue nullValue;
+const std::string emptyString;
+}
+
+Oglre::JsonValue Oglre::JsonValue::Parse(std::string_view text, std::string& error)
+{
+    JsonValue value;
+    JsonParser parser(text);
+    if (!parser.ParseDocument(value, error)) {
+        return JsonValue();
+    }
+    return value;
+}
+
+const Oglre::JsonValue& Oglre::JsonValue::operator[](std::string_view key) const
+{
+    for (const auto& [memberKey, member] : m_Members) {
+        if (memberKey == key) {
+            return member;
+        }
+    }
+    return nullValue;
+}
+
+const Oglre::JsonValue& Oglre::JsonValue::operator[](size_t index) const
+{
+    return index < m_Elements.size() ? m_Elements[index] : nullValue;
+}
+
+size_t Oglre::JsonValue::Size() const
+{
+    return m_Type == Type::ARRAY ? m_Elements.size() : m_Members.size();
+}
+
+double Oglre::JsonValue::AsNumber(double defaultValue) const
+{
+    return m_Type == Type::NUMBER ? m_Number : defaultValue;
+}
+
+bool Oglre::JsonValue::AsBoolean(bool defaultValue) const
+{
+    return m_Type == Type::BOOLEAN ? m_Boolean : defaultValue;
+}
+
+const std::string& Oglre::JsonValue::AsString() const
+{
+    return m_Type == Type::STRING ? m_String : emptyString;
+}
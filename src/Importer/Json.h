@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Oglre {
+
+// Minimal read-only JSON document, enough for glTF. Lookups of missing keys or out of range indices return a null
+// value rather than failing, so optional glTF properties can be read with a default in one expression.
+class JsonValue {
+public:
+    enum class Type {
+        NULL_VALUE,
+        BOOLEAN,
+        NUMBER,
+        STRING,
+        ARRAY,
+        OBJECT
+    };
+
+    // Returns a null value, and sets error, if text is not valid JSON.
+    static JsonValue Parse(std::string_view text, std::string& error);
+
+    inline Type GetType() const
+    {
+        return m_Type;
+    }
+
+    inline bool IsNull() const
+    {
+        return m_Type == Type::NULL_VALUE;
+    }
+
+    const JsonValue& operator[](std::string_view key) const;
+    const JsonValue& operator[](size_t index) const;
+
+    // Number of elements of an array or members of an object, 0 for anything else.
+    size_t Size() const;
+
+    double AsNumber(double defaultValue = 0.0) const;
+    bool AsBoolean(bool defaultValue = false) const;
+    const std::string& AsString() const;
+
+    // Members of an object, in document order.
+    inline const std::vector<std::pair<std::string, JsonValue>>& GetMembers() const
+    {
+        return m_Members;
+    }
+
+private:
+    Type m_Type = Type::NULL_VALUE;
+    bool m_Boolean = false;
+    double m_Number = 0.0;
+    std::string m_String;
+    std::vector<JsonValue> m_Elements;
+    std::vector<std::pair<std::string, JsonValue>> m_Members;
+
+    friend class JsonParser;
+};
+}
@@ -0,0 +1,191 @@
+#include "JobSystem.h"
+
+#include <cstdlib>
+
+void Oglre::JobSystem::Initialize(uint32_t workerCount)
+{
+    std::lock_guard<std::mutex> lock(m_initializeMutex);
+    if (m_isInitialized) {
+        return;
+    }
+
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    }
+
+    m_threads.clear();
+    for (uint32_t i = 0; i <= workerCount; ++i) {
+        m_threads.push_back(std::make_unique<Thread>());
+    }
+    m_statistics.assign(workerCount + 1, {});
+    m_windowStartTime = Clock::now();
+
+    m_isStopping = false;
+    m_threadIndex = 0;
+    for (uint32_t i = 1; i <= workerCount; ++i) {
+        m_workers.emplace_back(WorkerMain, i);
+    }
+
+    // Workers still running at exit would terminate the program, for tools that never call Shutdown().
+    if (!m_isShutdownRegistered) {
+        std::atexit(Shutdown);
+        m_isShutdownRegistered = true;
+    }
+
+    m_isInitialized = true;
+}
+
+void Oglre::JobSystem::Shutdown()
+{
+    std::lock_guard<std::mutex> lock(m_initializeMutex);
+    if (!m_isInitialized) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> sleepLock(m_sleepMutex);
+        m_isStopping = true;
+    }
+    m_wakeCondition.notify_all();
+
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+    m_threads.clear();
+    m_queuedJobCount = 0;
+
+    m_isInitialized = false;
+}
+
+uint32_t Oglre::JobSystem::GetThreadCount()
+{
+    if (!m_isInitialized) {
+        Initialize();
+    }
+    return static_cast<uint32_t>(m_threads.size());
+}
+
+void Oglre::JobSystem::Submit(const Job& job)
+{
+    if (!m_isInitialized) {
+        Initialize();
+    }
+
+    if (job.counter) {
+        job.counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Thread& thread = *m_threads[m_threadIndex];
+    {
+        std::lock_guard<std::mutex> lock(thread.mutex);
+        thread.jobs.push_back(job);
+    }
+
+    // Counted before taking the sleep mutex, so a worker about to sleep either sees the job or gets woken.
+    m_queuedJobCount.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> sleepLock(m_sleepMutex);
+    }
+    m_wakeCondition.notify_one();
+}
+
+void Oglre::JobSystem::Wait(JobCounter& counter)
+{
+    while (!counter.IsDone()) {
+        if (!TryRunJob(m_threadIndex)) {
+            // The remaining jobs are running on other threads.
+            std::this_thread::yield();
+        }
+    }
+}
+
+void Oglre::JobSystem::EndFrame()
+{
+    const Clock::time_point now = Clock::now();
+    const double windowNanoseconds = std::max(1.0, static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_windowStartTime).count()));
+    m_windowStartTime = now;
+
+    for (size_t i = 0; i < m_threads.size(); ++i) {
+        Thread& thread = *m_threads[i];
+        JobThreadStatistics& statistics = m_statistics[i];
+
+        statistics.jobCount = thread.jobCount.exchange(0, std::memory_order_relaxed);
+        statistics.stolenCount = thread.stolenCount.exchange(0, std::memory_order_relaxed);
+        statistics.utilization = static_cast<float>(static_cast<double>(thread.busyNanoseconds.exchange(0, std::memory_order_relaxed)) / windowNanoseconds);
+    }
+}
+
+const std::vector<Oglre::JobThreadStatistics>& Oglre::JobSystem::GetStatistics()
+{
+    return m_statistics;
+}
+
+void Oglre::JobSystem::WorkerMain(uint32_t threadIndex)
+{
+    m_threadIndex = threadIndex;
+
+    while (true) {
+        if (TryRunJob(threadIndex)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wakeCondition.wait(lock, []() { return m_isStopping || m_queuedJobCount.load(std::memory_order_acquire) > 0; });
+        if (m_isStopping) {
+            return;
+        }
+    }
+}
+
+bool Oglre::JobSystem::TryRunJob(uint32_t threadIndex)
+{
+    if (m_queuedJobCount.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    // Newest first from this thread's own queue, then oldest first from the others', starting with the next one along.
+    Job job;
+    bool isFound = false;
+    bool isStolen = false;
+    const size_t threadCount = m_threads.size();
+    for (size_t i = 0; i < threadCount && !isFound; ++i) {
+        Thread& victim = *m_threads[(threadIndex + i) % threadCount];
+
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.jobs.empty()) {
+            continue;
+        }
+
+        if (i == 0) {
+            job = victim.jobs.back();
+            victim.jobs.pop_back();
+        } else {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            isStolen = true;
+        }
+        isFound = true;
+    }
+
+    if (!isFound) {
+        return false;
+    }
+    m_queuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+
+    const Clock::time_point startTime = Clock::now();
+    job.function(job.data, job.begin, job.end);
+    const uint64_t busyNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - startTime).count();
+
+    Thread& thread = *m_threads[threadIndex];
+    thread.busyNanoseconds.fetch_add(busyNanoseconds, std::memory_order_relaxed);
+    thread.jobCount.fetch_add(1, std::memory_order_relaxed);
+    if (isStolen) {
+        thread.stolenCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (job.counter) {
+        job.counter->m_Pending.fetch_sub(1, std::memory_order_release);
+    }
+    return true;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Oglre {
+
+// Number of unfinished jobs submitted with it. Submitting a job increments it and finishing the job decrements it, so
+// it is a fence: JobSystem::Wait() on it returns once every job submitted with it has run. Must outlive its jobs.
+class JobCounter {
+public:
+    inline bool IsDone() const
+    {
+        return m_Pending.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<uint32_t> m_Pending = 0;
+};
+
+// Calls function(data, begin, end). Jobs do not own data, whoever submits them keeps it alive until they are done.
+struct Job {
+    void (*function)(const void* data, uint32_t begin, uint32_t end) = nullptr;
+    const void* data = nullptr;
+    uint32_t begin = 0;
+    uint32_t end = 0;
+    JobCounter* counter = nullptr;
+};
+
+// Per thread, over the window between the last two calls to JobSystem::EndFrame().
+struct JobThreadStatistics {
+    uint32_t jobCount = 0;
+    uint32_t stolenCount = 0; // Jobs taken from another thread's queue.
+    float utilization = 0.0f; // Fraction of the window spent running jobs.
+};
+
+// ----------
+// Job System
+// ----------
+//
+// A pool of worker threads, plus the thread that initialized it, which all run small jobs. Every thread has its own
+// queue of jobs: it pushes and pops its own at the back, and when it runs out it steals from the front of the others'.
+// Work submitted together therefore mostly stays on the thread that submitted it, and idle threads take the oldest,
+// usually largest, jobs of the busy ones.
+//
+// Waiting on a JobCounter runs queued jobs until the counter is done, so jobs may submit and wait on jobs of their own,
+// and the main thread helps out rather than blocking. With no worker threads, e.g. on a single core machine, jobs run
+// when they are waited on.
+//
+// The main thread keeps the OpenGL context, so jobs must not make GL calls. Thread 0 is the main thread.
+class JobSystem {
+public:
+    // Starts workerCount worker threads, one fewer than the number of hardware threads if 0. The first use of the job
+    // system does this if it has not been done yet.
+    static void Initialize(uint32_t workerCount = 0);
+
+    // Stops and joins the workers. Jobs that have not started yet are dropped, so wait on them first.
+    static void Shutdown();
+
+    // Worker threads plus the main thread.
+    static uint32_t GetThreadCount();
+
+    static void Submit(const Job& job);
+
+    // Runs jobs until counter is done.
+    static void Wait(JobCounter& counter);
+
+    // Submits function() as a job. function must outlive the job.
+    template <typename Function>
+    static void Run(JobCounter& counter, const Function& function)
+    {
+        Submit({ [](const void* data, uint32_t, uint32_t) { (*static_cast<const Function*>(data))(); }, &function, 0, 0, &counter });
+    }
+
+    // Calls function(begin, end) over [0, count) in batches, spread over every thread, and waits for them. Batch sizes
+    // are multiples of granularity, with a few batches per thread so that stealing can even out uneven batches.
+    template <typename Function>
+    static void ParallelFor(uint32_t count, uint32_t granularity, const Function& function)
+    {
+        const uint32_t threadCount = GetThreadCount();
+        if (count <= granularity || threadCount <= 1) {
+            if (count > 0) {
+                function(0u, count);
+            }
+            return;
+        }
+
+        const uint32_t targetBatchSize = std::max(granularity, count / (batchesPerThread * threadCount));
+        const uint32_t batchSize = (targetBatchSize + granularity - 1) / granularity * granularity;
+
+        // Queued last first, so the calling thread pops the batches in order, and thieves steal from the end.
+        JobCounter counter;
+        const auto run = [](const void* data, uint32_t begin, uint32_t end) { (*static_cast<const Function*>(data))(begin, end); };
+        for (uint32_t begin = (count - 1) / batchSize * batchSize; begin >= batchSize; begin -= batchSize) {
+            Submit({ run, &function, begin, std::min(begin + batchSize, count), &counter });
+        }
+        function(0u, std::min(batchSize, count));
+
+        Wait(counter);
+    }
+
+    // Ends the current statistics window and starts the next one. Call once per frame, from the main thread.
+    static void EndFrame();
+
+    static const std::vector<JobThreadStatistics>& GetStatistics();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr uint32_t batchesPerThread = 4;
+
+    struct Thread {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+
+        std::atomic<uint64_t> busyNanoseconds = 0;
+        std::atomic<uint32_t> jobCount = 0;
+        std::atomic<uint32_t> stolenCount = 0;
+    };
+
+    static inline std::vector<std::unique_ptr<Thread>> m_threads;
+    static inline std::vector<std::thread> m_workers;
+    static inline std::mutex m_initializeMutex;
+    static inline std::atomic<bool> m_isInitialized = false;
+    static inline bool m_isShutdownRegistered = false;
+
+    // Queued jobs over all threads, and what idle workers sleep on until there are some.
+    static inline std::atomic<uint32_t> m_queuedJobCount = 0;
+    static inline std::mutex m_sleepMutex;
+    static inline std::condition_variable m_wakeCondition;
+    static inline bool m_isStopping = false;
+
+    static inline std::vector<JobThreadStatistics> m_statistics;
+    static inline Clock::time_point m_windowStartTime;
+
+    static inline thread_local uint32_t m_threadIndex = 0;
+
+    static void WorkerMain(uint32_t threadIndex);
+    static bool TryRunJob(uint32_t threadIndex);
+};
+}
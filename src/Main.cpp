@@ -3,9 +3,74 @@
 
 #include "Application.h"
 
-int main()
+#include <algorithm>
+#include <string>
+
+int main(int argc, char* argv[])
 {
-    Oglre::Application::Initialize();
+    Oglre::ContextBackend backend = Oglre::ContextBackend::WINDOW;
+    bool hasInstanceCount = false;
+
+    // Usage: oglre [--headless] [--frames N] [--duration SECONDS] [--width W] [--height H] [--output FILE.ppm] [--instances N] [--draw-path instanced|indirect] [--mesh FILE.(oglm|obj|gltf|glb)] [--workers N] [--views N] [--frame-cap FPS] [--swap-interval N]
+    //                 [--record-path FILE] [--replay-path FILE] [--benchmark] [--benchmark-poses N] [--warmup N] [--benchmark-output PREFIX]
+    //                 [--baseline FILE.json] [--regression-threshold PERCENT]
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (argument == "--headless") {
+            backend = Oglre::ContextBackend::HEADLESS;
+        } else if (argument == "--frames" && hasValue) {
+            Oglre::Application::headlessSettings.frameCount = std::stoul(argv[++i]);
+        } else if (argument == "--duration" && hasValue) {
+            Oglre::Application::headlessSettings.durationSeconds = std::stod(argv[++i]);
+        } else if (argument == "--width" && hasValue) {
+            Oglre::Application::headlessSettings.width = std::stoul(argv[++i]);
+        } else if (argument == "--height" && hasValue) {
+            Oglre::Application::headlessSettings.height = std::stoul(argv[++i]);
+        } else if (argument == "--output" && hasValue) {
+            Oglre::Application::headlessSettings.outputImagePath = argv[++i];
+        } else if (argument == "--instances" && hasValue) {
+            Oglre::Application::instanceCount = std::clamp(std::stoi(argv[++i]), 1, Oglre::Application::maxInstanceCount);
+            hasInstanceCount = true;
+        } else if (argument == "--mesh" && hasValue) {
+            Oglre::Application::meshPath = argv[++i];
+        } else if (argument == "--draw-path" && hasValue) {
+            const std::string path = argv[++i];
+            Oglre::Application::drawPath = path == "indirect" ? Oglre::DrawPath::INDIRECT : Oglre::DrawPath::INSTANCED;
+        } else if (argument == "--workers" && hasValue) {
+            Oglre::Application::workerCount = std::stoul(argv[++i]);
+        } else if (argument == "--views" && hasValue) {
+            Oglre::Application::viewCount = std::max(std::stoi(argv[++i]), 1);
+        } else if (argument == "--frame-cap" && hasValue) {
+            Oglre::Application::frameSchedulerSettings.frameRateCap = std::max(std::stod(argv[++i]), 0.0);
+        } else if (argument == "--swap-interval" && hasValue) {
+            Oglre::Application::frameSchedulerSettings.swapInterval = std::max(std::stoi(argv[++i]), 0);
+        } else if (argument == "--record-path" && hasValue) {
+            Oglre::Application::recordPathFile = argv[++i];
+        } else if (argument == "--replay-path" && hasValue) {
+            Oglre::Application::replayPathFile = argv[++i];
+        } else if (argument == "--benchmark") {
+            Oglre::Application::benchmarkSettings.isEnabled = true;
+        } else if (argument == "--benchmark-poses" && hasValue) {
+            Oglre::Application::benchmarkSettings.flythroughPoseCount = std::max(std::stoi(argv[++i]), 1);
+        } else if (argument == "--warmup" && hasValue) {
+            Oglre::Application::benchmarkSettings.warmupFrameCount = std::stoul(argv[++i]);
+        } else if (argument == "--benchmark-output" && hasValue) {
+            Oglre::Application::benchmarkSettings.outputPath = argv[++i];
+        } else if (argument == "--baseline" && hasValue) {
+            Oglre::Application::benchmarkSettings.baselinePath = argv[++i];
+        } else if (argument == "--regression-threshold" && hasValue) {
+            Oglre::Application::benchmarkSettings.regressionThreshold = std::stod(argv[++i]) / 100.0;
+        }
+    }
+
+    // The benchmark's stress scene is a grid of cubes, 10000 unless told otherwise.
+    if (Oglre::Application::benchmarkSettings.isEnabled && !hasInstanceCount) {
+        Oglre::Application::instanceCount = 10000;
+    }
+
+    Oglre::Application::Initialize(backend);
     Oglre::Application::Run();
     Oglre::Application::Exit();
-}
\ No newline at end of file
+}
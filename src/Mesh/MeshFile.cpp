@@ -0,0 +1,335 @@
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "VertexQuantizer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define OGLRE_MESH_FILE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+uint64_t AlignUp(uint64_t value)
+{
+    return (value + Oglre::meshFileAlignment - 1) / Oglre::meshFileAlignment * Oglre::meshFileAlignment;
+}
+
+// Whether all count indices at data address one of vertexCount vertices. Only the largest index matters, which keeps
+// the loop free of branches.
+template <typename Index>
+bool AreIndicesInRange(const std::byte* data, uint32_t count, uint32_t vertexCount)
+{
+    Index largestIndex = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        Index index;
+        std::memcpy(&index, data + size_t(i) * sizeof(Index), sizeof(Index));
+        largestIndex = std::max(largestIndex, index);
+    }
+
+    return count == 0 || largestIndex < vertexCount;
+}
+}
+
+Oglre::MeshFile::MeshFile(const std::string& path)
+    : m_Data(nullptr)
+    , m_Size(0)
+    , m_Header(nullptr)
+    , m_IsMapped(false)
+{
+#ifdef OGLRE_MESH_FILE_MMAP
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        std::cout << "Mesh file " << path << " could not be opened" << std::endl;
+        return;
+    }
+
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size > 0) {
+        void* mapping = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapping != MAP_FAILED) {
+            m_Data = static_cast<const std::byte*>(mapping);
+            m_Size = static_cast<uint64_t>(status.st_size);
+            m_IsMapped = true;
+
+            // Uploads read the whole file front to back.
+            madvise(mapping, m_Size, MADV_SEQUENTIAL);
+        }
+    }
+
+    // The mapping keeps its own reference to the file.
+    close(file);
+#endif
+
+    // Without mmap, fall back to reading the whole file.
+    if (!m_IsMapped) {
+        std::ifstream stream(path, std::ios::binary | std::ios::ate);
+        if (!stream) {
+            std::cout << "Mesh file " << path << " could not be opened" << std::endl;
+            return;
+        }
+
+        m_Storage.resize(static_cast<size_t>(stream.tellg()));
+        stream.seekg(0);
+        stream.read(reinterpret_cast<char*>(m_Storage.data()), static_cast<std::streamsize>(m_Storage.size()));
+
+        m_Data = m_Storage.data();
+        m_Size = m_Storage.size();
+    }
+
+    if (Validate(path)) {
+        m_Header = reinterpret_cast<const MeshFileHeader*>(m_Data);
+    }
+}
+
+Oglre::MeshFile::~MeshFile()
+{
+#ifdef OGLRE_MESH_FILE_MMAP
+    if (m_IsMapped) {
+        munmap(const_cast<std::byte*>(m_Data), m_Size);
+    }
+#endif
+}
+
+bool Oglre::MeshFile::Validate(const std::string& path) const
+{
+    if (m_Size < sizeof(MeshFileHeader)) {
+        std::cout << "Mesh file " << path << " is too small to be a mesh file" << std::endl;
+        return false;
+    }
+
+    const MeshFileHeader& header = *reinterpret_cast<const MeshFileHeader*>(m_Data);
+    if (std::memcmp(header.magic, meshFileMagic, sizeof(meshFileMagic)) != 0) {
+        std::cout << "Mesh file " << path << " is not a mesh file" << std::endl;
+        return false;
+    }
+
+    if (header.version != meshFileVersion) {
+        std::cout << "Mesh file " << path << " is version " << header.version << ", expected version " << meshFileVersion << std::endl;
+        return false;
+    }
+
+    const uint64_t attributesSize = uint64_t(header.attributeCount) * sizeof(MeshFileAttribute) + uint64_t(header.lodCount) * sizeof(MeshFileLod);
+    const uint64_t vertexDataSize = uint64_t(header.vertexCount) * header.vertexStride;
+    const uint64_t indexDataSize = uint64_t(header.indexCount) * VertexBufferElement::GetSizeOfType(header.indexType);
+
+    if (header.indexType != GL_UNSIGNED_BYTE && header.indexType != GL_UNSIGNED_SHORT && header.indexType != GL_UNSIGNED_INT) {
+        std::cout << "Mesh file " << path << " has an unsupported index type" << std::endl;
+        return false;
+    }
+
+    const bool isAligned = header.attributesOffset % meshFileAlignment == 0
+        && header.vertexDataOffset % meshFileAlignment == 0
+        && header.indexDataOffset % meshFileAlignment == 0;
+    // Written so that a corrupt offset near UINT64_MAX cannot wrap around and pass.
+    const auto isSectionInBounds = [this](uint64_t offset, uint64_t size) { return offset <= m_Size && size <= m_Size - offset; };
+    const bool isInBounds = header.fileSize == m_Size
+        && isSectionInBounds(header.attributesOffset, attributesSize)
+        && isSectionInBounds(header.vertexDataOffset, vertexDataSize)
+        && isSectionInBounds(header.indexDataOffset, indexDataSize);
+
+    if (!isAligned || !isInBounds) {
+        std::cout << "Mesh file " << path << " is truncated or corrupt" << std::endl;
+        return false;
+    }
+
+    // The stride must match the attributes, otherwise GetLayout() would describe different data.
+    const auto* attributes = reinterpret_cast<const MeshFileAttribute*>(m_Data + header.attributesOffset);
+    uint32_t stride = 0;
+    for (uint32_t i = 0; i < header.attributeCount; ++i) {
+        const VertexBufferElement element { attributes[i].type, attributes[i].count, static_cast<unsigned char>(attributes[i].normalized), attributes[i].divisor };
+        const bool isPackedCountValid = !VertexBufferElement::IsPackedType(element.type) || element.count == 4;
+        if (VertexBufferElement::GetSizeOfType(element.type) == 0 || element.count == 0 || element.count > 4 || !isPackedCountValid) {
+            std::cout << "Mesh file " << path << " has an unsupported vertex attribute" << std::endl;
+            return false;
+        }
+        stride += element.GetSize();
+    }
+
+    if (stride != header.vertexStride) {
+        std::cout << "Mesh file " << path << " has a vertex stride that does not match its attributes" << std::endl;
+        return false;
+    }
+
+    // As Write() requires, the first attribute is the position.
+    if (header.attributeCount == 0 || header.vertexStride == 0 || attributes[0].count < 3) {
+        std::cout << "Mesh file " << path << " has no position attribute" << std::endl;
+        return false;
+    }
+
+    const auto* lods = reinterpret_cast<const MeshFileLod*>(attributes + header.attributeCount);
+    bool areLodsValid = header.lodCount > 0;
+    for (uint32_t i = 0; i < header.lodCount; ++i) {
+        areLodsValid &= lods[i].indexCount % 3 == 0 && uint64_t(lods[i].indexOffset) + lods[i].indexCount <= header.indexCount;
+    }
+
+    if (!areLodsValid) {
+        std::cout << "Mesh file " << path << " has levels of detail outside of its indices" << std::endl;
+        return false;
+    }
+
+    // Every index is checked, as one past the vertices would have the GPU read outside the vertex buffer.
+    const std::byte* indexData = m_Data + header.indexDataOffset;
+    bool areIndicesValid = false;
+    switch (header.indexType) {
+    case GL_UNSIGNED_BYTE:
+        areIndicesValid = AreIndicesInRange<uint8_t>(indexData, header.indexCount, header.vertexCount);
+        break;
+    case GL_UNSIGNED_SHORT:
+        areIndicesValid = AreIndicesInRange<uint16_t>(indexData, header.indexCount, header.vertexCount);
+        break;
+    case GL_UNSIGNED_INT:
+        areIndicesValid = AreIndicesInRange<uint32_t>(indexData, header.indexCount, header.vertexCount);
+        break;
+    }
+
+    if (!areIndicesValid) {
+        std::cout << "Mesh file " << path << " has indices outside of its vertices" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool Oglre::MeshFile::Write(const std::string& path, const VertexBufferLayout& layout, std::span<const std::byte> vertexData, std::span<const uint32_t> indices,
+    std::span<const MeshLod> lods)
+{
+    const auto& elements = layout.GetElements();
+    const uint32_t stride = layout.GetStride();
+
+    if (elements.empty() || elements[0].count < 3 || vertexData.size() % stride != 0) {
+        std::cout << "Mesh data for " << path << " does not match its layout" << std::endl;
+        return false;
+    }
+
+    if (vertexData.size() / stride > std::numeric_limits<uint32_t>::max() || indices.size() > std::numeric_limits<uint32_t>::max()) {
+        std::cout << "Mesh data for " << path << " is too large for a mesh file" << std::endl;
+        return false;
+    }
+
+    std::vector<MeshFileLod> fileLods;
+    for (const MeshLod& lod : lods) {
+        fileLods.push_back({ lod.indexOffset, lod.indexCount, lod.error, 0 });
+    }
+    if (fileLods.empty()) {
+        fileLods.push_back({ 0, static_cast<uint32_t>(indices.size()), 0.0f, 0 });
+    }
+
+    MeshFileHeader header {};
+    std::memcpy(header.magic, meshFileMagic, sizeof(meshFileMagic));
+    header.version = meshFileVersion;
+    header.attributeCount = static_cast<uint32_t>(elements.size());
+    header.vertexStride = stride;
+    header.vertexCount = static_cast<uint32_t>(vertexData.size() / stride);
+    header.indexCount = static_cast<uint32_t>(indices.size());
+    header.indexType = MeshOptimizer::SelectIndexType(header.vertexCount);
+    header.lodCount = static_cast<uint32_t>(fileLods.size());
+
+    const std::vector<std::byte> indexData = MeshOptimizer::PackIndices(indices, header.indexType);
+
+    glm::vec3 minimum(std::numeric_limits<float>::max());
+    glm::vec3 maximum(std::numeric_limits<float>::lowest());
+    for (uint32_t vertex = 0; vertex < header.vertexCount; ++vertex) {
+        float position[4];
+        VertexQuantizer::UnpackAttribute(elements[0], vertexData.data() + uint64_t(vertex) * stride, position);
+
+        const glm::vec3 point(position[0], position[1], position[2]);
+        minimum = glm::min(minimum, point);
+        maximum = glm::max(maximum, point);
+    }
+    if (header.vertexCount == 0) {
+        minimum = maximum = glm::vec3(0.0f);
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        header.boundsMinimum[axis] = minimum[axis];
+        header.boundsMaximum[axis] = maximum[axis];
+    }
+
+    header.attributesOffset = AlignUp(sizeof(MeshFileHeader));
+    header.vertexDataOffset = AlignUp(header.attributesOffset + elements.size() * sizeof(MeshFileAttribute) + fileLods.size() * sizeof(MeshFileLod));
+    header.indexDataOffset = AlignUp(header.vertexDataOffset + vertexData.size());
+    header.fileSize = header.indexDataOffset + indexData.size();
+
+    std::vector<MeshFileAttribute> attributes;
+    attributes.reserve(elements.size());
+    for (const VertexBufferElement& element : elements) {
+        attributes.push_back({ element.type, element.count, element.normalized, element.divisor });
+    }
+
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        std::cout << "Mesh file " << path << " could not be created" << std::endl;
+        return false;
+    }
+
+    // Pads the stream with zeros up to offset.
+    const auto seekTo = [&stream](uint64_t offset) {
+        static const char zeros[meshFileAlignment] = {};
+        const uint64_t position = static_cast<uint64_t>(stream.tellp());
+        stream.write(zeros, static_cast<std::streamsize>(offset - position));
+    };
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    seekTo(header.attributesOffset);
+    stream.write(reinterpret_cast<const char*>(attributes.data()), static_cast<std::streamsize>(attributes.size() * sizeof(MeshFileAttribute)));
+    stream.write(reinterpret_cast<const char*>(fileLods.data()), static_cast<std::streamsize>(fileLods.size() * sizeof(MeshFileLod)));
+    seekTo(header.vertexDataOffset);
+    stream.write(reinterpret_cast<const char*>(vertexData.data()), static_cast<std::streamsize>(vertexData.size()));
+    seekTo(header.indexDataOffset);
+    stream.write(reinterpret_cast<const char*>(indexData.data()), static_cast<std::streamsize>(indexData.size()));
+
+    if (!stream) {
+        std::cout << "Mesh file " << path << " could not be written" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+Oglre::VertexBufferLayout Oglre::MeshFile::GetLayout() const
+{
+    VertexBufferLayout layout;
+
+    const auto* attributes = reinterpret_cast<const MeshFileAttribute*>(m_Data + m_Header->attributesOffset);
+    for (uint32_t i = 0; i < m_Header->attributeCount; ++i) {
+        layout.Push({ attributes[i].type, attributes[i].count, static_cast<unsigned char>(attributes[i].normalized), attributes[i].divisor });
+    }
+
+    return layout;
+}
+
+std::span<const std::byte> Oglre::MeshFile::GetVertexData() const
+{
+    return { m_Data + m_Header->vertexDataOffset, uint64_t(m_Header->vertexCount) * m_Header->vertexStride };
+}
+
+std::span<const std::byte> Oglre::MeshFile::GetIndexData() const
+{
+    return { m_Data + m_Header->indexDataOffset, uint64_t(m_Header->indexCount) * VertexBufferElement::GetSizeOfType(m_Header->indexType) };
+}
+
+std::vector<Oglre::MeshLod> Oglre::MeshFile::GetLods() const
+{
+    const auto* attributes = reinterpret_cast<const MeshFileAttribute*>(m_Data + m_Header->attributesOffset);
+    const auto* fileLods = reinterpret_cast<const MeshFileLod*>(attributes + m_Header->attributeCount);
+
+    std::vector<MeshLod> lods;
+    for (uint32_t i = 0; i < m_Header->lodCount; ++i) {
+        lods.push_back({ fileLods[i].indexOffset, fileLods[i].indexCount, fileLods[i].error });
+    }
+
+    return lods;
+}
+
+std::span<const std::byte> Oglre::MeshFile::GetIndexData(const MeshLod& lod) const
+{
+    const uint32_t indexSize = VertexBufferElement::GetSizeOfType(m_Header->indexType);
+    return GetIndexData().subspan(uint64_t(lod.indexOffset) * indexSize, uint64_t(lod.indexCount) * indexSize);
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "MeshLod.h"
+#include "VertexBufferLayout.h"
+
+namespace Oglre {
+
+// -----------------
+// .oglm File Format
+// -----------------
+//
+// | MeshFileHeader | MeshFileAttribute * attributeCount, MeshFileLod * lodCount | vertex data | index data |
+//
+// Little-endian, fixed-width fields only. Every section starts at a multiple of meshFileAlignment, so once the file is
+// mapped into memory the vertex and index blobs can be handed straight to VertexBuffer and IndexBuffer, without copying
+// or parsing. Bump meshFileVersion on any change to these structs.
+//
+// The index data holds every level of detail's indices back to back, finest first. All levels index the same vertices.
+
+constexpr char meshFileMagic[4] = { 'O', 'G', 'L', 'M' };
+constexpr uint32_t meshFileVersion = 3;
+constexpr uint32_t meshFileAlignment = 64;
+
+struct MeshFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t attributeCount;
+    uint32_t vertexStride;
+    uint32_t vertexCount;
+    uint32_t indexCount; // Of every level of detail together.
+    uint32_t indexType; // GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, the narrowest that fits vertexCount.
+    uint32_t lodCount; // At least 1, the full mesh.
+    float boundsMinimum[3];
+    float boundsMaximum[3];
+    uint64_t attributesOffset;
+    uint64_t vertexDataOffset;
+    uint64_t indexDataOffset;
+    uint64_t fileSize;
+};
+static_assert(sizeof(MeshFileHeader) == 88, "MeshFileHeader is part of the file format, its size must not change.");
+
+// A VertexBufferElement, with fixed-width fields.
+struct MeshFileAttribute {
+    uint32_t type;
+    uint32_t count;
+    uint32_t normalized;
+    uint32_t divisor;
+};
+static_assert(sizeof(MeshFileAttribute) == 16, "MeshFileAttribute is part of the file format, its size must not change.");
+
+// A MeshLod, with fixed-width fields.
+struct MeshFileLod {
+    uint32_t indexOffset;
+    uint32_t indexCount;
+    float error;
+    uint32_t reserved;
+};
+static_assert(sizeof(MeshFileLod) == 16, "MeshFileLod is part of the file format, its size must not change.");
+
+// A read-only .oglm file. Memory-mapped where the platform allows it, so opening a file costs no more than its header
+// checks and one pass over the indices, and the vertex data's pages are only read in as it is uploaded.
+class MeshFile {
+public:
+    // Check IsValid() before using the file. Errors are reported to std::cout.
+    MeshFile(const std::string& path);
+    ~MeshFile();
+
+    MeshFile(const MeshFile&) = delete;
+    MeshFile& operator=(const MeshFile&) = delete;
+
+    // Writes a mesh. vertexData must hold a whole number of layout.GetStride() sized vertices, and the bounds are
+    // taken from the first attribute, which must be a position with at least 3 components, quantized or not.
+    // Indices are stored with the narrowest type that can address every vertex. lods are ranges of indices, see
+    // LodChain, without them all indices are one level.
+    static bool Write(const std::string& path, const VertexBufferLayout& layout, std::span<const std::byte> vertexData, std::span<const uint32_t> indices,
+        std::span<const MeshLod> lods = {});
+
+    inline bool IsValid() const
+    {
+        return m_Header != nullptr;
+    }
+
+    inline const MeshFileHeader& GetHeader() const
+    {
+        return *m_Header;
+    }
+
+    VertexBufferLayout GetLayout() const;
+
+    std::span<const std::byte> GetVertexData() const;
+    // Indices packed as GetIndexType(), ready for IndexBuffer.
+    std::span<const std::byte> GetIndexData() const;
+
+    // Levels of detail, finest first, and the indices of one of them.
+    std::vector<MeshLod> GetLods() const;
+    std::span<const std::byte> GetIndexData(const MeshLod& lod) const;
+
+    inline GLenum GetIndexType() const
+    {
+        return m_Header->indexType;
+    }
+
+    inline glm::vec3 GetBoundsMinimum() const
+    {
+        return glm::vec3(m_Header->boundsMinimum[0], m_Header->boundsMinimum[1], m_Header->boundsMinimum[2]);
+    }
+
+    inline glm::vec3 GetBoundsMaximum() const
+    {
+        return glm::vec3(m_Header->boundsMaximum[0], m_Header->boundsMaximum[1], m_Header->boundsMaximum[2]);
+    }
+
+    // Size of the whole file in bytes.
+    inline uint64_t GetSize() const
+    {
+        return m_Size;
+    }
+
+private:
+    const std::byte* m_Data;
+    uint64_t m_Size;
+    const MeshFileHeader* m_Header;
+
+    // Set if the file was mapped, otherwise m_Data points into m_Storage.
+    bool m_IsMapped;
+    std::vector<std::byte> m_Storage;
+
+    bool Validate(const std::string& path) const;
+};
+}
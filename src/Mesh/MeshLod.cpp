@@ -0,0 +1,41 @@
+#include "MeshLod.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+void Oglre::LodSelector::SetProjection(float fieldOfView, float viewportHeight)
+{
+    // A perspective projection maps 2 * tan(fov / 2) world units at distance 1 to the viewport's height.
+    m_PixelsPerUnit = viewportHeight / (2.0f * std::tan(glm::radians(fieldOfView) * 0.5f));
+}
+
+float Oglre::LodSelector::GetScreenError(float error, float distance) const
+{
+    // Objects the camera is inside of are as close as they get, so use a small distance rather than dividing by 0.
+    return error * m_PixelsPerUnit / std::max(distance, 1e-3f);
+}
+
+uint32_t Oglre::LodSelector::Select(std::span<const MeshLod> lods, float errorScale, float distance, uint32_t currentLod) const
+{
+    if (lods.empty()) {
+        return 0;
+    }
+    currentLod = std::min(currentLod, static_cast<uint32_t>(lods.size() - 1));
+
+    // Coarsest level under threshold. Errors grow with each level, so the search stops at the first one over it.
+    const auto selectUnder = [&](float threshold) {
+        uint32_t lod = 0;
+        while (lod + 1 < lods.size() && GetScreenError(lods[lod + 1].error * errorScale, distance) <= threshold) {
+            ++lod;
+        }
+        return lod;
+    };
+
+    if (GetScreenError(lods[currentLod].error * errorScale, distance) > pixelErrorThreshold) {
+        return selectUnder(pixelErrorThreshold);
+    }
+
+    return std::max(currentLod, selectUnder(pixelErrorThreshold * (1.0f - hysteresis)));
+}
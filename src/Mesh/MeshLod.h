@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Oglre {
+
+// One level of detail of a mesh: a range of indices into the same vertices as every other level of the mesh.
+struct MeshLod {
+    uint32_t indexOffset = 0;
+    uint32_t indexCount = 0;
+    float error = 0.0f; // Quadric error of the level from the full mesh, in the mesh's units, see MeshSimplifier.
+};
+
+// Levels of detail of a mesh, finest first, with every level's indices back to back.
+struct LodChain {
+    std::vector<uint32_t> indices;
+    std::vector<MeshLod> lods;
+};
+
+// -------------
+// LOD Selection
+// -------------
+//
+// Picks the coarsest level of detail whose quadric error, projected onto the screen, stays below pixelErrorThreshold
+// pixels. The error is projected at the nearest its object gets to the camera, so the choice errs on the fine side, but
+// the error itself is an estimate of how far the level strays, not a bound.
+//
+// Switching to a coarser level needs its error to be below the threshold by the hysteresis fraction, while switching to
+// a finer one happens as soon as the current level is over the threshold. Objects near a switching distance therefore
+// do not flicker between two levels as the camera moves back and forth.
+class LodSelector {
+public:
+    float pixelErrorThreshold = 1.0f;
+    float hysteresis = 0.25f;
+
+    // Updates the projection the errors are projected with, e.g. once per frame. fieldOfView is vertical, in degrees
+    // like Camera::cameraFOV, and viewportHeight is in pixels.
+    void SetProjection(float fieldOfView, float viewportHeight);
+
+    // Size in pixels of error world units at distance world units from the camera.
+    float GetScreenError(float error, float distance) const;
+
+    // Returns the level of lods to draw, given the level drawn last frame. errorScale converts the levels' errors to
+    // world units, e.g. the object's scale, and distance is from the camera to the nearest point of the object's bounds.
+    uint32_t Select(std::span<const MeshLod> lods, float errorScale, float distance, uint32_t currentLod) const;
+
+private:
+    float m_PixelsPerUnit = 1.0f; // Pixels per world unit at a distance of one world unit.
+};
+}
@@ -0,0 +1,389 @@
+#include "MeshOptimizer.h"
+#include "VertexBufferLayout.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace {
+constexpr uint32_t invalidVertex = std::numeric_limits<uint32_t>::max();
+
+// A FIFO vertex cache. A vertex is cached if fewer than cacheSize misses happened since it was last loaded, so the
+// cache never has to be searched or shifted.
+class VertexCacheSimulator {
+public:
+    VertexCacheSimulator(uint32_t vertexCount, uint32_t cacheSize)
+        : m_Timestamps(vertexCount, 0)
+        , m_CacheSize(cacheSize)
+        , m_Time(cacheSize + 1)
+    {
+    }
+
+    // Returns true if vertex had to be transformed.
+    inline bool Access(uint32_t vertex)
+    {
+        if (m_Time - m_Timestamps[vertex] > m_CacheSize) {
+            m_Timestamps[vertex] = m_Time++;
+            return true;
+        }
+        return false;
+    }
+
+    inline uint32_t AccessTriangle(const uint32_t* triangle)
+    {
+        return Access(triangle[0]) + Access(triangle[1]) + Access(triangle[2]);
+    }
+
+    inline bool IsCached(uint32_t vertex) const
+    {
+        return m_Time - m_Timestamps[vertex] <= m_CacheSize;
+    }
+
+    // Age of a cached vertex, in misses since it was loaded.
+    inline uint32_t GetAge(uint32_t vertex) const
+    {
+        return m_Time - m_Timestamps[vertex];
+    }
+
+    // Evicts every vertex.
+    inline void Flush()
+    {
+        m_Time += m_CacheSize + 1;
+    }
+
+private:
+    std::vector<uint32_t> m_Timestamps;
+    uint32_t m_CacheSize;
+    uint32_t m_Time;
+};
+
+glm::vec3 ReadPosition(std::span<const std::byte> vertexData, uint32_t vertexStride, uint32_t vertex)
+{
+    float position[3];
+    std::memcpy(position, vertexData.data() + uint64_t(vertex) * vertexStride, sizeof(position));
+    return glm::vec3(position[0], position[1], position[2]);
+}
+}
+
+Oglre::VertexCacheStatistics Oglre::MeshOptimizer::AnalyzeVertexCache(std::span<const uint32_t> indices, uint32_t vertexCount, uint32_t cacheSize)
+{
+    VertexCacheStatistics statistics;
+    if (indices.size() < 3) {
+        return statistics;
+    }
+
+    VertexCacheSimulator cache(vertexCount, cacheSize);
+    std::vector<bool> isReferenced(vertexCount, false);
+    uint32_t referencedCount = 0;
+
+    for (uint32_t index : indices) {
+        statistics.transformedVertices += cache.Access(index);
+
+        if (!isReferenced[index]) {
+            isReferenced[index] = true;
+            ++referencedCount;
+        }
+    }
+
+    statistics.acmr = static_cast<float>(statistics.transformedVertices) / static_cast<float>(indices.size() / 3);
+    statistics.atvr = static_cast<float>(statistics.transformedVertices) / static_cast<float>(referencedCount);
+
+    return statistics;
+}
+
+void Oglre::MeshOptimizer::OptimizeVertexCache(std::span<uint32_t> indices, uint32_t vertexCount, uint32_t cacheSize)
+{
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) {
+        return;
+    }
+
+    // Triangles using each vertex, and how many of them are yet to be emitted.
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for (uint32_t index : indices) {
+        ++liveTriangles[index];
+    }
+
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    std::inclusive_scan(liveTriangles.begin(), liveTriangles.end(), adjacencyOffsets.begin() + 1);
+
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> fillOffsets(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+        for (size_t corner = 0; corner < 3; ++corner) {
+            adjacency[fillOffsets[indices[triangle * 3 + corner]]++] = static_cast<uint32_t>(triangle);
+        }
+    }
+
+    VertexCacheSimulator cache(vertexCount, cacheSize);
+    std::vector<bool> isEmitted(triangleCount, false);
+    std::vector<uint32_t> deadEndStack;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    deadEndStack.reserve(triangleCount * 3);
+    output.reserve(triangleCount * 3);
+
+    // Next vertex to try once both the candidates and the dead-end stack are exhausted.
+    uint32_t cursor = 0;
+    const auto nextUnfinishedVertex = [&]() {
+        while (cursor < vertexCount && liveTriangles[cursor] == 0) {
+            ++cursor;
+        }
+        return cursor < vertexCount ? cursor : invalidVertex;
+    };
+
+    uint32_t fanningVertex = nextUnfinishedVertex();
+    while (fanningVertex != invalidVertex) {
+        // Emit every remaining triangle around the fanning vertex.
+        candidates.clear();
+        for (uint32_t i = adjacencyOffsets[fanningVertex]; i < adjacencyOffsets[fanningVertex + 1]; ++i) {
+            const uint32_t triangle = adjacency[i];
+            if (isEmitted[triangle]) {
+                continue;
+            }
+
+            for (size_t corner = 0; corner < 3; ++corner) {
+                const uint32_t vertex = indices[triangle * 3 + corner];
+                output.push_back(vertex);
+                deadEndStack.push_back(vertex);
+                candidates.push_back(vertex);
+                --liveTriangles[vertex];
+                cache.Access(vertex);
+            }
+            isEmitted[triangle] = true;
+        }
+
+        // Fan around the oldest candidate that will still be cached once all of its triangles are emitted.
+        // Candidates that would not be get priority 0, but are still better than jumping elsewhere.
+        uint32_t bestVertex = invalidVertex;
+        int64_t bestPriority = -1;
+        for (uint32_t vertex : candidates) {
+            if (liveTriangles[vertex] == 0) {
+                continue;
+            }
+
+            int64_t priority = 0;
+            if (cache.IsCached(vertex) && cache.GetAge(vertex) + 2 * liveTriangles[vertex] <= cacheSize) {
+                priority = cache.GetAge(vertex);
+            }
+
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                bestVertex = vertex;
+            }
+        }
+
+        // Dead end: go back to the most recently used vertex with triangles left, which is likely still cached.
+        while (bestVertex == invalidVertex && !deadEndStack.empty()) {
+            const uint32_t vertex = deadEndStack.back();
+            deadEndStack.pop_back();
+            if (liveTriangles[vertex] > 0) {
+                bestVertex = vertex;
+            }
+        }
+
+        fanningVertex = bestVertex != invalidVertex ? bestVertex : nextUnfinishedVertex();
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void Oglre::MeshOptimizer::OptimizeOverdraw(std::span<uint32_t> indices, std::span<const std::byte> vertexData, uint32_t vertexStride,
+    float threshold, uint32_t cacheSize)
+{
+    const size_t triangleCount = indices.size() / 3;
+    const uint32_t vertexCount = static_cast<uint32_t>(vertexData.size() / vertexStride);
+    if (triangleCount < 2) {
+        return;
+    }
+
+    // Hard boundaries, where the cache is cold anyway: triangles whose three vertices all miss.
+    std::vector<uint8_t> triangleMisses(triangleCount);
+    std::vector<uint32_t> hardBoundaries;
+    {
+        VertexCacheSimulator cache(vertexCount, cacheSize);
+        for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+            triangleMisses[triangle] = static_cast<uint8_t>(cache.AccessTriangle(&indices[triangle * 3]));
+            if (triangle == 0 || triangleMisses[triangle] == 3) {
+                hardBoundaries.push_back(static_cast<uint32_t>(triangle));
+            }
+        }
+        hardBoundaries.push_back(static_cast<uint32_t>(triangleCount));
+    }
+
+    // Soft boundaries. Within each hard cluster, split wherever the part since the last split, drawn with a cold cache,
+    // has an ACMR within threshold of the whole cluster's. Splitting there loses at most that much cache efficiency.
+    std::vector<uint32_t> clusterStarts;
+    {
+        VertexCacheSimulator cache(vertexCount, cacheSize);
+        for (size_t cluster = 0; cluster + 1 < hardBoundaries.size(); ++cluster) {
+            const uint32_t start = hardBoundaries[cluster];
+            const uint32_t end = hardBoundaries[cluster + 1];
+
+            uint32_t clusterMisses = 0;
+            for (uint32_t triangle = start; triangle < end; ++triangle) {
+                clusterMisses += triangleMisses[triangle];
+            }
+            const float acmrLimit = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+            cache.Flush();
+            clusterStarts.push_back(start);
+
+            uint32_t splitStart = start;
+            uint32_t splitMisses = 0;
+            for (uint32_t triangle = start; triangle + 1 < end; ++triangle) {
+                splitMisses += cache.AccessTriangle(&indices[triangle * 3]);
+
+                if (static_cast<float>(splitMisses) <= acmrLimit * static_cast<float>(triangle + 1 - splitStart)) {
+                    splitStart = triangle + 1;
+                    splitMisses = 0;
+                    clusterStarts.push_back(splitStart);
+                    cache.Flush();
+                }
+            }
+        }
+        clusterStarts.push_back(static_cast<uint32_t>(triangleCount));
+    }
+
+    const size_t clusterCount = clusterStarts.size() - 1;
+    if (clusterCount < 2) {
+        return;
+    }
+
+    // Area weighted centroid and normal of each cluster. Clusters facing away from the mesh's centroid are likely to
+    // occlude the rest of the mesh, so they are drawn first.
+    std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.0f));
+    std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+
+    for (size_t cluster = 0; cluster < clusterCount; ++cluster) {
+        float clusterArea = 0.0f;
+
+        for (uint32_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; ++triangle) {
+            const glm::vec3 a = ReadPosition(vertexData, vertexStride, indices[triangle * 3 + 0]);
+            const glm::vec3 b = ReadPosition(vertexData, vertexStride, indices[triangle * 3 + 1]);
+            const glm::vec3 c = ReadPosition(vertexData, vertexStride, indices[triangle * 3 + 2]);
+
+            const glm::vec3 normal = glm::cross(b - a, c - a);
+            const float area = glm::length(normal);
+
+            clusterCentroids[cluster] += (a + b + c) * (area / 3.0f);
+            clusterNormals[cluster] += normal;
+            clusterArea += area;
+        }
+
+        meshCentroid += clusterCentroids[cluster];
+        meshArea += clusterArea;
+
+        if (clusterArea > 0.0f) {
+            clusterCentroids[cluster] /= clusterArea;
+        }
+    }
+
+    if (meshArea > 0.0f) {
+        meshCentroid /= meshArea;
+    }
+
+    std::vector<float> sortKeys(clusterCount);
+    for (size_t cluster = 0; cluster < clusterCount; ++cluster) {
+        const float normalLength = glm::length(clusterNormals[cluster]);
+        const glm::vec3 normal = normalLength > 0.0f ? clusterNormals[cluster] / normalLength : glm::vec3(0.0f);
+        sortKeys[cluster] = glm::dot(clusterCentroids[cluster] - meshCentroid, normal);
+    }
+
+    std::vector<uint32_t> clusterOrder(clusterCount);
+    std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&sortKeys](uint32_t a, uint32_t b) {
+        return sortKeys[a] > sortKeys[b];
+    });
+
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+    for (uint32_t cluster : clusterOrder) {
+        output.insert(output.end(), indices.begin() + clusterStarts[cluster] * 3, indices.begin() + clusterStarts[cluster + 1] * 3);
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+uint32_t Oglre::MeshOptimizer::OptimizeVertexFetch(std::span<std::byte> vertexData, uint32_t vertexStride, std::span<uint32_t> indices)
+{
+    const uint32_t vertexCount = static_cast<uint32_t>(vertexData.size() / vertexStride);
+
+    std::vector<uint32_t> remap(vertexCount, invalidVertex);
+    uint32_t referencedCount = 0;
+
+    for (uint32_t& index : indices) {
+        if (remap[index] == invalidVertex) {
+            remap[index] = referencedCount++;
+        }
+        index = remap[index];
+    }
+
+    uint32_t unreferencedVertex = referencedCount;
+    for (uint32_t& newVertex : remap) {
+        if (newVertex == invalidVertex) {
+            newVertex = unreferencedVertex++;
+        }
+    }
+
+    std::vector<std::byte> reordered(vertexData.size());
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex) {
+        std::memcpy(reordered.data() + uint64_t(remap[vertex]) * vertexStride, vertexData.data() + uint64_t(vertex) * vertexStride, vertexStride);
+    }
+    std::copy(reordered.begin(), reordered.end(), vertexData.begin());
+
+    return referencedCount;
+}
+
+Oglre::MeshOptimizationReport Oglre::MeshOptimizer::Optimize(std::span<std::byte> vertexData, uint32_t vertexStride, std::span<uint32_t> indices)
+{
+    const uint32_t vertexCount = static_cast<uint32_t>(vertexData.size() / vertexStride);
+
+    MeshOptimizationReport report;
+    report.before = AnalyzeVertexCache(indices, vertexCount);
+
+    OptimizeVertexCache(indices, vertexCount);
+    OptimizeOverdraw(indices, vertexData, vertexStride);
+    report.vertexCount = OptimizeVertexFetch(vertexData, vertexStride, indices);
+
+    report.after = AnalyzeVertexCache(indices, report.vertexCount);
+    report.indexType = SelectIndexType(report.vertexCount);
+
+    return report;
+}
+
+GLenum Oglre::MeshOptimizer::SelectIndexType(uint32_t vertexCount)
+{
+    if (vertexCount <= 0x100) {
+        return GL_UNSIGNED_BYTE;
+    }
+    if (vertexCount <= 0x10000) {
+        return GL_UNSIGNED_SHORT;
+    }
+    return GL_UNSIGNED_INT;
+}
+
+std::vector<std::byte> Oglre::MeshOptimizer::PackIndices(std::span<const uint32_t> indices, GLenum indexType)
+{
+    std::vector<std::byte> packed(indices.size() * VertexBufferElement::GetSizeOfType(indexType));
+
+    const auto pack = [&]<typename T>(T*) {
+        for (size_t i = 0; i < indices.size(); ++i) {
+            const T index = static_cast<T>(indices[i]);
+            std::memcpy(packed.data() + i * sizeof(T), &index, sizeof(T));
+        }
+    };
+
+    switch (indexType) {
+        case GL_UNSIGNED_BYTE:  pack(static_cast<uint8_t*>(nullptr)); break;
+        case GL_UNSIGNED_SHORT: pack(static_cast<uint16_t*>(nullptr)); break;
+        default:                std::memcpy(packed.data(), indices.data(), indices.size_bytes()); break;
+    }
+
+    return packed;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Oglre {
+
+// Post-transform vertex cache efficiency of an index order, simulated with a FIFO cache.
+struct VertexCacheStatistics {
+    uint32_t transformedVertices = 0; // Cache misses, i.e. vertex shader invocations.
+    float acmr = 0.0f; // Average cache miss ratio: transformed vertices per triangle. 0.5 is ideal, 3 is worst.
+    float atvr = 0.0f; // Average transformed vertex ratio: transformed vertices per referenced vertex. 1 is ideal.
+};
+
+// Before and after figures of MeshOptimizer::Optimize().
+struct MeshOptimizationReport {
+    VertexCacheStatistics before;
+    VertexCacheStatistics after;
+    uint32_t vertexCount = 0; // After unreferenced vertices were dropped.
+    GLenum indexType = GL_UNSIGNED_INT; // Narrowest index type that can address vertexCount vertices.
+};
+
+// --------------
+// Mesh Optimizer
+// --------------
+//
+// Reorders indexed triangle lists so the GPU does less work drawing them. The passes should run in this order, as
+// each one keeps what the previous one achieved:
+//  1. OptimizeVertexCache(): triangle order for post-transform vertex cache hits (Tipsify, Sander et al. 2007).
+//  2. OptimizeOverdraw(): cluster order so outward facing clusters are drawn first and occlude the rest.
+//  3. OptimizeVertexFetch(): vertex order matching first use, so vertex fetches walk memory linearly.
+// Every pass is a permutation, the rendered result does not change.
+class MeshOptimizer {
+public:
+    // Matches the FIFO size Tipsify was tuned for. Modern GPUs do not have a fixed FIFO, but orders that do well on one
+    // do well on their batch-based reuse too.
+    static constexpr uint32_t defaultCacheSize = 16;
+
+    // Simulates drawing indices through a FIFO vertex cache of cacheSize entries.
+    static VertexCacheStatistics AnalyzeVertexCache(std::span<const uint32_t> indices, uint32_t vertexCount, uint32_t cacheSize = defaultCacheSize);
+
+    // Reorders triangles in place for vertex cache reuse. Runs in time linear in the number of triangles.
+    static void OptimizeVertexCache(std::span<uint32_t> indices, uint32_t vertexCount, uint32_t cacheSize = defaultCacheSize);
+
+    // Reorders clusters of triangles in place to reduce overdraw. Clusters are split wherever the vertex cache would be
+    // cold anyway, and, where it costs no more than threshold times the cache misses, in between. So threshold trades
+    // vertex cache efficiency (1.0 keeps it intact) for overdraw.
+    // Positions are read from the first 3 floats of each vertexStride sized vertex in vertexData.
+    static void OptimizeOverdraw(std::span<uint32_t> indices, std::span<const std::byte> vertexData, uint32_t vertexStride,
+        float threshold = 1.05f, uint32_t cacheSize = defaultCacheSize);
+
+    // Reorders vertices in place into the order the indices first use them, and rewrites the indices to match.
+    // Unreferenced vertices are moved to the end. Returns the number of referenced vertices, the rest can be dropped.
+    static uint32_t OptimizeVertexFetch(std::span<std::byte> vertexData, uint32_t vertexStride, std::span<uint32_t> indices);
+
+    // Runs all three passes and reports the vertex cache figures before and after. Positions are read as for
+    // OptimizeOverdraw(). vertexData should be resized to report.vertexCount vertices afterwards.
+    static MeshOptimizationReport Optimize(std::span<std::byte> vertexData, uint32_t vertexStride, std::span<uint32_t> indices);
+
+    // ---------------
+    // Index Narrowing
+    // ---------------
+
+    // GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, whichever is the smallest that can index vertexCount vertices.
+    static GLenum SelectIndexType(uint32_t vertexCount);
+
+    // Converts indices to indexType, which must be able to hold every index.
+    static std::vector<std::byte> PackIndices(std::span<const uint32_t> indices, GLenum indexType);
+};
+}
@@ -0,0 +1,463 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace {
+// Boundary planes are weighted this much more than the triangles' own planes, so borders keep their shape.
+constexpr double borderWeight = 10.0;
+
+// Rejects collapses that turn a triangle's normal by more than about 75 degrees, i.e. cos(normal change) < 0.25.
+constexpr float minimumNormalCosine = 0.25f;
+
+constexpr uint32_t maximumPassCount = 128;
+
+// Sum of squared distances to a set of weighted planes, as the symmetric 4x4 matrix of Garland and Heckbert. Dividing
+// by the total weight gives the mean squared distance, so costs do not depend on how finely the mesh is tessellated.
+struct Quadric {
+    double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+    double b2 = 0.0, bc = 0.0, bd = 0.0;
+    double c2 = 0.0, cd = 0.0;
+    double d2 = 0.0;
+    double weight = 0.0;
+
+    // Plane through point with unit normal.
+    void AddPlane(const glm::vec3& normal, const glm::vec3& point, double planeWeight)
+    {
+        const double a = normal.x;
+        const double b = normal.y;
+        const double c = normal.z;
+        const double d = -(a * point.x + b * point.y + c * point.z);
+
+        a2 += planeWeight * a * a;
+        ab += planeWeight * a * b;
+        ac += planeWeight * a * c;
+        ad += planeWeight * a * d;
+        b2 += planeWeight * b * b;
+        bc += planeWeight * b * c;
+        bd += planeWeight * b * d;
+        c2 += planeWeight * c * c;
+        cd += planeWeight * c * d;
+        d2 += planeWeight * d * d;
+        weight += planeWeight;
+    }
+
+    void Add(const Quadric& other)
+    {
+        a2 += other.a2;
+        ab += other.ab;
+        ac += other.ac;
+        ad += other.ad;
+        b2 += other.b2;
+        bc += other.bc;
+        bd += other.bd;
+        c2 += other.c2;
+        cd += other.cd;
+        d2 += other.d2;
+        weight += other.weight;
+    }
+
+    double Evaluate(const glm::vec3& point) const
+    {
+        const double x = point.x;
+        const double y = point.y;
+        const double z = point.z;
+
+        const double error = a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x
+            + b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y
+            + c2 * z * z + 2.0 * cd * z
+            + d2;
+
+        return std::max(error, 0.0);
+    }
+};
+
+struct Collapse {
+    uint32_t source;
+    uint32_t target;
+    float cost; // Mean squared distance.
+};
+
+glm::vec3 ReadPosition(std::span<const std::byte> vertexData, uint32_t vertexStride, uint32_t vertex)
+{
+    float position[3];
+    std::memcpy(position, vertexData.data() + uint64_t(vertex) * vertexStride, sizeof(position));
+    return glm::vec3(position[0], position[1], position[2]);
+}
+
+// For every vertex, the first vertex at the same position, so vertices split by seams can be treated as one.
+std::vector<uint32_t> FindPositionGroups(const std::vector<glm::vec3>& positions)
+{
+    std::vector<uint32_t> order(positions.size());
+    std::iota(order.begin(), order.end(), 0u);
+
+    const auto isLess = [&positions](uint32_t left, uint32_t right) {
+        const glm::vec3& a = positions[left];
+        const glm::vec3& b = positions[right];
+        if (a.x != b.x) {
+            return a.x < b.x;
+        }
+        if (a.y != b.y) {
+            return a.y < b.y;
+        }
+        if (a.z != b.z) {
+            return a.z < b.z;
+        }
+        return left < right;
+    };
+    std::sort(order.begin(), order.end(), isLess);
+
+    std::vector<uint32_t> groups(positions.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        const bool isSame = i > 0 && positions[order[i]] == positions[order[i - 1]];
+        groups[order[i]] = isSame ? groups[order[i - 1]] : order[i];
+    }
+
+    return groups;
+}
+
+// Triangle planes weighted by area, and planes perpendicular to open borders, accumulated per position group.
+std::vector<Quadric> ComputeQuadrics(std::span<const uint32_t> indices, const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& groups)
+{
+    std::vector<Quadric> quadrics(positions.size());
+
+    // Edges between position groups, smallest group first, to find the ones only one triangle uses.
+    struct Edge {
+        uint64_t key;
+        uint32_t triangle;
+    };
+    std::vector<Edge> edges;
+    edges.reserve(indices.size());
+
+    for (size_t triangle = 0; triangle < indices.size() / 3; ++triangle) {
+        const uint32_t* corners = &indices[triangle * 3];
+        const glm::vec3& p0 = positions[corners[0]];
+        const glm::vec3 normal = glm::cross(positions[corners[1]] - p0, positions[corners[2]] - p0);
+        const float doubleArea = glm::length(normal);
+        if (doubleArea == 0.0f) {
+            continue;
+        }
+
+        Quadric quadric;
+        quadric.AddPlane(normal / doubleArea, p0, 0.5 * doubleArea);
+        for (int corner = 0; corner < 3; ++corner) {
+            quadrics[groups[corners[corner]]].Add(quadric);
+
+            const uint32_t from = groups[corners[corner]];
+            const uint32_t to = groups[corners[(corner + 1) % 3]];
+            edges.push_back({ (uint64_t(std::min(from, to)) << 32) | std::max(from, to), static_cast<uint32_t>(triangle) });
+        }
+    }
+
+    std::sort(edges.begin(), edges.end(), [](const Edge& left, const Edge& right) { return left.key < right.key; });
+
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const bool isShared = (i > 0 && edges[i - 1].key == edges[i].key) || (i + 1 < edges.size() && edges[i + 1].key == edges[i].key);
+        if (isShared) {
+            continue;
+        }
+
+        const uint32_t* corners = &indices[uint64_t(edges[i].triangle) * 3];
+        const glm::vec3& p0 = positions[corners[0]];
+        const glm::vec3 triangleNormal = glm::normalize(glm::cross(positions[corners[1]] - p0, positions[corners[2]] - p0));
+
+        const uint32_t from = static_cast<uint32_t>(edges[i].key >> 32);
+        const uint32_t to = static_cast<uint32_t>(edges[i].key);
+        const glm::vec3 edge = positions[to] - positions[from];
+        const glm::vec3 borderNormal = glm::cross(edge, triangleNormal);
+        const float length = glm::length(borderNormal);
+        if (length == 0.0f) {
+            continue;
+        }
+
+        Quadric quadric;
+        quadric.AddPlane(borderNormal / length, positions[from], borderWeight * glm::dot(edge, edge));
+        quadrics[from].Add(quadric);
+        quadrics[to].Add(quadric);
+    }
+
+    return quadrics;
+}
+
+// Whether moving source onto target keeps every other triangle around source facing the same way.
+bool IsCollapseValid(std::span<const uint32_t> indices, std::span<const uint32_t> sourceTriangles, const std::vector<glm::vec3>& positions,
+    uint32_t source, uint32_t target)
+{
+    for (uint32_t triangle : sourceTriangles) {
+        const uint32_t* corners = &indices[uint64_t(triangle) * 3];
+        if (corners[0] == target || corners[1] == target || corners[2] == target) {
+            continue; // Collapses away.
+        }
+
+        glm::vec3 before[3];
+        glm::vec3 after[3];
+        for (int corner = 0; corner < 3; ++corner) {
+            before[corner] = positions[corners[corner]];
+            after[corner] = corners[corner] == source ? positions[target] : before[corner];
+        }
+
+        const glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+        const glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+        const float lengths = glm::length(normalBefore) * glm::length(normalAfter);
+        if (lengths == 0.0f || glm::dot(normalBefore, normalAfter) < minimumNormalCosine * lengths) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Vertex positions, read from the first 3 floats of each vertex.
+std::vector<glm::vec3> ReadPositions(std::span<const std::byte> vertexData, uint32_t vertexStride)
+{
+    const uint32_t vertexCount = static_cast<uint32_t>(vertexData.size() / vertexStride);
+
+    std::vector<glm::vec3> positions(vertexCount);
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex) {
+        positions[vertex] = ReadPosition(vertexData, vertexStride, vertex);
+    }
+
+    return positions;
+}
+
+// Degenerate triangles are dropped up front, every later step assumes three distinct corners.
+std::vector<uint32_t> DropDegenerateTriangles(std::span<const uint32_t> indices)
+{
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        if (indices[i] != indices[i + 1] && indices[i + 1] != indices[i + 2] && indices[i] != indices[i + 2]) {
+            result.insert(result.end(), { indices[i], indices[i + 1], indices[i + 2] });
+        }
+    }
+
+    return result;
+}
+
+// Collapses edges of result towards targetIndexCount indices. Every applied collapse adds its source's quadric to its
+// target's, so quadrics keep measuring distances from the planes of the mesh they were computed from, however many
+// times this runs on them. resultCost is raised to the most expensive applied collapse, as a mean squared distance.
+void CollapseEdges(std::vector<uint32_t>& result, const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& groups,
+    std::vector<Quadric>& quadrics, uint32_t targetIndexCount, double maximumCost, double& resultCost)
+{
+    const uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+
+    // Seam vertices are the ones whose position group has other members.
+    std::vector<bool> isSeam(vertexCount, false);
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex) {
+        if (groups[vertex] != vertex) {
+            isSeam[vertex] = true;
+            isSeam[groups[vertex]] = true;
+        }
+    }
+
+    std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+    std::vector<uint32_t> vertexTriangles;
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<bool> isLocked(vertexCount);
+    std::vector<Collapse> collapses;
+    std::vector<std::pair<uint32_t, uint32_t>> neighbours; // Neighbour and the number of triangles the edge to it is in.
+
+    // Each pass finds the cheapest collapse of every vertex, then applies as many as it can, cheapest first, without
+    // two collapses touching the same triangles. Cheaper than a priority queue, as no costs need updating within a pass.
+    for (uint32_t pass = 0; pass < maximumPassCount && result.size() > targetIndexCount; ++pass) {
+        // Triangles around each vertex.
+        std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0u);
+        for (uint32_t index : result) {
+            ++triangleOffsets[index + 1];
+        }
+        std::partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+
+        vertexTriangles.resize(result.size());
+        std::vector<uint32_t> cursors(triangleOffsets.begin(), triangleOffsets.end() - 1);
+        for (size_t i = 0; i < result.size(); ++i) {
+            vertexTriangles[cursors[result[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        const auto getTriangles = [&](uint32_t vertex) {
+            return std::span<const uint32_t>(vertexTriangles.data() + triangleOffsets[vertex], triangleOffsets[vertex + 1] - triangleOffsets[vertex]);
+        };
+
+        collapses.clear();
+        for (uint32_t source = 0; source < vertexCount; ++source) {
+            const std::span<const uint32_t> sourceTriangles = getTriangles(source);
+            if (isSeam[source] || sourceTriangles.empty()) {
+                continue;
+            }
+
+            neighbours.clear();
+            for (uint32_t triangle : sourceTriangles) {
+                for (int corner = 0; corner < 3; ++corner) {
+                    const uint32_t vertex = result[uint64_t(triangle) * 3 + corner];
+                    if (vertex == source) {
+                        continue;
+                    }
+
+                    auto neighbour = std::find_if(neighbours.begin(), neighbours.end(), [vertex](const auto& entry) { return entry.first == vertex; });
+                    if (neighbour == neighbours.end()) {
+                        neighbours.push_back({ vertex, 1 });
+                    } else {
+                        ++neighbour->second;
+                    }
+                }
+            }
+
+            // Edges in one triangle are open borders, in more than two the surface is not a manifold here.
+            bool isBorder = false;
+            bool isManifold = true;
+            for (const auto& [vertex, edgeTriangleCount] : neighbours) {
+                isBorder |= edgeTriangleCount == 1;
+                isManifold &= edgeTriangleCount <= 2;
+            }
+            if (!isManifold) {
+                continue;
+            }
+
+            Collapse best { source, source, std::numeric_limits<float>::infinity() };
+            for (const auto& [target, edgeTriangleCount] : neighbours) {
+                if (isBorder && edgeTriangleCount != 1) {
+                    continue;
+                }
+
+                Quadric quadric = quadrics[source];
+                quadric.Add(quadrics[groups[target]]);
+                const float cost = static_cast<float>(quadric.Evaluate(positions[target]) / std::max(quadric.weight, 1e-30));
+
+                if (cost < best.cost && IsCollapseValid(result, sourceTriangles, positions, source, target)) {
+                    best = { source, target, cost };
+                }
+            }
+
+            if (best.target != source) {
+                collapses.push_back(best);
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& left, const Collapse& right) { return left.cost < right.cost; });
+
+        // A collapse changes the triangles around its source, so none of their vertices may collapse in the same pass,
+        // and its target must still exist.
+        std::iota(remap.begin(), remap.end(), 0u);
+        std::fill(isLocked.begin(), isLocked.end(), false);
+
+        size_t indexCount = result.size();
+        uint32_t appliedCount = 0;
+        for (const Collapse& collapse : collapses) {
+            if (indexCount <= targetIndexCount || collapse.cost > maximumCost) {
+                break;
+            }
+            if (isLocked[collapse.source] || remap[collapse.target] != collapse.target) {
+                continue;
+            }
+
+            for (uint32_t triangle : getTriangles(collapse.source)) {
+                const uint32_t* corners = &result[uint64_t(triangle) * 3];
+                for (int corner = 0; corner < 3; ++corner) {
+                    isLocked[corners[corner]] = true;
+                }
+                if (corners[0] == collapse.target || corners[1] == collapse.target || corners[2] == collapse.target) {
+                    indexCount -= 3;
+                }
+            }
+
+            remap[collapse.source] = collapse.target;
+            quadrics[groups[collapse.target]].Add(quadrics[collapse.source]);
+            resultCost = std::max(resultCost, double(collapse.cost));
+            ++appliedCount;
+        }
+
+        if (appliedCount == 0) {
+            break;
+        }
+
+        // Targets never collapse in the same pass, so one remap lookup is enough.
+        size_t writeIndex = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            const uint32_t a = remap[result[i]];
+            const uint32_t b = remap[result[i + 1]];
+            const uint32_t c = remap[result[i + 2]];
+            if (a != b && b != c && a != c) {
+                result[writeIndex++] = a;
+                result[writeIndex++] = b;
+                result[writeIndex++] = c;
+            }
+        }
+        result.resize(writeIndex);
+    }
+}
+}
+
+// ---------------
+// Edge Collapsing
+// ---------------
+
+std::vector<uint32_t> Oglre::MeshSimplifier::Simplify(std::span<const uint32_t> indices, std::span<const std::byte> vertexData, uint32_t vertexStride,
+    uint32_t targetIndexCount, float maximumError, float* error)
+{
+    const std::vector<glm::vec3> positions = ReadPositions(vertexData, vertexStride);
+    std::vector<uint32_t> result = DropDegenerateTriangles(indices);
+
+    const std::vector<uint32_t> groups = FindPositionGroups(positions);
+    std::vector<Quadric> quadrics = ComputeQuadrics(result, positions, groups);
+
+    double resultCost = 0.0;
+    CollapseEdges(result, positions, groups, quadrics, targetIndexCount, double(maximumError) * double(maximumError), resultCost);
+
+    if (error != nullptr) {
+        *error = static_cast<float>(std::sqrt(resultCost));
+    }
+
+    return result;
+}
+
+// ---------------
+// Level Of Detail
+// ---------------
+
+Oglre::LodChain Oglre::MeshSimplifier::GenerateLodChain(std::span<const uint32_t> indices, std::span<const std::byte> vertexData, uint32_t vertexStride,
+    const LodChainSettings& settings)
+{
+    const std::vector<glm::vec3> positions = ReadPositions(vertexData, vertexStride);
+    const uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+
+    LodChain chain;
+    chain.indices.assign(indices.begin(), indices.end());
+    chain.lods.push_back({ 0, static_cast<uint32_t>(indices.size()), 0.0f });
+
+    // The full mesh's quadrics carry on from level to level, so every level's error is measured from the full mesh.
+    std::vector<uint32_t> previous = DropDegenerateTriangles(indices);
+    const std::vector<uint32_t> groups = FindPositionGroups(positions);
+    std::vector<Quadric> quadrics = ComputeQuadrics(previous, positions, groups);
+    double chainCost = 0.0;
+
+    while (chain.lods.size() < settings.maximumLodCount) {
+        const uint32_t targetTriangleCount = static_cast<uint32_t>(previous.size() / 3 * settings.reduction);
+        if (targetTriangleCount < settings.minimumTriangleCount) {
+            break;
+        }
+
+        std::vector<uint32_t> simplified = previous;
+        CollapseEdges(simplified, positions, groups, quadrics, targetTriangleCount * 3, std::numeric_limits<double>::infinity(), chainCost);
+
+        // A level that saves less than half of what was asked for is not worth drawing, the mesh is as simple as the
+        // locked seams and borders allow.
+        if (simplified.size() > (previous.size() + uint64_t(targetTriangleCount) * 3) / 2) {
+            break;
+        }
+
+        MeshOptimizer::OptimizeVertexCache(simplified, vertexCount);
+
+        const float error = static_cast<float>(std::sqrt(chainCost));
+        chain.lods.push_back({ static_cast<uint32_t>(chain.indices.size()), static_cast<uint32_t>(simplified.size()), error });
+        chain.indices.insert(chain.indices.end(), simplified.begin(), simplified.end());
+
+        previous = std::move(simplified);
+    }
+
+    return chain;
+}
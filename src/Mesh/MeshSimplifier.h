@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "MeshLod.h"
+
+namespace Oglre {
+
+struct LodChainSettings {
+    uint32_t maximumLodCount = 5; // Including the full mesh.
+    float reduction = 0.5f; // Each level aims for this fraction of the previous level's triangles.
+    uint32_t minimumTriangleCount = 32; // No level is made with fewer triangles than this.
+};
+
+// ---------------
+// Mesh Simplifier
+// ---------------
+//
+// Removes triangles from indexed triangle lists by collapsing edges, cheapest first by the quadric error metric
+// (Garland and Heckbert 1997). Every collapse moves one vertex onto one of its neighbours, so the simplified indices
+// still index the original vertices, and every level of detail of a mesh can share its vertex buffer.
+//
+// Positions are read from the first 3 floats of each vertexStride sized vertex. Vertices that share a position with
+// another vertex, i.e. lie on a normal or texture coordinate seam, never move, so seams do not tear open. Open borders
+// only collapse along themselves. Collapses that would flip a triangle over are skipped.
+//
+// Errors are quadric errors: the root mean square distance of a moved vertex from the planes of the triangles it has
+// absorbed, weighted by their areas, for the vertex that strayed furthest. It is an estimate rather than a bound, as a
+// vertex can stray further from one of its planes than from their mean.
+class MeshSimplifier {
+public:
+    // Simplifies indices towards targetIndexCount indices, stopping early if the next collapse would cost more than
+    // maximumError, in the mesh's units. If error is not null, it is set to the error of the result from indices.
+    static std::vector<uint32_t> Simplify(std::span<const uint32_t> indices, std::span<const std::byte> vertexData, uint32_t vertexStride,
+        uint32_t targetIndexCount, float maximumError = std::numeric_limits<float>::infinity(), float* error = nullptr);
+
+    // Simplifies a mesh into a chain of levels of detail, each from the previous one, until a level cannot be made
+    // smaller. The first level is the mesh itself, the others are optimized for the vertex cache. A level's error is
+    // measured from the full mesh, not from the previous level, and never falls from one level to the next.
+    static LodChain GenerateLodChain(std::span<const uint32_t> indices, std::span<const std::byte> vertexData, uint32_t vertexStride,
+        const LodChainSettings& settings = {});
+};
+}
@@ -0,0 +1,601 @@
+#include "VertexQuantizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define OGLRE_QUANTIZER_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define OGLRE_QUANTIZER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+// Same results as _mm_min_ps() and _mm_max_ps(), including for NaN, which ends up as the second argument.
+inline float Minimum(float a, float b)
+{
+    return a < b ? a : b;
+}
+
+inline float Maximum(float a, float b)
+{
+    return a > b ? a : b;
+}
+
+// Rounds to nearest even, like the SIMD conversions do in the default rounding mode.
+inline int32_t QuantizeComponent(float value, float low, float high, float scale)
+{
+    return static_cast<int32_t>(std::nearbyint(Maximum(Minimum(value, high), low) * scale));
+}
+
+// Scale and range of the x, y, z and w fields of a 10_10_10_2 format.
+struct Packed10_10_10_2Format {
+    float low;
+    float scale;
+    float wScale;
+};
+
+constexpr Packed10_10_10_2Format snorm10_10_10_2 = { -1.0f, 511.0f, 1.0f };
+constexpr Packed10_10_10_2Format unorm10_10_10_2 = { 0.0f, 1023.0f, 3.0f };
+
+// The largest finite half. Larger values, infinities included, are clamped to it.
+constexpr float halfMaximum = 65504.0f;
+
+inline float GetComponent(const float* vertex, uint32_t component, uint32_t componentCount)
+{
+    return component < componentCount ? vertex[component] : (component == 3 ? 1.0f : 0.0f);
+}
+
+uint32_t Pack10_10_10_2(const float* vertex, uint32_t componentCount, const Packed10_10_10_2Format& format)
+{
+    uint32_t packed = 0;
+    for (uint32_t component = 0; component < 3; ++component) {
+        const int32_t value = QuantizeComponent(GetComponent(vertex, component, componentCount), format.low, 1.0f, format.scale);
+        packed |= (static_cast<uint32_t>(value) & 0x3FF) << (component * 10);
+    }
+
+    const int32_t w = QuantizeComponent(GetComponent(vertex, 3, componentCount), format.low, 1.0f, format.wScale);
+    return packed | (static_cast<uint32_t>(w) & 0x3) << 30;
+}
+
+#ifdef OGLRE_QUANTIZER_SSE2
+// Quantizes one component of 4 consecutive vertices.
+inline __m128i Quantize10_10_10_2FieldSse2(const float* vertices, uint32_t component, uint32_t componentCount, float low, float scale)
+{
+    __m128 values;
+    if (component < componentCount) {
+        values = _mm_setr_ps(vertices[component], vertices[componentCount + component], vertices[2 * componentCount + component], vertices[3 * componentCount + component]);
+    } else {
+        values = _mm_set1_ps(component == 3 ? 1.0f : 0.0f);
+    }
+    values = _mm_max_ps(_mm_min_ps(values, _mm_set1_ps(1.0f)), _mm_set1_ps(low));
+    return _mm_cvtps_epi32(_mm_mul_ps(values, _mm_set1_ps(scale)));
+}
+
+// 4 vertices at a time, with the source de-interleaved into one register per component.
+size_t Pack10_10_10_2Sse2(const float* source, uint32_t componentCount, uint32_t* destination, size_t vertexCount, const Packed10_10_10_2Format& format)
+{
+    const __m128i fieldMask = _mm_set1_epi32(0x3FF);
+
+    size_t vertex = 0;
+    for (; vertex + 4 <= vertexCount; vertex += 4) {
+        const float* vertices = source + vertex * componentCount;
+
+        const __m128i x = Quantize10_10_10_2FieldSse2(vertices, 0, componentCount, format.low, format.scale);
+        const __m128i y = Quantize10_10_10_2FieldSse2(vertices, 1, componentCount, format.low, format.scale);
+        const __m128i z = Quantize10_10_10_2FieldSse2(vertices, 2, componentCount, format.low, format.scale);
+        const __m128i w = Quantize10_10_10_2FieldSse2(vertices, 3, componentCount, format.low, format.wScale);
+
+        const __m128i xy = _mm_or_si128(_mm_and_si128(x, fieldMask), _mm_slli_epi32(_mm_and_si128(y, fieldMask), 10));
+        const __m128i zw = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(z, fieldMask), 20), _mm_slli_epi32(w, 30));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + vertex), _mm_or_si128(xy, zw));
+    }
+
+    return vertex;
+}
+
+// FloatToHalf() on 4 floats, with the same bits for every input: round to nearest even, halves below 2^-14 rounded
+// with the same 0.5 addition, and NaN kept quiet. Results are in the low 16 bits, sign extended so that
+// _mm_packs_epi32() keeps them as they are.
+inline __m128i FloatToHalfSse2(__m128 value)
+{
+    // The limit goes first, as _mm_min_ps() and _mm_max_ps() return their second argument for NaN.
+    const __m128 limit = _mm_set1_ps(halfMaximum);
+    value = _mm_max_ps(_mm_xor_ps(limit, _mm_set1_ps(-0.0f)), _mm_min_ps(limit, value));
+
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 sign = _mm_and_ps(value, signMask);
+    const __m128 magnitude = _mm_xor_ps(value, sign);
+    const __m128i magnitudeBits = _mm_castps_si128(magnitude);
+
+    // Below 2^-14, as in FloatToHalf().
+    const __m128i subnormalBias = _mm_set1_epi32(0x3F000000);
+    const __m128i isSubnormal = _mm_cmplt_epi32(magnitudeBits, _mm_set1_epi32(0x38800000));
+    const __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(magnitude, _mm_castsi128_ps(subnormalBias))), subnormalBias);
+
+    // Normal, as in FloatToHalf(): rebias, and round the 13 dropped mantissa bits to nearest even.
+    const __m128i isMantissaOdd = _mm_and_si128(_mm_srli_epi32(magnitudeBits, 13), _mm_set1_epi32(1));
+    const __m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(magnitudeBits, _mm_set1_epi32(static_cast<int>(0xC8000FFF))), isMantissaOdd), 13);
+
+    const __m128i isNan = _mm_castps_si128(_mm_cmpunord_ps(magnitude, magnitude));
+    const __m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+    const __m128i half = _mm_or_si128(_mm_and_si128(isNan, _mm_set1_epi32(0x7E00)), _mm_andnot_si128(isNan, finite));
+
+    return _mm_or_si128(half, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+}
+
+size_t PackHalfSse2(const float* source, uint16_t* destination, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i a = FloatToHalfSse2(_mm_loadu_ps(source + i));
+        const __m128i b = FloatToHalfSse2(_mm_loadu_ps(source + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packs_epi32(a, b));
+    }
+
+    return i;
+}
+
+size_t PackSnorm16Sse2(const float* source, int16_t* destination, size_t count)
+{
+    const __m128 low = _mm_set1_ps(-1.0f);
+    const __m128 high = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(32767.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128 a = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(source + i), high), low);
+        const __m128 b = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(source + i + 4), high), low);
+        const __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(a, scale)), _mm_cvtps_epi32(_mm_mul_ps(b, scale)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), packed);
+    }
+
+    return i;
+}
+
+size_t PackUnorm16Sse2(const float* source, uint16_t* destination, size_t count)
+{
+    const __m128 low = _mm_set1_ps(0.0f);
+    const __m128 high = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(65535.0f);
+
+    // SSE2 can only pack with signed saturation, so pack value - 32768 and flip the sign bit back.
+    const __m128i bias = _mm_set1_epi32(32768);
+    const __m128i signBit = _mm_set1_epi16(static_cast<int16_t>(0x8000));
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128 a = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(source + i), high), low);
+        const __m128 b = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(source + i + 4), high), low);
+        const __m128i aInteger = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(a, scale)), bias);
+        const __m128i bInteger = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(b, scale)), bias);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_xor_si128(_mm_packs_epi32(aInteger, bInteger), signBit));
+    }
+
+    return i;
+}
+#endif
+
+#ifdef OGLRE_QUANTIZER_AVX2
+bool HasAvx2()
+{
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+    return hasAvx2;
+}
+
+__attribute__((target("avx2,f16c"))) size_t PackHalfAvx2(const float* source, uint16_t* destination, size_t count)
+{
+    // Clamped first, the limit as the first argument so that NaN passes through.
+    const __m256 high = _mm256_set1_ps(halfMaximum);
+    const __m256 low = _mm256_set1_ps(-halfMaximum);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 value = _mm256_max_ps(low, _mm256_min_ps(high, _mm256_loadu_ps(source + i)));
+        const __m128i packed = _mm256_cvtps_ph(value, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), packed);
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2,f16c"))) size_t PackSnorm16Avx2(const float* source, int16_t* destination, size_t count)
+{
+    const __m256 low = _mm256_set1_ps(-1.0f);
+    const __m256 high = _mm256_set1_ps(1.0f);
+    const __m256 scale = _mm256_set1_ps(32767.0f);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256 a = _mm256_max_ps(_mm256_min_ps(_mm256_loadu_ps(source + i), high), low);
+        const __m256 b = _mm256_max_ps(_mm256_min_ps(_mm256_loadu_ps(source + i + 8), high), low);
+        const __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(a, scale)), _mm256_cvtps_epi32(_mm256_mul_ps(b, scale)));
+
+        // Packing works within 128-bit lanes, which leaves the 64-bit quarters in a, b, a, b order.
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2,f16c"))) size_t PackUnorm16Avx2(const float* source, uint16_t* destination, size_t count)
+{
+    const __m256 low = _mm256_set1_ps(0.0f);
+    const __m256 high = _mm256_set1_ps(1.0f);
+    const __m256 scale = _mm256_set1_ps(65535.0f);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256 a = _mm256_max_ps(_mm256_min_ps(_mm256_loadu_ps(source + i), high), low);
+        const __m256 b = _mm256_max_ps(_mm256_min_ps(_mm256_loadu_ps(source + i + 8), high), low);
+        const __m256i packed = _mm256_packus_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(a, scale)), _mm256_cvtps_epi32(_mm256_mul_ps(b, scale)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+
+    return i;
+}
+
+// Quantizes one component of 8 consecutive vertices.
+__attribute__((target("avx2,f16c"))) __m256i Quantize10_10_10_2FieldAvx2(const float* vertices, uint32_t component, uint32_t componentCount,
+    __m256i vertexOffsets, float low, float scale)
+{
+    __m256 values;
+    if (component < componentCount) {
+        values = _mm256_i32gather_ps(vertices + component, vertexOffsets, 4);
+    } else {
+        values = _mm256_set1_ps(component == 3 ? 1.0f : 0.0f);
+    }
+    values = _mm256_max_ps(_mm256_min_ps(values, _mm256_set1_ps(1.0f)), _mm256_set1_ps(low));
+    return _mm256_cvtps_epi32(_mm256_mul_ps(values, _mm256_set1_ps(scale)));
+}
+
+// 8 vertices at a time, gathering one register per component.
+__attribute__((target("avx2,f16c"))) size_t Pack10_10_10_2Avx2(const float* source, uint32_t componentCount, uint32_t* destination,
+    size_t vertexCount, const Packed10_10_10_2Format& format)
+{
+    const __m256i fieldMask = _mm256_set1_epi32(0x3FF);
+    const __m256i vertexOffsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(componentCount)));
+
+    size_t vertex = 0;
+    for (; vertex + 8 <= vertexCount; vertex += 8) {
+        const float* vertices = source + vertex * componentCount;
+
+        const __m256i x = Quantize10_10_10_2FieldAvx2(vertices, 0, componentCount, vertexOffsets, format.low, format.scale);
+        const __m256i y = Quantize10_10_10_2FieldAvx2(vertices, 1, componentCount, vertexOffsets, format.low, format.scale);
+        const __m256i z = Quantize10_10_10_2FieldAvx2(vertices, 2, componentCount, vertexOffsets, format.low, format.scale);
+        const __m256i w = Quantize10_10_10_2FieldAvx2(vertices, 3, componentCount, vertexOffsets, format.low, format.wScale);
+
+        const __m256i xy = _mm256_or_si256(_mm256_and_si256(x, fieldMask), _mm256_slli_epi32(_mm256_and_si256(y, fieldMask), 10));
+        const __m256i zw = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(z, fieldMask), 20), _mm256_slli_epi32(w, 30));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + vertex), _mm256_or_si256(xy, zw));
+    }
+
+    return vertex;
+}
+#endif
+
+void Pack10_10_10_2(std::span<const float> source, uint32_t componentCount, std::span<uint32_t> destination, const Packed10_10_10_2Format& format)
+{
+    const size_t vertexCount = source.size() / componentCount;
+    size_t vertex = 0;
+
+#ifdef OGLRE_QUANTIZER_AVX2
+    if (HasAvx2()) {
+        vertex = Pack10_10_10_2Avx2(source.data(), componentCount, destination.data(), vertexCount, format);
+    }
+#endif
+#ifdef OGLRE_QUANTIZER_SSE2
+    vertex += Pack10_10_10_2Sse2(source.data() + vertex * componentCount, componentCount, destination.data() + vertex, vertexCount - vertex, format);
+#endif
+
+    for (; vertex < vertexCount; ++vertex) {
+        destination[vertex] = Pack10_10_10_2(source.data() + vertex * componentCount, componentCount, format);
+    }
+}
+
+// Sign extends the bits wide field starting at shift.
+inline int32_t ExtractSigned(uint32_t packed, uint32_t shift, uint32_t bits)
+{
+    return static_cast<int32_t>(packed << (32 - shift - bits)) >> (32 - bits);
+}
+
+inline uint32_t ExtractUnsigned(uint32_t packed, uint32_t shift, uint32_t bits)
+{
+    return (packed >> shift) & ((1u << bits) - 1);
+}
+}
+
+void Oglre::VertexQuantizer::PackHalf(std::span<const float> source, std::span<uint16_t> destination)
+{
+    size_t i = 0;
+
+#ifdef OGLRE_QUANTIZER_AVX2
+    if (HasAvx2()) {
+        i = PackHalfAvx2(source.data(), destination.data(), source.size());
+    }
+#endif
+#ifdef OGLRE_QUANTIZER_SSE2
+    i += PackHalfSse2(source.data() + i, destination.data() + i, source.size() - i);
+#endif
+
+    for (; i < source.size(); ++i) {
+        destination[i] = FloatToHalf(source[i]);
+    }
+}
+
+void Oglre::VertexQuantizer::PackSnorm16(std::span<const float> source, std::span<int16_t> destination)
+{
+    size_t i = 0;
+
+#ifdef OGLRE_QUANTIZER_AVX2
+    if (HasAvx2()) {
+        i = PackSnorm16Avx2(source.data(), destination.data(), source.size());
+    }
+#endif
+#ifdef OGLRE_QUANTIZER_SSE2
+    i += PackSnorm16Sse2(source.data() + i, destination.data() + i, source.size() - i);
+#endif
+
+    for (; i < source.size(); ++i) {
+        destination[i] = static_cast<int16_t>(QuantizeComponent(source[i], -1.0f, 1.0f, 32767.0f));
+    }
+}
+
+void Oglre::VertexQuantizer::PackUnorm16(std::span<const float> source, std::span<uint16_t> destination)
+{
+    size_t i = 0;
+
+#ifdef OGLRE_QUANTIZER_AVX2
+    if (HasAvx2()) {
+        i = PackUnorm16Avx2(source.data(), destination.data(), source.size());
+    }
+#endif
+#ifdef OGLRE_QUANTIZER_SSE2
+    i += PackUnorm16Sse2(source.data() + i, destination.data() + i, source.size() - i);
+#endif
+
+    for (; i < source.size(); ++i) {
+        destination[i] = static_cast<uint16_t>(QuantizeComponent(source[i], 0.0f, 1.0f, 65535.0f));
+    }
+}
+
+void Oglre::VertexQuantizer::PackSnorm10_10_10_2(std::span<const float> source, uint32_t componentCount, std::span<uint32_t> destination)
+{
+    Pack10_10_10_2(source, componentCount, destination, snorm10_10_10_2);
+}
+
+void Oglre::VertexQuantizer::PackUnorm10_10_10_2(std::span<const float> source, uint32_t componentCount, std::span<uint32_t> destination)
+{
+    Pack10_10_10_2(source, componentCount, destination, unorm10_10_10_2);
+}
+
+uint16_t Oglre::VertexQuantizer::FloatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t magnitude = bits & 0x7FFFFFFF;
+
+    // NaN, kept quiet.
+    if (magnitude > 0x7F800000) {
+        return static_cast<uint16_t>(sign | 0x7E00);
+    }
+
+    // 65504 and up, infinity included, clamp to the largest finite half.
+    if (magnitude >= 0x477FE000) {
+        return static_cast<uint16_t>(sign | 0x7BFF);
+    }
+
+    // Below the smallest normal half, 2^-14. Adding 0.5 lines the float's mantissa up with the half's, and the FPU's
+    // round to nearest even does the rounding.
+    if (magnitude < 0x38800000) {
+        float shifted;
+        std::memcpy(&shifted, &magnitude, sizeof(shifted));
+        shifted += 0.5f;
+
+        uint32_t shiftedBits;
+        std::memcpy(&shiftedBits, &shifted, sizeof(shiftedBits));
+        return static_cast<uint16_t>(sign | (shiftedBits - 0x3F000000));
+    }
+
+    // Normal: rebias the exponent from 127 to 15, and round the 13 dropped mantissa bits to nearest even.
+    const uint32_t isMantissaOdd = (magnitude >> 13) & 1;
+    magnitude += 0xC8000FFF + isMantissaOdd;
+    return static_cast<uint16_t>(sign | (magnitude >> 13));
+}
+
+float Oglre::VertexQuantizer::HalfToFloat(uint16_t value)
+{
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1F;
+    const uint32_t mantissa = value & 0x3FF;
+
+    if (exponent == 0) {
+        const float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign != 0 ? -magnitude : magnitude;
+    }
+
+    const uint32_t bits = exponent == 0x1F ? sign | 0x7F800000 | (mantissa << 13) : sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+void Oglre::VertexQuantizer::UnpackAttribute(const VertexBufferElement& element, const std::byte* source, float* destination)
+{
+    const auto read = [source]<typename T>(T, uint32_t component) {
+        T value;
+        std::memcpy(&value, source + component * sizeof(T), sizeof(T));
+        return value;
+    };
+
+    if (VertexBufferElement::IsPackedType(element.type)) {
+        const uint32_t packed = read(uint32_t(), 0);
+        for (uint32_t component = 0; component < 4; ++component) {
+            const uint32_t bits = component == 3 ? 2 : 10;
+
+            if (element.type == GL_INT_2_10_10_10_REV) {
+                const float value = static_cast<float>(ExtractSigned(packed, component * 10, bits));
+                destination[component] = element.normalized ? std::max(value / (component == 3 ? 1.0f : 511.0f), -1.0f) : value;
+            } else {
+                const float value = static_cast<float>(ExtractUnsigned(packed, component * 10, bits));
+                destination[component] = element.normalized ? value / (component == 3 ? 3.0f : 1023.0f) : value;
+            }
+        }
+        return;
+    }
+
+    for (uint32_t component = 0; component < element.count; ++component) {
+        float value = 0.0f;
+
+        switch (element.type) {
+            case GL_FLOAT:
+                value = read(float(), component);
+                break;
+            case GL_HALF_FLOAT:
+                value = HalfToFloat(read(uint16_t(), component));
+                break;
+            case GL_SHORT:
+                value = read(int16_t(), component);
+                value = element.normalized ? std::max(value / 32767.0f, -1.0f) : value;
+                break;
+            case GL_UNSIGNED_SHORT:
+                value = read(uint16_t(), component);
+                value = element.normalized ? value / 65535.0f : value;
+                break;
+            case GL_UNSIGNED_INT:
+                value = static_cast<float>(read(uint32_t(), component));
+                break;
+            case GL_UNSIGNED_BYTE:
+                value = read(uint8_t(), component);
+                value = element.normalized ? value / 255.0f : value;
+                break;
+        }
+
+        destination[component] = value;
+    }
+}
+
+bool Oglre::VertexQuantizer::Quantize(const VertexBufferLayout& layout, std::span<const std::byte> vertexData, std::span<const GLenum> attributeTypes,
+    VertexBufferLayout& quantizedLayout, std::vector<std::byte>& quantizedData, std::vector<QuantizationError>* errors)
+{
+    const auto& elements = layout.GetElements();
+    const uint32_t stride = layout.GetStride();
+    const size_t vertexCount = stride == 0 ? 0 : vertexData.size() / stride;
+
+    // Work out the quantized layout first, so nothing is written if a conversion is not possible.
+    quantizedLayout = VertexBufferLayout();
+    for (size_t attribute = 0; attribute < elements.size(); ++attribute) {
+        const VertexBufferElement& element = elements[attribute];
+        const GLenum type = attribute < attributeTypes.size() ? attributeTypes[attribute] : GL_FLOAT;
+
+        if (element.type != GL_FLOAT || type == GL_FLOAT) {
+            quantizedLayout.Push(element);
+        } else if (VertexBufferElement::IsPackedType(type)) {
+            quantizedLayout.Push({ type, 4, GL_TRUE, element.divisor });
+        } else if (type == GL_HALF_FLOAT || type == GL_SHORT || type == GL_UNSIGNED_SHORT) {
+            // Round up to a multiple of 4 bytes.
+            quantizedLayout.Push({ type, (element.count + 1) & ~1u, static_cast<unsigned char>(type == GL_HALF_FLOAT ? GL_FALSE : GL_TRUE), element.divisor });
+        } else {
+            std::cout << "Vertex attribute " << attribute << " can not be quantized to type " << type << std::endl;
+            return false;
+        }
+    }
+
+    const auto& quantizedElements = quantizedLayout.GetElements();
+    const uint32_t quantizedStride = quantizedLayout.GetStride();
+    quantizedData.assign(vertexCount * quantizedStride, std::byte(0));
+
+    if (errors != nullptr) {
+        errors->clear();
+    }
+
+    uint32_t offset = 0;
+    uint32_t quantizedOffset = 0;
+    std::vector<float> stream;
+    std::vector<std::byte> packed;
+
+    for (size_t attribute = 0; attribute < elements.size(); ++attribute) {
+        const VertexBufferElement& element = elements[attribute];
+        const VertexBufferElement& quantizedElement = quantizedElements[attribute];
+        const uint32_t size = element.GetSize();
+        const uint32_t quantizedSize = quantizedElement.GetSize();
+
+        if (quantizedElement.type == element.type) {
+            for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+                std::memcpy(quantizedData.data() + vertex * quantizedStride + quantizedOffset, vertexData.data() + vertex * stride + offset, size);
+            }
+        } else {
+            // De-interleave the attribute into one float stream, with the components the packers read per vertex.
+            const bool isPacked = VertexBufferElement::IsPackedType(quantizedElement.type);
+            const uint32_t streamCount = isPacked ? element.count : quantizedElement.count;
+
+            stream.resize(vertexCount * streamCount);
+            for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+                float* streamVertex = stream.data() + vertex * streamCount;
+                std::memcpy(streamVertex, vertexData.data() + vertex * stride + offset, size);
+                for (uint32_t component = element.count; component < streamCount; ++component) {
+                    streamVertex[component] = component == 3 ? 1.0f : 0.0f;
+                }
+            }
+
+            packed.resize(vertexCount * quantizedSize);
+            switch (quantizedElement.type) {
+                case GL_HALF_FLOAT:
+                    PackHalf(stream, std::span(reinterpret_cast<uint16_t*>(packed.data()), stream.size()));
+                    break;
+                case GL_SHORT:
+                    PackSnorm16(stream, std::span(reinterpret_cast<int16_t*>(packed.data()), stream.size()));
+                    break;
+                case GL_UNSIGNED_SHORT:
+                    PackUnorm16(stream, std::span(reinterpret_cast<uint16_t*>(packed.data()), stream.size()));
+                    break;
+                case GL_INT_2_10_10_10_REV:
+                    PackSnorm10_10_10_2(stream, streamCount, std::span(reinterpret_cast<uint32_t*>(packed.data()), vertexCount));
+                    break;
+                case GL_UNSIGNED_INT_2_10_10_10_REV:
+                    PackUnorm10_10_10_2(stream, streamCount, std::span(reinterpret_cast<uint32_t*>(packed.data()), vertexCount));
+                    break;
+            }
+
+            for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+                std::memcpy(quantizedData.data() + vertex * quantizedStride + quantizedOffset, packed.data() + vertex * quantizedSize, quantizedSize);
+            }
+
+            // Compare what the GPU will read with the original floats. Padding components are not part of the error.
+            if (errors != nullptr) {
+                QuantizationError error;
+                error.attribute = static_cast<uint32_t>(attribute);
+                error.type = quantizedElement.type;
+
+                double squaredErrorSum = 0.0;
+                float unpacked[4];
+                for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+                    UnpackAttribute(quantizedElement, packed.data() + vertex * quantizedSize, unpacked);
+
+                    for (uint32_t component = 0; component < element.count; ++component) {
+                        const float difference = std::abs(unpacked[component] - stream[vertex * streamCount + component]);
+                        error.maximumError = std::max(error.maximumError, difference);
+                        squaredErrorSum += double(difference) * difference;
+                    }
+                }
+
+                const size_t componentCount = vertexCount * element.count;
+                error.rmsError = componentCount == 0 ? 0.0f : static_cast<float>(std::sqrt(squaredErrorSum / componentCount));
+                errors->push_back(error);
+            }
+        }
+
+        offset += size;
+        quantizedOffset += quantizedSize;
+    }
+
+    return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "VertexBufferLayout.h"
+
+namespace Oglre {
+
+// How far an attribute's quantized values are from the floats they were packed from, in the attribute's own units.
+struct QuantizationError {
+    uint32_t attribute = 0; // Index in the source layout.
+    GLenum type = GL_FLOAT;
+    float maximumError = 0.0f;
+    float rmsError = 0.0f;
+};
+
+// ----------------
+// Vertex Quantizer
+// ----------------
+//
+// Converts float vertex attributes into smaller formats, to cut the memory and bandwidth vertex fetching costs:
+//  GL_HALF_FLOAT: 2 bytes per component, ~3 significant digits for magnitudes from 2^-14 (6.1e-5) to 65504, fewer
+//   below as halves go subnormal. Larger values clamp to 65504, keeping their sign. Texture coordinates, small positions.
+//  GL_SHORT / GL_UNSIGNED_SHORT: normalized, 2 bytes per component for values in [-1, 1] / [0, 1].
+//  GL_INT_2_10_10_10_REV / GL_UNSIGNED_INT_2_10_10_10_REV: normalized, 4 bytes for all 4 components. Normals, colours.
+// Values outside a format's range are clamped, which shows up in the error report.
+//
+// The bulk packers use AVX2 + F16C where the CPU has them, checked once at runtime, SSE2 on other x86-64 CPUs and plain
+// C++ elsewhere. Every path rounds to nearest even, so they all produce the same bits for the same input, NaN payloads aside.
+class VertexQuantizer {
+public:
+    // Bulk packers. destination must be at least as large as source, except for the 10_10_10_2 packers, which pack every
+    // componentCount (1 to 4) source floats into one value. Missing components are 0, except w, which is 1.
+    static void PackHalf(std::span<const float> source, std::span<uint16_t> destination);
+    static void PackSnorm16(std::span<const float> source, std::span<int16_t> destination);
+    static void PackUnorm16(std::span<const float> source, std::span<uint16_t> destination);
+    static void PackSnorm10_10_10_2(std::span<const float> source, uint32_t componentCount, std::span<uint32_t> destination);
+    static void PackUnorm10_10_10_2(std::span<const float> source, uint32_t componentCount, std::span<uint32_t> destination);
+
+    static uint16_t FloatToHalf(float value);
+    static float HalfToFloat(uint16_t value);
+
+    // Decodes one attribute of any type VertexBufferElement supports into floats, the way the GPU reads it.
+    // Writes element.count floats to destination.
+    static void UnpackAttribute(const VertexBufferElement& element, const std::byte* source, float* destination);
+
+    // Converts each GL_FLOAT attribute i of layout to attributeTypes[i], which is GL_FLOAT to leave it as is.
+    // Attributes that are not GL_FLOAT are copied unchanged. 2 byte formats are padded to a multiple of 4 bytes, so every
+    // attribute stays 4 byte aligned. Returns false, and reports to std::cout, if a conversion is not possible.
+    static bool Quantize(const VertexBufferLayout& layout, std::span<const std::byte> vertexData, std::span<const GLenum> attributeTypes,
+        VertexBufferLayout& quantizedLayout, std::vector<std::byte>& quantizedData, std::vector<QuantizationError>* errors = nullptr);
+};
+}
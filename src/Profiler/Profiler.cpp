@@ -0,0 +1,374 @@
+#include "Profiler.h"
+
+#include <GL/glew.h>
+
+#include "imgui.h"
+
+#include <algorithm>
+#include <iomanip>
+
+const std::array<uint32_t, 4> Oglre::Profiler::pipelineStatisticTargets = {
+    GL_VERTICES_SUBMITTED_ARB,
+    GL_PRIMITIVES_SUBMITTED_ARB,
+    GL_VERTEX_SHADER_INVOCATIONS_ARB,
+    GL_FRAGMENT_SHADER_INVOCATIONS_ARB
+};
+
+const std::array<const char*, 4> Oglre::Profiler::pipelineStatisticNames = {
+    "Vertices Submitted",
+    "Primitives Submitted",
+    "Vertex Shader Invocations",
+    "Fragment Shader Invocations"
+};
+
+// ----------------
+// Profiler History
+// ----------------
+
+void Oglre::ProfilerHistory::Push(float sample)
+{
+    m_Samples[m_Next] = sample;
+    m_Next = (m_Next + 1) % historyLength;
+    m_Count = std::min(m_Count + 1, historyLength);
+}
+
+Oglre::ProfilerStatistics Oglre::ProfilerHistory::GetStatistics() const
+{
+    ProfilerStatistics statistics;
+    if (m_Count == 0) {
+        return statistics;
+    }
+
+    std::array<float, historyLength> sorted;
+    std::copy(m_Samples.begin(), m_Samples.begin() + m_Count, sorted.begin());
+
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < m_Count; ++i) {
+        sum += sorted[i];
+    }
+
+    // Only the 99th percentile needs to be in place, no need for a full sort.
+    const uint32_t p99Index = (m_Count * 99) / 100;
+    std::nth_element(sorted.begin(), sorted.begin() + p99Index, sorted.begin() + m_Count);
+
+    statistics.latest = m_Samples[(m_Next + historyLength - 1) % historyLength];
+    statistics.minimum = *std::min_element(sorted.begin(), sorted.begin() + m_Count);
+    statistics.average = sum / m_Count;
+    statistics.p99 = sorted[p99Index];
+
+    return statistics;
+}
+
+// ----------------
+// Frame Boundaries
+// ----------------
+
+void Oglre::Profiler::BeginFrame()
+{
+    if (!m_isInitialized) {
+        m_isPipelineStatisticsSupported = GLEW_ARB_pipeline_statistics_query;
+        m_isInitialized = true;
+    }
+
+    // The slot about to be reused was submitted frameLatency frames ago, so its results are almost always ready.
+    FrameQueries& queries = m_frameQueries[m_frameIndex % frameLatency];
+    ResolveQueries(queries);
+
+    if (m_isPipelineStatisticsSupported) {
+        if (queries.pipelineQueries.empty()) {
+            queries.pipelineQueries.resize(pipelineStatisticTargets.size());
+            glGenQueries(static_cast<int>(queries.pipelineQueries.size()), queries.pipelineQueries.data());
+        }
+
+        for (size_t i = 0; i < pipelineStatisticTargets.size(); ++i) {
+            glBeginQuery(pipelineStatisticTargets[i], queries.pipelineQueries[i]);
+        }
+        queries.hasPipelineQueries = true;
+    }
+
+    BeginScope("Frame");
+}
+
+void Oglre::Profiler::EndFrame()
+{
+    // Close anything left open, "Frame" included.
+    while (!m_activeScopes.empty()) {
+        EndScope();
+    }
+
+    if (m_isPipelineStatisticsSupported) {
+        for (uint32_t target : pipelineStatisticTargets) {
+            glEndQuery(target);
+        }
+    }
+
+    for (Scope& scope : m_scopes) {
+        if (scope.wasEntered) {
+            scope.cpuHistory.Push(static_cast<float>(scope.cpuTime));
+        }
+
+        scope.cpuTime = 0.0;
+        scope.wasEntered = false;
+    }
+
+    for (Counter& counter : m_counters) {
+        if (counter.wasSet) {
+            counter.history.Push(static_cast<float>(counter.value));
+        }
+
+        counter.wasSet = false;
+    }
+
+    ++m_frameIndex;
+}
+
+void Oglre::Profiler::Shutdown()
+{
+    for (FrameQueries& queries : m_frameQueries) {
+        glDeleteQueries(static_cast<int>(queries.timerQueries.size()), queries.timerQueries.data());
+        glDeleteQueries(static_cast<int>(queries.pipelineQueries.size()), queries.pipelineQueries.data());
+
+        queries = FrameQueries();
+    }
+}
+
+// ------
+// Scopes
+// ------
+
+void Oglre::Profiler::BeginScope(const char* name, bool timeGPU)
+{
+    const uint32_t scopeIndex = GetScopeIndex(name);
+
+    // GL_TIME_ELAPSED queries cannot be nested, so only the outermost GPU scope gets a query.
+    const bool timesGPU = timeGPU && m_activeGPUScopes++ == 0;
+    if (timesGPU) {
+        FrameQueries& queries = m_frameQueries[m_frameIndex % frameLatency];
+        if (queries.usedTimerQueries == queries.timerQueries.size()) {
+            uint32_t queryID = 0;
+            glGenQueries(1, &queryID);
+
+            queries.timerQueries.push_back(queryID);
+            queries.timerScopes.push_back(0);
+        }
+
+        queries.timerScopes[queries.usedTimerQueries] = scopeIndex;
+        glBeginQuery(GL_TIME_ELAPSED, queries.timerQueries[queries.usedTimerQueries]);
+        ++queries.usedTimerQueries;
+    }
+
+    m_activeScopes.push_back({ scopeIndex, Clock::now(), timeGPU });
+}
+
+void Oglre::Profiler::EndScope()
+{
+    if (m_activeScopes.empty()) {
+        return;
+    }
+
+    const ActiveScope activeScope = m_activeScopes.back();
+    m_activeScopes.pop_back();
+
+    if (activeScope.timesGPU && --m_activeGPUScopes == 0) {
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+
+    Scope& scope = m_scopes[activeScope.scopeIndex];
+    scope.cpuTime += std::chrono::duration<double, std::milli>(Clock::now() - activeScope.startTime).count();
+    scope.wasEntered = true;
+}
+
+void Oglre::Profiler::SetCounter(const char* name, double value)
+{
+    auto it = m_counterIndices.find(name);
+    if (it == m_counterIndices.end()) {
+        it = m_counterIndices.emplace(name, static_cast<uint32_t>(m_counters.size())).first;
+        m_counters.push_back({ name });
+    }
+
+    Counter& counter = m_counters[it->second];
+    counter.value = value;
+    counter.wasSet = true;
+}
+
+double Oglre::Profiler::GetCounter(const char* name)
+{
+    const auto it = m_counterIndices.find(name);
+    if (it == m_counterIndices.end() || !m_counters[it->second].wasSet) {
+        return 0.0;
+    }
+
+    return m_counters[it->second].value;
+}
+
+uint32_t Oglre::Profiler::GetScopeIndex(const char* name)
+{
+    // The address only caches the lookup, a different name at the same address, e.g. in a reused buffer, falls through.
+    const auto literal = m_scopeLiteralIndices.find(name);
+    if (literal != m_scopeLiteralIndices.end() && m_scopes[literal->second].name == name) {
+        return literal->second;
+    }
+
+    auto it = m_scopeIndices.find(name);
+    if (it == m_scopeIndices.end()) {
+        it = m_scopeIndices.emplace(name, static_cast<uint32_t>(m_scopes.size())).first;
+
+        Scope scope;
+        scope.name = name;
+        scope.depth = static_cast<uint32_t>(m_activeScopes.size());
+        m_scopes.push_back(scope);
+    }
+
+    m_scopeLiteralIndices[name] = it->second;
+    return it->second;
+}
+
+void Oglre::Profiler::ResolveQueries(FrameQueries& queries)
+{
+    // Results that are still not available are dropped rather than waited on.
+    for (uint32_t i = 0; i < queries.usedTimerQueries; ++i) {
+        int isAvailable = GL_FALSE;
+        glGetQueryObjectiv(queries.timerQueries[i], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+        if (isAvailable) {
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(queries.timerQueries[i], GL_QUERY_RESULT, &nanoseconds);
+
+            m_scopes[queries.timerScopes[i]].gpuHistory.Push(static_cast<float>(nanoseconds / 1.0e6));
+        }
+    }
+    queries.usedTimerQueries = 0;
+
+    if (queries.hasPipelineQueries) {
+        for (size_t i = 0; i < queries.pipelineQueries.size(); ++i) {
+            int isAvailable = GL_FALSE;
+            glGetQueryObjectiv(queries.pipelineQueries[i], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+            if (isAvailable) {
+                GLuint64 result = 0;
+                glGetQueryObjectui64v(queries.pipelineQueries[i], GL_QUERY_RESULT, &result);
+                m_pipelineStatistics[i] = result;
+            }
+        }
+        queries.hasPipelineQueries = false;
+    }
+}
+
+// ---------
+// Reporting
+// ---------
+
+Oglre::ProfilerStatistics Oglre::Profiler::GetCPUStatistics(const char* name)
+{
+    const auto it = m_scopeIndices.find(name);
+    return it == m_scopeIndices.end() ? ProfilerStatistics() : m_scopes[it->second].cpuHistory.GetStatistics();
+}
+
+Oglre::ProfilerStatistics Oglre::Profiler::GetGPUStatistics(const char* name)
+{
+    const auto it = m_scopeIndices.find(name);
+    return it == m_scopeIndices.end() ? ProfilerStatistics() : m_scopes[it->second].gpuHistory.GetStatistics();
+}
+
+void Oglre::Profiler::DrawImGuiWindow()
+{
+    ImGui::Begin("Profiler");
+
+    if (!m_scopes.empty()) {
+        const ProfilerHistory& frameHistory = m_scopes[0].cpuHistory;
+        ImGui::PlotLines("Frame (ms)", frameHistory.GetSamples(), frameHistory.GetCount(), frameHistory.GetOffset(), nullptr, 0.0f, 33.3f, ImVec2(0, 60));
+    }
+
+    if (ImGui::BeginTable("Scopes", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Scope");
+        ImGui::TableSetupColumn("CPU min");
+        ImGui::TableSetupColumn("CPU avg");
+        ImGui::TableSetupColumn("CPU p99");
+        ImGui::TableSetupColumn("GPU min");
+        ImGui::TableSetupColumn("GPU avg");
+        ImGui::TableSetupColumn("GPU p99");
+        ImGui::TableHeadersRow();
+
+        for (const Scope& scope : m_scopes) {
+            const ProfilerStatistics cpu = scope.cpuHistory.GetStatistics();
+            const ProfilerStatistics gpu = scope.gpuHistory.GetStatistics();
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%*s%s", scope.depth * 2, "", scope.name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", cpu.minimum);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", cpu.average);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", cpu.p99);
+
+            if (scope.gpuHistory.IsEmpty()) {
+                for (int column = 0; column < 3; ++column) {
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted("-");
+                }
+            } else {
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", gpu.minimum);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", gpu.average);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", gpu.p99);
+            }
+        }
+
+        ImGui::EndTable();
+    }
+
+    if (!m_counters.empty() && ImGui::CollapsingHeader("Counters")) {
+        for (const Counter& counter : m_counters) {
+            const ProfilerStatistics statistics = counter.history.GetStatistics();
+            ImGui::Text("%s: %.0f (avg %.1f)", counter.name.c_str(), statistics.latest, statistics.average);
+        }
+    }
+
+    if (ImGui::CollapsingHeader("Pipeline Statistics")) {
+        if (m_isPipelineStatisticsSupported) {
+            for (size_t i = 0; i < m_pipelineStatistics.size(); ++i) {
+                ImGui::Text("%s: %llu", pipelineStatisticNames[i], static_cast<unsigned long long>(m_pipelineStatistics[i]));
+            }
+        } else {
+            ImGui::TextUnformatted("GL_ARB_pipeline_statistics_query is not supported by the driver.");
+        }
+    }
+
+    ImGui::End();
+}
+
+void Oglre::Profiler::PrintReport(std::ostream& stream)
+{
+    // Restored at the end, so that whatever the caller prints next is not rounded to the report's precision.
+    const std::streamsize previousPrecision = stream.precision();
+
+    stream << std::fixed << std::setprecision(3);
+    stream << "Profiler report over the last " << (m_scopes.empty() ? 0 : m_scopes[0].cpuHistory.GetCount()) << " frames (ms)\n";
+
+    for (const Scope& scope : m_scopes) {
+        const ProfilerStatistics cpu = scope.cpuHistory.GetStatistics();
+        stream << std::string(scope.depth * 2, ' ') << scope.name << ": CPU min " << cpu.minimum << " avg " << cpu.average << " p99 " << cpu.p99;
+
+        if (!scope.gpuHistory.IsEmpty()) {
+            const ProfilerStatistics gpu = scope.gpuHistory.GetStatistics();
+            stream << " | GPU min " << gpu.minimum << " avg " << gpu.average << " p99 " << gpu.p99;
+        }
+        stream << "\n";
+    }
+
+    stream << std::setprecision(1);
+    for (const Counter& counter : m_counters) {
+        const ProfilerStatistics statistics = counter.history.GetStatistics();
+        stream << counter.name << ": " << statistics.latest << " (avg " << statistics.average << ")\n";
+    }
+
+    if (m_isPipelineStatisticsSupported) {
+        for (size_t i = 0; i < m_pipelineStatistics.size(); ++i) {
+            stream << pipelineStatisticNames[i] << ": " << m_pipelineStatistics[i] << "\n";
+        }
+    }
+
+    stream << std::defaultfloat << std::setprecision(previousPrecision);
+}
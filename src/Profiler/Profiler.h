@@ -0,0 +1,171 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Oglre {
+
+// Summary of a value (time in ms, or a counter) over the most recent frames.
+struct ProfilerStatistics {
+    float latest = 0.0f;
+    float minimum = 0.0f;
+    float average = 0.0f;
+    float p99 = 0.0f;
+};
+
+// Fixed-size ring of per-frame samples. No allocations once constructed.
+class ProfilerHistory {
+public:
+    static constexpr uint32_t historyLength = 256;
+
+    void Push(float sample);
+    ProfilerStatistics GetStatistics() const;
+
+    inline bool IsEmpty() const
+    {
+        return m_Count == 0;
+    }
+
+    // Samples in chronological order, for ImGui::PlotLines().
+    inline const float* GetSamples() const
+    {
+        return m_Samples.data();
+    }
+
+    inline uint32_t GetCount() const
+    {
+        return m_Count;
+    }
+
+    inline uint32_t GetOffset() const
+    {
+        return m_Count < historyLength ? 0 : m_Next;
+    }
+
+private:
+    std::array<float, historyLength> m_Samples {};
+    uint32_t m_Count = 0;
+    uint32_t m_Next = 0;
+};
+
+// Query objects used during one frame. Reused once the frame is Profiler::frameLatency frames old.
+struct ProfilerFrameQueries {
+    std::vector<uint32_t> timerQueries;
+    std::vector<uint32_t> timerScopes;
+    uint32_t usedTimerQueries = 0;
+
+    std::vector<uint32_t> pipelineQueries;
+    bool hasPipelineQueries = false;
+};
+
+// Frame profiler with named, nestable CPU scopes and GL_TIME_ELAPSED timer queries for GPU passes.
+// GPU queries are kept in a ring that is frameLatency frames deep, and results are only read back once the
+// driver reports them as available, so the profiler never stalls the pipeline waiting on the GPU.
+// Must only be used from the thread that owns the OpenGL context.
+class Profiler {
+public:
+    static constexpr uint32_t frameLatency = 4;
+
+    static void BeginFrame();
+    static void EndFrame();
+
+    // Deletes the query objects. Must be called while the OpenGL context is still current.
+    static void Shutdown();
+
+    // Scopes are identified by name, and may be entered several times per frame (times are summed). name only needs
+    // to live until the call returns.
+    // GPU timing is meant for whole passes. Timer queries cannot overlap, so only the outermost GPU scope is timed.
+    static void BeginScope(const char* name, bool timeGPU = false);
+    static void EndScope();
+
+    // Per-frame values that are not times, e.g. draw calls or triangles.
+    static void SetCounter(const char* name, double value);
+
+    // The value a counter was set to this frame, 0 if it has not been set yet. Must be called before EndFrame().
+    static double GetCounter(const char* name);
+
+    // Draws the "Profiler" window. Must be called between ImGui::NewFrame() and ImGui::Render().
+    static void DrawImGuiWindow();
+
+    // Text version of the profiler window, for headless runs.
+    static void PrintReport(std::ostream& stream);
+
+    static ProfilerStatistics GetCPUStatistics(const char* name);
+    static ProfilerStatistics GetGPUStatistics(const char* name);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Scope {
+        std::string name;
+        uint32_t depth = 0;
+
+        // Accumulated over the current frame.
+        double cpuTime = 0.0;
+        bool wasEntered = false;
+
+        ProfilerHistory cpuHistory;
+        ProfilerHistory gpuHistory;
+    };
+
+    struct Counter {
+        std::string name;
+        double value = 0.0;
+        bool wasSet = false;
+
+        ProfilerHistory history;
+    };
+
+    struct ActiveScope {
+        uint32_t scopeIndex;
+        Clock::time_point startTime;
+        bool timesGPU;
+    };
+
+    using FrameQueries = ProfilerFrameQueries;
+
+    // Pipeline statistics that are queried over the whole frame when GL_ARB_pipeline_statistics_query is supported.
+    static const std::array<uint32_t, 4> pipelineStatisticTargets;
+    static const std::array<const char*, 4> pipelineStatisticNames;
+
+    static inline std::vector<Scope> m_scopes;
+    static inline std::unordered_map<std::string, uint32_t> m_scopeIndices;
+    static inline std::unordered_map<const char*, uint32_t> m_scopeLiteralIndices; // Skips hashing the name when its address was seen before, checked against the scope's name.
+    static inline std::vector<ActiveScope> m_activeScopes;
+
+    static inline std::vector<Counter> m_counters;
+    static inline std::unordered_map<std::string, uint32_t> m_counterIndices;
+
+    static inline std::array<FrameQueries, frameLatency> m_frameQueries;
+    static inline std::array<uint64_t, 4> m_pipelineStatistics {};
+    static inline uint64_t m_frameIndex = 0;
+    static inline uint32_t m_activeGPUScopes = 0;
+    static inline bool m_isInitialized = false;
+    static inline bool m_isPipelineStatisticsSupported = false;
+
+    static uint32_t GetScopeIndex(const char* name);
+    static void ResolveQueries(FrameQueries& queries);
+};
+
+// Times the enclosing block, e.g. { ProfileScope scope("Culling"); ... }.
+class ProfileScope {
+public:
+    ProfileScope(const char* name, bool timeGPU = false)
+    {
+        Profiler::BeginScope(name, timeGPU);
+    }
+
+    ~ProfileScope()
+    {
+        Profiler::EndScope();
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+}
@@ -0,0 +1,226 @@
+#include "GLStateCache.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+bool Oglre::GLStateCache::Update(uint32_t& cached, uint32_t value)
+{
+    if (cached == value) {
+        ++m_frameCounters.skipped;
+        return false;
+    }
+
+    cached = value;
+    ++m_frameCounters.issued;
+    return true;
+}
+
+// -------
+// Objects
+// -------
+
+void Oglre::GLStateCache::UseProgram(uint32_t program)
+{
+    if (Update(m_program, program)) {
+        glUseProgram(program);
+    }
+}
+
+void Oglre::GLStateCache::BindVertexArray(uint32_t vertexArray)
+{
+    if (Update(m_vertexArray, vertexArray)) {
+        glBindVertexArray(vertexArray);
+
+        // The element buffer binding of a VAO seen for the first time is not known, it may have been set elsewhere.
+        m_elementBuffers.try_emplace(vertexArray, unknown);
+    }
+}
+
+void Oglre::GLStateCache::BindBuffer(uint32_t target, uint32_t buffer)
+{
+    if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        // Binding an element buffer changes the currently bound VAO, so it is only cached while the VAO is known.
+        if (m_vertexArray == unknown) {
+            ++m_frameCounters.issued;
+            glBindBuffer(target, buffer);
+            return;
+        }
+
+        if (Update(m_elementBuffers[m_vertexArray], buffer)) {
+            glBindBuffer(target, buffer);
+        }
+        return;
+    }
+
+    const auto it = std::find(bufferTargets.begin(), bufferTargets.end(), target);
+    if (it == bufferTargets.end()) {
+        ++m_frameCounters.issued;
+        glBindBuffer(target, buffer);
+        return;
+    }
+
+    if (Update(m_buffers[it - bufferTargets.begin()], buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void Oglre::GLStateCache::BindBufferBase(uint32_t target, uint32_t index, uint32_t buffer)
+{
+    ++m_frameCounters.issued;
+    glBindBufferBase(target, index, buffer);
+
+    const auto it = std::find(bufferTargets.begin(), bufferTargets.end(), target);
+    if (it != bufferTargets.end()) {
+        m_buffers[it - bufferTargets.begin()] = buffer;
+    }
+}
+
+void Oglre::GLStateCache::BindBufferRange(uint32_t target, uint32_t index, uint32_t buffer, intptr_t offset, intptr_t size)
+{
+    ++m_frameCounters.issued;
+    glBindBufferRange(target, index, buffer, offset, size);
+
+    const auto it = std::find(bufferTargets.begin(), bufferTargets.end(), target);
+    if (it != bufferTargets.end()) {
+        m_buffers[it - bufferTargets.begin()] = buffer;
+    }
+}
+
+// --------------------
+// Fixed-function State
+// --------------------
+
+void Oglre::GLStateCache::SetCapability(uint32_t capability, bool enable)
+{
+    const auto it = std::find(capabilities.begin(), capabilities.end(), capability);
+    if (it != capabilities.end() && !Update(m_capabilities[it - capabilities.begin()], enable)) {
+        return;
+    }
+
+    if (enable) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+}
+
+void Oglre::GLStateCache::SetDepthMask(bool enable)
+{
+    if (Update(m_depthMask, enable)) {
+        glDepthMask(enable ? GL_TRUE : GL_FALSE);
+    }
+}
+
+void Oglre::GLStateCache::SetPolygonMode(uint32_t mode)
+{
+    if (Update(m_polygonMode, mode)) {
+        glPolygonMode(GL_FRONT_AND_BACK, mode);
+    }
+}
+
+void Oglre::GLStateCache::SetBlendFunction(uint32_t sourceFactor, uint32_t destinationFactor)
+{
+    if (m_blendFunction[0] == sourceFactor && m_blendFunction[1] == destinationFactor) {
+        ++m_frameCounters.skipped;
+        return;
+    }
+
+    m_blendFunction = { sourceFactor, destinationFactor };
+    ++m_frameCounters.issued;
+    glBlendFunc(sourceFactor, destinationFactor);
+}
+
+void Oglre::GLStateCache::SetViewport(int x, int y, int width, int height)
+{
+    const std::array<int, 4> viewport = { x, y, width, height };
+    if (m_viewport == viewport) {
+        ++m_frameCounters.skipped;
+        return;
+    }
+
+    m_viewport = viewport;
+    ++m_frameCounters.issued;
+    glViewport(x, y, width, height);
+}
+
+void Oglre::GLStateCache::SetViewportIndexed(uint32_t index, int x, int y, int width, int height)
+{
+    if (index == 0) {
+        SetViewport(x, y, width, height);
+        return;
+    }
+
+    ++m_frameCounters.issued;
+    glViewportIndexedf(index, static_cast<float>(x), static_cast<float>(y), static_cast<float>(width), static_cast<float>(height));
+}
+
+// --------
+// Deletion
+// --------
+
+void Oglre::GLStateCache::DeleteProgram(uint32_t program)
+{
+    glDeleteProgram(program);
+
+    if (m_program == program) {
+        m_program = unknown;
+    }
+}
+
+void Oglre::GLStateCache::DeleteVertexArray(uint32_t vertexArray)
+{
+    glDeleteVertexArrays(1, &vertexArray);
+
+    // Deleting the bound VAO reverts the binding to 0.
+    if (m_vertexArray == vertexArray) {
+        m_vertexArray = 0;
+    }
+    m_elementBuffers.erase(vertexArray);
+}
+
+void Oglre::GLStateCache::DeleteBuffer(uint32_t buffer)
+{
+    glDeleteBuffers(1, &buffer);
+
+    // Deleted buffers are unbound from the current context's targets, including the bound VAO's element buffer.
+    // Other VAOs keep referring to it, so those bindings are no longer known.
+    for (uint32_t& binding : m_buffers) {
+        if (binding == buffer) {
+            binding = 0;
+        }
+    }
+
+    for (auto& [vertexArray, elementBuffer] : m_elementBuffers) {
+        if (elementBuffer == buffer) {
+            elementBuffer = vertexArray == m_vertexArray ? 0 : unknown;
+        }
+    }
+}
+
+// ----------
+// Management
+// ----------
+
+void Oglre::GLStateCache::Invalidate()
+{
+    m_program = unknown;
+    m_vertexArray = unknown;
+    m_buffers.fill(unknown);
+    for (auto& [vertexArray, elementBuffer] : m_elementBuffers) {
+        elementBuffer = unknown;
+    }
+
+    m_capabilities.fill(unknown);
+    m_depthMask = unknown;
+    m_polygonMode = unknown;
+    m_blendFunction.fill(unknown);
+    m_viewport.fill(-1);
+}
+
+void Oglre::GLStateCache::EndFrame()
+{
+    Profiler::SetCounter("GL State Calls Issued", m_frameCounters.issued);
+    Profiler::SetCounter("GL State Calls Skipped", m_frameCounters.skipped);
+
+    m_frameCounters = GLStateCounters();
+}
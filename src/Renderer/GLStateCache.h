@@ -0,0 +1,97 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+
+namespace Oglre {
+
+// How many state changes were sent to the driver, and how many were dropped because the state was already set.
+struct GLStateCounters {
+    uint32_t issued = 0;
+    uint32_t skipped = 0;
+};
+
+// Shadow copy of the OpenGL state that the engine changes, so that redundant calls never reach the driver.
+// Every wrapper (Shader, VertexArray, VertexBuffer, IndexBuffer, Renderer) must change state through here,
+// otherwise the shadow copy goes stale. Call Invalidate() after code that bypasses it, e.g. DearImGui's renderer.
+class GLStateCache {
+public:
+    static void UseProgram(uint32_t program);
+    static void BindVertexArray(uint32_t vertexArray);
+    static void BindBuffer(uint32_t target, uint32_t buffer);
+
+    // Indexed binding (uniform/shader storage buffers). Always issued, but also updates the generic binding it replaces.
+    static void BindBufferBase(uint32_t target, uint32_t index, uint32_t buffer);
+    static void BindBufferRange(uint32_t target, uint32_t index, uint32_t buffer, intptr_t offset, intptr_t size);
+
+    // Only GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE, GL_SCISSOR_TEST and GL_STENCIL_TEST are cached, others go straight to GL.
+    static void SetCapability(uint32_t capability, bool enable);
+    static void SetDepthMask(bool enable);
+    static void SetPolygonMode(uint32_t mode);
+    static void SetBlendFunction(uint32_t sourceFactor, uint32_t destinationFactor);
+    static void SetViewport(int x, int y, int width, int height);
+
+    // One viewport of a viewport array (GL 4.1 or GL_ARB_viewport_array). Only viewport 0 is cached, the others are
+    // always issued. Note that SetViewport() sets every viewport of the array.
+    static void SetViewportIndexed(uint32_t index, int x, int y, int width, int height);
+
+    // Delete the GL object and forget any binding of it.
+    static void DeleteProgram(uint32_t program);
+    static void DeleteVertexArray(uint32_t vertexArray);
+    static void DeleteBuffer(uint32_t buffer);
+
+    // Forget everything, the next call of each kind always reaches the driver.
+    static void Invalidate();
+
+    // Publishes this frame's counters to the profiler and resets them.
+    static void EndFrame();
+
+    static inline const GLStateCounters& GetFrameCounters()
+    {
+        return m_frameCounters;
+    }
+
+private:
+    // Marks state whose value is not known, e.g. after Invalidate().
+    static constexpr uint32_t unknown = 0xFFFFFFFF;
+
+    // Buffer targets with a cached binding. GL_ELEMENT_ARRAY_BUFFER is not here, as it is part of the VAO's state.
+    static constexpr std::array<uint32_t, 7> bufferTargets = {
+        GL_ARRAY_BUFFER,
+        GL_UNIFORM_BUFFER,
+        GL_SHADER_STORAGE_BUFFER,
+        GL_DRAW_INDIRECT_BUFFER,
+        GL_COPY_READ_BUFFER,
+        GL_COPY_WRITE_BUFFER,
+        GL_PIXEL_PACK_BUFFER
+    };
+
+    static constexpr std::array<uint32_t, 5> capabilities = {
+        GL_DEPTH_TEST,
+        GL_BLEND,
+        GL_CULL_FACE,
+        GL_SCISSOR_TEST,
+        GL_STENCIL_TEST
+    };
+
+    static inline uint32_t m_program = unknown;
+    static inline uint32_t m_vertexArray = unknown;
+    static inline std::array<uint32_t, bufferTargets.size()> m_buffers = { unknown, unknown, unknown, unknown, unknown, unknown, unknown };
+
+    // GL_ELEMENT_ARRAY_BUFFER binding of every VAO that has been bound through the cache.
+    static inline std::unordered_map<uint32_t, uint32_t> m_elementBuffers;
+
+    static inline std::array<uint32_t, capabilities.size()> m_capabilities = { unknown, unknown, unknown, unknown, unknown };
+    static inline uint32_t m_depthMask = unknown;
+    static inline uint32_t m_polygonMode = unknown;
+    static inline std::array<uint32_t, 2> m_blendFunction = { unknown, unknown };
+    static inline std::array<int, 4> m_viewport = { -1, -1, -1, -1 };
+
+    static inline GLStateCounters m_frameCounters;
+
+    // Returns true, and counts the call as issued, if value differs from cached. Otherwise counts it as skipped.
+    static bool Update(uint32_t& cached, uint32_t value);
+};
+}
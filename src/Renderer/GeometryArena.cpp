@@ -0,0 +1,36 @@
+#include "GeometryArena.h"
+
+Oglre::GeometryArena::GeometryArena(const VertexBufferLayout& layout, uint32_t vertexCapacity, uint32_t indexCapacity)
+    : m_VertexBuffer(vertexCapacity * layout.GetStride())
+    , m_IndexBuffer(indexCapacity)
+    , m_Stride(layout.GetStride())
+    , m_VertexCapacity(vertexCapacity)
+    , m_IndexCapacity(indexCapacity)
+    , m_VertexCount(0)
+    , m_IndexCount(0)
+{
+    m_VertexArray.AddBuffer(m_VertexBuffer, layout);
+    m_VertexArray.SetIndexBuffer(m_IndexBuffer);
+}
+
+bool Oglre::GeometryArena::AddMesh(std::span<const std::byte> vertexData, std::span<const uint32_t> indices, MeshRange& range)
+{
+    const uint32_t vertexCount = static_cast<uint32_t>(vertexData.size() / m_Stride);
+    const uint32_t indexCount = static_cast<uint32_t>(indices.size());
+
+    if (m_VertexCount + vertexCount > m_VertexCapacity || m_IndexCount + indexCount > m_IndexCapacity) {
+        return false;
+    }
+
+    m_VertexBuffer.Update(m_VertexCount * m_Stride, vertexData.data(), vertexCount * m_Stride);
+    m_IndexBuffer.Update(m_IndexCount, indices.data(), indexCount);
+
+    range.firstIndex = m_IndexCount;
+    range.indexCount = indexCount;
+    range.baseVertex = static_cast<int32_t>(m_VertexCount);
+
+    m_VertexCount += vertexCount;
+    m_IndexCount += indexCount;
+
+    return true;
+}
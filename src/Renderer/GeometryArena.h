@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+
+namespace Oglre {
+
+// Where a mesh lives inside a GeometryArena. firstIndex is relative to the arena, add GeometryArena::GetFirstIndex()
+// for the position in the bound index buffer.
+struct MeshRange {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    int32_t baseVertex = 0;
+};
+
+// Packs every mesh that shares a vertex format into one vertex buffer and one index buffer, with one VAO over both.
+// Indices stay relative to their own mesh, and baseVertex offsets them at draw time. This lets a single
+// glMultiDrawElementsIndirect() call draw any mix of the arena's meshes without rebinding anything.
+class GeometryArena {
+public:
+    // Capacities are fixed at construction, in vertices and indices.
+    GeometryArena(const VertexBufferLayout& layout, uint32_t vertexCapacity, uint32_t indexCapacity);
+
+    // vertexData must match the layout the arena was created with. Returns false, and leaves range untouched, if full.
+    bool AddMesh(std::span<const std::byte> vertexData, std::span<const uint32_t> indices, MeshRange& range);
+
+    inline const VertexArray& GetVertexArray() const
+    {
+        return m_VertexArray;
+    }
+
+    // Position of the arena's first index within the index heap. Changes when the heap's generation does.
+    inline uint32_t GetFirstIndex() const
+    {
+        return m_IndexBuffer.GetOffset() / sizeof(uint32_t);
+    }
+
+    inline uint32_t GetVertexCount() const
+    {
+        return m_VertexCount;
+    }
+
+    inline uint32_t GetIndexCount() const
+    {
+        return m_IndexCount;
+    }
+
+private:
+    VertexBuffer m_VertexBuffer;
+    IndexBuffer m_IndexBuffer;
+    VertexArray m_VertexArray;
+
+    uint32_t m_Stride;
+    uint32_t m_VertexCapacity;
+    uint32_t m_IndexCapacity;
+    uint32_t m_VertexCount;
+    uint32_t m_IndexCount;
+};
+}
@@ -0,0 +1,285 @@
+#include "GpuHeap.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+Oglre::GpuHeap::GpuHeap(uint32_t target, uint32_t capacity, uint32_t alignment)
+    : m_RendererID(0)
+    , m_Target(target)
+    , m_Capacity(capacity)
+    , m_Alignment(alignment)
+    , m_Generation(0)
+    , m_BytesInUse(0)
+{
+    // Created with DSA, so that making a heap never disturbs the current bindings.
+    glCreateBuffers(1, &m_RendererID);
+    glNamedBufferData(m_RendererID, m_Capacity, nullptr, GL_STATIC_DRAW);
+
+    InsertFreeRange(0, m_Capacity);
+}
+
+Oglre::GpuHeap::~GpuHeap()
+{
+    GLStateCache::DeleteBuffer(m_RendererID);
+}
+
+// ------------
+// Shared Heaps
+// ------------
+
+Oglre::GpuHeap& Oglre::GpuHeap::Get(GpuHeapType type)
+{
+    constexpr uint32_t alignment = 16;
+
+    if (type == GpuHeapType::INDEX) {
+        if (!m_indexHeap) {
+            m_indexHeap = std::make_unique<GpuHeap>(GL_ELEMENT_ARRAY_BUFFER, 1 << 20, alignment);
+        }
+        return *m_indexHeap;
+    }
+
+    if (!m_vertexHeap) {
+        m_vertexHeap = std::make_unique<GpuHeap>(GL_ARRAY_BUFFER, 4 << 20, alignment);
+    }
+    return *m_vertexHeap;
+}
+
+void Oglre::GpuHeap::EndFrame()
+{
+    if (m_vertexHeap) {
+        const GpuHeapStatistics statistics = m_vertexHeap->GetStatistics();
+        Profiler::SetCounter("Vertex Heap In Use (KB)", statistics.bytesInUse / 1024.0);
+        Profiler::SetCounter("Vertex Heap Fragmentation", statistics.fragmentation);
+    }
+
+    if (m_indexHeap) {
+        const GpuHeapStatistics statistics = m_indexHeap->GetStatistics();
+        Profiler::SetCounter("Index Heap In Use (KB)", statistics.bytesInUse / 1024.0);
+        Profiler::SetCounter("Index Heap Fragmentation", statistics.fragmentation);
+    }
+}
+
+void Oglre::GpuHeap::Shutdown()
+{
+    m_vertexHeap.reset();
+    m_indexHeap.reset();
+}
+
+// ----------
+// Allocation
+// ----------
+
+Oglre::GpuHeap::Handle Oglre::GpuHeap::Allocate(uint32_t size, const void* data)
+{
+    // Rounding every size up keeps every offset aligned. Sizes are in 64 bits until they are known to fit the heap.
+    const uint64_t alignedSize = (uint64_t(std::max(size, 1u)) + m_Alignment - 1) / m_Alignment * m_Alignment;
+    if (uint64_t(m_BytesInUse) + alignedSize > std::numeric_limits<uint32_t>::max()) {
+        std::cout << "GPU heap allocation of " << size << " bytes could not be made, the heap would exceed 4 GiB" << std::endl;
+        return invalidHandle;
+    }
+
+    uint32_t offset = TakeFreeRange(static_cast<uint32_t>(alignedSize));
+    if (offset == invalidHandle) {
+        // Compacting gets back the space lost to fragmentation, growing is only needed if that is not enough.
+        // Starting from at least the allocation's size means an empty heap grows too.
+        uint64_t newCapacity = std::max<uint64_t>(m_Capacity, alignedSize);
+        while (newCapacity - m_BytesInUse < alignedSize) {
+            newCapacity *= 2;
+        }
+
+        Reallocate(static_cast<uint32_t>(std::min<uint64_t>(newCapacity, std::numeric_limits<uint32_t>::max() / m_Alignment * m_Alignment)));
+        offset = TakeFreeRange(static_cast<uint32_t>(alignedSize));
+        if (offset == invalidHandle) {
+            std::cout << "GPU heap allocation of " << size << " bytes could not be made, no free range is large enough" << std::endl;
+            return invalidHandle;
+        }
+    }
+
+    Handle handle;
+    if (m_FreeHandles.empty()) {
+        handle = static_cast<Handle>(m_Allocations.size());
+        m_Allocations.emplace_back();
+    } else {
+        handle = m_FreeHandles.back();
+        m_FreeHandles.pop_back();
+    }
+
+    m_Allocations[handle] = { offset, static_cast<uint32_t>(alignedSize), true };
+    m_BytesInUse += static_cast<uint32_t>(alignedSize);
+
+    if (data != nullptr) {
+        glNamedBufferSubData(m_RendererID, offset, size, data);
+    }
+
+    return handle;
+}
+
+void Oglre::GpuHeap::Free(Handle handle)
+{
+    if (handle >= m_Allocations.size() || !m_Allocations[handle].live) {
+        return;
+    }
+
+    Allocation& allocation = m_Allocations[handle];
+    InsertFreeRange(allocation.offset, allocation.size);
+    m_BytesInUse -= allocation.size;
+
+    allocation.live = false;
+    m_FreeHandles.push_back(handle);
+}
+
+void Oglre::GpuHeap::Update(Handle handle, uint32_t offset, const void* data, uint32_t size)
+{
+    if (handle >= m_Allocations.size()) {
+        return;
+    }
+
+    glNamedBufferSubData(m_RendererID, m_Allocations[handle].offset + offset, size, data);
+}
+
+void Oglre::GpuHeap::Defragment()
+{
+    Reallocate(m_Capacity);
+}
+
+void Oglre::GpuHeap::Bind() const
+{
+    GLStateCache::BindBuffer(m_Target, m_RendererID);
+}
+
+Oglre::GpuHeapStatistics Oglre::GpuHeap::GetStatistics() const
+{
+    GpuHeapStatistics statistics;
+    statistics.capacity = m_Capacity;
+    statistics.bytesInUse = m_BytesInUse;
+    statistics.allocationCount = static_cast<uint32_t>(m_Allocations.size() - m_FreeHandles.size());
+    statistics.freeRangeCount = static_cast<uint32_t>(m_FreeRangesByOffset.size());
+    statistics.largestFreeRange = m_FreeRangesBySize.empty() ? 0 : m_FreeRangesBySize.rbegin()->first;
+
+    const uint32_t bytesFree = m_Capacity - m_BytesInUse;
+    if (bytesFree > 0) {
+        statistics.fragmentation = 1.0 - static_cast<double>(statistics.largestFreeRange) / bytesFree;
+    }
+
+    return statistics;
+}
+
+// -----------
+// Free Ranges
+// -----------
+
+void Oglre::GpuHeap::InsertFreeRange(uint32_t offset, uint32_t size)
+{
+    // Merge with the free ranges directly after and before, so free space is never split into adjacent pieces.
+    const auto next = m_FreeRangesByOffset.find(offset + size);
+    if (next != m_FreeRangesByOffset.end()) {
+        const uint32_t nextSize = next->second;
+        EraseFreeRange(offset + size, nextSize);
+        size += nextSize;
+    }
+
+    const auto previous = m_FreeRangesByOffset.lower_bound(offset);
+    if (previous != m_FreeRangesByOffset.begin()) {
+        const auto before = std::prev(previous);
+        if (before->first + before->second == offset) {
+            const uint32_t beforeOffset = before->first;
+            const uint32_t beforeSize = before->second;
+            EraseFreeRange(beforeOffset, beforeSize);
+            offset = beforeOffset;
+            size += beforeSize;
+        }
+    }
+
+    m_FreeRangesByOffset.emplace(offset, size);
+    m_FreeRangesBySize.emplace(size, offset);
+}
+
+void Oglre::GpuHeap::EraseFreeRange(uint32_t offset, uint32_t size)
+{
+    m_FreeRangesByOffset.erase(offset);
+
+    auto [first, last] = m_FreeRangesBySize.equal_range(size);
+    for (auto it = first; it != last; ++it) {
+        if (it->second == offset) {
+            m_FreeRangesBySize.erase(it);
+            return;
+        }
+    }
+}
+
+uint32_t Oglre::GpuHeap::TakeFreeRange(uint32_t size)
+{
+    // Smallest free range that fits.
+    const auto it = m_FreeRangesBySize.lower_bound(size);
+    if (it == m_FreeRangesBySize.end()) {
+        return invalidHandle;
+    }
+
+    const uint32_t rangeSize = it->first;
+    const uint32_t offset = it->second;
+    EraseFreeRange(offset, rangeSize);
+
+    if (rangeSize > size) {
+        InsertFreeRange(offset + size, rangeSize - size);
+    }
+
+    return offset;
+}
+
+void Oglre::GpuHeap::Reallocate(uint32_t newCapacity)
+{
+    uint32_t newRendererID = 0;
+    glCreateBuffers(1, &newRendererID);
+    glNamedBufferData(newRendererID, newCapacity, nullptr, GL_STATIC_DRAW);
+
+    // Copy in offset order, merging allocations that stay next to each other into one copy.
+    std::vector<Handle> liveHandles;
+    liveHandles.reserve(m_Allocations.size());
+    for (Handle handle = 0; handle < m_Allocations.size(); ++handle) {
+        if (m_Allocations[handle].live) {
+            liveHandles.push_back(handle);
+        }
+    }
+    std::sort(liveHandles.begin(), liveHandles.end(), [this](Handle a, Handle b) {
+        return m_Allocations[a].offset < m_Allocations[b].offset;
+    });
+
+    uint32_t cursor = 0;
+    uint32_t runSource = 0;
+    uint32_t runDestination = 0;
+    uint32_t runSize = 0;
+    for (const Handle handle : liveHandles) {
+        Allocation& allocation = m_Allocations[handle];
+
+        if (runSize > 0 && runSource + runSize != allocation.offset) {
+            glCopyNamedBufferSubData(m_RendererID, newRendererID, runSource, runDestination, runSize);
+            runSize = 0;
+        }
+        if (runSize == 0) {
+            runSource = allocation.offset;
+            runDestination = cursor;
+        }
+        runSize += allocation.size;
+
+        allocation.offset = cursor;
+        cursor += allocation.size;
+    }
+    if (runSize > 0) {
+        glCopyNamedBufferSubData(m_RendererID, newRendererID, runSource, runDestination, runSize);
+    }
+
+    GLStateCache::DeleteBuffer(m_RendererID);
+    m_RendererID = newRendererID;
+    m_Capacity = newCapacity;
+    ++m_Generation;
+
+    m_FreeRangesByOffset.clear();
+    m_FreeRangesBySize.clear();
+    if (cursor < m_Capacity) {
+        InsertFreeRange(cursor, m_Capacity - cursor);
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace Oglre {
+
+// Which of the shared heaps an allocation comes from. Each heap is a single GL buffer, bound to its own target.
+enum class GpuHeapType {
+    VERTEX, // GL_ARRAY_BUFFER, used by VertexBuffer.
+    INDEX // GL_ELEMENT_ARRAY_BUFFER, used by IndexBuffer.
+};
+
+struct GpuHeapStatistics {
+    uint32_t capacity = 0; // Bytes reserved from the driver.
+    uint32_t bytesInUse = 0; // Bytes handed out, including alignment padding.
+    uint32_t allocationCount = 0;
+    uint32_t freeRangeCount = 0;
+    uint32_t largestFreeRange = 0;
+
+    // 0 when all free space is one contiguous range, approaching 1 as it is split into many small ranges.
+    double fragmentation = 0.0;
+};
+
+// Suballocates many small buffers out of one large GL buffer, so that loading thousands of meshes does not mean
+// thousands of driver allocations, and so that switching between meshes does not mean switching buffers.
+// Free space is kept in a best-fit free list, and neighbouring free ranges are merged when an allocation is freed.
+//
+// Allocations are referred to by handle, as their offset can change: when the heap grows, or when it is defragmented,
+// the data moves to a new GL buffer. Both bump the generation, and anything that baked an offset or the buffer ID into
+// GL state (e.g. a VAO's attribute pointers) must re-specify it when the generation changes.
+class GpuHeap {
+public:
+    using Handle = uint32_t;
+    static constexpr Handle invalidHandle = 0xFFFFFFFF;
+
+    GpuHeap(uint32_t target, uint32_t capacity, uint32_t alignment);
+    ~GpuHeap();
+
+    GpuHeap(const GpuHeap&) = delete;
+    GpuHeap& operator=(const GpuHeap&) = delete;
+
+    // The shared heaps. Created on first use, which requires a current GL context.
+    static GpuHeap& Get(GpuHeapType type);
+
+    // Publishes the heaps' statistics to the profiler.
+    static void EndFrame();
+
+    // Deletes the shared heaps' buffers. Must be called before the GL context is destroyed.
+    static void Shutdown();
+
+    // If no free range is large enough the heap is defragmented, or grown if that would not help either. Returns
+    // invalidHandle only if the heap would have to grow past 4 GiB; every other member accepts it.
+    // data may be nullptr, to fill the allocation in later with Update().
+    Handle Allocate(uint32_t size, const void* data = nullptr);
+    void Free(Handle handle);
+
+    // Overwrites size bytes starting offset bytes into the allocation. Does not bind anything.
+    void Update(Handle handle, uint32_t offset, const void* data, uint32_t size);
+
+    // Moves every allocation to the start of a new buffer, leaving all free space as one range at the end.
+    void Defragment();
+
+    void Bind() const;
+
+    // Both are 0 for invalidHandle, so a buffer whose allocation failed binds as empty rather than reading past
+    // m_Allocations.
+    inline uint32_t GetOffset(Handle handle) const
+    {
+        return handle < m_Allocations.size() ? m_Allocations[handle].offset : 0;
+    }
+
+    inline uint32_t GetSize(Handle handle) const
+    {
+        return handle < m_Allocations.size() ? m_Allocations[handle].size : 0;
+    }
+
+    inline uint32_t GetRendererID() const
+    {
+        return m_RendererID;
+    }
+
+    inline uint32_t GetGeneration() const
+    {
+        return m_Generation;
+    }
+
+    GpuHeapStatistics GetStatistics() const;
+
+private:
+    struct Allocation {
+        uint32_t offset = 0;
+        uint32_t size = 0;
+        bool live = false;
+    };
+
+    uint32_t m_RendererID;
+    uint32_t m_Target;
+    uint32_t m_Capacity;
+    uint32_t m_Alignment;
+    uint32_t m_Generation;
+    uint32_t m_BytesInUse;
+
+    std::vector<Allocation> m_Allocations;
+    std::vector<Handle> m_FreeHandles;
+
+    // The same free ranges, indexed by offset for merging neighbours and by size for best-fit searches.
+    std::map<uint32_t, uint32_t> m_FreeRangesByOffset;
+    std::multimap<uint32_t, uint32_t> m_FreeRangesBySize;
+
+    static inline std::unique_ptr<GpuHeap> m_vertexHeap;
+    static inline std::unique_ptr<GpuHeap> m_indexHeap;
+
+    void InsertFreeRange(uint32_t offset, uint32_t size);
+    void EraseFreeRange(uint32_t offset, uint32_t size);
+
+    // Returns the offset of the best fitting free range, removing size bytes from its start, or invalidHandle.
+    uint32_t TakeFreeRange(uint32_t size);
+
+    // Copies the live allocations, packed together from offset 0, into a new buffer of newCapacity bytes.
+    void Reallocate(uint32_t newCapacity);
+};
+}
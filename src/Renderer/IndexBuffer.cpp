@@ -1,28 +1,46 @@
 #include "IndexBuffer.h"
+#include "GLStateCache.h"
+#include "VertexBufferLayout.h"
 #include <GL/glew.h>
 #include <cstdint>
 
-Oglre::IndexBuffer::IndexBuffer(const std::vector<uint32_t> data, uint32_t count)
-    : m_Count(count)
+Oglre::IndexBuffer::IndexBuffer(std::span<const uint32_t> data)
+    : m_Allocation(GpuHeap::Get(GpuHeapType::INDEX).Allocate(static_cast<uint32_t>(data.size_bytes()), data.data()))
+    , m_Count(static_cast<uint32_t>(data.size()))
+    , m_Type(GL_UNSIGNED_INT)
 {
-    const int numberOfBuffers = 1;
+}
+
+Oglre::IndexBuffer::IndexBuffer(std::span<const std::byte> data, GLenum type)
+    : m_Allocation(GpuHeap::Get(GpuHeapType::INDEX).Allocate(static_cast<uint32_t>(data.size_bytes()), data.data()))
+    , m_Count(static_cast<uint32_t>(data.size_bytes() / VertexBufferElement::GetSizeOfType(type)))
+    , m_Type(type)
+{
+}
 
-    glGenBuffers(numberOfBuffers, &m_RendererID);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(uint32_t), data.data(), GL_STATIC_DRAW);
+Oglre::IndexBuffer::IndexBuffer(uint32_t count)
+    : m_Allocation(GpuHeap::Get(GpuHeapType::INDEX).Allocate(count * sizeof(uint32_t)))
+    , m_Count(count)
+    , m_Type(GL_UNSIGNED_INT)
+{
 }
 
 Oglre::IndexBuffer::~IndexBuffer()
 {
-    glDeleteBuffers(1, &m_RendererID);
+    GpuHeap::Get(GpuHeapType::INDEX).Free(m_Allocation);
+}
+
+void Oglre::IndexBuffer::Update(uint32_t firstIndex, const uint32_t* data, uint32_t count)
+{
+    GpuHeap::Get(GpuHeapType::INDEX).Update(m_Allocation, firstIndex * sizeof(uint32_t), data, count * sizeof(uint32_t));
 }
 
 void Oglre::IndexBuffer::Bind() const
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+    GpuHeap::Get(GpuHeapType::INDEX).Bind();
 }
 
 void Oglre::IndexBuffer::Unbind() const
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
@@ -1,15 +1,34 @@
 #pragma once
 
+#include <GL/glew.h>
+#include <cstddef>
 #include <cstdint>
-#include <vector>
+#include <span>
+
+#include "GpuHeap.h"
 namespace Oglre {
-// Handles creation, binding, data storage and deletion of an Index Buffer Object.
+// A range of 8, 16 or 32-bit indices inside the shared index GpuHeap. Binding it binds the heap's buffer, which every
+// IndexBuffer shares, so draws must start reading at GetOffset() rather than at 0.
 class IndexBuffer {
 
 public:
-    IndexBuffer(const std::vector<uint32_t> data, uint32_t count);
+    // Uploads data straight from the caller's memory, e.g. a mapped MeshFile, without an intermediate copy.
+    IndexBuffer(std::span<const uint32_t> data);
+
+    // Uploads indices already packed as type: GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+    // See MeshOptimizer::SelectIndexType() and MeshOptimizer::PackIndices().
+    IndexBuffer(std::span<const std::byte> data, GLenum type);
+
+    // Reserves room for count 32-bit indices without uploading anything, to be filled in with Update().
+    IndexBuffer(uint32_t count);
     ~IndexBuffer();
 
+    IndexBuffer(const IndexBuffer&) = delete;
+    IndexBuffer& operator=(const IndexBuffer&) = delete;
+
+    // Overwrites count indices starting at firstIndex. 32-bit index buffers only. Does not bind anything, so no VAO's element buffer is changed.
+    void Update(uint32_t firstIndex, const uint32_t* data, uint32_t count);
+
     void Bind() const;
     void Unbind() const;
 
@@ -18,8 +37,27 @@ public:
         return m_Count;
     }
 
+    // The type to pass to glDrawElements*().
+    inline GLenum GetType() const
+    {
+        return m_Type;
+    }
+
+    // Byte offset of the first index within the heap, to be passed as the indices pointer of glDrawElements*().
+    // Changes when the heap's generation does, so it must be read at draw time.
+    inline uint32_t GetOffset() const
+    {
+        return GpuHeap::Get(GpuHeapType::INDEX).GetOffset(m_Allocation);
+    }
+
+    inline uint32_t GetRendererID() const
+    {
+        return GpuHeap::Get(GpuHeapType::INDEX).GetRendererID();
+    }
+
 private:
-    uint32_t m_RendererID;
+    GpuHeap::Handle m_Allocation;
     uint32_t m_Count;
+    GLenum m_Type;
 };
-}
\ No newline at end of file
+}
@@ -0,0 +1,65 @@
+#include "IndirectDrawBatch.h"
+#include "GLStateCache.h"
+
+#include <GL/glew.h>
+#include <cstring>
+
+namespace {
+uint32_t GetStorageBufferOffsetAlignment()
+{
+    GLint alignment = 0;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    return alignment > 0 ? static_cast<uint32_t>(alignment) : 256;
+}
+}
+
+Oglre::IndirectDrawBatch::IndirectDrawBatch()
+    : m_IndexCount(0)
+    , m_FirstIndexBase(0)
+    , m_CommandBuffer(GL_DRAW_INDIRECT_BUFFER, 1024 * sizeof(DrawElementsIndirectCommand), sizeof(DrawElementsIndirectCommand))
+    , m_DrawDataBuffer(GL_SHADER_STORAGE_BUFFER, 1024 * sizeof(glm::mat4), GetStorageBufferOffsetAlignment())
+{
+}
+
+void Oglre::IndirectDrawBatch::Clear()
+{
+    m_Commands.clear();
+    m_DrawData.clear();
+    m_IndexCount = 0;
+    m_FirstIndexBase = 0;
+}
+
+void Oglre::IndirectDrawBatch::Add(const MeshRange& mesh, const glm::mat4& model)
+{
+    // gl_DrawID is the index of the command, so draw i reads m_DrawData[i].
+    m_Commands.push_back({ mesh.indexCount, 1, m_FirstIndexBase + mesh.firstIndex, mesh.baseVertex, 0 });
+    m_DrawData.push_back(model);
+    m_IndexCount += mesh.indexCount;
+}
+
+void Oglre::IndirectDrawBatch::Upload(uint32_t firstIndexBase)
+{
+    const uint32_t drawCount = GetDrawCount();
+
+    if (firstIndexBase != m_FirstIndexBase) {
+        for (DrawElementsIndirectCommand& command : m_Commands) {
+            command.firstIndex = command.firstIndex - m_FirstIndexBase + firstIndexBase;
+        }
+        m_FirstIndexBase = firstIndexBase;
+    }
+
+    const uint32_t commandsSize = drawCount * sizeof(DrawElementsIndirectCommand);
+    const uint32_t drawDataSize = drawCount * sizeof(glm::mat4);
+
+    std::memcpy(m_CommandBuffer.BeginRegion(commandsSize), m_Commands.data(), commandsSize);
+    std::memcpy(m_DrawDataBuffer.BeginRegion(drawDataSize), m_DrawData.data(), drawDataSize);
+
+    m_CommandBuffer.Bind();
+    GLStateCache::BindBufferRange(GL_SHADER_STORAGE_BUFFER, drawDataBinding, m_DrawDataBuffer.GetRendererID(), m_DrawDataBuffer.GetRegionOffset(), drawDataSize);
+}
+
+void Oglre::IndirectDrawBatch::EndDraw()
+{
+    m_CommandBuffer.EndRegion();
+    m_DrawDataBuffer.EndRegion();
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "GeometryArena.h"
+#include "StreamingBuffer.h"
+
+namespace Oglre {
+
+// Layout required by glMultiDrawElementsIndirect(), see http://docs.gl/gl4/glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand {
+    uint32_t count;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t baseVertex;
+    uint32_t baseInstance;
+};
+
+// The draws for one glMultiDrawElementsIndirect() call, plus the per-draw data that shaders fetch with gl_DrawID.
+// Record with Add() every frame, Renderer::MultiDrawIndirect() uploads and draws the batch.
+// Both are streamed through persistently mapped buffers, so uploading never waits on the GPU's previous frames.
+class IndirectDrawBatch {
+public:
+    // Binding point of the shader storage block that holds the per-draw model matrices.
+    static constexpr uint32_t drawDataBinding = 0;
+
+    IndirectDrawBatch();
+
+    IndirectDrawBatch(const IndirectDrawBatch&) = delete;
+    IndirectDrawBatch& operator=(const IndirectDrawBatch&) = delete;
+
+    void Clear();
+    void Add(const MeshRange& mesh, const glm::mat4& model);
+
+    // Copies the commands and per-draw data to this frame's region of their streaming buffers and binds them.
+    // firstIndexBase is added to every command's firstIndex, see GeometryArena::GetFirstIndex().
+    void Upload(uint32_t firstIndexBase);
+
+    // Fences this frame's regions. Must follow the draw that reads them.
+    void EndDraw();
+
+    // Offset of the first command in the bound GL_DRAW_INDIRECT_BUFFER, for the indirect pointer of the draw.
+    inline uint32_t GetCommandOffset() const
+    {
+        return m_CommandBuffer.GetRegionOffset();
+    }
+
+    inline uint32_t GetDrawCount() const
+    {
+        return static_cast<uint32_t>(m_Commands.size());
+    }
+
+    inline uint32_t GetIndexCount() const
+    {
+        return m_IndexCount;
+    }
+
+private:
+    std::vector<DrawElementsIndirectCommand> m_Commands;
+    std::vector<glm::mat4> m_DrawData;
+    uint32_t m_IndexCount;
+
+    // firstIndexBase already added to m_Commands, so uploading the same batch again does not add it twice.
+    uint32_t m_FirstIndexBase;
+
+    StreamingBuffer m_CommandBuffer;
+    StreamingBuffer m_DrawDataBuffer;
+};
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Oglre {
+// A 64-bit sort key and the index of the item it was generated for.
+struct SortItem {
+    uint64_t key;
+    uint32_t index;
+};
+
+// Stable LSD radix sort on SortItem::key, 8 bits per pass.
+// Passes over bytes that are the same for every key are skipped, which is common for the high bits of render keys.
+// scratch is resized as needed, and is kept by the caller so that sorting every frame does not allocate.
+inline void RadixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch)
+{
+    constexpr uint32_t bitsPerPass = 8;
+    constexpr uint32_t numberOfBuckets = 1 << bitsPerPass;
+    constexpr uint32_t numberOfPasses = 64 / bitsPerPass;
+
+    const size_t count = items.size();
+    if (count < 2) {
+        return;
+    }
+    scratch.resize(count);
+
+    // Build the histograms for every pass with a single read over the keys.
+    std::array<std::array<uint32_t, numberOfBuckets>, numberOfPasses> histograms {};
+    for (const SortItem& item : items) {
+        for (uint32_t pass = 0; pass < numberOfPasses; ++pass) {
+            ++histograms[pass][(item.key >> (pass * bitsPerPass)) & (numberOfBuckets - 1)];
+        }
+    }
+
+    for (uint32_t pass = 0; pass < numberOfPasses; ++pass) {
+        const uint32_t shift = pass * bitsPerPass;
+        auto& histogram = histograms[pass];
+
+        if (histogram[(items[0].key >> shift) & (numberOfBuckets - 1)] == count) {
+            continue;
+        }
+
+        // Turn the counts into the first output position of each bucket.
+        uint32_t offset = 0;
+        for (uint32_t& bucket : histogram) {
+            const uint32_t bucketCount = bucket;
+            bucket = offset;
+            offset += bucketCount;
+        }
+
+        for (const SortItem& item : items) {
+            scratch[histogram[(item.key >> shift) & (numberOfBuckets - 1)]++] = item;
+        }
+
+        items.swap(scratch);
+    }
+}
+}
@@ -1,37 +1,248 @@
 #include "Renderer.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+// Writes the single block of a buffer that is rewritten once per frame, and binds it until the next call.
+template <typename Block>
+void WriteFrameBlock(std::unique_ptr<Oglre::UniformBuffer>& buffer, const Block& block)
+{
+    if (!buffer) {
+        buffer = std::make_unique<Oglre::UniformBuffer>(Block::binding, sizeof(Block), 1);
+    }
+
+    // Every draw that read the previous frame's block has been issued by now, so its region can be fenced here.
+    if (buffer->IsWriting()) {
+        buffer->End();
+    }
+
+    buffer->Begin(1);
+    buffer->Write(0, block);
+    buffer->Bind(0);
+}
+}
 
 void Renderer::Clear()
 {
+    // glClear() honours the write masks, and the translucent pass leaves depth writes off. The passes never change the
+    // color mask.
+    Oglre::GLStateCache::SetDepthMask(true);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
+void Renderer::SetFrameUniforms(const Oglre::FrameUniforms& uniforms)
+{
+    WriteFrameBlock(m_frameUniforms, uniforms);
+}
+
+void Renderer::SetViews(std::span<const RenderView> views)
+{
+    if (views.size() > Oglre::ViewUniforms::maxViews) {
+        std::cout << "Only " << Oglre::ViewUniforms::maxViews << " views can be drawn at once, not " << views.size() << std::endl;
+        views = views.first(Oglre::ViewUniforms::maxViews);
+    }
+
+    // The cameras' matrices are cached, so this only multiplies matrices for cameras that have changed.
+    Oglre::ViewUniforms uniforms {};
+    uniforms.viewCount = static_cast<uint32_t>(views.size());
+    for (uint32_t view = 0; view < uniforms.viewCount; ++view) {
+        uniforms.viewProjections[view] = views[view].camera->GetViewProjectionMatrix();
+        Oglre::GLStateCache::SetViewportIndexed(view, views[view].x, views[view].y, views[view].width, views[view].height);
+    }
+
+    WriteFrameBlock(m_viewUniforms, uniforms);
+}
+
+void Renderer::Shutdown()
+{
+    m_frameUniforms.reset();
+    m_objectUniforms.reset();
+    m_viewUniforms.reset();
+}
+
 void Renderer::Draw(const Oglre::VertexArray& va, const Oglre::IndexBuffer& ibo, const Shader& shader)
 {
     shader.Bind();
     va.Bind();
 
-    // TODO: Don't need to bind an ibo again. VAOs keep track of the last IBO bound, so what we really need is to keep track of what the last IBO + VBO was about to a VAO 
+    // VAOs keep track of the last IBO bound. The state cache knows which IBO each VAO has, so this only reaches GL if it changed.
     ibo.Bind();
 
-    // Enable Depth Testing. Prevents occluded triangles from being drawn.
-    glEnable(GL_DEPTH_TEST);
+    ApplyPassState(RenderPass::SOLID);
 
-    // Wireframe mode
-    if (m_enableWireFrameMode) {
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    } else {
-        // Enable default fill mode.
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    }
-
-    // Index Buffer is already bound, and so the pointer to the IB location can just be nullptr.
-    glDrawElements(GL_TRIANGLES, ibo.GetCount(), GL_UNSIGNED_INT, nullptr);
+    // Index Buffer is already bound, so the pointer is the offset of its indices within the bound buffer.
+    glDrawElements(GL_TRIANGLES, ibo.GetCount(), ibo.GetType(), GetIndexOffset(ibo));
 
     // Not using Unbind()s at the moment, unnecessary for OpenGL.
     // Normally just a waste of performance.
 }
 
+void Renderer::DrawInstanced(const Oglre::VertexArray& va, const Oglre::IndexBuffer& ibo, const Shader& shader, uint32_t instanceCount)
+{
+    shader.Bind();
+    va.Bind();
+    ibo.Bind();
+
+    ApplyPassState(RenderPass::SOLID);
+
+    glDrawElementsInstanced(GL_TRIANGLES, ibo.GetCount(), ibo.GetType(), GetIndexOffset(ibo), instanceCount);
+
+    Oglre::Profiler::SetCounter("Draw Calls", 1);
+}
+
+void Renderer::MultiDrawIndirect(const Oglre::GeometryArena& arena, Oglre::IndirectDrawBatch& batch, const Shader& shader)
+{
+    if (batch.GetDrawCount() == 0) {
+        return;
+    }
+
+    shader.Bind();
+    arena.GetVertexArray().Bind();
+    batch.Upload(arena.GetFirstIndex());
+
+    ApplyPassState(RenderPass::SOLID);
+
+    // The commands are read from the bound GL_DRAW_INDIRECT_BUFFER, so the pointer is an offset into it.
+    // Arenas always hold 32-bit indices, as their meshes share one index range.
+    const void* commands = reinterpret_cast<const void*>(static_cast<uintptr_t>(batch.GetCommandOffset()));
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, commands, static_cast<GLsizei>(batch.GetDrawCount()), 0);
+    batch.EndDraw();
+
+    Oglre::Profiler::SetCounter("Draw Calls", 1);
+    Oglre::Profiler::SetCounter("Indirect Draws", batch.GetDrawCount());
+}
+
 void Renderer::EnableWireFrameMode(bool enable)
 {
     m_enableWireFrameMode = enable;
 }
+
+void Renderer::Submit(const Oglre::VertexArray& va, const Oglre::IndexBuffer& ibo, Shader& shader, const Oglre::ObjectUniforms& uniforms,
+    float depth, uint32_t materialID, RenderPass pass)
+{
+    const uint64_t key = MakeSortKey(pass, shader.GetRendererID(), materialID, va.GetRendererID(), depth);
+
+    m_sortItems.push_back({ key, static_cast<uint32_t>(m_commands.size()) });
+    m_commands.push_back({ &va, &ibo, &shader, uniforms });
+}
+
+void Renderer::Flush()
+{
+    Oglre::ProfileScope scope("Flush");
+
+    Oglre::RadixSort(m_sortItems, m_sortScratch);
+
+    // Block i is the uniforms of the i-th draw in sorted order, so consecutive draws bind consecutive blocks.
+    const uint32_t commandCount = static_cast<uint32_t>(m_sortItems.size());
+    if (!m_objectUniforms) {
+        m_objectUniforms = std::make_unique<Oglre::UniformBuffer>(Oglre::ObjectUniforms::binding, sizeof(Oglre::ObjectUniforms), 1024);
+    }
+    m_objectUniforms->Begin(commandCount);
+    for (uint32_t i = 0; i < commandCount; ++i) {
+        m_objectUniforms->Write(i, m_commands[m_sortItems[i].index].uniforms);
+    }
+
+    const Shader* boundShader = nullptr;
+    const Oglre::VertexArray* boundVertexArray = nullptr;
+    const Oglre::IndexBuffer* boundIndexBuffer = nullptr;
+    int appliedPass = -1;
+
+    uint32_t shaderBinds = 0;
+    uint32_t vertexArrayBinds = 0;
+
+    // Only bind what differs from the previous command. The sort order makes runs of equal state as long as possible.
+    for (uint32_t i = 0; i < commandCount; ++i) {
+        const Oglre::SortItem& item = m_sortItems[i];
+        const RenderCommand& command = m_commands[item.index];
+
+        const int pass = static_cast<int>(item.key >> 60);
+        if (pass != appliedPass) {
+            ApplyPassState(static_cast<RenderPass>(pass));
+            appliedPass = pass;
+        }
+
+        if (command.shader != boundShader) {
+            command.shader->Bind();
+            boundShader = command.shader;
+            ++shaderBinds;
+        }
+
+        // The element array binding is part of the VAO's state, so a new VAO also means a new IBO binding.
+        if (command.vertexArray != boundVertexArray) {
+            command.vertexArray->Bind();
+            boundVertexArray = command.vertexArray;
+            boundIndexBuffer = nullptr;
+            ++vertexArrayBinds;
+        }
+
+        if (command.indexBuffer != boundIndexBuffer) {
+            command.indexBuffer->Bind();
+            boundIndexBuffer = command.indexBuffer;
+        }
+
+        m_objectUniforms->Bind(i);
+        glDrawElements(GL_TRIANGLES, command.indexBuffer->GetCount(), command.indexBuffer->GetType(), GetIndexOffset(*command.indexBuffer));
+    }
+    m_objectUniforms->End();
+
+    Oglre::Profiler::SetCounter("Draw Calls", static_cast<double>(m_commands.size()));
+    Oglre::Profiler::SetCounter("Shader Binds", shaderBinds);
+    Oglre::Profiler::SetCounter("Vertex Array Binds", vertexArrayBinds);
+
+    m_commands.clear();
+    m_sortItems.clear();
+}
+
+uint64_t Renderer::MakeSortKey(RenderPass pass, uint32_t shaderID, uint32_t materialID, uint32_t vertexArrayID, float depth)
+{
+    constexpr uint32_t depthBits = 24;
+    constexpr uint32_t depthMax = (1u << depthBits) - 1;
+
+    // std::clamp passes NaN through, and converting NaN to an integer is undefined, so it sorts as nearest instead.
+    if (!(depth >= 0.0f)) {
+        depth = 0.0f;
+    }
+    uint32_t quantizedDepth = static_cast<uint32_t>(std::min(depth, 1.0f) * depthMax);
+
+    // Translucent draws need to be blended back to front.
+    if (pass == RenderPass::TRANSLUCENT) {
+        quantizedDepth = depthMax - quantizedDepth;
+    }
+
+    return (static_cast<uint64_t>(pass) & 0xF) << 60
+        | (static_cast<uint64_t>(shaderID) & 0xFFF) << 48
+        | (static_cast<uint64_t>(materialID) & 0xFFF) << 36
+        | (static_cast<uint64_t>(vertexArrayID) & 0xFFF) << 24
+        | quantizedDepth;
+}
+
+const void* Renderer::GetIndexOffset(const Oglre::IndexBuffer& ibo)
+{
+    return reinterpret_cast<const void*>(static_cast<uintptr_t>(ibo.GetOffset()));
+}
+
+void Renderer::ApplyPassState(RenderPass pass)
+{
+    // Enable Depth Testing. Prevents occluded triangles from being drawn.
+    Oglre::GLStateCache::SetCapability(GL_DEPTH_TEST, true);
+
+    if (pass == RenderPass::TRANSLUCENT) {
+        Oglre::GLStateCache::SetDepthMask(false);
+        Oglre::GLStateCache::SetCapability(GL_BLEND, true);
+        Oglre::GLStateCache::SetBlendFunction(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    } else {
+        Oglre::GLStateCache::SetDepthMask(true);
+        Oglre::GLStateCache::SetCapability(GL_BLEND, false);
+    }
+
+    // Wireframe mode
+    if (m_enableWireFrameMode) {
+        Oglre::GLStateCache::SetPolygonMode(GL_LINE);
+    } else {
+        // Enable default fill mode.
+        Oglre::GLStateCache::SetPolygonMode(GL_FILL);
+    }
+}
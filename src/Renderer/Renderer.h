@@ -1,3 +1,5 @@
+#pragma once
+
 // GLEW loads OpenGL function pointers from the system's graphics drivers.
 // glew.h MUST be included before gl.h
 // clang-format off
@@ -11,17 +13,104 @@
 #include <GLFW/glfw3.h>
 // clang-format on
 
+#include "GeometryArena.h"
 #include "IndexBuffer.h"
+#include "IndirectDrawBatch.h"
+#include "RadixSort.h"
 #include "Shader.h"
+#include "UniformBuffer.h"
 #include "VertexArray.h"
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
 
+#include "Camera.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <span>
+#include <vector>
+
+// Passes are executed in this order. Each pass has its own fixed-function state, see Renderer::ApplyPassState().
+enum class RenderPass : uint8_t {
+    SOLID = 0, // Sorted front to back to make the most of early depth testing.
+    TRANSLUCENT = 1 // Sorted back to front, blended, no depth writes.
+};
+
+// A camera's view of the scene, drawn into its own rectangle of the framebuffer, in pixels.
+struct RenderView {
+    const Oglre::Camera* camera;
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+// A recorded draw, executed by Renderer::Flush().
+struct RenderCommand {
+    const Oglre::VertexArray* vertexArray;
+    const Oglre::IndexBuffer* indexBuffer;
+    Shader* shader;
+    Oglre::ObjectUniforms uniforms;
+};
+
 class Renderer {
 public:
     static void Clear();
+
+    // Writes this frame's FrameUniforms block once and binds it, for every draw until the next call.
+    static void SetFrameUniforms(const Oglre::FrameUniforms& uniforms);
+
+    // Sets up a multi-view pass of up to Oglre::ViewUniforms::maxViews views, e.g. split-screen, a minimap or shadow
+    // cascades. Every draw with a MULTIVIEW program afterwards is drawn into every view at once: a geometry shader
+    // invocation per view projects each triangle with the view's camera into the view's viewport, see Basic.glsl. The
+    // scene is culled and submitted once, instead of once per view.
+    // Requires GL 4.1 or GL_ARB_viewport_array. Other programs only draw into the first view.
+    static void SetViews(std::span<const RenderView> views);
+
+    // Releases the uniform buffers, while the context is still current.
+    static void Shutdown();
+
+    // Immediate draw. Prefer Submit() + Flush(), which sorts draws to minimize state changes.
     static void Draw(const Oglre::VertexArray& va, const Oglre::IndexBuffer& ibo, const Shader& shader);
     static void EnableWireFrameMode(bool enable);
+
+    // Immediate draw of instanceCount copies of the mesh in one call.
+    // Per-instance data comes from a buffer added to va with a per-instance (divisor > 0) layout.
+    static void DrawInstanced(const Oglre::VertexArray& va, const Oglre::IndexBuffer& ibo, const Shader& shader, uint32_t instanceCount);
+
+    // Draws every command in batch with one glMultiDrawElementsIndirect() call. All of them must come from arena.
+    // The shader reads its per-draw model matrix from the storage block at IndirectDrawBatch::drawDataBinding with gl_DrawIDARB.
+    static void MultiDrawIndirect(const Oglre::GeometryArena& arena, Oglre::IndirectDrawBatch& batch, const Shader& shader);
+
+    // Records a draw for this frame. depth is the normalized [0, 1] depth of the object, used for ordering within a pass.
+    // materialID groups draws that share uniforms/textures, 0 if there is no such grouping.
+    static void Submit(const Oglre::VertexArray& va, const Oglre::IndexBuffer& ibo, Shader& shader, const Oglre::ObjectUniforms& uniforms,
+        float depth, uint32_t materialID = 0, RenderPass pass = RenderPass::SOLID);
+
+    // Sorts every command submitted since the last Flush() and executes them.
+    // Every command's ObjectUniforms are written to one buffer up front, then bound per draw with glBindBufferRange().
+    static void Flush();
+
+    // Sort key layout, most significant bits first: | pass: 4 | shader: 12 | material: 12 | vertex array: 12 | depth: 24 |
+    // IDs wider than their field only make sorting less effective, never incorrect, as Flush() compares the real objects.
+    static uint64_t MakeSortKey(RenderPass pass, uint32_t shaderID, uint32_t materialID, uint32_t vertexArrayID, float depth);
+
 private:
     static inline bool m_enableWireFrameMode = false;
-};
\ No newline at end of file
+
+    // Per-frame command buffer. Cleared, but never shrunk, so steady-state frames do not allocate.
+    static inline std::vector<RenderCommand> m_commands;
+    static inline std::vector<Oglre::SortItem> m_sortItems;
+    static inline std::vector<Oglre::SortItem> m_sortScratch;
+
+    // Created on first use, as they need a context.
+    static inline std::unique_ptr<Oglre::UniformBuffer> m_frameUniforms;
+    static inline std::unique_ptr<Oglre::UniformBuffer> m_objectUniforms;
+    static inline std::unique_ptr<Oglre::UniformBuffer> m_viewUniforms;
+
+    static void ApplyPassState(RenderPass pass);
+
+    // Every IndexBuffer shares the index heap's buffer, so draws start at the buffer's offset within it.
+    static const void* GetIndexOffset(const Oglre::IndexBuffer& ibo);
+};
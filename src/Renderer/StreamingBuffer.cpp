@@ -0,0 +1,93 @@
+#include "StreamingBuffer.h"
+#include "GLStateCache.h"
+
+#include <GL/glew.h>
+
+Oglre::StreamingBuffer::StreamingBuffer(uint32_t target, uint32_t regionSize, uint32_t alignment)
+    : m_RendererID(0)
+    , m_Target(target)
+    , m_Alignment(alignment)
+    , m_RegionSize(0)
+    , m_Region(0)
+    , m_StallCount(0)
+    , m_MappedData(nullptr)
+    , m_Fences {}
+{
+    Allocate(regionSize);
+}
+
+Oglre::StreamingBuffer::~StreamingBuffer()
+{
+    Release();
+}
+
+void* Oglre::StreamingBuffer::BeginRegion(uint32_t size)
+{
+    if (size > m_RegionSize) {
+        // Grow by half again, so that slowly growing data does not reallocate every frame.
+        Release();
+        Allocate(size + size / 2);
+    }
+
+    WaitForRegion(m_Region);
+    return m_MappedData + GetRegionOffset();
+}
+
+void Oglre::StreamingBuffer::EndRegion()
+{
+    m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_Region = (m_Region + 1) % regionCount;
+}
+
+void Oglre::StreamingBuffer::Bind() const
+{
+    GLStateCache::BindBuffer(m_Target, m_RendererID);
+}
+
+void Oglre::StreamingBuffer::Allocate(uint32_t regionSize)
+{
+    m_RegionSize = (regionSize + m_Alignment - 1) / m_Alignment * m_Alignment;
+    m_Region = 0;
+
+    // Persistent + coherent: mapped once for the buffer's lifetime, and CPU writes are visible without flushing.
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const GLsizeiptr size = static_cast<GLsizeiptr>(m_RegionSize) * regionCount;
+
+    glCreateBuffers(1, &m_RendererID);
+    glNamedBufferStorage(m_RendererID, size, nullptr, flags);
+    m_MappedData = static_cast<unsigned char*>(glMapNamedBufferRange(m_RendererID, 0, size, flags));
+}
+
+void Oglre::StreamingBuffer::Release()
+{
+    for (uint32_t region = 0; region < regionCount; ++region) {
+        WaitForRegion(region);
+    }
+
+    glUnmapNamedBuffer(m_RendererID);
+    GLStateCache::DeleteBuffer(m_RendererID);
+    m_MappedData = nullptr;
+}
+
+void Oglre::StreamingBuffer::WaitForRegion(uint32_t region)
+{
+    GLsync fence = static_cast<GLsync>(m_Fences[region]);
+    if (fence == nullptr) {
+        return;
+    }
+
+    // Check without waiting first, so stalls can be counted.
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        ++m_StallCount;
+
+        // Flushing makes sure the fence itself reaches the GPU, otherwise the wait could never end.
+        constexpr GLuint64 oneSecond = 1000000000;
+        do {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, oneSecond);
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+
+    glDeleteSync(fence);
+    m_Fences[region] = nullptr;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace Oglre {
+
+// A persistently mapped buffer for data that is rewritten every frame, e.g. per-draw or per-instance data.
+// The buffer is split into regionCount regions used round-robin. Each region is fenced once the GPU work that reads it
+// has been submitted, and only waited on when the CPU comes back round to it, so the CPU writes frame N + 2 while the
+// GPU is still reading frame N. Nothing is ever orphaned or reallocated, unless a frame needs a bigger region.
+//
+// Usage, once per frame:
+//     void* data = buffer.BeginRegion(size); (write up to size bytes to data)
+//     (issue draws that read from GetRegionOffset())
+//     buffer.EndRegion();
+//
+// Requires GL 4.4 or GL_ARB_buffer_storage.
+class StreamingBuffer {
+public:
+    static constexpr uint32_t regionCount = 3;
+
+    // Region offsets are multiples of alignment, e.g. GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT for storage buffers.
+    StreamingBuffer(uint32_t target, uint32_t regionSize, uint32_t alignment = 256);
+    ~StreamingBuffer();
+
+    StreamingBuffer(const StreamingBuffer&) = delete;
+    StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+    // Waits until the GPU is done with the next region, then returns where to write it. Grows the buffer if size does
+    // not fit, which waits for every region.
+    void* BeginRegion(uint32_t size);
+
+    // Fences the region, must follow the last GL command that reads it.
+    void EndRegion();
+
+    void Bind() const;
+
+    inline uint32_t GetRendererID() const
+    {
+        return m_RendererID;
+    }
+
+    // Byte offset of the region being written, valid between BeginRegion() and EndRegion().
+    inline uint32_t GetRegionOffset() const
+    {
+        return m_Region * m_RegionSize;
+    }
+
+    inline uint32_t GetRegionSize() const
+    {
+        return m_RegionSize;
+    }
+
+    // How many times BeginRegion() had to block because the GPU was still reading the region. Ideally 0.
+    inline uint32_t GetStallCount() const
+    {
+        return m_StallCount;
+    }
+
+private:
+    uint32_t m_RendererID;
+    uint32_t m_Target;
+    uint32_t m_Alignment;
+    uint32_t m_RegionSize;
+    uint32_t m_Region;
+    uint32_t m_StallCount;
+
+    unsigned char* m_MappedData;
+
+    // GLsync handles, one per region, nullptr once the region is known to be free.
+    std::array<void*, regionCount> m_Fences;
+
+    void Allocate(uint32_t regionSize);
+    void Release();
+    void WaitForRegion(uint32_t region);
+};
+}
@@ -0,0 +1,49 @@
+#include "UniformBuffer.h"
+#include "GLStateCache.h"
+
+#include <GL/glew.h>
+
+namespace {
+uint32_t GetUniformBufferOffsetAlignment()
+{
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    return alignment > 0 ? static_cast<uint32_t>(alignment) : 256;
+}
+
+uint32_t AlignUp(uint32_t size, uint32_t alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+}
+
+Oglre::UniformBuffer::UniformBuffer(uint32_t binding, uint32_t blockSize, uint32_t blockCount)
+    : m_Binding(binding)
+    , m_BlockSize(blockSize)
+    , m_BlockStride(AlignUp(blockSize, GetUniformBufferOffsetAlignment()))
+    , m_BoundOffset(-1)
+    , m_Data(nullptr)
+    , m_Buffer(GL_UNIFORM_BUFFER, blockCount * m_BlockStride, GetUniformBufferOffsetAlignment())
+{
+}
+
+void Oglre::UniformBuffer::Begin(uint32_t blockCount)
+{
+    m_Data = static_cast<unsigned char*>(m_Buffer.BeginRegion(blockCount * m_BlockStride));
+    m_BoundOffset = -1;
+}
+
+void Oglre::UniformBuffer::Bind(uint32_t index)
+{
+    const int64_t offset = m_Buffer.GetRegionOffset() + static_cast<int64_t>(index) * m_BlockStride;
+    if (offset != m_BoundOffset) {
+        GLStateCache::BindBufferRange(GL_UNIFORM_BUFFER, m_Binding, m_Buffer.GetRendererID(), offset, m_BlockSize);
+        m_BoundOffset = offset;
+    }
+}
+
+void Oglre::UniformBuffer::End()
+{
+    m_Buffer.EndRegion();
+    m_Data = nullptr;
+}
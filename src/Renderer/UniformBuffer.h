@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <glm/glm.hpp>
+
+#include "StreamingBuffer.h"
+
+namespace Oglre {
+
+// --------------
+// Uniform Blocks
+// --------------
+//
+// C++ mirrors of the std140 blocks in resources/shaders/include/Uniforms.glsl. Mostly mat4 and vec4 members, which
+// std140 lays out exactly as C++ does, so little padding needs writing by hand. Shader::Reflect() reports a program
+// whose blocks do not match these.
+
+// Written once per frame, see Renderer::SetFrameUniforms().
+struct FrameUniforms {
+    static constexpr uint32_t binding = 0;
+    static constexpr const char* blockName = "FrameUniforms";
+
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::vec4 cameraPosition; // w is 1.
+};
+
+// Written once per draw by Renderer::Flush().
+struct ObjectUniforms {
+    static constexpr uint32_t binding = 1;
+    static constexpr const char* blockName = "ObjectUniforms";
+
+    glm::mat4 model;
+    glm::mat4 mvp;
+};
+
+// Every view of a multi-view pass, written by Renderer::SetViews(). maxViews must match MAX_VIEWS in Uniforms.glsl.
+struct ViewUniforms {
+    static constexpr uint32_t binding = 2;
+    static constexpr const char* blockName = "ViewUniforms";
+    static constexpr uint32_t maxViews = 4;
+
+    glm::mat4 viewProjections[maxViews];
+    uint32_t viewCount;
+    uint32_t padding[3]; // std140 blocks are a multiple of 16 bytes.
+};
+
+static_assert(sizeof(FrameUniforms) == 208 && sizeof(ObjectUniforms) == 128 && sizeof(ViewUniforms) == 272, "Uniform blocks must match their std140 layout.");
+
+// Blocks of one uniform block type, streamed through a StreamingBuffer and bound to the block's binding point with
+// glBindBufferRange(). Each block starts at a multiple of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, so that any of them can
+// be bound on its own.
+//
+// Usage, once per frame:
+//     buffer.Begin(count); buffer.Write(i, block) for each block;
+//     buffer.Bind(i) before each draw that reads block i;
+//     buffer.End();
+class UniformBuffer {
+public:
+    UniformBuffer(uint32_t binding, uint32_t blockSize, uint32_t blockCount);
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    // Starts this frame's region, with room for blockCount blocks.
+    void Begin(uint32_t blockCount);
+
+    template <typename Block>
+    inline void Write(uint32_t index, const Block& block)
+    {
+        static_assert(std::is_trivially_copyable_v<Block>, "Uniform blocks are copied straight into the mapped buffer.");
+        std::memcpy(m_Data + index * m_BlockStride, &block, sizeof(Block));
+    }
+
+    // Binds block index of this frame's region. Binding the block that is already bound does nothing.
+    void Bind(uint32_t index);
+
+    // Fences this frame's region. Must follow the last draw that reads it.
+    void End();
+
+    inline bool IsWriting() const
+    {
+        return m_Data != nullptr;
+    }
+
+    inline uint32_t GetBinding() const
+    {
+        return m_Binding;
+    }
+
+private:
+    uint32_t m_Binding;
+    uint32_t m_BlockSize;
+    uint32_t m_BlockStride; // m_BlockSize rounded up to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+    int64_t m_BoundOffset; // -1 if nothing of this frame is bound yet.
+
+    unsigned char* m_Data; // This frame's region, nullptr outside of Begin() and End().
+
+    StreamingBuffer m_Buffer;
+};
+}
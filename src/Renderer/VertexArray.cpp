@@ -1,50 +1,122 @@
 #include <cstdint>
+#include <iostream>
 
+#include "GLStateCache.h"
 #include "Renderer.h"
 #include "VertexArray.h"
 
 Oglre::VertexArray::VertexArray()
+    : m_AttributeCount(0)
+    , m_AttachmentCount(0)
+    , m_IndexBuffer(nullptr)
+    , m_VertexHeapGeneration(0)
+    , m_IndexHeapGeneration(0)
 {
     glGenVertexArrays(1, &m_RendererID);
 }
 Oglre::VertexArray::~VertexArray()
 {
-    glDeleteVertexArrays(1, &m_RendererID);
+    GLStateCache::DeleteVertexArray(m_RendererID);
 }
 
 void Oglre::VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
 {
+    // The caller's layout may not outlive the VAO, so the attachment keeps a copy to point at.
+    if (m_AttachmentCount < maxAttachments) {
+        Attachment& attachment = m_Attachments[m_AttachmentCount];
+        attachment.runtimeLayout = layout;
+        AddBuffer(vb, attachment.runtimeLayout.GetElements(), layout.GetStride());
+    } else {
+        AddBuffer(vb, {}, layout.GetStride());
+    }
+}
+
+void Oglre::VertexArray::AddBuffer(const VertexBuffer& vb, std::span<const VertexBufferElement> elements, uint32_t stride)
+{
+    if (m_AttachmentCount == maxAttachments) {
+        std::cout << "Vertex array " << m_RendererID << " already has " << maxAttachments << " buffers, not adding another" << std::endl;
+        return;
+    }
+
     // First bind Vertex Array.
     Bind();
 
-    // Then bind buffer.
-    vb.Bind();
-
-    // Set up layout for the buffer.
-    const auto& elements = layout.GetElements();
+    Attachment& attachment = m_Attachments[m_AttachmentCount++];
+    attachment.buffer = &vb;
+    attachment.elements = elements;
+    attachment.stride = stride;
+    attachment.firstAttribute = m_AttributeCount;
+    m_AttributeCount += static_cast<uint32_t>(elements.size());
 
-    uint32_t offset = 0;
-    
-    // Loop through vertex attributes.
-    for (uint32_t index = 0; index < elements.size(); ++index) {
-        const auto& element = elements[index];
+    SpecifyAttributes(attachment);
+}
 
-        // Vertex Attribute
-        // Note the necessary void* cast due to the OpenGL API.
-        glVertexAttribPointer(index, element.count, element.type, element.normalized, layout.GetStride(), (void*)offset);
-        // Must enable the generic vertex attribute array for the vertex to be drawn.
-        glEnableVertexAttribArray(index);
+void Oglre::VertexArray::SetIndexBuffer(const IndexBuffer& ibo)
+{
+    Bind();
+    ibo.Bind();
 
-        offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
-    }
+    m_IndexBuffer = &ibo;
 }
 
 void Oglre::VertexArray::Bind() const
 {
-    glBindVertexArray(m_RendererID);
+    GLStateCache::BindVertexArray(m_RendererID);
+
+    // Growing or defragmenting a heap moves its data to a new buffer, which the VAO still points at the old one of.
+    const uint32_t vertexHeapGeneration = GpuHeap::Get(GpuHeapType::VERTEX).GetGeneration();
+    if (vertexHeapGeneration != m_VertexHeapGeneration) {
+        m_VertexHeapGeneration = vertexHeapGeneration;
+        for (uint32_t i = 0; i < m_AttachmentCount; ++i) {
+            SpecifyAttributes(m_Attachments[i]);
+        }
+    }
+
+    const uint32_t indexHeapGeneration = GpuHeap::Get(GpuHeapType::INDEX).GetGeneration();
+    if (indexHeapGeneration != m_IndexHeapGeneration) {
+        m_IndexHeapGeneration = indexHeapGeneration;
+        if (m_IndexBuffer != nullptr) {
+            m_IndexBuffer->Bind();
+        }
+    }
 }
 
 void Oglre::VertexArray::Unbind() const
 {
-    glBindVertexArray(0);
+    GLStateCache::BindVertexArray(0);
+}
+
+const Oglre::VertexBufferElement* Oglre::VertexArray::GetAttribute(uint32_t location) const
+{
+    for (uint32_t i = 0; i < m_AttachmentCount; ++i) {
+        const Attachment& attachment = m_Attachments[i];
+        if (location >= attachment.firstAttribute && location < attachment.firstAttribute + attachment.elements.size()) {
+            return &attachment.elements[location - attachment.firstAttribute];
+        }
+    }
+
+    return nullptr;
+}
+
+void Oglre::VertexArray::SpecifyAttributes(const Attachment& attachment) const
+{
+    // Then bind buffer.
+    attachment.buffer->Bind();
+
+    // Set up layout for the buffer. The buffer's data starts part way into the heap's buffer.
+    const uint32_t bufferOffset = attachment.buffer->GetOffset();
+    uint32_t index = attachment.firstAttribute;
+
+    // Loop through vertex attributes.
+    for (const VertexBufferElement& element : attachment.elements) {
+        // Vertex Attribute
+        // Note the necessary void* cast due to the OpenGL API.
+        const uint32_t offset = bufferOffset + element.offset;
+        glVertexAttribPointer(index, element.count, element.type, element.normalized, attachment.stride, reinterpret_cast<const void*>(static_cast<uintptr_t>(offset)));
+        // Must enable the generic vertex attribute array for the vertex to be drawn.
+        glEnableVertexAttribArray(index);
+        glVertexAttribDivisor(index, element.divisor);
+
+        ++index;
+    }
 }
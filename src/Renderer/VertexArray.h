@@ -1,7 +1,10 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
+#include <span>
 
+#include "IndexBuffer.h"
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
 namespace Oglre {
@@ -10,13 +13,69 @@ public:
     VertexArray();
     ~VertexArray();
 
+    // Attachments refer to their own layouts, so a VertexArray must not be copied or moved.
+    VertexArray(const VertexArray&) = delete;
+    VertexArray& operator=(const VertexArray&) = delete;
+
     // Binds Vertex Buffer and sets up the layout.
+    // Can be called once per buffer, e.g. for per-vertex and per-instance data. Attribute locations continue on from
+    // the previous buffer's, so a second buffer's first attribute is at location (number of attributes added so far).
     void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
 
+    // As above, for a buffer of Vertex structs with a compile-time layout, see VertexLayoutOf.
+    // The attributes are set straight from the constexpr layout, nothing is copied or allocated.
+    template <typename Vertex>
+    void AddBuffer(const VertexBuffer& vb)
+    {
+        AddBuffer(vb, StaticVertexLayout<Vertex>::elements, StaticVertexLayout<Vertex>::stride);
+    }
+
+    // Makes ibo part of the VAO's state, so binding the VAO is enough to draw with it.
+    void SetIndexBuffer(const IndexBuffer& ibo);
+
+    // Also re-specifies the attribute pointers and element buffer if the vertex or index heap has moved since.
     void Bind() const;
     void Unbind() const;
 
+    inline uint32_t GetRendererID() const
+    {
+        return m_RendererID;
+    }
+
+    inline uint32_t GetAttributeCount() const
+    {
+        return m_AttributeCount;
+    }
+
+    // The element that feeds attribute location, or nullptr if no buffer does. Matrices take up one per column.
+    const VertexBufferElement* GetAttribute(uint32_t location) const;
+
 private:
+    // A buffer added with AddBuffer(), kept so its attributes can be re-specified when the vertex heap moves.
+    // elements points either at a compile-time layout or at runtimeLayout's copy of a runtime one.
+    struct Attachment {
+        const VertexBuffer* buffer = nullptr;
+        std::span<const VertexBufferElement> elements;
+        uint32_t stride = 0;
+        uint32_t firstAttribute = 0;
+        VertexBufferLayout runtimeLayout;
+    };
+
+    // Every attachment has at least one attribute, and GL guarantees no more than 16 attribute locations.
+    static constexpr uint32_t maxAttachments = 16;
+
     uint32_t m_RendererID;
+    uint32_t m_AttributeCount;
+
+    std::array<Attachment, maxAttachments> m_Attachments;
+    uint32_t m_AttachmentCount;
+    const IndexBuffer* m_IndexBuffer;
+
+    // Heap generations the attribute pointers and element buffer were specified against.
+    mutable uint32_t m_VertexHeapGeneration;
+    mutable uint32_t m_IndexHeapGeneration;
+
+    void AddBuffer(const VertexBuffer& vb, std::span<const VertexBufferElement> elements, uint32_t stride);
+    void SpecifyAttributes(const Attachment& attachment) const;
 };
 }
\ No newline at end of file
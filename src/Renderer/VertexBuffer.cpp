@@ -1,26 +1,38 @@
 #include "VertexBuffer.h"
+#include "GLStateCache.h"
 #include <GL/glew.h>
 
-Oglre::VertexBuffer::VertexBuffer(const std::vector<float> data, uint32_t size)
+Oglre::VertexBuffer::VertexBuffer(std::span<const std::byte> data)
+    : m_Allocation(GpuHeap::Get(GpuHeapType::VERTEX).Allocate(static_cast<uint32_t>(data.size()), data.data()))
 {
-    const int numberOfBuffers = 1;
+}
+
+Oglre::VertexBuffer::VertexBuffer(std::span<const float> data)
+    : VertexBuffer(std::as_bytes(data))
+{
+}
 
-    glGenBuffers(numberOfBuffers, &m_RendererID);
-    glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
-    glBufferData(GL_ARRAY_BUFFER, size, data.data(), GL_STATIC_DRAW);
+Oglre::VertexBuffer::VertexBuffer(uint32_t size)
+    : m_Allocation(GpuHeap::Get(GpuHeapType::VERTEX).Allocate(size))
+{
 }
 
 Oglre::VertexBuffer::~VertexBuffer()
 {
-    glDeleteBuffers(1, &m_RendererID);
+    GpuHeap::Get(GpuHeapType::VERTEX).Free(m_Allocation);
+}
+
+void Oglre::VertexBuffer::Update(uint32_t offset, const void* data, uint32_t size)
+{
+    GpuHeap::Get(GpuHeapType::VERTEX).Update(m_Allocation, offset, data, size);
 }
 
 void Oglre::VertexBuffer::Bind() const
 {
-    glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+    GpuHeap::Get(GpuHeapType::VERTEX).Bind();
 }
 
 void Oglre::VertexBuffer::Unbind() const
 {
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
 }
@@ -1,18 +1,44 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
-#include <vector>
+#include <span>
+
+#include "GpuHeap.h"
 namespace Oglre {
-// Handles creation, binding, data storage and deletion of a Vertex Buffer Object.
+// A range of vertex data inside the shared vertex GpuHeap. Binding it binds the heap's buffer, which every
+// VertexBuffer shares, so the offset from GetOffset() must be added to attribute pointers (see VertexArray).
 class VertexBuffer {
 public:
-    VertexBuffer(const std::vector<float> data, uint32_t size);
+    // Uploads data straight from the caller's memory, e.g. a mapped MeshFile, without an intermediate copy.
+    VertexBuffer(std::span<const std::byte> data);
+    VertexBuffer(std::span<const float> data);
+
+    // Reserves size bytes without uploading anything, to be filled in with Update().
+    VertexBuffer(uint32_t size);
     ~VertexBuffer();
 
+    VertexBuffer(const VertexBuffer&) = delete;
+    VertexBuffer& operator=(const VertexBuffer&) = delete;
+
+    // Overwrites size bytes starting at offset. Does not bind anything.
+    void Update(uint32_t offset, const void* data, uint32_t size);
+
     void Bind() const;
     void Unbind() const;
 
+    // Byte offset of this buffer's data within the heap. Changes when the heap's generation does.
+    inline uint32_t GetOffset() const
+    {
+        return GpuHeap::Get(GpuHeapType::VERTEX).GetOffset(m_Allocation);
+    }
+
+    inline uint32_t GetRendererID() const
+    {
+        return GpuHeap::Get(GpuHeapType::VERTEX).GetRendererID();
+    }
+
 private:
-    uint32_t m_RendererID;
+    GpuHeap::Handle m_Allocation;
 };
-}
\ No newline at end of file
+}
@@ -1,9 +1,31 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
 #include <vector>
+
+#include <glm/glm.hpp>
 namespace Oglre {
+// Tags for the quantized attribute formats that have no C++ type of their own, for VertexBufferLayout::Push().
+// See VertexQuantizer for packing float data into them.
+struct Half {
+    uint16_t bits;
+};
+
+// Normalized 10 bit x, y, z and 2 bit w, packed into 32 bits with x in the lowest bits. Always 4 components.
+struct Snorm10_10_10_2 {
+    uint32_t bits;
+};
+
+struct Unorm10_10_10_2 {
+    uint32_t bits;
+};
+
 struct VertexBufferElement {
     uint32_t type;
     uint32_t count;
@@ -11,19 +33,42 @@ struct VertexBufferElement {
     // unsigned char rather than bool to avoid Glboolean conversion.
     unsigned char normalized;
 
-    static uint32_t GetSizeOfType(uint32_t type)
+    // 0 advances the attribute per vertex, N advances it once every N instances.
+    uint32_t divisor;
+
+    // Byte offset of the attribute within a vertex. Filled in by VertexBufferLayout::Push().
+    uint32_t offset = 0;
+
+    static constexpr uint32_t GetSizeOfType(uint32_t type)
     {
         // clang-format off
         switch (type)
         {
-            case GL_FLOAT:          return 4;
-            case GL_UNSIGNED_INT:   return 4;
-            case GL_UNSIGNED_BYTE:  return 1;
+            case GL_FLOAT:                          return 4;
+            case GL_UNSIGNED_INT:                   return 4;
+            case GL_HALF_FLOAT:                     return 2;
+            case GL_SHORT:                          return 2;
+            case GL_UNSIGNED_SHORT:                 return 2;
+            case GL_UNSIGNED_BYTE:                  return 1;
+            case GL_INT_2_10_10_10_REV:             return 4;
+            case GL_UNSIGNED_INT_2_10_10_10_REV:    return 4;
         }
         // clang-format on
 
         return 0;
     }
+
+    // Packed types hold all of their components in one GetSizeOfType() sized value.
+    static constexpr bool IsPackedType(uint32_t type)
+    {
+        return type == GL_INT_2_10_10_10_REV || type == GL_UNSIGNED_INT_2_10_10_10_REV;
+    }
+
+    // Size of the whole attribute in bytes.
+    constexpr uint32_t GetSize() const
+    {
+        return IsPackedType(type) ? GetSizeOfType(type) : count * GetSizeOfType(type);
+    }
 };
 
 // Maintains elements in the Vertex Buffer, specifying the layout of the buffer.
@@ -33,11 +78,25 @@ public:
     VertexBufferLayout()
         : m_Stride(0) {};
 
+    // Copies a layout whose offsets are already known, e.g. a StaticVertexLayout, for APIs that take a runtime layout.
+    VertexBufferLayout(std::span<const VertexBufferElement> elements, uint32_t stride)
+        : m_Elements(elements.begin(), elements.end())
+        , m_Stride(stride) {};
+
     template <typename T>
     // Explicitly prevent unspecified function from being called.
     // Templates are outside class as C++ standard does not allow for explicit template specialization
     // in a non-namespace scope.
-    void Push(uint32_t count) = delete;
+    // A non-zero divisor makes the attribute per-instance, see glVertexAttribDivisor().
+    void Push(uint32_t count, uint32_t divisor = 0) = delete;
+
+    // Appends an element that is only known at runtime, e.g. read from a mesh file.
+    inline void Push(const VertexBufferElement& element)
+    {
+        m_Elements.push_back(element);
+        m_Elements.back().offset = m_Stride;
+        m_Stride += element.GetSize();
+    }
 
     // Long explanation, see: http://docs.gl/gl4/glVertexAttribPointer
     inline uint32_t GetStride() const
@@ -45,7 +104,7 @@ public:
         return m_Stride;
     }
 
-    inline const std::vector<VertexBufferElement> GetElements() const
+    inline const std::vector<VertexBufferElement>& GetElements() const
     {
         return m_Elements;
     }
@@ -58,23 +117,175 @@ private:
 
 // Specializations for each type of element.
 template <>
-inline void VertexBufferLayout::Push<float>(uint32_t count)
+inline void VertexBufferLayout::Push<float>(uint32_t count, uint32_t divisor)
+{
+    Push({ GL_FLOAT, count, GL_FALSE, divisor });
+}
+
+template <>
+inline void VertexBufferLayout::Push<uint32_t>(uint32_t count, uint32_t divisor)
+{
+    Push({ GL_UNSIGNED_INT, count, GL_FALSE, divisor });
+}
+
+template <>
+inline void VertexBufferLayout::Push<unsigned char>(uint32_t count, uint32_t divisor)
 {
-    m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
-    m_Stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT);
+    Push({ GL_UNSIGNED_BYTE, count, GL_TRUE, divisor });
 }
 
+// Normalized 16-bit integers, read as floats in [-1, 1].
 template <>
-inline void VertexBufferLayout::Push<uint32_t>(uint32_t count)
+inline void VertexBufferLayout::Push<int16_t>(uint32_t count, uint32_t divisor)
 {
-    m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
-    m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT);
+    Push({ GL_SHORT, count, GL_TRUE, divisor });
 }
 
+// Normalized 16-bit integers, read as floats in [0, 1].
 template <>
-inline void VertexBufferLayout::Push<unsigned char>(uint32_t count)
+inline void VertexBufferLayout::Push<uint16_t>(uint32_t count, uint32_t divisor)
 {
-    m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
-    m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
+    Push({ GL_UNSIGNED_SHORT, count, GL_TRUE, divisor });
+}
+
+template <>
+inline void VertexBufferLayout::Push<Half>(uint32_t count, uint32_t divisor)
+{
+    Push({ GL_HALF_FLOAT, count, GL_FALSE, divisor });
+}
+
+// Packed attributes always have 4 components, so count is the number of packed values, i.e. attributes.
+template <>
+inline void VertexBufferLayout::Push<Snorm10_10_10_2>(uint32_t count, uint32_t divisor)
+{
+    for (uint32_t attribute = 0; attribute < count; ++attribute) {
+        Push({ GL_INT_2_10_10_10_REV, 4, GL_TRUE, divisor });
+    }
+}
+
+template <>
+inline void VertexBufferLayout::Push<Unorm10_10_10_2>(uint32_t count, uint32_t divisor)
+{
+    for (uint32_t attribute = 0; attribute < count; ++attribute) {
+        Push({ GL_UNSIGNED_INT_2_10_10_10_REV, 4, GL_TRUE, divisor });
+    }
+}
+
+// A vertex attribute can be at most a vec4, so each matrix takes up four consecutive attribute locations, one per column.
+// count is the number of matrices.
+template <>
+inline void VertexBufferLayout::Push<glm::mat4>(uint32_t count, uint32_t divisor)
+{
+    const uint32_t columnsPerMatrix = 4;
+    for (uint32_t column = 0; column < count * columnsPerMatrix; ++column) {
+        Push<float>(4, divisor);
+    }
+}
+
+// --------------------
+// Compile-Time Layouts
+// --------------------
+//
+// A layout declared next to a vertex struct, with every offset taken from offsetof() and checked at compile time:
+//
+//   struct ColouredVertex {
+//       glm::vec3 position;
+//       Unorm10_10_10_2 colour;
+//   };
+//
+//   template <>
+//   struct VertexLayoutOf<ColouredVertex> {
+//       static constexpr auto elements = MakeVertexElements(
+//           OGLRE_VERTEX_ATTRIBUTE(ColouredVertex, position),
+//           OGLRE_VERTEX_ATTRIBUTE(ColouredVertex, colour));
+//   };
+//
+// VertexArray::AddBuffer<ColouredVertex>() then sets the attributes straight from the constexpr array.
+
+// The attribute format of a vertex struct member type. Types without a specialization do not compile.
+template <typename T>
+struct VertexAttributeFormat;
+
+template <uint32_t Type, uint32_t Count, bool Normalized, uint32_t Columns = 1>
+struct VertexAttributeFormatOf {
+    static constexpr uint32_t type = Type;
+    static constexpr uint32_t count = Count;
+    static constexpr bool normalized = Normalized;
+    static constexpr uint32_t columns = Columns; // Attribute locations taken up, more than 1 for matrices.
+};
+
+// clang-format off
+template <> struct VertexAttributeFormat<float> : VertexAttributeFormatOf<GL_FLOAT, 1, false> {};
+template <> struct VertexAttributeFormat<glm::vec2> : VertexAttributeFormatOf<GL_FLOAT, 2, false> {};
+template <> struct VertexAttributeFormat<glm::vec3> : VertexAttributeFormatOf<GL_FLOAT, 3, false> {};
+template <> struct VertexAttributeFormat<glm::vec4> : VertexAttributeFormatOf<GL_FLOAT, 4, false> {};
+template <> struct VertexAttributeFormat<glm::mat4> : VertexAttributeFormatOf<GL_FLOAT, 4, false, 4> {};
+template <> struct VertexAttributeFormat<Snorm10_10_10_2> : VertexAttributeFormatOf<GL_INT_2_10_10_10_REV, 4, true> {};
+template <> struct VertexAttributeFormat<Unorm10_10_10_2> : VertexAttributeFormatOf<GL_UNSIGNED_INT_2_10_10_10_REV, 4, true> {};
+template <size_t N> struct VertexAttributeFormat<std::array<Half, N>> : VertexAttributeFormatOf<GL_HALF_FLOAT, N, false> {};
+template <size_t N> struct VertexAttributeFormat<std::array<int16_t, N>> : VertexAttributeFormatOf<GL_SHORT, N, true> {};
+template <size_t N> struct VertexAttributeFormat<std::array<uint16_t, N>> : VertexAttributeFormatOf<GL_UNSIGNED_SHORT, N, true> {};
+// clang-format on
+
+// The elements of one struct member of type T, at offset bytes into the vertex.
+template <typename T>
+constexpr std::array<VertexBufferElement, VertexAttributeFormat<T>::columns> MakeMemberElements(uint32_t offset, uint32_t divisor)
+{
+    using Format = VertexAttributeFormat<T>;
+    constexpr VertexBufferElement column { Format::type, Format::count, Format::normalized, 0 };
+    static_assert(sizeof(T) == Format::columns * column.GetSize(), "The member's size does not match its vertex attribute format.");
+
+    std::array<VertexBufferElement, Format::columns> elements {};
+    for (uint32_t i = 0; i < Format::columns; ++i) {
+        elements[i] = { Format::type, Format::count, Format::normalized, divisor, offset + i * column.GetSize() };
+    }
+    return elements;
+}
+
+// Joins the elements of each member, in attribute location order.
+template <size_t... Counts>
+constexpr std::array<VertexBufferElement, (Counts + ...)> MakeVertexElements(const std::array<VertexBufferElement, Counts>&... members)
+{
+    std::array<VertexBufferElement, (Counts + ...)> elements {};
+    size_t next = 0;
+    ((std::copy(members.begin(), members.end(), elements.begin() + next), next += Counts), ...);
+    return elements;
+}
+
+// Per-vertex and per-instance (divisor 1) attributes from a member of a vertex struct.
+#define OGLRE_VERTEX_ATTRIBUTE(Vertex, member) ::Oglre::MakeMemberElements<decltype(Vertex::member)>(offsetof(Vertex, member), 0)
+#define OGLRE_INSTANCE_ATTRIBUTE(Vertex, member) ::Oglre::MakeMemberElements<decltype(Vertex::member)>(offsetof(Vertex, member), 1)
+
+// Specialize with a static constexpr std::array<VertexBufferElement, N> elements, see above.
+template <typename Vertex>
+struct VertexLayoutOf;
+
+// True if no two elements overlap, and all of them fit within size bytes.
+template <size_t N>
+constexpr bool AreVertexElementsDisjoint(const std::array<VertexBufferElement, N>& elements, size_t size)
+{
+    for (size_t i = 0; i < N; ++i) {
+        if (elements[i].offset + elements[i].GetSize() > size) {
+            return false;
+        }
+        for (size_t j = i + 1; j < N; ++j) {
+            const bool isBefore = elements[i].offset + elements[i].GetSize() <= elements[j].offset;
+            const bool isAfter = elements[j].offset + elements[j].GetSize() <= elements[i].offset;
+            if (!isBefore && !isAfter) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// The checked layout of Vertex. The stride is sizeof(Vertex), so arrays of Vertex can be uploaded as they are.
+template <typename Vertex>
+struct StaticVertexLayout {
+    static_assert(std::is_standard_layout_v<Vertex>, "Vertex structs must be standard-layout, for offsetof().");
+    static_assert(AreVertexElementsDisjoint(VertexLayoutOf<Vertex>::elements, sizeof(Vertex)), "Vertex attributes overlap or extend past the end of the vertex struct.");
+
+    static constexpr std::span<const VertexBufferElement> elements = VertexLayoutOf<Vertex>::elements;
+    static constexpr uint32_t stride = sizeof(Vertex);
+};
 }
-}
\ No newline at end of file
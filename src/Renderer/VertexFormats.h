@@ -0,0 +1,34 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "VertexBufferLayout.h"
+
+namespace Oglre {
+
+// Vertex structs with compile-time layouts, for VertexArray::AddBuffer<Vertex>().
+
+// Position and 10 bit per channel colour, 16 bytes. Used by the demo meshes.
+struct ColouredVertex {
+    glm::vec3 position;
+    Unorm10_10_10_2 colour;
+};
+
+template <>
+struct VertexLayoutOf<ColouredVertex> {
+    static constexpr auto elements = MakeVertexElements(
+        OGLRE_VERTEX_ATTRIBUTE(ColouredVertex, position),
+        OGLRE_VERTEX_ATTRIBUTE(ColouredVertex, colour));
+};
+static_assert(StaticVertexLayout<ColouredVertex>::stride == 16, "ColouredVertex must stay tightly packed.");
+
+// Per-instance model matrix, taking up 4 attribute locations.
+struct InstanceTransform {
+    glm::mat4 model;
+};
+
+template <>
+struct VertexLayoutOf<InstanceTransform> {
+    static constexpr auto elements = MakeVertexElements(OGLRE_INSTANCE_ATTRIBUTE(InstanceTransform, model));
+};
+}
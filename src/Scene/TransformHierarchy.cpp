@@ -0,0 +1,393 @@
+#include "TransformHierarchy.h"
+
+#include "JobSystem.h"
+
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64)
+#define OGLRE_TRANSFORM_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace {
+constexpr uint32_t batchSize = 4;
+
+// Calls function(begin, end) over [0, count), in whole batches spread over the job system if count is at least threshold.
+template <typename Function>
+void ForEachChunk(uint32_t count, uint32_t threshold, const Function& function)
+{
+    if (count < threshold) {
+        function(0u, count);
+        return;
+    }
+    Oglre::JobSystem::ParallelFor(count, batchSize, function);
+}
+
+#ifdef OGLRE_TRANSFORM_SSE
+// result = a * b, with b's columns given as the 4 broadcast components of each.
+inline void MultiplyColumns(const __m128 a[4], const float* b, float* result)
+{
+    for (int column = 0; column < 4; ++column) {
+        const float* c = b + column * 4;
+        __m128 sum = _mm_mul_ps(a[0], _mm_set1_ps(c[0]));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a[1], _mm_set1_ps(c[1])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a[2], _mm_set1_ps(c[2])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a[3], _mm_set1_ps(c[3])));
+        _mm_storeu_ps(result + column * 4, sum);
+    }
+}
+#endif
+}
+
+// -----
+// Nodes
+// -----
+
+uint32_t Oglre::TransformHierarchy::CreateNode(uint32_t parent, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale)
+{
+    const uint32_t handle = static_cast<uint32_t>(m_Indices.size());
+    const uint32_t index = static_cast<uint32_t>(m_Handles.size());
+
+    // Appended out of order for now, Reorder() moves it where it belongs.
+    m_Indices.push_back(index);
+    m_ParentHandles.push_back(parent);
+    m_Handles.push_back(handle);
+    m_Parents.push_back(parent == noParent ? noParent : m_Indices[parent]);
+    m_FirstChildren.push_back(0);
+    m_ChildCounts.push_back(0);
+    m_Depths.push_back(parent == noParent ? 0 : m_Depths[m_Indices[parent]] + 1);
+
+    m_TranslationX.push_back(translation.x);
+    m_TranslationY.push_back(translation.y);
+    m_TranslationZ.push_back(translation.z);
+    m_RotationX.push_back(rotation.x);
+    m_RotationY.push_back(rotation.y);
+    m_RotationZ.push_back(rotation.z);
+    m_RotationW.push_back(rotation.w);
+    m_ScaleX.push_back(scale.x);
+    m_ScaleY.push_back(scale.y);
+    m_ScaleZ.push_back(scale.z);
+
+    m_WorldMatrices.push_back(glm::mat4(1.0f));
+    m_IsDirty.push_back(0);
+
+    m_IsOrderDirty = true;
+
+    return handle;
+}
+
+void Oglre::TransformHierarchy::SetTranslation(uint32_t node, const glm::vec3& translation)
+{
+    const uint32_t index = m_Indices[node];
+    m_TranslationX[index] = translation.x;
+    m_TranslationY[index] = translation.y;
+    m_TranslationZ[index] = translation.z;
+    MarkDirty(index);
+}
+
+void Oglre::TransformHierarchy::SetRotation(uint32_t node, const glm::quat& rotation)
+{
+    const uint32_t index = m_Indices[node];
+    m_RotationX[index] = rotation.x;
+    m_RotationY[index] = rotation.y;
+    m_RotationZ[index] = rotation.z;
+    m_RotationW[index] = rotation.w;
+    MarkDirty(index);
+}
+
+void Oglre::TransformHierarchy::SetScale(uint32_t node, const glm::vec3& scale)
+{
+    const uint32_t index = m_Indices[node];
+    m_ScaleX[index] = scale.x;
+    m_ScaleY[index] = scale.y;
+    m_ScaleZ[index] = scale.z;
+    MarkDirty(index);
+}
+
+void Oglre::TransformHierarchy::SetLocal(uint32_t node, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale)
+{
+    SetTranslation(node, translation);
+    SetRotation(node, rotation);
+    SetScale(node, scale);
+}
+
+glm::vec3 Oglre::TransformHierarchy::GetTranslation(uint32_t node) const
+{
+    const uint32_t index = m_Indices[node];
+    return glm::vec3(m_TranslationX[index], m_TranslationY[index], m_TranslationZ[index]);
+}
+
+glm::quat Oglre::TransformHierarchy::GetRotation(uint32_t node) const
+{
+    const uint32_t index = m_Indices[node];
+    return glm::quat(m_RotationW[index], m_RotationX[index], m_RotationY[index], m_RotationZ[index]);
+}
+
+glm::vec3 Oglre::TransformHierarchy::GetScale(uint32_t node) const
+{
+    const uint32_t index = m_Indices[node];
+    return glm::vec3(m_ScaleX[index], m_ScaleY[index], m_ScaleZ[index]);
+}
+
+void Oglre::TransformHierarchy::MarkDirty(uint32_t index)
+{
+    // Everything is recomputed after a reorder anyway.
+    if (m_IsOrderDirty || m_IsDirty[index]) {
+        return;
+    }
+
+    m_IsDirty[index] = 1;
+    m_DirtyNodes[m_Depths[index]].push_back(index);
+}
+
+void Oglre::TransformHierarchy::Reorder()
+{
+    const uint32_t nodeCount = GetNodeCount();
+
+    // Children of each node, by handle.
+    std::vector<uint32_t> childOffsets(nodeCount + 1, 0);
+    for (uint32_t parent : m_ParentHandles) {
+        if (parent != noParent) {
+            ++childOffsets[parent + 1];
+        }
+    }
+    for (uint32_t handle = 0; handle < nodeCount; ++handle) {
+        childOffsets[handle + 1] += childOffsets[handle];
+    }
+
+    std::vector<uint32_t> children(childOffsets[nodeCount]);
+    std::vector<uint32_t> cursors(childOffsets.begin(), childOffsets.end() - 1);
+    for (uint32_t handle = 0; handle < nodeCount; ++handle) {
+        if (m_ParentHandles[handle] != noParent) {
+            children[cursors[m_ParentHandles[handle]]++] = handle;
+        }
+    }
+
+    // Breadth first from the roots, which puts every node's children next to each other.
+    std::vector<uint32_t> order;
+    order.reserve(nodeCount);
+    for (uint32_t handle = 0; handle < nodeCount; ++handle) {
+        if (m_ParentHandles[handle] == noParent) {
+            order.push_back(handle);
+        }
+    }
+    for (size_t i = 0; i < order.size(); ++i) {
+        const uint32_t handle = order[i];
+        order.insert(order.end(), children.begin() + childOffsets[handle], children.begin() + childOffsets[handle + 1]);
+    }
+
+    for (uint32_t index = 0; index < nodeCount; ++index) {
+        m_Indices[order[index]] = index;
+    }
+
+    // m_Handles still holds the old order here, so each value moves from its old index to its new one.
+    std::vector<float> reordered(nodeCount);
+    for (std::vector<float>* values : { &m_TranslationX, &m_TranslationY, &m_TranslationZ, &m_RotationX, &m_RotationY, &m_RotationZ, &m_RotationW,
+             &m_ScaleX, &m_ScaleY, &m_ScaleZ }) {
+        for (uint32_t oldIndex = 0; oldIndex < nodeCount; ++oldIndex) {
+            reordered[m_Indices[m_Handles[oldIndex]]] = (*values)[oldIndex];
+        }
+        values->swap(reordered);
+    }
+
+    uint32_t depthCount = 0;
+    for (uint32_t index = 0; index < nodeCount; ++index) {
+        const uint32_t handle = order[index];
+        const uint32_t parent = m_ParentHandles[handle];
+
+        m_Handles[index] = handle;
+        m_Parents[index] = parent == noParent ? noParent : m_Indices[parent];
+        m_Depths[index] = parent == noParent ? 0 : m_Depths[m_Parents[index]] + 1;
+        m_ChildCounts[index] = childOffsets[handle + 1] - childOffsets[handle];
+        m_FirstChildren[index] = m_ChildCounts[index] > 0 ? m_Indices[children[childOffsets[handle]]] : 0;
+
+        depthCount = std::max(depthCount, m_Depths[index] + 1);
+    }
+
+    m_DirtyNodes.assign(depthCount, {});
+    std::fill(m_IsDirty.begin(), m_IsDirty.end(), 0);
+    m_IsOrderDirty = false;
+}
+
+// ----------------------
+// World and MVP Matrices
+// ----------------------
+
+uint32_t Oglre::TransformHierarchy::Update()
+{
+    // After a reorder every node is recomputed, and each depth's nodes are contiguous.
+    if (m_IsOrderDirty) {
+        Reorder();
+
+        uint32_t depthBegin = 0;
+        while (depthBegin < GetNodeCount()) {
+            uint32_t depthEnd = depthBegin;
+            while (depthEnd < GetNodeCount() && m_Depths[depthEnd] == m_Depths[depthBegin]) {
+                ++depthEnd;
+            }
+
+            UpdateDepth(depthEnd - depthBegin, [depthBegin](uint32_t i) { return depthBegin + i; });
+            depthBegin = depthEnd;
+        }
+
+        return GetNodeCount();
+    }
+
+    // Each depth's dirty nodes make their children dirty, which are then updated with the next depth.
+    uint32_t updatedCount = 0;
+    for (size_t depth = 0; depth < m_DirtyNodes.size(); ++depth) {
+        std::vector<uint32_t>& dirtyNodes = m_DirtyNodes[depth];
+        if (dirtyNodes.empty()) {
+            continue;
+        }
+
+        UpdateDepth(static_cast<uint32_t>(dirtyNodes.size()), [&dirtyNodes](uint32_t i) { return dirtyNodes[i]; });
+
+        for (uint32_t index : dirtyNodes) {
+            for (uint32_t child = m_FirstChildren[index]; child < m_FirstChildren[index] + m_ChildCounts[index]; ++child) {
+                if (!m_IsDirty[child]) {
+                    m_IsDirty[child] = 1;
+                    m_DirtyNodes[depth + 1].push_back(child);
+                }
+            }
+            m_IsDirty[index] = 0;
+        }
+
+        updatedCount += static_cast<uint32_t>(dirtyNodes.size());
+        dirtyNodes.clear();
+    }
+
+    return updatedCount;
+}
+
+template <typename NodeAt>
+void Oglre::TransformHierarchy::UpdateDepth(uint32_t count, const NodeAt& nodeAt)
+{
+    ForEachChunk(count, parallelThreshold, [&](uint32_t begin, uint32_t end) {
+        // Local matrices of a batch of nodes: the 12 non-constant elements of T * R * S, one node per lane.
+        alignas(16) float locals[12][batchSize];
+        uint32_t nodes[batchSize];
+
+        for (uint32_t batchBegin = begin; batchBegin < end; batchBegin += batchSize) {
+            const uint32_t batchCount = std::min(batchSize, end - batchBegin);
+
+            // Gathered into lanes. A partial batch repeats its last node.
+            alignas(16) float lanes[10][batchSize];
+            for (uint32_t lane = 0; lane < batchSize; ++lane) {
+                const uint32_t index = nodeAt(batchBegin + std::min(lane, batchCount - 1));
+                nodes[lane] = index;
+
+                lanes[0][lane] = m_TranslationX[index];
+                lanes[1][lane] = m_TranslationY[index];
+                lanes[2][lane] = m_TranslationZ[index];
+                lanes[3][lane] = m_RotationX[index];
+                lanes[4][lane] = m_RotationY[index];
+                lanes[5][lane] = m_RotationZ[index];
+                lanes[6][lane] = m_RotationW[index];
+                lanes[7][lane] = m_ScaleX[index];
+                lanes[8][lane] = m_ScaleY[index];
+                lanes[9][lane] = m_ScaleZ[index];
+            }
+
+#ifdef OGLRE_TRANSFORM_SSE
+            const __m128 x = _mm_load_ps(lanes[3]);
+            const __m128 y = _mm_load_ps(lanes[4]);
+            const __m128 z = _mm_load_ps(lanes[5]);
+            const __m128 w = _mm_load_ps(lanes[6]);
+            const __m128 scaleX = _mm_load_ps(lanes[7]);
+            const __m128 scaleY = _mm_load_ps(lanes[8]);
+            const __m128 scaleZ = _mm_load_ps(lanes[9]);
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 two = _mm_set1_ps(2.0f);
+
+            const __m128 xx = _mm_mul_ps(x, x);
+            const __m128 yy = _mm_mul_ps(y, y);
+            const __m128 zz = _mm_mul_ps(z, z);
+            const __m128 xy = _mm_mul_ps(x, y);
+            const __m128 xz = _mm_mul_ps(x, z);
+            const __m128 yz = _mm_mul_ps(y, z);
+            const __m128 wx = _mm_mul_ps(w, x);
+            const __m128 wy = _mm_mul_ps(w, y);
+            const __m128 wz = _mm_mul_ps(w, z);
+
+            // Rotation columns, each scaled by the scale along it.
+            _mm_store_ps(locals[0], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), scaleX));
+            _mm_store_ps(locals[1], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), scaleX));
+            _mm_store_ps(locals[2], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), scaleX));
+            _mm_store_ps(locals[3], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), scaleY));
+            _mm_store_ps(locals[4], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), scaleY));
+            _mm_store_ps(locals[5], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), scaleY));
+            _mm_store_ps(locals[6], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), scaleZ));
+            _mm_store_ps(locals[7], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), scaleZ));
+            _mm_store_ps(locals[8], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), scaleZ));
+#else
+            for (uint32_t lane = 0; lane < batchSize; ++lane) {
+                const float x = lanes[3][lane], y = lanes[4][lane], z = lanes[5][lane], w = lanes[6][lane];
+                const float scaleX = lanes[7][lane], scaleY = lanes[8][lane], scaleZ = lanes[9][lane];
+
+                locals[0][lane] = (1.0f - 2.0f * (y * y + z * z)) * scaleX;
+                locals[1][lane] = (2.0f * (x * y + w * z)) * scaleX;
+                locals[2][lane] = (2.0f * (x * z - w * y)) * scaleX;
+                locals[3][lane] = (2.0f * (x * y - w * z)) * scaleY;
+                locals[4][lane] = (1.0f - 2.0f * (x * x + z * z)) * scaleY;
+                locals[5][lane] = (2.0f * (y * z + w * x)) * scaleY;
+                locals[6][lane] = (2.0f * (x * z + w * y)) * scaleZ;
+                locals[7][lane] = (2.0f * (y * z - w * x)) * scaleZ;
+                locals[8][lane] = (1.0f - 2.0f * (x * x + y * y)) * scaleZ;
+            }
+#endif
+            for (uint32_t lane = 0; lane < batchSize; ++lane) {
+                locals[9][lane] = lanes[0][lane];
+                locals[10][lane] = lanes[1][lane];
+                locals[11][lane] = lanes[2][lane];
+            }
+
+            // World = parent world * local. Parents are one depth up, so they are already up to date.
+            for (uint32_t lane = 0; lane < batchCount; ++lane) {
+                // clang-format off
+                const float local[16] = {
+                    locals[0][lane], locals[1][lane], locals[2][lane], 0.0f,
+                    locals[3][lane], locals[4][lane], locals[5][lane], 0.0f,
+                    locals[6][lane], locals[7][lane], locals[8][lane], 0.0f,
+                    locals[9][lane], locals[10][lane], locals[11][lane], 1.0f
+                };
+                // clang-format on
+
+                const uint32_t index = nodes[lane];
+                float* world = &m_WorldMatrices[index][0][0];
+                if (m_Parents[index] == noParent) {
+                    std::copy(local, local + 16, world);
+                    continue;
+                }
+
+                const glm::mat4& parent = m_WorldMatrices[m_Parents[index]];
+#ifdef OGLRE_TRANSFORM_SSE
+                const __m128 parentColumns[4] = { _mm_loadu_ps(&parent[0][0]), _mm_loadu_ps(&parent[1][0]), _mm_loadu_ps(&parent[2][0]), _mm_loadu_ps(&parent[3][0]) };
+                MultiplyColumns(parentColumns, local, world);
+#else
+                glm::mat4 localMatrix;
+                std::copy(local, local + 16, &localMatrix[0][0]);
+                m_WorldMatrices[index] = parent * localMatrix;
+#endif
+            }
+        }
+    });
+}
+
+void Oglre::TransformHierarchy::ComputeMvpMatrices(const glm::mat4& viewProjection, std::span<const uint32_t> nodes, std::span<glm::mat4> mvpMatrices) const
+{
+    ForEachChunk(static_cast<uint32_t>(nodes.size()), parallelThreshold, [&](uint32_t begin, uint32_t end) {
+#ifdef OGLRE_TRANSFORM_SSE
+        const __m128 viewProjectionColumns[4] = { _mm_loadu_ps(&viewProjection[0][0]), _mm_loadu_ps(&viewProjection[1][0]),
+            _mm_loadu_ps(&viewProjection[2][0]), _mm_loadu_ps(&viewProjection[3][0]) };
+
+        for (uint32_t i = begin; i < end; ++i) {
+            MultiplyColumns(viewProjectionColumns, &GetWorldMatrix(nodes[i])[0][0], &mvpMatrices[i][0][0]);
+        }
+#else
+        for (uint32_t i = begin; i < end; ++i) {
+            mvpMatrices[i] = viewProjection * GetWorldMatrix(nodes[i]);
+        }
+#endif
+    });
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace Oglre {
+
+// -------------------
+// Transform Hierarchy
+// -------------------
+//
+// Parent/child transforms of a scene's nodes. Each node has a local translation, rotation and scale (TRS), and a world
+// matrix, its parent's world matrix times its local matrix.
+//
+// Nodes are stored structure-of-arrays in breadth-first order, so the nodes of each depth are contiguous and come after
+// their parents, and a node's children are contiguous. Changing a node's local transform marks it dirty, and Update()
+// recomputes the world matrices of the dirty nodes and their descendants only, one depth at a time. Its cost grows with
+// the number of nodes that changed, not with the size of the scene.
+//
+// Matrices are computed 4 nodes at a time with SSE where available. Depths with at least parallelThreshold dirty nodes
+// are split over the job system's threads.
+//
+// Nodes are identified by the handle CreateNode() returns, which does not change as nodes are reordered.
+class TransformHierarchy {
+public:
+    static constexpr uint32_t noParent = std::numeric_limits<uint32_t>::max();
+
+    uint32_t parallelThreshold = 1 << 14;
+
+    // parent must already exist. The new node is dirty, and placed in order by the next Update(), which is then a
+    // full update. Create nodes up front rather than every frame.
+    uint32_t CreateNode(uint32_t parent = noParent, const glm::vec3& translation = glm::vec3(0.0f), const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+        const glm::vec3& scale = glm::vec3(1.0f));
+
+    void SetTranslation(uint32_t node, const glm::vec3& translation);
+    void SetRotation(uint32_t node, const glm::quat& rotation);
+    void SetScale(uint32_t node, const glm::vec3& scale);
+    void SetLocal(uint32_t node, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale);
+
+    glm::vec3 GetTranslation(uint32_t node) const;
+    glm::quat GetRotation(uint32_t node) const;
+    glm::vec3 GetScale(uint32_t node) const;
+
+    // Recomputes the world matrices of every dirty node and its descendants. Returns how many were recomputed.
+    uint32_t Update();
+
+    // As of the last Update().
+    inline const glm::mat4& GetWorldMatrix(uint32_t node) const
+    {
+        return m_WorldMatrices[m_Indices[node]];
+    }
+
+    // Writes viewProjection * world of each of nodes to mvpMatrices, which must be as long as nodes.
+    void ComputeMvpMatrices(const glm::mat4& viewProjection, std::span<const uint32_t> nodes, std::span<glm::mat4> mvpMatrices) const;
+
+    inline uint32_t GetNodeCount() const
+    {
+        return static_cast<uint32_t>(m_Indices.size());
+    }
+
+    inline uint32_t GetDepthCount() const
+    {
+        return static_cast<uint32_t>(m_DirtyNodes.size());
+    }
+
+private:
+    // Per node, by handle.
+    std::vector<uint32_t> m_Indices; // Index into the arrays below.
+    std::vector<uint32_t> m_ParentHandles;
+
+    // Per node, in breadth-first order.
+    std::vector<uint32_t> m_Handles;
+    std::vector<uint32_t> m_Parents; // Index of the parent, noParent for roots.
+    std::vector<uint32_t> m_FirstChildren;
+    std::vector<uint32_t> m_ChildCounts;
+    std::vector<uint32_t> m_Depths;
+
+    std::vector<float> m_TranslationX;
+    std::vector<float> m_TranslationY;
+    std::vector<float> m_TranslationZ;
+    std::vector<float> m_RotationX;
+    std::vector<float> m_RotationY;
+    std::vector<float> m_RotationZ;
+    std::vector<float> m_RotationW;
+    std::vector<float> m_ScaleX;
+    std::vector<float> m_ScaleY;
+    std::vector<float> m_ScaleZ;
+
+    std::vector<glm::mat4> m_WorldMatrices;
+
+    std::vector<uint8_t> m_IsDirty;
+    std::vector<std::vector<uint32_t>> m_DirtyNodes; // Per depth.
+
+    // Set by CreateNode(), the nodes need putting back into breadth-first order and every world matrix recomputing.
+    bool m_IsOrderDirty = false;
+
+    void MarkDirty(uint32_t index);
+
+    // Rebuilds the breadth-first order from m_ParentHandles.
+    void Reorder();
+
+    // Computes the world matrices of nodes[0, count), which must all be at the same depth.
+    template <typename NodeAt>
+    void UpdateDepth(uint32_t count, const NodeAt& nodeAt);
+};
+}
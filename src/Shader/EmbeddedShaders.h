@@ -0,0 +1,37 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+
+#include "ShaderPreprocessor.h"
+
+namespace Oglre {
+
+struct EmbeddedShaderStage {
+    ShaderStage stage;
+    const char* condition; // See ShaderStageSource.
+    const char* version;
+    const char* body;
+};
+
+// A program from resources/shaders, preprocessed at build time by oglre-shader-embed. See ShaderPreprocessor.
+struct EmbeddedShaderProgram {
+    const char* name; // The program file's name without its extension, e.g. "Basic".
+    std::span<const char* const> files;
+    std::span<const EmbeddedShaderStage> stages;
+};
+
+// Defined in the generated EmbeddedShaders.cpp.
+std::span<const EmbeddedShaderProgram> GetEmbeddedShaderPrograms();
+
+// Returns nullptr if there is no program called name.
+inline const EmbeddedShaderProgram* FindEmbeddedShaderProgram(std::string_view name)
+{
+    for (const EmbeddedShaderProgram& program : GetEmbeddedShaderPrograms()) {
+        if (program.name == name) {
+            return &program;
+        }
+    }
+    return nullptr;
+}
+}
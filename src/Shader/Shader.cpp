@@ -1,73 +1,198 @@
 #include <array>
 #include <cstdint>
+#include <string_view>
+#include <vector>
 
+#include "GLStateCache.h"
 #include "Shader.h"
+#include "ShaderCache.h"
+#include "UniformBuffer.h"
+#include "VertexArray.h"
 
-Shader::Shader(const std::string& filepath)
+namespace {
+constexpr std::array<uint32_t, 4> glShaderTypes = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER, GL_COMPUTE_SHADER };
+
+// The shared blocks of Uniforms.glsl, with the binding and size of their C++ structs.
+struct SharedUniformBlock {
+    const char* name;
+    uint32_t binding;
+    uint32_t size;
+};
+
+constexpr std::array<SharedUniformBlock, 3> sharedUniformBlocks = { {
+    { Oglre::FrameUniforms::blockName, Oglre::FrameUniforms::binding, sizeof(Oglre::FrameUniforms) },
+    { Oglre::ObjectUniforms::blockName, Oglre::ObjectUniforms::binding, sizeof(Oglre::ObjectUniforms) },
+    { Oglre::ViewUniforms::blockName, Oglre::ViewUniforms::binding, sizeof(Oglre::ViewUniforms) },
+} };
+}
+
+Shader::Shader(const std::string& name, const std::vector<std::string>& defines)
     : m_RendererID(0)
-    , m_FilePath(filepath)
+    , m_Name(name)
+    , m_Defines(defines)
 {
-    ShaderProgramSource shaderSource = ParseShader(filepath);
-    m_RendererID = CreateShader(shaderSource.vertexSource, shaderSource.fragmentSource);
+    m_Program = Oglre::FindEmbeddedShaderProgram(name);
+    if (!m_Program) {
+        std::cout << "No shader program called " << name << " was embedded, see resources/shaders and meson.build." << std::endl;
+        return;
+    }
+
+    // The sources were preprocessed at build time, so a permutation is only a matter of adding its defines.
+    std::vector<std::string> sources;
+    for (const Oglre::EmbeddedShaderStage& stage : m_Program->stages) {
+        if (!Oglre::ShaderPreprocessor::IsStageEnabled(stage.condition, defines)) {
+            continue;
+        }
+        m_Stages.push_back(stage.stage);
+        sources.push_back(Oglre::ShaderPreprocessor::GetPermutationSource(stage.version, stage.body, defines));
+    }
+
+    const std::vector<std::string_view> sourceViews(sources.begin(), sources.end());
+    m_CacheKey = Oglre::ShaderCache::GetKey(sourceViews);
+
+    m_RendererID = LoadCachedProgram();
+    if (m_RendererID != 0) {
+        Oglre::ShaderCache::CountHit();
+        Reflect();
+    } else {
+        Oglre::ShaderCache::CountMiss();
+        m_RendererID = CreateShader(sources);
+    }
 }
 Shader::~Shader()
 {
-    glDeleteProgram(m_RendererID);
+    Oglre::GLStateCache::DeleteProgram(m_RendererID);
+}
+
+void Shader::EnableParallelCompile()
+{
+    m_isParallelCompileSupported = GLEW_KHR_parallel_shader_compile;
+    if (m_isParallelCompileSupported) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+}
+
+bool Shader::IsReady() const
+{
+    if (!m_IsLinking || !m_isParallelCompileSupported) {
+        return true;
+    }
+
+    int isComplete = GL_FALSE;
+    glGetProgramiv(m_RendererID, GL_COMPLETION_STATUS_KHR, &isComplete);
+    return isComplete == GL_TRUE;
 }
 
 void Shader::Bind() const
 {
-    glUseProgram(m_RendererID);
+    FinishLinking();
+    Oglre::GLStateCache::UseProgram(m_RendererID);
 }
 void Shader::Unbind() const
 {
-    glUseProgram(0);
+    Oglre::GLStateCache::UseProgram(0);
+}
+
+Shader::UniformHandle Shader::GetUniformHandle(std::string_view name) const
+{
+    FinishLinking();
+
+    // Uniforms in blocks have no location of their own, they are set through the block's buffer.
+    const Oglre::ShaderUniform* uniform = m_Reflection.FindUniform(name);
+    if (uniform == nullptr || uniform->location == -1) {
+        std::cout << "Warning: " << GetPermutationName() << " has no active uniform '" << name << "'!" << std::endl;
+        return {};
+    }
+
+    return { uniform->location };
 }
 
-void Shader::SetUniform(const std::string& name, float v0, float v1, float v2, float v3)
+void Shader::SetUniform(UniformHandle handle, const glm::vec4& vector) const
 {
-    glUniform4f(GetUniformLocation(name), v0, v1, v2, v3);
+    const int nElements = 1;
+    glProgramUniform4fv(m_RendererID, handle.location, nElements, &vector[0]);
 }
 
-void Shader::SetUniformMat4f(const std::string& name, const glm::mat4 matrix)
+void Shader::SetUniform(UniformHandle handle, const glm::mat4& matrix) const
 {
     const int nElements = 1;
-    glUniformMatrix4fv(GetUniformLocation(name), nElements, GL_FALSE, &matrix[0][0]);
+    glProgramUniformMatrix4fv(m_RendererID, handle.location, nElements, GL_FALSE, &matrix[0][0]);
 }
 
-Shader::ShaderProgramSource Shader::ParseShader(const std::string& filepath)
+bool Shader::CheckVertexInputs(const Oglre::VertexArray& va) const
 {
-    // For separating the two stringstreams.
-    enum class ShaderType {
-        NONE = -1,
-        VERTEX = 0,
-        FRAGMENT = 1
+    FinishLinking();
+
+    // Attributes are always specified with glVertexAttribPointer(), so they arrive as floats. Fewer components than
+    // the input has are filled in with (0, 0, 0, 1), but more are dropped, which is most likely a layout mistake.
+    bool isMatching = true;
+    const auto report = [&](const Oglre::ShaderInput& input, uint32_t location, const std::string& problem) {
+        std::cout << "Vertex array " << va.GetRendererID() << " does not match " << GetPermutationName() << ": input '" << input.name
+                  << "' at location " << location << " " << problem << std::endl;
+        isMatching = false;
     };
 
-    std::ifstream stream(filepath);
-    std::array<std::stringstream, 2> ss;
+    for (const Oglre::ShaderInput& input : m_Reflection.GetInputs()) {
+        // Built-ins, e.g. gl_VertexID, come from the draw rather than the vertex array.
+        if (input.location < 0) {
+            continue;
+        }
+
+        const Oglre::ShaderTypeInfo typeInfo = Oglre::GetShaderTypeInfo(input.type);
+        if (typeInfo.columns == 0) {
+            report(input, input.location, "is of a type that vertex arrays cannot feed");
+            continue;
+        }
+        if (typeInfo.isInteger) {
+            report(input, input.location, "is an integer, but attributes are always converted to floats");
+            continue;
+        }
 
-    std::string line = "";
-    ShaderType type = ShaderType::NONE;
+        // Matrices and arrays take up one location per column and element.
+        const uint32_t locationCount = typeInfo.columns * input.arraySize;
+        for (uint32_t column = 0; column < locationCount; ++column) {
+            const uint32_t location = input.location + column;
+            const Oglre::VertexBufferElement* element = va.GetAttribute(location);
 
-    // Read lines from the file while separating the two shader types into different stringstreams.
-    while (getline(stream, line)) {
-        if (line.find("#shader") != std::string::npos) {
-            if (line.find("vertex") != std::string::npos) {
-                type = ShaderType::VERTEX;
-            } else if (line.find("fragment") != std::string::npos) {
-                type = ShaderType::FRAGMENT;
+            if (element == nullptr) {
+                report(input, location, "has no attribute, and would read a constant");
+                break;
+            }
+            if (!Oglre::VertexBufferElement::IsPackedType(element->type) && element->count > typeInfo.components) {
+                report(input, location, "has " + std::to_string(typeInfo.components) + " components, but its attribute has " + std::to_string(element->count));
             }
-        } else {
-            ss[static_cast<int>(type)] << line << "\n";
         }
     }
 
-    ShaderProgramSource shaders;
-    shaders.vertexSource = ss[0].str();
-    shaders.fragmentSource = ss[1].str();
+    return isMatching;
+}
 
-    return shaders;
+const Oglre::ShaderReflection& Shader::GetReflection() const
+{
+    FinishLinking();
+    return m_Reflection;
+}
+
+uint32_t Shader::LoadCachedProgram()
+{
+    uint32_t format = 0;
+    std::vector<std::byte> binary;
+    if (!Oglre::ShaderCache::Load(m_CacheKey, format, binary)) {
+        return 0;
+    }
+
+    unsigned int program = glCreateProgram();
+    glProgramBinary(program, format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+    // Drivers may reject binaries, e.g. after an update that kept the version string.
+    int result = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &result);
+    if (result == GL_FALSE) {
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
 }
 
 uint32_t Shader::CompileShader(uint32_t shaderType, const std::string& source)
@@ -82,62 +207,126 @@ uint32_t Shader::CompileShader(uint32_t shaderType, const std::string& source)
     glShaderSource(id, numberOfShaderSources, &src, nullptr);
     glCompileShader(id);
 
+    return id;
+}
+
+bool Shader::CheckCompileStatus(uint32_t id, Oglre::ShaderStage stage) const
+{
     // Error handling.
     int result = 0;
     glGetShaderiv(id, GL_COMPILE_STATUS, &result);
     if (result == GL_FALSE) {
         int errorMessageLength = 0;
         glGetShaderiv(id, GL_INFO_LOG_LENGTH, &errorMessageLength);
-        std::string message = "";
+        std::string message(errorMessageLength, '\0');
         glGetShaderInfoLog(id, errorMessageLength, &errorMessageLength, message.data());
+        message.resize(errorMessageLength);
 
         // A bit hacky, will eventually need proper logging.
-        std::cout << "Failed to compile " << (shaderType == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader!\n"
-                  << message << std::endl;
-
-        glDeleteShader(id);
+        // Errors are reported as source string number:line, the files are numbered in the order they are listed.
+        std::cout << "Failed to compile " << Oglre::GetShaderStageName(stage) << " shader of " << GetPermutationName() << "!\n";
+        for (size_t file = 0; file < m_Program->files.size(); ++file) {
+            std::cout << file << ": " << m_Program->files[file] << "\n";
+        }
+        std::cout << message << std::endl;
 
-        return 0;
+        return false;
     }
 
-    return id;
+    return true;
 }
 
-uint32_t Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+uint32_t Shader::CreateShader(const std::vector<std::string>& sources)
 {
-    // Need error handling.
     unsigned int program = glCreateProgram();
-    unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
 
     // These steps create an executable that is run on the programmable vertex/fragment shader processer on the GPU.
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
+    // Nothing is queried until FinishLinking(), so that the driver can compile and link in the background.
+    for (size_t i = 0; i < sources.size(); ++i) {
+        m_ShaderIDs.push_back(CompileShader(glShaderTypes[static_cast<size_t>(m_Stages[i])], sources[i]));
+        glAttachShader(program, m_ShaderIDs.back());
+    }
+    if (Oglre::ShaderCache::IsEnabled()) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(program);
-    glValidateProgram(program);
+    m_IsLinking = true;
+
+    return program;
+}
+
+void Shader::FinishLinking() const
+{
+    if (!m_IsLinking) {
+        return;
+    }
+    m_IsLinking = false;
+
+    bool isCompiled = true;
+    for (size_t i = 0; i < m_ShaderIDs.size(); ++i) {
+        isCompiled = CheckCompileStatus(m_ShaderIDs[i], m_Stages[i]) && isCompiled;
+    }
+
+    int result = 0;
+    glGetProgramiv(m_RendererID, GL_LINK_STATUS, &result);
+    if (result == GL_FALSE && isCompiled) {
+        int errorMessageLength = 0;
+        glGetProgramiv(m_RendererID, GL_INFO_LOG_LENGTH, &errorMessageLength);
+        std::string message(errorMessageLength, '\0');
+        glGetProgramInfoLog(m_RendererID, errorMessageLength, &errorMessageLength, message.data());
+        message.resize(errorMessageLength);
+
+        std::cout << "Failed to link " << GetPermutationName() << "!\n"
+                  << message << std::endl;
+    }
+
+    if (result == GL_TRUE && Oglre::ShaderCache::IsEnabled()) {
+        int binaryLength = 0;
+        glGetProgramiv(m_RendererID, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+
+        std::vector<std::byte> binary(binaryLength);
+        GLenum format = 0;
+        glGetProgramBinary(m_RendererID, binaryLength, &binaryLength, &format, binary.data());
+        binary.resize(binaryLength);
+
+        Oglre::ShaderCache::Store(m_CacheKey, format, binary);
+    }
+
+    if (result == GL_TRUE) {
+        Reflect();
+    }
 
     // Delete to shaders once they have been linked and compiled.
-    glDeleteShader(vs);
-    glDeleteShader(fs);
+    for (uint32_t id : m_ShaderIDs) {
+        glDetachShader(m_RendererID, id);
+        glDeleteShader(id);
+    }
+    m_ShaderIDs.clear();
+}
 
-    return program;
+std::string Shader::GetPermutationName() const
+{
+    std::string name = m_Name;
+    for (size_t i = 0; i < m_Defines.size(); ++i) {
+        name += (i == 0 ? " (" : ", ") + m_Defines[i];
+    }
+    return m_Defines.empty() ? name : name + ")";
 }
 
-uint32_t Shader::GetUniformLocation(const std::string& name)
+void Shader::Reflect() const
 {
-    // If uniform location has not been cached.
-    if (m_UniformLocationCache.find(name) == m_UniformLocationCache.end()) {
-        int location = glGetUniformLocation(m_RendererID, name.c_str());
-        // Sometimes a uniform location can be -1 if unused, for example.
-        if (location == -1) {
-            std::cout << "Warning: uniform '" << name << "' does not exist!" << std::endl;
+    m_Reflection.Reflect(m_RendererID);
+
+    // Blocks are bound by binding point, and written as their C++ structs, so both have to match exactly.
+    for (const SharedUniformBlock& shared : sharedUniformBlocks) {
+        const Oglre::ShaderUniformBlock* block = m_Reflection.FindUniformBlock(shared.name);
+        if (block == nullptr) {
+            continue;
         }
 
-        // Cache location for later.
-        m_UniformLocationCache[name] = location;
-        return location;
-    } else {
-        // Uniform location already exists.
-        return m_UniformLocationCache[name];
+        if (block->binding != shared.binding || block->size != shared.size) {
+            std::cout << "Uniform block " << shared.name << " of " << GetPermutationName() << " is at binding " << block->binding << " with "
+                      << block->size << " bytes, but UniformBuffer.h has binding " << shared.binding << " with " << shared.size << " bytes" << std::endl;
+        }
     }
 }
\ No newline at end of file
@@ -2,47 +2,106 @@
 
 #include <GL/glew.h>
 #include <cstdint>
-#include <fstream>
 #include <iostream>
-#include <sstream>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
 
 #include <glm/glm.hpp>
 
+#include "EmbeddedShaders.h"
+#include "ShaderReflection.h"
+
+namespace Oglre {
+class VertexArray;
+}
+
+// A permutation of one of the programs embedded at build time, see Oglre::ShaderPreprocessor. Only the permutations
+// that are created are ever compiled.
+//
+// Programs are loaded from Oglre::ShaderCache when they can be, otherwise compiled and linked, which happens in the
+// background with GL_KHR_parallel_shader_compile. Create every program up front, do other work, and poll IsReady().
+// Binding a program or setting a uniform before then waits for it.
+//
+// Each program is reflected once it is linked, see Oglre::ShaderReflection. Uniforms are set through handles looked up
+// once, and the shared uniform blocks of resources/shaders/include/Uniforms.glsl are checked against their C++ structs
+// in UniformBuffer.h, then bound by binding point rather than set per program.
 class Shader {
 public:
-    Shader(const std::string& filepath);
+    // A uniform's location, looked up by name once with GetUniformHandle() rather than on every call.
+    struct UniformHandle {
+        int location = -1;
+    };
+
+    // name is the program's file name without its extension, e.g. "Basic". defines select the permutation.
+    Shader(const std::string& name, const std::vector<std::string>& defines = {});
     ~Shader();
 
+    // Lets the driver compile on as many threads as it likes. Call once, after the context is created.
+    static void EnableParallelCompile();
+
+    // False while the program is still compiling or linking in the background.
+    bool IsReady() const;
+
     void Bind() const;
     void Unbind() const;
 
-    void SetUniform(const std::string& name, float f0, float f1, float f2, float f4);
-    void SetUniformMat4f(const std::string& name, const glm::mat4 matrix);
+    inline uint32_t GetRendererID() const
+    {
+        return m_RendererID;
+    }
 
-    // Takes care of returning the two strings from parseShader().
-    struct ShaderProgramSource {
-        std::string vertexSource;
-        std::string fragmentSource;
-    };
+    // Waits for the program to link. Returns a handle that sets nothing if there is no such active uniform.
+    UniformHandle GetUniformHandle(std::string_view name) const;
+
+    // Set on the program itself, so it need not be bound.
+    void SetUniform(UniformHandle handle, const glm::vec4& vector) const;
+    void SetUniform(UniformHandle handle, const glm::mat4& matrix) const;
+
+    // Reports every vertex input of the program that va does not feed, or feeds with the wrong kind of data, to
+    // std::cout. Call when the vertex array is created, rather than finding out from what is drawn. Waits for the
+    // program to link.
+    bool CheckVertexInputs(const Oglre::VertexArray& va) const;
+
+    // Waits for the program to link.
+    const Oglre::ShaderReflection& GetReflection() const;
 
 private:
+    static inline bool m_isParallelCompileSupported = false;
+
     uint32_t m_RendererID;
 
+    // Set while the program is being compiled and linked. Its status is checked, and its binary cached, once it is done.
+    mutable bool m_IsLinking = false;
+    mutable std::vector<uint32_t> m_ShaderIDs; // One per stage in m_Stages.
+    uint64_t m_CacheKey = 0;
+
     // For debugging purposes.
-    std::string m_FilePath;
+    std::string m_Name;
+    std::vector<std::string> m_Defines;
+    const Oglre::EmbeddedShaderProgram* m_Program = nullptr;
+    std::vector<Oglre::ShaderStage> m_Stages; // The stages of m_Program in this permutation.
 
-    // For caching the uniform location.
-    // Constantly retrieving the uniform location is slow and unnecessary, hence the cache.
-    std::unordered_map<std::string, int> m_UniformLocationCache;
+    // The program's active resources, read once it is linked.
+    mutable Oglre::ShaderReflection m_Reflection;
 
-    ShaderProgramSource ParseShader(const std::string& filepath);
+    // Returns the ID of a program made from the cached binary, or 0 if there is none or the driver rejects it.
+    uint32_t LoadCachedProgram();
 
     // Ensure that source string does not go out of scope before running compileShader().
     uint32_t CompileShader(uint32_t type, const std::string& source);
+    bool CheckCompileStatus(uint32_t id, Oglre::ShaderStage stage) const;
+
+    // Returns ID for a program that combines a shader per source, one for each of m_Stages. Compiling and
+    // linking is only started, FinishLinking() checks the result.
+    uint32_t CreateShader(const std::vector<std::string>& sources);
+
+    // Name and defines, for error messages.
+    std::string GetPermutationName() const;
+
+    // Waits for the program to link if it is still linking, reports errors, caches its binary, and reflects it.
+    void FinishLinking() const;
 
-    // Returns ID for a shader that combines the vertexShader and the fragmentShader.
-    uint32_t CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-    uint32_t GetUniformLocation(const std::string& name);
+    // Reads m_Reflection and reports shared uniform blocks that differ from their C++ structs.
+    void Reflect() const;
 };
\ No newline at end of file
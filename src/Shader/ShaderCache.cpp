@@ -0,0 +1,152 @@
+#include "ShaderCache.h"
+
+#include <GL/glew.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+// Written before each binary.
+struct ShaderCacheHeader {
+    char magic[4] = { 'O', 'G', 'S', 'B' };
+    uint32_t version = 1;
+    uint64_t key = 0;
+    uint32_t format = 0;
+    uint32_t binarySize = 0;
+};
+
+// FNV-1a, continuing from hash.
+uint64_t Hash(std::string_view data, uint64_t hash = 14695981039346656037ull)
+{
+    for (char c : data) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+}
+
+void Oglre::ShaderCache::SetDirectory(const std::string& directory)
+{
+    m_directory = directory;
+}
+
+bool Oglre::ShaderCache::IsEnabled()
+{
+    if (m_directory.empty()) {
+        return false;
+    }
+
+    if (m_isSupported < 0) {
+        int formatCount = 0;
+        if (GLEW_ARB_get_program_binary) {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        }
+        m_isSupported = formatCount > 0;
+
+        if (!m_isSupported) {
+            std::cout << "Program binaries are not supported by this context, shaders will not be cached." << std::endl;
+        }
+    }
+
+    return m_isSupported;
+}
+
+uint64_t Oglre::ShaderCache::GetKey(std::span<const std::string_view> sources)
+{
+    if (m_driverString.empty()) {
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const GLubyte* string = glGetString(name);
+            m_driverString += string ? reinterpret_cast<const char*>(string) : "";
+            m_driverString += '\n';
+        }
+    }
+
+    // Each source's length goes in too, so that moving text from one source to the next changes the key.
+    uint64_t hash = Hash(m_driverString);
+    for (std::string_view source : sources) {
+        const uint64_t length = source.size();
+        hash = Hash(std::string_view(reinterpret_cast<const char*>(&length), sizeof(length)), hash);
+        hash = Hash(source, hash);
+    }
+    return hash;
+}
+
+bool Oglre::ShaderCache::Load(uint64_t key, uint32_t& format, std::vector<std::byte>& binary)
+{
+    if (!IsEnabled()) {
+        return false;
+    }
+
+    std::ifstream stream(GetPath(key), std::ios::binary | std::ios::ate);
+    if (!stream) {
+        return false;
+    }
+    const std::streamoff fileSize = stream.tellg();
+    stream.seekg(0);
+
+    ShaderCacheHeader header;
+    const ShaderCacheHeader expected;
+    stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!stream || std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != expected.version || header.key != key) {
+        return false;
+    }
+
+    // The header is not trusted with the allocation size: a corrupt file must not make the cache allocate gigabytes.
+    if (fileSize < 0 || static_cast<uint64_t>(fileSize) - sizeof(header) != header.binarySize) {
+        return false;
+    }
+
+    binary.resize(header.binarySize);
+    stream.read(reinterpret_cast<char*>(binary.data()), header.binarySize);
+    if (!stream) {
+        return false;
+    }
+
+    format = header.format;
+    return true;
+}
+
+void Oglre::ShaderCache::Store(uint64_t key, uint32_t format, std::span<const std::byte> binary)
+{
+    if (!IsEnabled() || binary.empty()) {
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+
+    // Written to a temporary file first, so that an interrupted write never leaves a truncated binary behind.
+    const std::string path = GetPath(key);
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!stream) {
+            std::cout << "Could not write " << temporaryPath << std::endl;
+            return;
+        }
+
+        ShaderCacheHeader header;
+        header.key = key;
+        header.format = format;
+        header.binarySize = static_cast<uint32_t>(binary.size());
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+    }
+
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::cout << "Could not write " << path << ": " << error.message() << std::endl;
+    }
+}
+
+std::string Oglre::ShaderCache::GetPath(uint64_t key)
+{
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(m_directory) / (std::string(name) + ".bin")).string();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Oglre {
+
+// ------------
+// Shader Cache
+// ------------
+//
+// Linked program binaries on disk, from glGetProgramBinary(), so that later runs can skip compiling and linking with
+// glProgramBinary(). Binaries are only valid for the driver that made them, so each is keyed by a hash of the
+// program's sources and the GL vendor, renderer and version strings. A driver update changes the key, and the program
+// is compiled from source again.
+//
+// Files are <directory>/<key>.bin. Needs a current context, and at least one program binary format, which some
+// drivers only offer with their own shader cache enabled.
+class ShaderCache {
+public:
+    // Empty disables the cache.
+    static void SetDirectory(const std::string& directory);
+
+    static bool IsEnabled();
+
+    static uint64_t GetKey(std::span<const std::string_view> sources);
+
+    // Returns false if there is no binary for key.
+    static bool Load(uint64_t key, uint32_t& format, std::vector<std::byte>& binary);
+    static void Store(uint64_t key, uint32_t format, std::span<const std::byte> binary);
+
+    // Programs loaded from the cache, and programs that had to be compiled, since the start of the run.
+    static inline uint32_t GetHitCount()
+    {
+        return m_hitCount;
+    }
+
+    static inline uint32_t GetMissCount()
+    {
+        return m_missCount;
+    }
+
+    // Counts a program made from its cached binary.
+    static inline void CountHit()
+    {
+        ++m_hitCount;
+    }
+
+    // Counts a program that was compiled from source, either because it was not cached or the driver rejected it.
+    static inline void CountMiss()
+    {
+        ++m_missCount;
+    }
+
+private:
+    static inline std::string m_directory;
+    static inline std::string m_driverString; // Vendor, renderer and version, read on first use.
+    static inline int m_isSupported = -1; // -1 until checked.
+
+    static inline uint32_t m_hitCount = 0;
+    static inline uint32_t m_missCount = 0;
+
+    static std::string GetPath(uint64_t key);
+};
+}
@@ -0,0 +1,269 @@
+#include "ShaderPreprocessor.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+constexpr std::array<const char*, 4> stageNames = { "vertex", "fragment", "geometry", "compute" };
+
+// The directive of line, e.g. "include" for "  #include "File.glsl"", with argument set to the rest of the line.
+std::string_view GetDirective(std::string_view line, std::string_view& argument)
+{
+    const size_t hash = line.find_first_not_of(" \t");
+    if (hash == std::string_view::npos || line[hash] != '#') {
+        return {};
+    }
+
+    const size_t nameStart = line.find_first_not_of(" \t", hash + 1);
+    if (nameStart == std::string_view::npos) {
+        return {};
+    }
+
+    size_t nameEnd = nameStart;
+    while (nameEnd < line.size() && std::isalpha(static_cast<unsigned char>(line[nameEnd]))) {
+        ++nameEnd;
+    }
+
+    const size_t argumentStart = std::min(line.find_first_not_of(" \t", nameEnd), line.size());
+    argument = line.substr(argumentStart);
+    return line.substr(nameStart, nameEnd - nameStart);
+}
+
+bool IsBlank(std::string_view text)
+{
+    return text.find_first_not_of(" \t\r\n") == std::string_view::npos;
+}
+
+// Empty text counts, as no condition.
+bool IsIdentifier(std::string_view text)
+{
+    for (size_t i = 0; i < text.size(); ++i) {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        if (!(std::isalpha(c) || c == '_' || (i > 0 && std::isdigit(c)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+class Preprocessor {
+public:
+    Preprocessor(const Oglre::ShaderPreprocessor::FileReader& readFile, Oglre::PreprocessedShader& shader)
+        : m_ReadFile(readFile)
+        , m_Shader(shader)
+    {
+    }
+
+    bool ProcessProgram(const std::string& path, const std::string& text)
+    {
+        m_Shader.files.push_back(path);
+
+        uint32_t lineNumber = 0;
+        std::istringstream stream(text);
+        std::string line;
+        while (std::getline(stream, line)) {
+            ++lineNumber;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+
+            std::string_view argument;
+            const std::string_view directive = GetDirective(line, argument);
+
+            if (directive == "shader") {
+                const size_t nameEnd = std::min(argument.find_first_of(" \t"), argument.size());
+                const auto name = std::find(stageNames.begin(), stageNames.end(), argument.substr(0, nameEnd));
+                if (name == stageNames.end()) {
+                    std::cout << path << ":" << lineNumber << ": unknown shader stage '" << argument << "'" << std::endl;
+                    return false;
+                }
+
+                std::string_view condition = argument.substr(std::min(argument.find_first_not_of(" \t", nameEnd), argument.size()));
+                condition = condition.substr(0, condition.find_last_not_of(" \t") + 1);
+                if (!IsIdentifier(condition)) {
+                    std::cout << path << ":" << lineNumber << ": expected a define name after the stage, not '" << condition << "'" << std::endl;
+                    return false;
+                }
+
+                if (!FinishStage()) {
+                    return false;
+                }
+                Oglre::ShaderStageSource& stage = m_Shader.stages.emplace_back();
+                stage.stage = static_cast<Oglre::ShaderStage>(name - stageNames.begin());
+                stage.condition = condition;
+                m_IncludedFiles.clear();
+                continue;
+            }
+
+            if (m_Shader.stages.empty()) {
+                if (!IsBlank(line)) {
+                    std::cout << path << ":" << lineNumber << ": expected #shader before any source" << std::endl;
+                    return false;
+                }
+                continue;
+            }
+
+            Oglre::ShaderStageSource& stage = m_Shader.stages.back();
+            if (directive == "version") {
+                if (!stage.version.empty() || !IsBlank(stage.body)) {
+                    std::cout << path << ":" << lineNumber << ": #version must be the first line of a stage" << std::endl;
+                    return false;
+                }
+
+                // Lines are numbered as in the file, whatever is put after the #version line.
+                stage.version = line + "\n";
+                stage.body = "#line " + std::to_string(lineNumber + 1) + " 0\n";
+                continue;
+            }
+
+            if (!ProcessLine(path, 0, lineNumber, line, directive, argument)) {
+                return false;
+            }
+        }
+
+        return FinishStage();
+    }
+
+private:
+    const Oglre::ShaderPreprocessor::FileReader& m_ReadFile;
+    Oglre::PreprocessedShader& m_Shader;
+
+    // Files included in the current stage, which are not included again.
+    std::vector<std::string> m_IncludedFiles;
+
+    bool FinishStage()
+    {
+        if (!m_Shader.stages.empty() && m_Shader.stages.back().version.empty()) {
+            std::cout << m_Shader.files[0] << ": " << Oglre::GetShaderStageName(m_Shader.stages.back().stage) << " stage has no #version" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool ProcessLine(const std::string& path, uint32_t fileIndex, uint32_t lineNumber, const std::string& line, std::string_view directive, std::string_view argument)
+    {
+        Oglre::ShaderStageSource& stage = m_Shader.stages.back();
+
+        if (directive == "shader" || directive == "version") {
+            std::cout << path << ":" << lineNumber << ": #" << directive << " is only allowed in program files" << std::endl;
+            return false;
+        }
+
+        if (directive != "include") {
+            stage.body += line;
+            stage.body += '\n';
+            return true;
+        }
+
+        const size_t nameEnd = argument.size() > 1 && argument[0] == '"' ? argument.find('"', 1) : std::string_view::npos;
+        if (nameEnd == std::string_view::npos) {
+            std::cout << path << ":" << lineNumber << ": expected #include \"File.glsl\"" << std::endl;
+            return false;
+        }
+
+        const std::filesystem::path includePath = (std::filesystem::path(path).parent_path() / argument.substr(1, nameEnd - 1)).lexically_normal();
+        const std::string includeFile = includePath.generic_string();
+        if (std::find(m_IncludedFiles.begin(), m_IncludedFiles.end(), includeFile) != m_IncludedFiles.end()) {
+            stage.body += '\n';
+            return true;
+        }
+        m_IncludedFiles.push_back(includeFile);
+
+        std::string text;
+        if (!m_ReadFile(includeFile, text)) {
+            std::cout << path << ":" << lineNumber << ": cannot include " << includeFile << std::endl;
+            return false;
+        }
+
+        // Files keep their source string number in every stage.
+        const auto file = std::find(m_Shader.files.begin(), m_Shader.files.end(), includeFile);
+        const uint32_t includeIndex = static_cast<uint32_t>(file - m_Shader.files.begin());
+        if (file == m_Shader.files.end()) {
+            m_Shader.files.push_back(includeFile);
+        }
+
+        stage.body += "#line 1 " + std::to_string(includeIndex) + "\n";
+
+        uint32_t includeLineNumber = 0;
+        std::istringstream stream(text);
+        std::string includeLine;
+        while (std::getline(stream, includeLine)) {
+            ++includeLineNumber;
+            if (!includeLine.empty() && includeLine.back() == '\r') {
+                includeLine.pop_back();
+            }
+
+            std::string_view includeArgument;
+            const std::string_view includeDirective = GetDirective(includeLine, includeArgument);
+            if (!ProcessLine(includeFile, includeIndex, includeLineNumber, includeLine, includeDirective, includeArgument)) {
+                return false;
+            }
+        }
+
+        stage.body += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+        return true;
+    }
+};
+}
+
+const char* Oglre::GetShaderStageName(ShaderStage stage)
+{
+    return stageNames[static_cast<size_t>(stage)];
+}
+
+bool Oglre::ShaderPreprocessor::Preprocess(const std::string& path, const FileReader& readFile, PreprocessedShader& shader)
+{
+    shader = {};
+
+    std::string text;
+    if (!readFile(path, text)) {
+        std::cout << "Could not open " << path << std::endl;
+        return false;
+    }
+
+    Preprocessor preprocessor(readFile, shader);
+    return preprocessor.ProcessProgram(path, text);
+}
+
+bool Oglre::ShaderPreprocessor::ReadFile(const std::string& path, std::string& text)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) {
+        return false;
+    }
+
+    std::ostringstream contents;
+    contents << stream.rdbuf();
+    text = contents.str();
+    return true;
+}
+
+std::string Oglre::ShaderPreprocessor::GetPermutationSource(std::string_view version, std::string_view body, std::span<const std::string> defines)
+{
+    std::string source(version);
+    for (const std::string& define : defines) {
+        source += "#define ";
+        source += define;
+        source += '\n';
+    }
+    source += body;
+    return source;
+}
+
+bool Oglre::ShaderPreprocessor::IsStageEnabled(std::string_view condition, std::span<const std::string> defines)
+{
+    if (condition.empty()) {
+        return true;
+    }
+
+    // Defines may have a value after their name.
+    return std::any_of(defines.begin(), defines.end(), [condition](const std::string& define) {
+        return std::string_view(define).substr(0, define.find(' ')) == condition;
+    });
+}
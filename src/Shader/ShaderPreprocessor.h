@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Oglre {
+
+enum class ShaderStage {
+    VERTEX = 0,
+    FRAGMENT,
+    GEOMETRY,
+    COMPUTE
+};
+
+const char* GetShaderStageName(ShaderStage stage);
+
+// One stage of a preprocessed program. The #version line is kept apart from the rest, so that a permutation's defines
+// can go between them.
+struct ShaderStageSource {
+    ShaderStage stage = ShaderStage::VERTEX;
+    std::string condition; // Define that permutations need for the stage to be part of them, empty for every permutation.
+    std::string version;
+    std::string body;
+};
+
+// A program file with its includes resolved. files are the program file then every file it included, in the order of
+// the GLSL source string numbers used by the #line directives, so compile errors of "1:12" are line 12 of files[1].
+struct PreprocessedShader {
+    std::vector<std::string> files;
+    std::vector<ShaderStageSource> stages;
+};
+
+// -------------------
+// Shader Preprocessor
+// -------------------
+//
+// Program files hold every stage of a program, each starting with a "#shader vertex", "#shader fragment",
+// "#shader geometry" or "#shader compute" line, followed by its #version line. A stage only some permutations need
+// names the define that selects it, e.g. "#shader geometry MULTIVIEW", and is left out of every other permutation.
+//
+// #include "File.glsl" pastes in File.glsl, relative to the including file. A file is only included once per stage,
+// so include files need no guards, and cannot include each other in a loop.
+//
+// Permutations are the same program compiled with different sets of #defines, e.g. INSTANCED, which the program
+// tests with #ifdef. GLSL's own preprocessor does the rest, so the #ifdefs are left as they are.
+class ShaderPreprocessor {
+public:
+    // Returns false if the file cannot be read.
+    using FileReader = std::function<bool(const std::string& path, std::string& text)>;
+
+    // Reads path and the files it includes with readFile. Errors are reported to std::cout.
+    static bool Preprocess(const std::string& path, const FileReader& readFile, PreprocessedShader& shader);
+
+    static bool ReadFile(const std::string& path, std::string& text);
+
+    // The source of a stage for one permutation: its #version line, a #define per define, then its body. Defines are
+    // a name, optionally followed by a space and a value.
+    static std::string GetPermutationSource(std::string_view version, std::string_view body, std::span<const std::string> defines);
+
+    // True if a stage with condition, see ShaderStageSource, is part of the permutation with defines.
+    static bool IsStageEnabled(std::string_view condition, std::span<const std::string> defines);
+};
+}
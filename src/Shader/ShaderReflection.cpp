@@ -0,0 +1,124 @@
+#include "ShaderReflection.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <array>
+
+namespace {
+
+// The name of resource index of interface, without the "[0]" that arrays are reported with.
+std::string GetResourceName(uint32_t program, GLenum interface, uint32_t index, int nameLength)
+{
+    std::string name(std::max(nameLength, 1), '\0');
+    GLsizei length = 0;
+    glGetProgramResourceName(program, interface, index, static_cast<GLsizei>(name.size()), &length, name.data());
+    name.resize(length);
+
+    if (name.ends_with("[0]")) {
+        name.resize(name.size() - 3);
+    }
+    return name;
+}
+
+// Values of properties for resource index of interface, in the same order.
+template <size_t N>
+std::array<GLint, N> GetResourceProperties(uint32_t program, GLenum interface, uint32_t index, const std::array<GLenum, N>& properties)
+{
+    std::array<GLint, N> values {};
+    glGetProgramResourceiv(program, interface, index, static_cast<GLsizei>(N), properties.data(), static_cast<GLsizei>(N), nullptr, values.data());
+    return values;
+}
+
+uint32_t GetResourceCount(uint32_t program, GLenum interface)
+{
+    GLint count = 0;
+    glGetProgramInterfaceiv(program, interface, GL_ACTIVE_RESOURCES, &count);
+    return static_cast<uint32_t>(count);
+}
+}
+
+Oglre::ShaderTypeInfo Oglre::GetShaderTypeInfo(uint32_t type)
+{
+    // clang-format off
+    switch (type)
+    {
+        case GL_FLOAT:              return { 1, 1, false };
+        case GL_FLOAT_VEC2:         return { 2, 1, false };
+        case GL_FLOAT_VEC3:         return { 3, 1, false };
+        case GL_FLOAT_VEC4:         return { 4, 1, false };
+        case GL_FLOAT_MAT2:         return { 2, 2, false };
+        case GL_FLOAT_MAT3:         return { 3, 3, false };
+        case GL_FLOAT_MAT4:         return { 4, 4, false };
+        case GL_INT:                return { 1, 1, true };
+        case GL_INT_VEC2:           return { 2, 1, true };
+        case GL_INT_VEC3:           return { 3, 1, true };
+        case GL_INT_VEC4:           return { 4, 1, true };
+        case GL_UNSIGNED_INT:       return { 1, 1, true };
+        case GL_UNSIGNED_INT_VEC2:  return { 2, 1, true };
+        case GL_UNSIGNED_INT_VEC3:  return { 3, 1, true };
+        case GL_UNSIGNED_INT_VEC4:  return { 4, 1, true };
+    }
+    // clang-format on
+
+    return {};
+}
+
+void Oglre::ShaderReflection::Reflect(uint32_t program)
+{
+    m_Uniforms.clear();
+    m_UniformBlocks.clear();
+    m_Inputs.clear();
+
+    const uint32_t uniformCount = GetResourceCount(program, GL_UNIFORM);
+    m_Uniforms.reserve(uniformCount);
+    for (uint32_t i = 0; i < uniformCount; ++i) {
+        const auto values = GetResourceProperties(program, GL_UNIFORM, i, std::array<GLenum, 5> { GL_NAME_LENGTH, GL_TYPE, GL_LOCATION, GL_BLOCK_INDEX, GL_ARRAY_SIZE });
+
+        ShaderUniform& uniform = m_Uniforms.emplace_back();
+        uniform.name = GetResourceName(program, GL_UNIFORM, i, values[0]);
+        uniform.type = static_cast<uint32_t>(values[1]);
+        uniform.location = values[2];
+        uniform.blockIndex = values[3];
+        uniform.arraySize = static_cast<uint32_t>(std::max(values[4], 1));
+    }
+
+    const uint32_t blockCount = GetResourceCount(program, GL_UNIFORM_BLOCK);
+    m_UniformBlocks.reserve(blockCount);
+    for (uint32_t i = 0; i < blockCount; ++i) {
+        const auto values = GetResourceProperties(program, GL_UNIFORM_BLOCK, i, std::array<GLenum, 3> { GL_NAME_LENGTH, GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE });
+
+        ShaderUniformBlock& block = m_UniformBlocks.emplace_back();
+        block.name = GetResourceName(program, GL_UNIFORM_BLOCK, i, values[0]);
+        block.binding = static_cast<uint32_t>(values[1]);
+        block.size = static_cast<uint32_t>(values[2]);
+    }
+
+    // Compute programs have no inputs, and report none.
+    const uint32_t inputCount = GetResourceCount(program, GL_PROGRAM_INPUT);
+    m_Inputs.reserve(inputCount);
+    for (uint32_t i = 0; i < inputCount; ++i) {
+        const auto values = GetResourceProperties(program, GL_PROGRAM_INPUT, i, std::array<GLenum, 4> { GL_NAME_LENGTH, GL_TYPE, GL_LOCATION, GL_ARRAY_SIZE });
+
+        ShaderInput& input = m_Inputs.emplace_back();
+        input.name = GetResourceName(program, GL_PROGRAM_INPUT, i, values[0]);
+        input.type = static_cast<uint32_t>(values[1]);
+        input.location = values[2];
+        input.arraySize = static_cast<uint32_t>(std::max(values[3], 1));
+    }
+
+    // Inputs in location order, which is the order VertexArray assigns attributes in.
+    std::sort(m_Inputs.begin(), m_Inputs.end(), [](const ShaderInput& a, const ShaderInput& b) { return a.location < b.location; });
+}
+
+const Oglre::ShaderUniform* Oglre::ShaderReflection::FindUniform(std::string_view name) const
+{
+    const auto uniform = std::find_if(m_Uniforms.begin(), m_Uniforms.end(), [name](const ShaderUniform& u) { return u.name == name; });
+    return uniform != m_Uniforms.end() ? &*uniform : nullptr;
+}
+
+const Oglre::ShaderUniformBlock* Oglre::ShaderReflection::FindUniformBlock(std::string_view name) const
+{
+    const auto block = std::find_if(m_UniformBlocks.begin(), m_UniformBlocks.end(), [name](const ShaderUniformBlock& b) { return b.name == name; });
+    return block != m_UniformBlocks.end() ? &*block : nullptr;
+}
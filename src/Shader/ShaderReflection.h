@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Oglre {
+
+// An active uniform outside of any block, or a member of a uniform block (blockIndex >= 0, location -1).
+struct ShaderUniform {
+    std::string name;
+    uint32_t type = 0; // GL_FLOAT_MAT4 etc.
+    int location = -1;
+    int blockIndex = -1;
+    uint32_t arraySize = 1;
+};
+
+struct ShaderUniformBlock {
+    std::string name;
+    uint32_t binding = 0; // From the block's layout(binding = N).
+    uint32_t size = 0; // Bytes, with std140 padding.
+};
+
+// An active vertex shader input. Built-ins such as gl_VertexID have location -1.
+struct ShaderInput {
+    std::string name;
+    uint32_t type = 0;
+    int location = -1;
+    uint32_t arraySize = 1;
+};
+
+// How a GLSL type is fed from vertex attributes, see GetShaderTypeInfo().
+struct ShaderTypeInfo {
+    uint32_t components = 0; // Per column.
+    uint32_t columns = 0; // Attribute locations taken up, more than 1 for matrices. 0 if the type is not known.
+    bool isInteger = false; // int, uint and bool types, which need glVertexAttribIPointer().
+};
+
+ShaderTypeInfo GetShaderTypeInfo(uint32_t type);
+
+// -----------------
+// Shader Reflection
+// -----------------
+//
+// What a linked program actually uses, read once with glGetProgramResourceiv() (GL 4.3 or
+// GL_ARB_program_interface_query) so that nothing is looked up by name while drawing. Only active resources are
+// listed: anything the compiler optimised out is missing, even if it is declared.
+class ShaderReflection {
+public:
+    // Replaces everything with program's resources. program must be linked.
+    void Reflect(uint32_t program);
+
+    inline const std::vector<ShaderUniform>& GetUniforms() const
+    {
+        return m_Uniforms;
+    }
+
+    inline const std::vector<ShaderUniformBlock>& GetUniformBlocks() const
+    {
+        return m_UniformBlocks;
+    }
+
+    inline const std::vector<ShaderInput>& GetInputs() const
+    {
+        return m_Inputs;
+    }
+
+    // nullptr if there is no such active uniform or block.
+    const ShaderUniform* FindUniform(std::string_view name) const;
+    const ShaderUniformBlock* FindUniformBlock(std::string_view name) const;
+
+private:
+    std::vector<ShaderUniform> m_Uniforms;
+    std::vector<ShaderUniformBlock> m_UniformBlocks;
+    std::vector<ShaderInput> m_Inputs;
+};
+}
@@ -0,0 +1,159 @@
+// Converts OBJ and glTF 2.0 meshes into the engine's .oglm format, see src/Mesh/MeshFile.h.
+// Usage: oglre-meshconv [--threads N] [--texcoords] [--no-optimize] [--quantize] [--lods N] INPUT.(obj|gltf|glb) OUTPUT.oglm
+//
+// --quantize stores positions and texture coordinates as half floats and normals as 10_10_10_2, which halves the size of
+// each vertex. The error this introduces is reported per attribute, half float positions suit small objects best.
+// Meshes are run through MeshOptimizer unless --no-optimize is given, and the vertex cache figures before and after are
+// reported. Up to --lods levels of detail (5 by default, 1 for none) are generated with MeshSimplifier, each with about
+// half the triangles of the one before, and stored alongside the mesh. Also reports import throughput and the process's
+// peak memory, which is what matters for large CAD exports.
+
+#include "Importer.h"
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "VertexQuantizer.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+// Peak resident set size in MB, or 0 where it is not available.
+double GetPeakMemoryMB()
+{
+#if defined(__APPLE__)
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / (1024.0 * 1024.0); // Bytes on macOS.
+#elif defined(__unix__)
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0; // Kilobytes on Linux.
+#else
+    return 0.0;
+#endif
+}
+}
+
+int main(int argc, char* argv[])
+{
+    Oglre::ImportSettings settings;
+    std::string inputPath;
+    std::string outputPath;
+    bool optimize = true;
+    bool quantize = false;
+    Oglre::LodChainSettings lodSettings;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+
+        if (argument == "--threads" && i + 1 < argc) {
+            settings.threadCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (argument == "--texcoords") {
+            settings.includeTexCoords = true;
+        } else if (argument == "--no-optimize") {
+            optimize = false;
+        } else if (argument == "--quantize") {
+            quantize = true;
+        } else if (argument == "--lods" && i + 1 < argc) {
+            lodSettings.maximumLodCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (inputPath.empty()) {
+            inputPath = argument;
+        } else {
+            outputPath = argument;
+        }
+    }
+
+    if (inputPath.empty() || outputPath.empty()) {
+        std::cout << "Usage: oglre-meshconv [--threads N] [--texcoords] [--no-optimize] [--quantize] [--lods N] INPUT.(obj|gltf|glb) OUTPUT.oglm" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Oglre::ImportedMesh mesh;
+    Oglre::ImportStatistics statistics;
+    if (!Oglre::Importer::Import(inputPath, mesh, settings, &statistics)) {
+        return EXIT_FAILURE;
+    }
+
+    const double megabytes = statistics.bytesRead / (1024.0 * 1024.0);
+    std::cout << "Imported " << inputPath << ": " << statistics.vertexCount << " vertices";
+    if (statistics.cornerCount > 0) {
+        std::cout << " (from " << statistics.cornerCount << " face corners)";
+    }
+    std::cout << ", " << mesh.indices.size() / 3 << " triangles\n"
+              << "  " << megabytes << " MB in " << statistics.seconds << "s on " << statistics.threadCount << " threads: "
+              << megabytes / statistics.seconds << " MB/s" << std::endl;
+
+    if (optimize) {
+        const auto optimizeStartTime = std::chrono::steady_clock::now();
+
+        const uint32_t stride = mesh.layout.GetStride();
+        const Oglre::MeshOptimizationReport report = Oglre::MeshOptimizer::Optimize(std::as_writable_bytes(std::span(mesh.vertices)), stride, mesh.indices);
+        mesh.vertices.resize(uint64_t(report.vertexCount) * stride / sizeof(float));
+
+        const double optimizeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - optimizeStartTime).count();
+        const uint32_t indexBits = report.indexType == GL_UNSIGNED_BYTE ? 8 : report.indexType == GL_UNSIGNED_SHORT ? 16 : 32;
+
+        std::cout << "Optimized in " << optimizeTime << "s\n"
+                  << "  ACMR: " << report.before.acmr << " -> " << report.after.acmr << "\n"
+                  << "  ATVR: " << report.before.atvr << " -> " << report.after.atvr << "\n"
+                  << "  Indices: " << indexBits << "-bit" << std::endl;
+    }
+
+    // The levels of detail are made from the optimized vertices, and before quantization, as MeshSimplifier reads float
+    // positions.
+    const auto lodStartTime = std::chrono::steady_clock::now();
+    const Oglre::LodChain lodChain = Oglre::MeshSimplifier::GenerateLodChain(mesh.indices, std::as_bytes(std::span(mesh.vertices)), mesh.layout.GetStride(), lodSettings);
+    const double lodTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - lodStartTime).count();
+
+    std::cout << "Generated " << lodChain.lods.size() << " levels of detail in " << lodTime << "s\n";
+    for (size_t lod = 0; lod < lodChain.lods.size(); ++lod) {
+        std::cout << "  LOD " << lod << ": " << lodChain.lods[lod].indexCount / 3 << " triangles, error " << lodChain.lods[lod].error << "\n";
+    }
+    std::cout << std::flush;
+
+    // Position, normal and, if present, texture coordinate, see Oglre::ImportedMesh.
+    Oglre::VertexBufferLayout layout = mesh.layout;
+    std::span<const std::byte> vertexData = std::as_bytes(std::span(mesh.vertices));
+    std::vector<std::byte> quantizedData;
+
+    if (quantize) {
+        const GLenum attributeTypes[] = { GL_HALF_FLOAT, GL_INT_2_10_10_10_REV, GL_HALF_FLOAT };
+        std::vector<Oglre::QuantizationError> errors;
+
+        const auto quantizeStartTime = std::chrono::steady_clock::now();
+        if (!Oglre::VertexQuantizer::Quantize(mesh.layout, vertexData, attributeTypes, layout, quantizedData, &errors)) {
+            return EXIT_FAILURE;
+        }
+        const double quantizeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - quantizeStartTime).count();
+
+        const char* attributeNames[] = { "Position", "Normal", "Texture coordinate" };
+        std::cout << "Quantized in " << quantizeTime << "s, " << mesh.layout.GetStride() << " -> " << layout.GetStride() << " bytes per vertex\n";
+        for (const Oglre::QuantizationError& error : errors) {
+            std::cout << "  " << attributeNames[error.attribute] << ": max error " << error.maximumError << ", RMS error " << error.rmsError << "\n";
+        }
+        std::cout << std::flush;
+
+        vertexData = quantizedData;
+    }
+
+    const auto writeStartTime = std::chrono::steady_clock::now();
+    if (!Oglre::MeshFile::Write(outputPath, layout, vertexData, lodChain.indices, lodChain.lods)) {
+        return EXIT_FAILURE;
+    }
+    const double writeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - writeStartTime).count();
+
+    std::cout << "Wrote " << outputPath << " in " << writeTime << "s\n"
+              << "Peak memory: " << GetPeakMemoryMB() << " MB" << std::endl;
+
+    return EXIT_SUCCESS;
+}
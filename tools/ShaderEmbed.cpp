@@ -0,0 +1,156 @@
+// Preprocesses shader programs and writes them out as C++, which is compiled into the engine so that shaders need no
+// file I/O or parsing at runtime. Run by the build, see meson.build.
+// Usage: oglre-shader-embed [--depfile FILE.d] OUTPUT.cpp PROGRAM.glsl...
+//
+// Each program is named after its file without the extension, and looked up with FindEmbeddedShaderProgram(). The
+// depfile lists every included file, so that the build reruns this when one of them changes.
+
+#include "ShaderPreprocessor.h"
+
+#include <array>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr std::array<const char*, 4> stageEnumerators = { "VERTEX", "FRAGMENT", "GEOMETRY", "COMPUTE" };
+
+// text as a C++ string literal, split into one literal per line.
+void WriteStringLiteral(std::ostream& stream, const std::string& text, const char* indent)
+{
+    stream << "\n"
+           << indent << "\"";
+    for (size_t i = 0; i < text.size(); ++i) {
+        const char c = text[i];
+        switch (c) {
+        case '\\':
+            stream << "\\\\";
+            break;
+        case '"':
+            stream << "\\\"";
+            break;
+        case '\t':
+            stream << "\\t";
+            break;
+        case '\n':
+            stream << "\\n\"";
+            if (i + 1 < text.size()) {
+                stream << "\n"
+                       << indent << "\"";
+            }
+            continue;
+        default:
+            stream << c;
+        }
+    }
+
+    if (text.empty() || text.back() != '\n') {
+        stream << "\"";
+    }
+}
+
+// A valid C++ identifier for a program name.
+std::string GetIdentifier(const std::string& name)
+{
+    std::string identifier = "program";
+    for (char c : name) {
+        identifier += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    }
+    return identifier;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    std::string outputPath;
+    std::string depfilePath;
+    std::vector<std::string> programPaths;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+
+        if (argument == "--depfile" && i + 1 < argc) {
+            depfilePath = argv[++i];
+        } else if (outputPath.empty()) {
+            outputPath = argument;
+        } else {
+            programPaths.push_back(argument);
+        }
+    }
+
+    if (outputPath.empty() || programPaths.empty()) {
+        std::cout << "Usage: oglre-shader-embed [--depfile FILE.d] OUTPUT.cpp PROGRAM.glsl..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::string> names;
+    std::vector<Oglre::PreprocessedShader> programs(programPaths.size());
+    for (size_t i = 0; i < programPaths.size(); ++i) {
+        if (!Oglre::ShaderPreprocessor::Preprocess(programPaths[i], Oglre::ShaderPreprocessor::ReadFile, programs[i])) {
+            return EXIT_FAILURE;
+        }
+        names.push_back(std::filesystem::path(programPaths[i]).stem().string());
+    }
+
+    std::ofstream output(outputPath, std::ios::binary);
+    if (!output) {
+        std::cout << "Could not write " << outputPath << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    output << "// Generated by oglre-shader-embed, do not edit.\n\n"
+           << "#include \"EmbeddedShaders.h\"\n\n"
+           << "namespace {\n";
+
+    for (size_t i = 0; i < programs.size(); ++i) {
+        const std::string identifier = GetIdentifier(names[i]);
+
+        // Only the file names are kept, for compile errors, not where they were on the build machine.
+        output << "constexpr const char* " << identifier << "Files[] = {";
+        for (const std::string& file : programs[i].files) {
+            const std::string relativeFile = std::filesystem::path(file).lexically_relative(std::filesystem::path(programPaths[i]).parent_path()).generic_string();
+            WriteStringLiteral(output, relativeFile, "    ");
+            output << ",";
+        }
+        output << "\n};\n\n";
+
+        output << "constexpr Oglre::EmbeddedShaderStage " << identifier << "Stages[] = {";
+        for (const Oglre::ShaderStageSource& stage : programs[i].stages) {
+            output << "\n    { Oglre::ShaderStage::" << stageEnumerators[static_cast<size_t>(stage.stage)] << ", \"" << stage.condition << "\",";
+            WriteStringLiteral(output, stage.version, "        ");
+            output << ",";
+            WriteStringLiteral(output, stage.body, "        ");
+            output << " },";
+        }
+        output << "\n};\n\n";
+    }
+
+    output << "constexpr Oglre::EmbeddedShaderProgram programs[] = {\n";
+    for (size_t i = 0; i < programs.size(); ++i) {
+        const std::string identifier = GetIdentifier(names[i]);
+        output << "    { \"" << names[i] << "\", " << identifier << "Files, " << identifier << "Stages },\n";
+    }
+    output << "};\n"
+           << "}\n\n"
+           << "std::span<const Oglre::EmbeddedShaderProgram> Oglre::GetEmbeddedShaderPrograms()\n"
+           << "{\n"
+           << "    return programs;\n"
+           << "}\n";
+
+    if (!depfilePath.empty()) {
+        std::ofstream depfile(depfilePath, std::ios::binary);
+        depfile << outputPath << ":";
+        for (const Oglre::PreprocessedShader& program : programs) {
+            for (const std::string& file : program.files) {
+                depfile << " " << file;
+            }
+        }
+        depfile << "\n";
+    }
+
+    return output ? EXIT_SUCCESS : EXIT_FAILURE;
+}